@@ -0,0 +1,204 @@
+#!/usr/bin/env python3
+"""Converts Deluge song files between XML and the compact binary format (.DBIN).
+
+The binary format carries exactly the same tree of tags and attributes as the XML, so conversion either way is
+lossless as far as the Deluge is concerned. See the comment above BinarySerializer in
+src/deluge/storage/storage_manager.h for the layout.
+
+Usage:
+    deluge_binary.py SONG.XML [OUT.DBIN]
+    deluge_binary.py SONG.DBIN [OUT.XML]
+"""
+
+import re
+import struct
+import sys
+from pathlib import Path
+
+MAGIC = b"DBIN"
+VERSION = 1
+
+RECORD_OPEN = 1
+RECORD_CLOSE = 2
+RECORD_INT = 3
+RECORD_STRING = 4
+RECORD_HEX = 5
+RECORD_BYTES = 6
+RECORD_CONTENT = 0x10
+
+# Must match BinarySerializer::writeValue(), so that converting back gives exactly the same text
+HEX_VALUE = re.compile(r"0x(?:[0-9A-F]{2})+")
+DECIMAL_VALUE = re.compile(r"-?(?:0|[1-9][0-9]*)")
+
+
+def encode_name(name):
+    data = name.encode("utf-8")[:254]
+    return bytes([len(data) + 1]) + data + b"\0"
+
+
+def encode_value(name, value, content=0):
+    if HEX_VALUE.fullmatch(value):
+        data = bytes.fromhex(value[2:])
+        return bytes([RECORD_HEX | content]) + encode_name(name) + encode_chunks(data)
+    if DECIMAL_VALUE.fullmatch(value) and value != "-0" and -(2**31) <= int(value) < 2**31:
+        return bytes([RECORD_INT | content]) + encode_name(name) + struct.pack("<i", int(value))
+    data = value.encode("utf-8")
+    if len(data) > 65534:
+        raise ValueError(f"value of {name} too long")
+    return bytes([RECORD_STRING | content]) + encode_name(name) + struct.pack("<H", len(data) + 1) + data + b"\0"
+
+
+def encode_chunks(data):
+    out = bytearray()
+    for start in range(0, len(data), 65535):
+        chunk = data[start : start + 65535]
+        out += struct.pack("<H", len(chunk)) + chunk
+    return bytes(out + struct.pack("<H", 0))
+
+
+# The Deluge's own XML is read the way the Deluge reads it - no entities, and repeated attribute names are kept
+TOKEN = re.compile(
+    r"<\?.*?\?>|<!--.*?-->"  # Declaration or comment - skipped
+    r"|<\s*/\s*([^\s>]+)\s*>"  # Closing tag
+    r"|<\s*([^\s/>]+)((?:\s*[^\s=/>]+\s*=\s*\"[^\"]*\")*)\s*(/?)>"  # Opening tag, attributes, whether empty
+    r"|([^<]+)",  # Text content
+    re.S,
+)
+ATTRIBUTE = re.compile(r'([^\s=/>]+)\s*=\s*"([^"]*)"')
+
+
+def xml_to_binary(xml_bytes):
+    out = bytearray(MAGIC + bytes([VERSION, 0, 0, 0]))
+    text = xml_bytes.decode("utf-8")
+    stack = []  # [name, offset of its opening record, whether it has anything other than text content, text]
+
+    for match in TOKEN.finditer(text):
+        closing_name, opening_name, attributes, empty, content = match.groups()
+        if opening_name:
+            if stack:
+                stack[-1][2] = True
+            record_offset = len(out)
+            out += bytes([RECORD_OPEN]) + encode_name(opening_name)
+            has_attributes = False
+            for name, value in ATTRIBUTE.findall(attributes):
+                out += encode_value(name, value)
+                has_attributes = True
+            if empty:
+                out.append(RECORD_CLOSE)
+            else:
+                stack.append([opening_name, record_offset, has_attributes, ""])
+        elif closing_name:
+            if not stack or stack[-1][0] != closing_name:
+                raise ValueError(f"unexpected </{closing_name}> at character {match.start()}")
+            name, record_offset, has_other, content = stack.pop()
+            content = content.strip()
+            if not has_other and content:
+                # A tag with nothing but text in it becomes a single record
+                del out[record_offset:]
+                out += encode_value(name, content, RECORD_CONTENT)
+            else:
+                out.append(RECORD_CLOSE)
+        elif content and stack:
+            stack[-1][3] += content
+        elif content and content.strip():
+            raise ValueError(f"text outside any tag at character {match.start()}")
+    if stack:
+        raise ValueError(f"<{stack[-1][0]}> never closed")
+    return bytes(out)
+
+
+class Reader:
+    def __init__(self, data):
+        self.data = data
+        self.pos = 0
+
+    def take(self, num_bytes):
+        if self.pos + num_bytes > len(self.data):
+            raise ValueError("file ends early")
+        chunk = self.data[self.pos : self.pos + num_bytes]
+        self.pos += num_bytes
+        return chunk
+
+    def u8(self):
+        return self.take(1)[0]
+
+    def u16(self):
+        return struct.unpack("<H", self.take(2))[0]
+
+    def name(self):
+        return self.take(self.u8())[:-1].decode("utf-8")
+
+    def value(self, kind):
+        if kind == RECORD_INT:
+            return str(struct.unpack("<i", self.take(4))[0])
+        if kind == RECORD_STRING:
+            return self.take(self.u16())[:-1].decode("utf-8")
+        data = bytearray()
+        while length := self.u16():
+            data += self.take(length)
+        return ("0x" if kind == RECORD_HEX else "") + data.hex().upper()
+
+
+def binary_to_xml(data):
+    reader = Reader(data)
+    if reader.take(4) != MAGIC or reader.u8() > VERSION:
+        raise ValueError("not a Deluge binary song file")
+    reader.take(3)
+
+    lines = ['<?xml version="1.0" encoding="UTF-8"?>']
+    stack = []  # [name, whether its opening tag has been ended with ">"]
+
+    def end_opening_tag():
+        if stack and not stack[-1][1]:
+            lines[-1] += ">"
+            stack[-1][1] = True
+
+    while reader.pos < len(data):
+        record = reader.u8()
+        kind = record & ~RECORD_CONTENT
+        indent = "\t" * len(stack)
+        if kind == RECORD_OPEN:
+            end_opening_tag()
+            name = reader.name()
+            lines.append(f"{indent}<{name}")
+            stack.append([name, False])
+        elif kind == RECORD_CLOSE:
+            name, ended = stack.pop()
+            if ended:
+                lines.append(f"{indent[:-1]}</{name}>")
+            else:
+                lines[-1] += " />"
+        elif kind in (RECORD_INT, RECORD_STRING, RECORD_HEX, RECORD_BYTES):
+            name = reader.name()
+            value = reader.value(kind)
+            if record & RECORD_CONTENT:
+                end_opening_tag()
+                lines.append(f"{indent}<{name}>{value}</{name}>")
+            else:
+                lines.append(f'{indent}{name}="{value}"')
+        else:
+            raise ValueError(f"unknown record type {record} at byte {reader.pos - 1}")
+    if stack:
+        raise ValueError("file ends inside a tag")
+    return ("\n".join(lines) + "\n").encode("utf-8")
+
+
+def main():
+    if len(sys.argv) not in (2, 3):
+        print(__doc__.strip())
+        sys.exit(1)
+    source = Path(sys.argv[1])
+    data = source.read_bytes()
+    if data.startswith(MAGIC):
+        output = binary_to_xml(data)
+        default_destination = source.with_suffix(".XML")
+    else:
+        output = xml_to_binary(data)
+        default_destination = source.with_suffix(".DBIN")
+    destination = Path(sys.argv[2]) if len(sys.argv) == 3 else default_destination
+    destination.write_bytes(output)
+    print(f"{source} ({len(data)} bytes) -> {destination} ({len(output)} bytes)")
+
+
+if __name__ == "__main__":
+    main()
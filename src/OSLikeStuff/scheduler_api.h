@@ -62,6 +62,35 @@ int8_t addOnceTask(TaskHandle task, uint8_t priority, double timeToWait, const c
 /// interfere with scheduling
 int8_t addConditionalTask(TaskHandle task, uint8_t priority, RunCondition condition, const char* name,
                           ResourceID resources);
+/// Declare the longest a repeating task can be kept waiting once it's due, in seconds. Only used by earliest deadline
+/// first scheduling - without one, the task's deadline comes from its max time between calls
+void setMaxLatencyForTask(TaskID id, double maxLatency);
+/// Change how often a repeating task gets called, as for addRepeatingTask(). Takes effect from its next call
+void setTimeBetweenCallsForTask(TaskID id, double backOffTime, double targetTimeBetweenCalls,
+                                double maxTimeBetweenCalls);
+/// Choose tasks earliest deadline first rather than by priority. Off by default
+void setEarliestDeadlineFirstScheduling(bool on);
+
+/// Call when task id has missed its deadline, for example when audio has underrun. Blames, logs and counts it against
+/// whichever other task ran for longest since windowStart (in system time)
+void reportDeadlineMiss(TaskID id, double windowStart);
+
+/// Latency is from when a task is due to when it starts. Times are in microseconds
+struct TaskStatsSummary {
+	const char* name;
+	uint32_t timesCalled;
+	uint32_t deadlineMissesCaused;
+	uint32_t latencyP50;
+	uint32_t latencyP99;
+	uint32_t latencyMax;
+	uint32_t durationP50;
+	uint32_t durationP99;
+	uint32_t durationMax;
+};
+/// Fill in stats for the first registered task after the given one, since stats were last printed. Pass -1 to start.
+/// @returns The task's ID, or -1 if there are no more
+TaskID getNextTaskStats(TaskID after, struct TaskStatsSummary* stats);
+
 void ignoreForStats();
 double getAverageRunTimeForTask(TaskID id);
 double getAverageRunTimeforCurrentTask();
@@ -0,0 +1,55 @@
+/*
+ * Copyright © 2025 Synthstrom Audible Limited
+ *
+ * This file is part of The Synthstrom Audible Deluge Firmware.
+ *
+ * The Synthstrom Audible Deluge Firmware is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program.
+ * If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "OSLikeStuff/task_scheduler/budgeted_section.h"
+#include "OSLikeStuff/task_scheduler/task_scheduler.h"
+#include "io/debug/log.h"
+#include <algorithm>
+
+extern TaskManager taskManager;
+
+BudgetedSection::BudgetedSection(const char* file, int32_t line, double budget, TaskHandle yieldTo)
+    : file(file), line(line), budget(budget), yieldTo(yieldTo), lastYield(taskManager.getSecondsFromStart()) {
+}
+
+BudgetedSection::~BudgetedSection() {
+	endStretch();
+	if (longestStretch > Time(kTooLongWithoutYielding)) {
+		D_PRINTLN("%s:%d went %.3fms without yielding", file, line, double(longestStretch) * 1000.);
+	}
+}
+
+/// @returns how long it's been since this section last yielded, or anything else ran
+Time BudgetedSection::endStretch() {
+	Time stretch = taskManager.getSecondsFromStart() - std::max(lastYield, taskManager.getLastFinishTime());
+	longestStretch = std::max(longestStretch, stretch);
+	return stretch;
+}
+
+bool BudgetedSection::check() {
+	if (endStretch() < budget) {
+		return false;
+	}
+	if (yieldTo != nullptr) {
+		yieldTo();
+	}
+	else {
+		yieldToIdle([]() { return false; });
+	}
+	lastYield = taskManager.getSecondsFromStart();
+	return true;
+}
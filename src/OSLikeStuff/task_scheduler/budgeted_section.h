@@ -0,0 +1,62 @@
+/*
+ * Copyright © 2025 Synthstrom Audible Limited
+ *
+ * This file is part of The Synthstrom Audible Deluge Firmware.
+ *
+ * The Synthstrom Audible Deluge Firmware is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program.
+ * If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "OSLikeStuff/scheduler_api.h"
+
+/// A long stretch of work inside one task, such as a big loop in a view or the browser, that has to let other tasks
+/// run now and then - audio above all - or they'll miss their deadlines.
+///
+/// Call check() often, e.g. once each time round the loop. Once budget has gone by since anything else last got to run
+/// it yields, then carries on. Running another task directly, as AudioEngine::routineWithClusterLoading() does, counts
+/// as a yield too, so a section can wrap code that already does that.
+///
+/// When the section ends, it logs its file and line if it ever went longer than kTooLongWithoutYielding without
+/// anything else getting to run - so the cause of a dropout can be found from the log rather than by ear.
+class BudgetedSection {
+public:
+	static constexpr double kDefaultBudget = 0.001;
+	// As long as the audio routine can be kept waiting before the output buffer runs dry
+	static constexpr double kTooLongWithoutYielding = 0.003;
+
+	/// @param yieldTo What to run once the budget's used up. By default everything that's due, as yieldToIdle() does
+	BudgetedSection(const char* file, int32_t line, double budget = kDefaultBudget, TaskHandle yieldTo = nullptr);
+	~BudgetedSection();
+	BudgetedSection(const BudgetedSection&) = delete;
+	BudgetedSection& operator=(const BudgetedSection&) = delete;
+
+	/// @returns whether it yielded
+	bool check();
+
+	/// The longest it's gone so far without anything else getting to run
+	[[nodiscard]] Time getLongestStretch() const { return longestStretch; }
+
+private:
+	Time endStretch();
+
+	const char* file;
+	int32_t line;
+	Time budget;
+	TaskHandle yieldTo;
+	// when this section started, or last yielded - whichever is later
+	Time lastYield;
+	Time longestStretch{0};
+};
+
+/// Declares a BudgetedSection called name, reported against the file and line it's declared on
+#define BUDGETED_SECTION(name, ...) BudgetedSection name(__FILE__, __LINE__ __VA_OPT__(, ) __VA_ARGS__)
@@ -20,6 +20,8 @@
 #include "OSLikeStuff/scheduler_api.h"
 #include "resource_checker.h"
 
+#include <algorithm>
+#include <array>
 #include <io/debug/log.h>
 #define SCHEDULER_DETAILED_STATS (0 && ENABLE_TEXT_OUTPUT)
 
@@ -48,6 +50,51 @@ struct StatBlock {
 	}
 };
 
+/// Counts of values in buckets half an octave wide, so percentiles can be read off to within 50% without
+/// storing every value
+struct Histogram {
+	// Values under 2^kFirstOctave ticks (about 1us) all go in the first bucket, and over 2^kLastOctave (about 0.25s)
+	// in the last
+	static constexpr int32_t kFirstOctave = 5;
+	static constexpr int32_t kLastOctave = 23;
+	static constexpr int32_t kNumBuckets = (kLastOctave - kFirstOctave) * 2;
+
+	std::array<uint32_t, kNumBuckets> counts{};
+	uint32_t total{0};
+	Time max{0};
+
+	[[gnu::hot]] void add(Time v) {
+		auto ticks = static_cast<uint64_t>(std::max<dTime>(dTime(v), 1));
+		int32_t octave = 63 - __builtin_clzll(ticks);
+		int32_t upperHalf = octave > 0 ? (ticks >> (octave - 1)) & 1 : 0;
+		int32_t bucket = std::clamp<int32_t>((octave - kFirstOctave) * 2 + upperHalf, 0, kNumBuckets - 1);
+		counts[bucket]++;
+		total++;
+		max = std::max(v, max);
+	}
+
+	/// @returns the top of the bucket the given percentile falls in - or the max, if that's lower
+	[[nodiscard]] Time getPercentile(int32_t percent) const {
+		uint32_t target = std::max<uint32_t>(((uint64_t)total * percent + 99) / 100, 1);
+		uint32_t count = 0;
+		for (int32_t bucket = 0; bucket < kNumBuckets; bucket++) {
+			count += counts[bucket];
+			if (count >= target) {
+				int32_t octave = bucket / 2 + kFirstOctave;
+				Time top = dTime{(3 + bucket % 2)} << (octave - 1);
+				return std::min(top, max);
+			}
+		}
+		return max;
+	}
+
+	void reset() {
+		counts.fill(0);
+		total = 0;
+		max = 0;
+	}
+};
+
 struct TaskSchedule {
 	// 0 is highest priority
 	uint8_t priority;
@@ -57,6 +104,9 @@ struct TaskSchedule {
 	Time targetInterval;
 	// maximum time between function calls
 	Time maxInterval;
+	// longest the task can be kept waiting once it's due, for earliest deadline first scheduling. 0 means no limit
+	// beyond maxInterval
+	Time maxLatency{0};
 };
 
 enum class State {
@@ -72,7 +122,8 @@ struct Task {
 	// constructor for making a "once" task
 	Task(TaskHandle _handle, uint8_t _priority, Time timeNow, Time _timeToWait, const char* _name,
 	     ResourceChecker checker)
-	    : handle(_handle), lastCallTime(timeNow), removeAfterUse(true), name(_name), _checker(checker) {
+	    : handle(_handle), lastCallTime(timeNow), readySince(timeNow), removeAfterUse(true), name(_name),
+	      _checker(checker) {
 
 		schedule = TaskSchedule{_priority, _timeToWait, _timeToWait, _timeToWait * 2};
 	}
@@ -91,10 +142,11 @@ struct Task {
 	void updateNextTimes(Time startTime, Time runtime, Time finishTime) {
 
 		durationStats.update(runtime);
+		durationHistogram.add(runtime);
+		// how long it waited from when it could have first been called - which might not have been until it was
+		// unblocked
+		latencyHistogram.add(std::max(lastCallTime - std::max(idealCallTime, readySince), Time(0)));
 
-#if SCHEDULER_DETAILED_STATS
-		latency.update(lastCallTime - idealCallTime);
-#endif
 		totalTime += runtime;
 		lastRunTime = runtime;
 		timesCalled += 1;
@@ -106,10 +158,11 @@ struct Task {
 		lastFinishTime = finishTime;
 	}
 	// returns true if the task becomes runnable
-	bool checkCondition() {
+	bool checkCondition(Time currentTime) {
 		if (condition != nullptr && state == State::BLOCKED) {
 			if (condition()) {
 				state = State::READY;
+				readySince = currentTime;
 				return true;
 			}
 		}
@@ -122,6 +175,15 @@ struct Task {
 	[[nodiscard]] bool isRunnable() const { return state == State::READY && resourcesAvailable(); }
 	[[nodiscard]] bool isReleased(Time currentTime) const { return currentTime > earliestCallTime; }
 	[[nodiscard]] bool resourcesAvailable() const { return _checker.checkResources(); }
+	/// The time by which the task needs to have started, for earliest deadline first scheduling
+	[[nodiscard]] Time getDeadline() const {
+		Time deadline = latestCallTime;
+		if (schedule.maxLatency > Time(0)) {
+			Time releaseTime = idealCallTime;
+			deadline = std::min(deadline, releaseTime + schedule.maxLatency);
+		}
+		return deadline;
+	}
 	TaskHandle handle{nullptr};
 	TaskSchedule schedule{0, 0, 0, 0};
 	Time earliestCallTime;
@@ -129,12 +191,13 @@ struct Task {
 	Time latestCallTime{0};
 	Time lastCallTime{0};
 	Time lastFinishTime{0};
+	// when the task was last unblocked, so time spent blocked doesn't count as latency
+	Time readySince{0};
 	bool boosted{false};
 
 	StatBlock durationStats;
-#if SCHEDULER_DETAILED_STATS
-	StatBlock latency;
-#endif
+	Histogram durationHistogram;
+	Histogram latencyHistogram;
 	State state{State::READY};
 	RunCondition condition{nullptr};
 	bool removeAfterUse{false};
@@ -142,6 +205,8 @@ struct Task {
 
 	Time totalTime{0};
 	int32_t timesCalled{0};
+	// times another task missed its deadline while this one ran for the longest
+	int32_t deadlineMissesCaused{0};
 	Time lastRunTime;
 
 	ResourceChecker _checker;
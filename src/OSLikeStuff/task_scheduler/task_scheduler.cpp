@@ -49,6 +49,9 @@ void TaskManager::createSortedList() {
 
 // deadline < 0 means no deadline
 TaskID TaskManager::chooseBestTask(Time deadline) {
+	if (policy == SchedulingPolicy::EARLIEST_DEADLINE_FIRST) {
+		return chooseBestTaskByDeadline(deadline);
+	}
 	Time currentTime = getSecondsFromStart();
 	Time nextFinishTime = currentTime;
 	TaskID bestTask = -1;
@@ -118,6 +121,64 @@ TaskID TaskManager::chooseBestTask(Time deadline) {
 	return bestTask;
 }
 
+/// Of the tasks that are due, run the one that needs to start soonest. If none are due, run whichever ready task needs
+/// to start soonest - as long as it can finish before any other task needs to start
+TaskID TaskManager::chooseBestTaskByDeadline(Time deadline) {
+	Time currentTime = getSecondsFromStart();
+	TaskID bestDueTask = -1;
+	Time bestDueDeadline{0};
+	TaskID bestReadyTask = -1;
+	Time bestReadyDeadline{0};
+	// the two soonest deadlines of any task, so we know how long a task that's not due yet has to run in
+	constexpr Time never{std::numeric_limits<dTime>::max()};
+	TaskID soonestTask = -1;
+	Time soonestDeadline = never;
+	Time nextSoonestDeadline = never;
+
+	// highest priority first, so it wins any ties
+	for (int i = (numActiveTasks - 1); i >= 0; i--) {
+		TaskID id = sortedList[i].task;
+		Task* t = &list[id];
+		if (!t->isRunnable()) {
+			continue;
+		}
+		Time taskDeadline = t->getDeadline();
+		if (taskDeadline < soonestDeadline) {
+			nextSoonestDeadline = soonestDeadline;
+			soonestDeadline = taskDeadline;
+			soonestTask = id;
+		}
+		else if (taskDeadline < nextSoonestDeadline) {
+			nextSoonestDeadline = taskDeadline;
+		}
+
+		if (!t->isReady(currentTime)
+		    || (deadline >= Time(0) && currentTime + t->durationStats.average >= deadline)) {
+			continue;
+		}
+		if (t->idealCallTime < currentTime) {
+			if (bestDueTask == -1 || taskDeadline < bestDueDeadline) {
+				bestDueTask = id;
+				bestDueDeadline = taskDeadline;
+			}
+		}
+		else if (bestReadyTask == -1 || taskDeadline < bestReadyDeadline) {
+			bestReadyTask = id;
+			bestReadyDeadline = taskDeadline;
+		}
+	}
+	if (bestDueTask != -1) {
+		return bestDueTask;
+	}
+	if (bestReadyTask != -1) {
+		Time otherDeadline = bestReadyTask == soonestTask ? nextSoonestDeadline : soonestDeadline;
+		if (currentTime + list[bestReadyTask].durationStats.average < otherDeadline) {
+			return bestReadyTask;
+		}
+	}
+	return -1;
+}
+
 /// insert task into the first empty spot in the list
 TaskID TaskManager::insertTaskToList(Task task) {
 	int8_t index = 0;
@@ -212,6 +273,7 @@ void TaskManager::unblockTask(TaskID id) {
 		auto* current_task = &list[id];
 		if (current_task->state == State::BLOCKED) {
 			current_task->state = State::READY;
+			current_task->readySince = getSecondsFromStart();
 		}
 	}
 }
@@ -225,6 +287,95 @@ void TaskManager::blockTask(TaskID id) {
 	}
 }
 
+void TaskManager::setMaxLatency(TaskID id, Time maxLatency) {
+	if (id >= 0 && id < kMaxTasks) [[likely]] {
+		list[id].schedule.maxLatency = maxLatency;
+	}
+}
+
+void TaskManager::setTimeBetweenCalls(TaskID id, Time backOffPeriod, Time targetInterval, Time maxInterval) {
+	if (id >= 0 && id < kMaxTasks) [[likely]] {
+		TaskSchedule& schedule = list[id].schedule;
+		schedule.backOffPeriod = backOffPeriod;
+		schedule.targetInterval = targetInterval;
+		schedule.maxInterval = maxInterval;
+	}
+}
+
+void TaskManager::recordRun(TaskID id, Time start, Time runtime) {
+	// short runs can't be what made anything miss its deadline, so don't let them push out the ones that could
+	if (runtime < Time(0.0001)) {
+		return;
+	}
+	recentRuns[nextRecentRun] = RecentRun{list[id].name, id, start, runtime};
+	nextRecentRun = (nextRecentRun + 1) % kNumRecentRuns;
+}
+
+void TaskManager::reportDeadlineMiss(TaskID id, Time windowStart) {
+	Time currentTime = getSecondsFromStart();
+	const RecentRun* culprit = nullptr;
+	Time culpritTime{0};
+
+	auto consider = [&](const RecentRun& run) {
+		if (run.name == nullptr || run.task == id) {
+			return;
+		}
+		// only the part of the run within the window counts
+		Time start = std::max(run.start, windowStart);
+		Time end = std::min(Time(run.start) + run.duration, currentTime);
+		Time timeInWindow = end - start;
+		if (timeInWindow > culpritTime) {
+			culprit = &run;
+			culpritTime = timeInWindow;
+		}
+	};
+	for (const RecentRun& run : recentRuns) {
+		consider(run);
+	}
+	// whatever's running now may have called the task directly, after running for too long itself - and so may
+	// whatever called that, and so on out
+	std::array<RecentRun, kMaxRunningDepth> running;
+	for (int32_t i = 0; i < std::min<int32_t>(numRunningTasks, kMaxRunningDepth); i++) {
+		const Task& task = list[runningTasks[i]];
+		running[i] = RecentRun{task.name, runningTasks[i], task.lastCallTime, currentTime - task.lastCallTime};
+		consider(running[i]);
+	}
+
+	if (culprit == nullptr) {
+		return;
+	}
+	Task* culpritTask = &list[culprit->task];
+	if (culpritTask->name == culprit->name) {
+		culpritTask->deadlineMissesCaused++;
+	}
+	D_PRINTLN("%s missed its deadline: %s ran for %.3fms of the %.3fms since it was due",
+	          (id >= 0 && id < kMaxTasks) ? list[id].name : "?", culprit->name, double(culpritTime) * 1000.,
+	          double(currentTime - windowStart) * 1000.);
+}
+
+TaskID TaskManager::getNextTaskStats(TaskID after, TaskStatsSummary* stats) const {
+	auto micros = [](Time t) { return static_cast<uint32_t>(double(t) * 1000000.); };
+	for (TaskID id = after + 1; id < kMaxTasks; id++) {
+		const Task& task = list[id];
+		if (task.handle == nullptr) {
+			continue;
+		}
+		*stats = TaskStatsSummary{
+		    .name = task.name,
+		    .timesCalled = static_cast<uint32_t>(task.timesCalled),
+		    .deadlineMissesCaused = static_cast<uint32_t>(task.deadlineMissesCaused),
+		    .latencyP50 = micros(task.latencyHistogram.getPercentile(50)),
+		    .latencyP99 = micros(task.latencyHistogram.getPercentile(99)),
+		    .latencyMax = micros(task.latencyHistogram.max),
+		    .durationP50 = micros(task.durationHistogram.getPercentile(50)),
+		    .durationP99 = micros(task.durationHistogram.getPercentile(99)),
+		    .durationMax = micros(task.durationHistogram.max),
+		};
+		return id;
+	}
+	return -1;
+}
+
 void TaskManager::runTask(TaskID id) {
 	// runTask() can be entered while another task is mid-run (e.g. the audio task during an SD wait),
 	// so restore the caller's currentID on exit - otherwise yield() acts on the wrong task and a
@@ -232,6 +383,10 @@ void TaskManager::runTask(TaskID id) {
 	TaskID callerID = currentID;
 	countThisTask = true;
 	currentID = id;
+	if (numRunningTasks < kMaxRunningDepth) {
+		runningTasks[numRunningTasks] = id;
+	}
+	numRunningTasks++;
 	auto* current_task = &list[currentID];
 
 	{
@@ -249,6 +404,9 @@ void TaskManager::runTask(TaskID id) {
 		Time timeNow = getSecondsFromStart();
 		Time runtime = (timeNow - start_time);
 		cpuTime += runtime;
+		if (countThisTask) {
+			recordRun(id, start_time, runtime);
+		}
 		if (current_task->removeAfterUse) {
 			removeTask(id);
 		}
@@ -266,6 +424,7 @@ void TaskManager::runTask(TaskID id) {
 		}
 		lastFinishTime = timeNow;
 	}
+	numRunningTasks--;
 	currentID = callerID;
 }
 
@@ -306,6 +465,7 @@ bool TaskManager::yield(RunCondition until, Time timeout, bool returnOnIdle) {
 			D_PRINTLN("Task %s took too long before yielding: %.3fms", yielding_task->name, double(runtime) * 1000.);
 		}
 		yielding_task->updateNextTimes(start_time, runtime, time_now);
+		recordRun(currentID, start_time, runtime);
 	}
 
 	// continue the main loop. The yielding task is still on the stack but that should be fine
@@ -382,9 +542,10 @@ void TaskManager::startClock() {
 }
 bool TaskManager::checkConditionalTasks() {
 	bool addedTask = false;
+	Time currentTime = getSecondsFromStart();
 	for (int i = 0; i < kMaxTasks; i++) {
 		Task* t = &list[i];
-		if (t->checkCondition()) {
+		if (t->checkCondition(currentTime)) {
 			addedTask = true;
 		}
 	}
@@ -400,10 +561,10 @@ void TaskManager::resetStats() {
 		if (task.handle) {
 			task.totalTime = 0;
 			task.timesCalled = 0;
+			task.deadlineMissesCaused = 0;
 			task.durationStats.reset();
-#if SCHEDULER_DETAILED_STATS
-			task.latency.reset();
-#endif
+			task.durationHistogram.reset();
+			task.latencyHistogram.reset();
 		}
 	}
 	cpuTime = 0;
@@ -411,7 +572,7 @@ void TaskManager::resetStats() {
 }
 
 void TaskManager::printStats() {
-	D_PRINTLN("Dumping task manager stats: (min/ average/ max)");
+	D_PRINTLN("Dumping task manager stats: (p50/ p99/ max)");
 	for (auto task : list) {
 		if (task.handle) {
 			constexpr float latencyScale = 1000.0;
@@ -422,12 +583,12 @@ void TaskManager::printStats() {
 			          "Latency: %8.3f/%8.3f/%8.3f ms "                                   //<
 			          "N: %10d hz, Task: %s",                                            //<
 			          100.0 * double(task.totalTime) / double(cpuTime),                  //<
-			          durationScale * double(task.durationStats.min),                    //<
-			          durationScale * double(task.totalTime) / double(task.timesCalled), //<
-			          durationScale * double(task.durationStats.max),                    //<
-			          latencyScale * double(task.latency.min),                           //<
-			          latencyScale * double(task.latency.average),                       //<
-			          latencyScale * double(task.latency.max),                           //<
+			          durationScale * double(task.durationHistogram.getPercentile(50)),  //<
+			          durationScale * double(task.durationHistogram.getPercentile(99)),  //<
+			          durationScale * double(task.durationHistogram.max),                //<
+			          latencyScale * double(task.latencyHistogram.getPercentile(50)),    //<
+			          latencyScale * double(task.latencyHistogram.getPercentile(99)),    //<
+			          latencyScale * double(task.latencyHistogram.max),                  //<
 			          task.timesCalled / 10, task.name);
 #else
 #ifdef NEVER
@@ -438,6 +599,9 @@ void TaskManager::printStats() {
 			          task.name);
 #endif
 #endif
+			if (task.deadlineMissesCaused) {
+				D_PRINTLN("Task %s made others miss their deadline %d times", task.name, task.deadlineMissesCaused);
+			}
 		}
 	}
 	auto totalTime = cpuTime + overhead;
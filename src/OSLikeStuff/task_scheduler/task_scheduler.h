@@ -16,6 +16,26 @@ struct SortedTask {
 };
 // currently 14 are in use
 constexpr int kMaxTasks = 25;
+// how many of the most recent task runs are kept, to find which one made another task miss its deadline
+constexpr int kNumRecentRuns = 16;
+// how many nested runTask() calls to keep track of, for blaming deadline misses
+constexpr int kMaxRunningDepth = 4;
+
+enum class SchedulingPolicy : uint8_t {
+	// run the least important task that can finish before a more important task needs to start
+	PRIORITY,
+	// run whichever due task needs to start soonest
+	EARLIEST_DEADLINE_FIRST,
+};
+
+struct RecentRun {
+	// the name rather than the ID, as a once task's slot can be reused by the time we look
+	const char* name{nullptr};
+	TaskID task{-1};
+	Time start{0};
+	Time duration{0};
+};
+
 /// internal only to the task scheduler, hence all public. External interaction to use the api
 struct TaskManager {
 
@@ -25,6 +45,7 @@ struct TaskManager {
 	void runTask(TaskID id);
 	void runHighestPriTask();
 	TaskID chooseBestTask(Time deadline);
+	TaskID chooseBestTaskByDeadline(Time deadline);
 	TaskID addRepeatingTask(TaskHandle task, TaskSchedule schedule, const char* name, ResourceChecker resources);
 
 	TaskID addOnceTask(TaskHandle task, uint8_t priority, Time timeToWait, const char* name, ResourceChecker resources);
@@ -42,9 +63,16 @@ struct TaskManager {
 	void setNextRunTimeforCurrentTask(Time seconds);
 	void unblockTask(TaskID id);
 	void blockTask(TaskID task);
+	void setMaxLatency(TaskID id, Time maxLatency);
+	void setTimeBetweenCalls(TaskID id, Time backOffPeriod, Time targetInterval, Time maxInterval);
+	void setPolicy(SchedulingPolicy newPolicy) { policy = newPolicy; }
+	void reportDeadlineMiss(TaskID id, Time windowStart);
+	TaskID getNextTaskStats(TaskID after, TaskStatsSummary* stats) const;
 
 	[[nodiscard]] Time getAverageRunTimeForCurrentTask() const;
 	[[nodiscard]] Time getAverageRunTimeForTask(TaskID id) const;
+	/// when a task last finished - from inside a task, that's when anything else last got to run
+	[[nodiscard]] Time getLastFinishTime() const { return lastFinishTime; }
 
 private:
 	// All current tasks
@@ -54,6 +82,10 @@ private:
 	std::array<SortedTask, kMaxTasks> sortedList;
 	uint8_t numActiveTasks = 0;
 	uint8_t numRegisteredTasks = 0;
+	SchedulingPolicy policy{SchedulingPolicy::PRIORITY};
+	// ring buffer of the last kNumRecentRuns task runs, oldest at nextRecentRun
+	std::array<RecentRun, kNumRecentRuns> recentRuns{};
+	uint8_t nextRecentRun{0};
 	Time mustEndBefore = -1; // use for testing or I guess if you want a second temporary task manager?
 	bool running{false};
 	Time cpuTime{0};
@@ -62,10 +94,14 @@ private:
 	Time lastPrintedStats{0};
 
 	volatile TaskID currentID{0};
+	// every task that's mid-run, outermost first - currentID and whatever called runTask() to run it, and so on
+	std::array<TaskID, kMaxRunningDepth> runningTasks{};
+	uint8_t numRunningTasks{0};
 	// for time tracking with rollover
 	Time lastTime{0};
 	Time runningTime{0};
 	void resetStats();
+	void recordRun(TaskID id, Time start, Time runtime);
 	// needs to be volatile, GCC misses that the handle call can call ignoreForStats and optimizes the check away
 	volatile bool countThisTask{true};
 	void startClock();
@@ -35,6 +35,27 @@ double getAverageRunTimeforCurrentTask() {
 	return taskManager.getAverageRunTimeForCurrentTask();
 }
 
+void setMaxLatencyForTask(TaskID id, double maxLatency) {
+	taskManager.setMaxLatency(id, maxLatency);
+}
+
+void setTimeBetweenCallsForTask(TaskID id, double backOffTime, double targetTimeBetweenCalls,
+                                double maxTimeBetweenCalls) {
+	taskManager.setTimeBetweenCalls(id, backOffTime, targetTimeBetweenCalls, maxTimeBetweenCalls);
+}
+
+void setEarliestDeadlineFirstScheduling(bool on) {
+	taskManager.setPolicy(on ? SchedulingPolicy::EARLIEST_DEADLINE_FIRST : SchedulingPolicy::PRIORITY);
+}
+
+void reportDeadlineMiss(TaskID id, double windowStart) {
+	taskManager.reportDeadlineMiss(id, windowStart);
+}
+
+TaskID getNextTaskStats(TaskID after, TaskStatsSummary* stats) {
+	return taskManager.getNextTaskStats(after, stats);
+}
+
 void setNextRunTimeforCurrentTask(double seconds) {
 	taskManager.setNextRunTimeforCurrentTask(seconds);
 }
@@ -607,6 +607,9 @@ enum class MIDITakeoverMode : uint8_t {
 };
 constexpr auto kNumMIDITakeoverModes = util::to_underlying(MIDITakeoverMode::RELATIVE) + 1;
 
+/// Longest MIDI input latency (see MidiEngine::inputLatencyMS) the menu offers and flash accepts, in ms
+constexpr uint8_t kMaxMIDIInputLatencyMS = 20;
+
 enum class MIDIFollowChannelType : uint8_t {
 	A,
 	B,
@@ -835,9 +838,28 @@ constexpr int32_t kNumMovingAverages = 3;
 // so more is not more!
 constexpr int32_t kMovingAverageLength = 35;
 
+// For the high quality tier's AMDF search - the length of the windows compared, and how far either side of the initial
+// position to look, both in source samples
+constexpr int32_t kCorrelationWindowLength = 128;
+constexpr int32_t kMaxCorrelationOffset = 512;
+
 } // namespace Crossfade
 
 constexpr int32_t kBufferSize = TIME_STRETCH_ENABLE_BUFFER ? 4096 : 256;
+
+/// How much work each hop puts into finding somewhere good to land. Cheaper tiers sound rougher.
+enum class Quality : uint8_t {
+	/// Hop length fixed at the middle of its range, and a short phase search
+	FAST,
+	/// Hop length guided by the percussiveness cache, and a phase search that stops once it's found a likely fit
+	STANDARD,
+	/// As STANDARD, but the phase search compares actual waveforms (AMDF) across its whole range, down to lower
+	/// frequencies
+	HIGH,
+};
+
+/// In automatic mode, the CPU direness at which hops drop to Quality::FAST
+constexpr int32_t kAutoQualityFastDireness = 6;
 } // namespace TimeStretch
 
 // We don't want the window too short, or some sounds / harmonics can be missed during the attack
@@ -1140,5 +1162,11 @@ constexpr uint8_t kMinScreensaverTimeoutMinutes = 1;
 constexpr uint8_t kMaxScreensaverTimeoutMinutes = 60;
 /// @}
 
+/// @brief How many samples the audio routine renders at a time - see AudioEngine::setLatencyTier().
+///
+/// @note Persisted to flash by value, so the order is fixed.
+enum class AudioLatencyTier : uint8_t { AUTO, LOW_LATENCY, BALANCED, EFFICIENT };
+constexpr auto kNumAudioLatencyTiers = util::to_underlying(AudioLatencyTier::EFFICIENT) + 1;
+
 constexpr uint8_t kHorizontalMenuSlotYOffset = 2;
 constexpr uint8_t kScreenTitleSeparatorY = 12 + OLED_MAIN_TOPMOST_PIXEL;
@@ -20,6 +20,7 @@
 #include "RZA1/sdhi/inc/sdif.h"
 #include "definitions_cxx.hpp"
 #include "drivers/pic/pic.h"
+#include "firmware_tasks.h"
 #include "gui/ui/audio_recorder.h"
 #include "gui/ui/browser/browser.h"
 #include "gui/ui/keyboard/keyboard_screen.h"
@@ -65,6 +66,7 @@
 #include "scheduler_api.h"
 #include "storage/audio/audio_file_manager.h"
 #include "storage/flash_storage.h"
+#include "storage/set_list.h"
 #include "storage/smsysex.h"
 #include "storage/storage_manager.h"
 #include "util/misc.h"
@@ -514,6 +516,7 @@ void setupOLED() {
 	delayMS(5);
 
 	oledMainInit();
+	deluge::hid::display::OLED::forgetPanelImage();
 
 	// delayMS(5);
 
@@ -529,75 +532,45 @@ extern "C" volatile uint32_t usbLock;
 extern "C" void usb_main_host(void);
 
 void registerTasks() {
-	// addRepeatingTask arguments are:
-	//
-	// - priority (lower = more important)
-	// - min time between calls
-	// - target time between calls
-	// - max time between calls
+	// Each task's priority (lower = more important) and min, target and max times between calls are in
+	// FirmwareTasks::kTasks.
 	//
 	// Scheduling algorithm is in chooseBestTask(), briefly:
 	// - keep track of average time a task takes
 	// - run the least important task that can finish before
 	//   a more important task needs to start
 	//
-	// Explicit gaps at 10, 20, 30, 40 for dynamic tasks.
-	//
-	// p++ for priorities, so we can be sure the lexical order
-	// here is always priority order.
-
-	// 0-9: High priority (10 for dyn tasks)
-	uint8_t p = 0;
-	AudioEngine::routine_task_id = addRepeatingTask(&(AudioEngine::routine_task), p++, 8 / 44100., 64 / 44100.,
-	                                                128 / 44100., "audio  routine", RESOURCE_NONE);
-	addRepeatingTask(MidiEngine::check_incoming_usb, p++, 0.0005, 0.0005, 0.001, "check usb midi", RESOURCE_USB);
-
-	// this will block itself unless an encoder is actually moved so can have a fast rate
-	encoders::EncoderTaskID = addRepeatingTask(&(encoders::interpretEncodersTask), p++, 0.001, 0.001, 0.002,
-	                                           "interpret encoders fast", RESOURCE_NONE);
-	// formerly part of audio routine, updates midi and clock
-	addRepeatingTask([]() { playbackHandler.routine(); }, p++, 0.0005, 0.001, 0.002, "playback routine", RESOURCE_NONE);
-	midiEngine.routine_task_id = addRepeatingTask([]() { playbackHandler.midiRoutine(); }, p++, 0.0005, 0.001, 0.002,
-	                                              "midi routine", RESOURCE_SD | RESOURCE_USB);
-	addRepeatingTask([]() { audioFileManager.loadAnyEnqueuedClusters(128, false); }, p++, 0.0001, 0.0001, 0.0002,
-	                 "load clusters", RESOURCE_NONE);
-	// handles sd card recorders
-	// named "slow" but isn't actually, it handles audio recording setup
-	addRepeatingTask(&AudioEngine::slowRoutine, p++, 0.001, 0.005, 0.05, "audio slow", RESOURCE_NONE);
-	addRepeatingTask(&(readButtonsAndPadsOnce), p++, 0.005, 0.005, 0.01, "buttons and pads", RESOURCE_NONE);
-
-	// 11-19: Medium priority (20 for dyn tasks)
-	p = 11;
-
-	// 30 Hz update desired?
-	addRepeatingTask(&doAnyPendingUIRendering, p++, 0.01, 0.01, 0.03, "pending UI", RESOURCE_NONE);
-
-	// Check for and handle queued SysEx traffic
-	addRepeatingTask([]() { smSysex::handleNextSysEx(); }, p++, 0.0002, 0.0002, 0.01, "Handle pending SysEx traffic.",
-	                 RESOURCE_SD);
-
-	// 21-29: Low priority (30 for dyn tasks)
-	p = 21;
-	// these ones are actually "slow" -> file manager just checks if an sd card has been inserted, audio recorder checks
-	// if recordings are finished
-	addRepeatingTask([]() { audioFileManager.slowRoutine(); }, p++, 0.1, 0.1, 0.2, "audio file slow", RESOURCE_SD);
-	// Needs the SD resources: it can call finishRecording(), which frees the SampleRecorder, and that must not happen
-	// while the card routine is part-way through using it.
-	addRepeatingTask([]() { audioRecorder.slowRoutine(); }, p++, 0.01, 0.09, 0.1, "audio recorder slow",
-	                 RESOURCE_SD | RESOURCE_SD_ROUTINE);
-	// formerly part of cluster loading (why? no idea), actions undo/redo midi commands
-	addRepeatingTask([]() { playbackHandler.slowRoutine(); }, p++, 0.01, 0.09, 0.1, "playback slow routine",
-	                 RESOURCE_SD);
-	// 31-39: Idle priority (40 for dyn tasks)
-	p = 31;
-	addRepeatingTask(&(PIC::flush), p++, 0.001, 0.001, 0.02, "PIC flush", RESOURCE_NONE);
+	// Or, with earliest deadline first scheduling turned on (by debug sysex), run whichever due task needs to start
+	// soonest. A task's deadline is its max time between calls, or sooner if it's declared a max latency with
+	// setMaxLatencyForTask()
+	using namespace FirmwareTasks;
+
+	AudioEngine::routine_task_id = add(AUDIO_ROUTINE, &(AudioEngine::routine_task));
+	// those times, and its max latency, are for the AUTO latency tier - this sets them for the one in use
+	AudioEngine::setLatencyTier(AudioEngine::latencyTier);
+	add(CHECK_USB_MIDI, []() {
+		MidiEngine::check_incoming_usb();
+		midiEngine.sendOverflowedUSBSysex();
+	});
+	encoders::EncoderTaskID = add(INTERPRET_ENCODERS, &(encoders::interpretEncodersTask));
+	add(PLAYBACK_ROUTINE, []() { playbackHandler.routine(); });
+	midiEngine.routine_task_id = add(MIDI_ROUTINE, []() { playbackHandler.midiRoutine(); });
+	add(LOAD_CLUSTERS, []() { audioFileManager.loadAnyEnqueuedClusters(128, false); });
+	add(AUDIO_SLOW, &AudioEngine::slowRoutine);
+	add(BUTTONS_AND_PADS, &(readButtonsAndPadsOnce));
+
+	add(PENDING_UI, &doAnyPendingUIRendering);
+	add(PENDING_SYSEX, []() { smSysex::handleNextSysEx(); });
+
+	add(AUDIO_FILE_SLOW, []() { audioFileManager.slowRoutine(); });
+	add(AUDIO_RECORDER_SLOW, []() { audioRecorder.slowRoutine(); });
+	add(PLAYBACK_SLOW_ROUTINE, []() { playbackHandler.slowRoutine(); });
+
+	add(PIC_FLUSH, &(PIC::flush));
 	if (hid::display::have_oled_screen) {
-		addRepeatingTask(&(oledRoutine), p++, 0.01, 0.01, 0.02, "oled routine", RESOURCE_NONE);
+		add(OLED_ROUTINE, &(oledRoutine));
 	}
-	// needs to be called very frequently,
-	// handles animations and checks on the timers for any infrequent actions
-	// long term this should probably be made into an idle task
-	addRepeatingTask([]() { uiTimerManager.routine(); }, p++, 0.0001, 0.0007, 0.01, "ui routine", RESOURCE_NONE);
+	add(UI_ROUTINE, []() { uiTimerManager.routine(); });
 
 	// addRepeatingTask([]() { AudioEngine::routineWithClusterLoading(true); }, 0, 1 / 44100., 16 / 44100., 32 / 44100.,
 	// true); addRepeatingTask(&(AudioEngine::routine), 0, 16 / 44100., 64 / 44100., true);
@@ -833,6 +806,7 @@ extern "C" int32_t deluge_main(void) {
 	    runtimeFeatureSettings.isOn(RuntimeFeatureSettingType::RoundedCorners);
 	MIDIDeviceManager::readDevicesFromFile();
 	midiFollow.readDefaultsFromFile();
+	setList.readFromFile();
 	PadLEDs::setBrightnessLevel(FlashStorage::defaultPadBrightness);
 	setupBlankSong(); // we always need to do this
 	addConditionalTask(setupStartupSong, 100, isCardReady, "load startup song", RESOURCE_SD | RESOURCE_SD_ROUTINE);
@@ -1035,7 +1009,7 @@ extern "C" void routineWithClusterLoading() {
 	AudioEngine::routineWithClusterLoading();
 }
 
-void deleteOldSongBeforeLoadingNew() {
+void silenceOldSongBeforeLoadingNew() {
 
 	currentSong->stopAllAuditioning();
 
@@ -1045,6 +1019,11 @@ void deleteOldSongBeforeLoadingNew() {
 	view.activeModControllableModelStack.modControllable = nullptr;
 	view.activeModControllableModelStack.setTimelineCounter(nullptr);
 	view.activeModControllableModelStack.paramManager = nullptr;
+}
+
+void deleteOldSongBeforeLoadingNew() {
+
+	silenceOldSongBeforeLoadingNew();
 
 	Song* toDelete = currentSong;
 	currentSong = nullptr;
@@ -261,12 +261,20 @@ uint32_t* uartGetCharWithTiming(int32_t timingCaptureItem, char* readData) {
 	return timer;
 }
 
+// Defined by the MIDI engine, which holds DIN output back in its own queue and only keeps the UART a few bytes ahead.
+// Tops the UART back up, and returns whether it added anything.
+extern uint8_t midiUartTransferEnded(void);
+
 // Warning - obviously this gets called in a DMA ISR
 // This is the function which seems to cause a crash if called via interrupt during the above one
 void tx_interrupt(int32_t item) {
 
 	uartItems[item].txBufferReadPos = uartItems[item].txBufferReadPosAfterTransfer;
 
+	if (item == UART_ITEM_MIDI && midiUartTransferEnded()) {
+		uartItems[item].shouldDoConsecutiveTransferAfter = 1;
+	}
+
 	// May want to try sending a consecutive transfer
 	if (item != UART_ITEM_MIDI || uartItems[item].shouldDoConsecutiveTransferAfter) {
 
@@ -16,8 +16,25 @@
  */
 
 #include "dsp/compressor/rms_feedback.h"
+#include "dsp/compressor/sidechain_key.h"
+#include "memory/memory_allocator_interface.h"
+#include "processing/engines/audio_engine.h"
+#include "storage/storage_manager.h"
 #include "util/fixedpoint.h"
+#include <cstring>
+#include <numbers>
 std::array<StereoSample, SSI_TX_BUFFER_NUM_SAMPLES> dryBuffer;
+std::array<std::array<StereoSample, SSI_TX_BUFFER_NUM_SAMPLES>, RMSFeedbackCompressor::kNumBands> bandBuffers;
+
+namespace {
+/// one pole coefficient for a cutoff in hertz, using the same approximation as setSidechain()
+constexpr q31_t crossoverCoefficient(float hz) {
+	float fc = std::numbers::pi_v<float> * hz / float(kSampleRate);
+	return (fc / (1 + fc)) * ONE_Q31;
+}
+constexpr q31_t kLowCrossover = crossoverCoefficient(200);
+constexpr q31_t kHighCrossover = crossoverCoefficient(3000);
+} // namespace
 
 RMSFeedbackCompressor::RMSFeedbackCompressor() {
 	setAttack(5 << 24);
@@ -29,6 +46,84 @@ RMSFeedbackCompressor::RMSFeedbackCompressor() {
 	// Default to the maximum useful base gain
 	baseGain_ = 1.35f;
 }
+
+RMSFeedbackCompressor::~RMSFeedbackCompressor() {
+	if (lookaheadBuffer != nullptr) {
+		delugeDealloc(lookaheadBuffer);
+	}
+}
+
+bool RMSFeedbackCompressor::setLookahead(q31_t lookahead) {
+	size_t newSamples = (uint64_t(std::max<q31_t>(lookahead, 0)) * kMaxLookaheadSamples) >> 31;
+	if (newSamples != 0 && lookaheadBuffer == nullptr) {
+		lookaheadBuffer = static_cast<StereoSample*>(allocMaxSpeed(kMaxLookaheadSamples * sizeof(StereoSample)));
+		if (lookaheadBuffer == nullptr) {
+			lookaheadSamples = 0;
+			lookaheadKnobPos = 0;
+			return false;
+		}
+		lookaheadHasAudio = true; // force a clear below
+	}
+	lookaheadKnobPos = lookahead;
+	if (newSamples != lookaheadSamples) {
+		lookaheadSamples = newSamples;
+		if (lookaheadBuffer != nullptr) {
+			clearLookahead();
+		}
+	}
+	return true;
+}
+
+void RMSFeedbackCompressor::clearLookahead() {
+	memset(lookaheadBuffer, 0, kMaxLookaheadSamples * sizeof(StereoSample));
+	lookaheadPos = 0;
+	lookaheadHasAudio = false;
+}
+
+void RMSFeedbackCompressor::setMultiband(bool newMultiband) {
+	if (newMultiband == multiband) {
+		return;
+	}
+	multiband = newMultiband;
+	// start the bands from where the single band compressor was so switching doesn't jump
+	for (Band& band : bands) {
+		band.state = state;
+		band.rms = rms;
+		band.mean = mean;
+		band.lastDBGain = lastDBGain;
+		band.currentVolumeL = currentVolumeL;
+		band.currentVolumeR = currentVolumeR;
+	}
+	crossover = {};
+	lookaheadCrossover = {};
+}
+
+void RMSFeedbackCompressor::Crossover::split(std::span<const StereoSample> input, std::span<StereoSample> low,
+                                             std::span<StereoSample> mid, std::span<StereoSample> high) {
+	// low is a one pole LP of the input, high a one pole HP of what's left and mid is the remainder, so the three
+	// bands always sum back to exactly the input
+	for (size_t i = 0; i < input.size(); i++) {
+		q31_t lowL = this->lowL.doFilter(input[i].l, kLowCrossover);
+		q31_t lowR = this->lowR.doFilter(input[i].r, kLowCrossover);
+		q31_t restL = input[i].l - lowL;
+		q31_t restR = input[i].r - lowR;
+		q31_t highL = restL - this->highL.doFilter(restL, kHighCrossover);
+		q31_t highR = restR - this->highR.doFilter(restR, kHighCrossover);
+		low[i] = {lowL, lowR};
+		mid[i] = {restL - highL, restR - highR};
+		high[i] = {highL, highR};
+	}
+}
+
+void RMSFeedbackCompressor::delayForLookahead(std::span<StereoSample> buffer) {
+	for (StereoSample& sample : buffer) {
+		std::swap(sample, lookaheadBuffer[lookaheadPos]);
+		if (++lookaheadPos == lookaheadSamples) {
+			lookaheadPos = 0;
+		}
+	}
+	lookaheadHasAudio = true;
+}
 // 16 is ln(1<<24) - 1, i.e. where we start clipping
 // since this applies to output
 void RMSFeedbackCompressor::updateER(float numSamples, q31_t finalVolume) {
@@ -58,6 +153,28 @@ void RMSFeedbackCompressor::renderVolNeutral(std::span<StereoSample> buffer, q31
 constexpr uint8_t saturationAmount = 3;
 void RMSFeedbackCompressor::render(std::span<StereoSample> buffer, q31_t volAdjustL, q31_t volAdjustR,
                                    q31_t finalVolume) {
+	if (lookaheadSamples != 0) {
+		// the level change from volAdjust, used to predict what the output will measure
+		float volAdjustDB =
+		    std::log(float(std::max(std::abs(volAdjustL), std::abs(volAdjustR))) / float(1 << 27) + 1e-10f);
+		// detect on the audio before it goes into the delay line. Since the feedback detector measures the output, add
+		// on the gain from last time to land in the same place
+		if (keyedFromSidechain) {
+			// the key does the detecting
+		}
+		else if (multiband) {
+			lookaheadCrossover.split(buffer, bandBuffers[0], bandBuffers[1], bandBuffers[2]);
+			for (size_t i = 0; i < kNumBands; i++) {
+				std::span bandBuffer{bandBuffers[i].data(), buffer.size()};
+				bands[i].rms = calcLogRMS(bandBuffer, bands[i].mean) + bands[i].lastDBGain + volAdjustDB;
+			}
+		}
+		else {
+			rms = calcRMS(buffer) + lastDBGain + volAdjustDB;
+		}
+		delayForLookahead(buffer);
+	}
+
 	// make a copy for blending if we need to
 	if (wet != ONE_Q31) {
 		memcpy(dryBuffer.data(), buffer.data(), buffer.size_bytes());
@@ -74,38 +191,49 @@ void RMSFeedbackCompressor::render(std::span<StereoSample> buffer, q31_t volAdju
 	// we update this every time since we won't know if the song volume changed
 	updateER(buffer.size(), finalVolume);
 
-	float over = std::max<float>(0, (rms - threshdb));
-
-	state = runEnvelope(state, over, buffer.size());
-
-	float reduction = -state * fraction;
-
-	// this is the most gain available without overflow
-	// Amount of gain. Must not exceed 3.43 as that will result in a gain > 31
-	float dbGain = baseGain_ + er + reduction;
+	if (keyedFromSidechain) {
+		// the key is measured and its envelope run once per window for everyone, from the previous window for the per
+		// track compressors
+		AudioEngine::sideChainKey.requestTimeConstants(a_, r_);
+	}
 
-	float gain = std::exp((dbGain));
-	gain = std::min<float>(gain, 31);
+	float reduction = 0;
+	if (multiband) {
+		crossover.split(buffer, bandBuffers[0], bandBuffers[1], bandBuffers[2]);
+		for (size_t i = 0; i < kNumBands; i++) {
+			Band& band = bands[i];
+			std::span bandBuffer{bandBuffers[i].data(), buffer.size()};
+			float bandReduction;
+			band.lastDBGain = keyedFromSidechain ? getKeyedDBGain(bandReduction)
+			                                     : getDBGain(band.state, band.rms, buffer.size(), bandReduction);
+			float gain = std::min<float>(std::exp(band.lastDBGain), 31);
+			applyVolume(bandBuffer, band.currentVolumeL, band.currentVolumeR, gain * float(volAdjustL >> 9),
+			            gain * float(volAdjustR >> 9));
+			// display whichever band is working hardest
+			reduction = std::min(reduction, bandReduction);
+		}
+		for (size_t i = 0; i < buffer.size(); i++) {
+			buffer[i].l = add_saturate(add_saturate(bandBuffers[0][i].l, bandBuffers[1][i].l), bandBuffers[2][i].l);
+			buffer[i].r = add_saturate(add_saturate(bandBuffers[0][i].r, bandBuffers[1][i].r), bandBuffers[2][i].r);
+		}
+	}
+	else {
+		// this is the most gain available without overflow
+		// Amount of gain. Must not exceed 3.43 as that will result in a gain > 31
+		lastDBGain = keyedFromSidechain ? getKeyedDBGain(reduction) : getDBGain(state, rms, buffer.size(), reduction);
 
-	// Compute linear volume adjustments as 13.18 signed fixed-point numbers (though stored as floats due to their
-	// use as an intermediate value prior to the increment computation below)
-	float finalVolumeL = gain * float(volAdjustL >> 9);
-	float finalVolumeR = gain * float(volAdjustR >> 9);
+		float gain = std::exp((lastDBGain));
+		gain = std::min<float>(gain, 31);
 
-	// The amount we need to step the current volume so that by the end of the rendering window
-	q31_t amplitudeIncrementL = ((int32_t)((finalVolumeL - (currentVolumeL >> 8)) / float(buffer.size()))) << 8;
-	q31_t amplitudeIncrementR = ((int32_t)((finalVolumeR - (currentVolumeR >> 8)) / float(buffer.size()))) << 8;
+		// Compute linear volume adjustments as 13.18 signed fixed-point numbers (though stored as floats due to their
+		// use as an intermediate value prior to the increment computation below)
+		applyVolume(buffer, currentVolumeL, currentVolumeR, gain * float(volAdjustL >> 9),
+		            gain * float(volAdjustR >> 9));
+	}
 
 	auto dry_it = dryBuffer.begin();
 	for (StereoSample& sample : buffer) {
-		currentVolumeL += amplitudeIncrementL;
-		currentVolumeR += amplitudeIncrementR;
-
-		// Need to shift left by 4 because currentVolumeL is a 5.26 signed number rather than a 1.30 signed.
-		sample.l = multiply_32x32_rshift32(sample.l, currentVolumeL) << 4;
 		sample.l = getTanHAntialiased(sample.l, &lastSaturationTanHWorkingValue[0], saturationAmount);
-
-		sample.r = multiply_32x32_rshift32(sample.r, currentVolumeR) << 4;
 		sample.r = getTanHAntialiased(sample.r, &lastSaturationTanHWorkingValue[1], saturationAmount);
 		// wet/dry blend
 		if (wet != ONE_Q31) {
@@ -123,21 +251,129 @@ void RMSFeedbackCompressor::render(std::span<StereoSample> buffer, q31_t volAdju
 	// for LEDs
 	// 4 converts to dB, then quadrupled for display range since a 30db reduction is basically killing the signal
 	gainReduction = std::clamp<int32_t>(-(reduction) * 4 * 4, 0, 127);
-	// calc compression for next round (feedback compressor)
-	rms = calcRMS(buffer);
+
+	// calc compression for next round (feedback compressor). With lookahead or a key this was already done up front
+	if (lookaheadSamples == 0 && !keyedFromSidechain) {
+		if (multiband) {
+			for (size_t i = 0; i < kNumBands; i++) {
+				bands[i].rms = calcLogRMS({bandBuffers[i].data(), buffer.size()}, bands[i].mean);
+			}
+		}
+		else {
+			rms = calcRMS(buffer);
+		}
+	}
 }
 
-float RMSFeedbackCompressor::runEnvelope(float current, float desired, float numSamples) const {
+float RMSFeedbackCompressor::getDBGain(float& envelope, float level, float numSamples, float& reduction) {
+	float over = std::max<float>(0, (level - threshdb));
+
+	envelope = runEnvelope(envelope, over, numSamples);
+
+	reduction = -envelope * fraction;
+
+	return baseGain_ + er + reduction;
+}
+
+float RMSFeedbackCompressor::getKeyedDBGain(float& reduction) {
+	reduction = -std::max<float>(0, AudioEngine::sideChainKey.getEnvelope() - threshdb) * fraction;
+
+	return baseGain_ + er + reduction;
+}
+
+void RMSFeedbackCompressor::applyVolume(std::span<StereoSample> buffer, q31_t& currentL, q31_t& currentR,
+                                        float targetL, float targetR) {
+	// The amount we need to step the current volume so that by the end of the rendering window
+	q31_t amplitudeIncrementL = ((int32_t)((targetL - (currentL >> 8)) / float(buffer.size()))) << 8;
+	q31_t amplitudeIncrementR = ((int32_t)((targetR - (currentR >> 8)) / float(buffer.size()))) << 8;
+
+	for (StereoSample& sample : buffer) {
+		currentL += amplitudeIncrementL;
+		currentR += amplitudeIncrementR;
+
+		// Need to shift left by 4 because currentVolumeL is a 5.26 signed number rather than a 1.30 signed.
+		sample.l = multiply_32x32_rshift32(sample.l, currentL) << 4;
+		sample.r = multiply_32x32_rshift32(sample.r, currentR) << 4;
+	}
+}
+
+float RMSFeedbackCompressor::runEnvelope(float current, float desired, float numSamples, float attack,
+                                        float release) {
 	float s{0};
 	if (desired > current) {
-		s = desired + std::exp(a_ * numSamples) * (current - desired);
+		s = desired + std::exp(attack * numSamples) * (current - desired);
 	}
 	else {
-		s = desired + std::exp(r_ * numSamples) * (current - desired);
+		s = desired + std::exp(release * numSamples) * (current - desired);
 	}
 	return s;
 }
 
+void RMSFeedbackCompressor::writeToFile(Serializer& writer, char const* tagName) {
+	writer.writeOpeningTagBeginning(tagName);
+	writer.writeAttribute("attack", getAttack());
+	writer.writeAttribute("release", getRelease());
+	writer.writeAttribute("thresh", getThreshold());
+	writer.writeAttribute("ratio", getRatio());
+	writer.writeAttribute("compHPF", getSidechain());
+	writer.writeAttribute("compBlend", getBlend());
+	if (getLookahead() != 0) {
+		writer.writeAttribute("compLookahead", getLookahead());
+	}
+	if (isMultiband()) {
+		writer.writeAttribute("compMultiband", 1);
+	}
+	if (isKeyedFromSidechain()) {
+		writer.writeAttribute("compSidechainKey", 1);
+	}
+	writer.closeTag();
+}
+
+void RMSFeedbackCompressor::readFromFile(Deserializer& reader) {
+	char const* tagName;
+	while (*(tagName = reader.readNextTagOrAttributeName())) {
+		if (!strcmp(tagName, "attack")) {
+			setAttack(reader.readTagOrAttributeValueInt());
+			reader.exitTag("attack");
+		}
+		else if (!strcmp(tagName, "release")) {
+			setRelease(reader.readTagOrAttributeValueInt());
+			reader.exitTag("release");
+		}
+		else if (!strcmp(tagName, "thresh")) {
+			setThreshold(reader.readTagOrAttributeValueInt());
+			reader.exitTag("thresh");
+		}
+		else if (!strcmp(tagName, "ratio")) {
+			setRatio(reader.readTagOrAttributeValueInt());
+			reader.exitTag("ratio");
+		}
+		else if (!strcmp(tagName, "compHPF")) {
+			setSidechain(reader.readTagOrAttributeValueInt());
+			reader.exitTag("compHPF");
+		}
+		else if (!strcmp(tagName, "compBlend")) {
+			setBlend(reader.readTagOrAttributeValueInt());
+			reader.exitTag("compBlend");
+		}
+		else if (!strcmp(tagName, "compLookahead")) {
+			setLookahead(reader.readTagOrAttributeValueInt());
+			reader.exitTag("compLookahead");
+		}
+		else if (!strcmp(tagName, "compMultiband")) {
+			setMultiband(reader.readTagOrAttributeValueInt() != 0);
+			reader.exitTag("compMultiband");
+		}
+		else if (!strcmp(tagName, "compSidechainKey")) {
+			setKeyedFromSidechain(reader.readTagOrAttributeValueInt() != 0);
+			reader.exitTag("compSidechainKey");
+		}
+		else {
+			reader.exitTag(tagName);
+		}
+	}
+}
+
 // output range is 0-21 (2^31)
 // dac clipping is at 16
 float RMSFeedbackCompressor::calcRMS(std::span<StereoSample> buffer) {
@@ -165,3 +401,21 @@ float RMSFeedbackCompressor::calcRMS(std::span<StereoSample> buffer) {
 
 	return logmean;
 }
+
+float RMSFeedbackCompressor::calcLogRMS(std::span<const StereoSample> buffer, float& mean) {
+	int64_t sum = 0;
+	float lastMean = mean;
+
+	for (StereoSample sample : buffer) {
+		q31_t s = std::max(std::abs(sample.l), std::abs(sample.r));
+		sum += multiply_32x32_rshift32(s, s);
+	}
+
+	float ns = buffer.size() * 2;
+	mean = (float(sum) / ONE_Q31f) / ns;
+	// same one pole smoothing as calcRMS()
+	mean = (mean * ns + lastMean) / (1 + ns);
+	float rms = ONE_Q31 * std::sqrt(mean);
+
+	return std::log(std::max(rms, 1.0f));
+}
@@ -20,12 +20,24 @@
 #include "definitions_cxx.hpp"
 #include "dsp/filter/ladder_components.h"
 #include "dsp/stereo_sample.h"
+#include <array>
 #include <cmath>
 #include <span>
 
+class Serializer;
+class Deserializer;
+
 class [[gnu::hot]] RMSFeedbackCompressor {
 public:
+	/// Longest lookahead available, in samples (about 5.8ms)
+	static constexpr size_t kMaxLookaheadSamples = 256;
+	/// Number of bands used when multiband is enabled
+	static constexpr size_t kNumBands = 3;
+
 	RMSFeedbackCompressor();
+	~RMSFeedbackCompressor();
+	RMSFeedbackCompressor(const RMSFeedbackCompressor&) = delete;
+	RMSFeedbackCompressor& operator=(const RMSFeedbackCompressor&) = delete;
 
 	/// takes in all values as knob positions in the range 0-ONE_Q31
 	constexpr void setup(q31_t a, q31_t r, q31_t t, q31_t rat, q31_t fc, q31_t blend, float baseGain) {
@@ -44,6 +56,13 @@ public:
 		er = 0;
 		mean = 0;
 		onLastTime = false;
+		for (Band& band : bands) {
+			band.state = 0;
+			band.mean = 0;
+		}
+		if (lookaheadHasAudio) {
+			clearLookahead();
+		}
 	}
 
 	/// Render the compressor in-place using the provided buffer.
@@ -64,7 +83,20 @@ public:
 
 	/// Compute an updated envelope value, using the attack time constant if desired > current and the release time
 	/// constant otherwise.
-	[[nodiscard]] float runEnvelope(float current, float desired, float numSamples) const;
+	[[nodiscard]] float runEnvelope(float current, float desired, float numSamples) const {
+		return runEnvelope(current, desired, numSamples, a_, r_);
+	}
+
+	/// As above, with the attack and release time constants (in inverse samples) given
+	[[nodiscard]] static float runEnvelope(float current, float desired, float numSamples, float attack,
+	                                       float release);
+
+	/// Write the settings as the attributes of a tag called tagName
+	void writeToFile(Serializer& writer, char const* tagName);
+
+	/// Read the attributes written by writeToFile(), once the caller has opened the tag. Settings missing from the
+	/// file, e.g. because it was saved by older firmware, are left as they are
+	void readFromFile(Deserializer& reader);
 
 	/// Get the current attack time constant in terms of the full knob range (0 to 2^31)
 	[[nodiscard]] inline constexpr q31_t getAttack() const { return attackKnobPos; }
@@ -166,12 +198,41 @@ public:
 	/// The song compressor must use 0.8 to maintain compatibility with previous songs.
 	constexpr void setBaseGain(float baseGain) { baseGain_ = baseGain; }
 
+	/// Get the current lookahead as a full-scale (0 to 2^31) number
+	[[nodiscard]] inline constexpr q31_t getLookahead() const { return lookaheadKnobPos; }
+
+	/// Get the current lookahead in MS
+	[[nodiscard]] inline constexpr float getLookaheadMS() const {
+		return 1000.0f * float(lookaheadSamples) / float(kSampleRate);
+	}
+
+	/// Set the lookahead from a full-scale (0 to 2^31) number, linearly mapped from 0 to kMaxLookaheadSamples.
+	///
+	/// With lookahead, the detector works on the audio before it goes through a short delay line, so gain changes
+	/// land on the transients that caused them. Returns false if the delay line couldn't be allocated, in which case
+	/// lookahead stays off.
+	bool setLookahead(q31_t lookahead);
+
+	/// Whether the signal is split into low, mid and high bands which are compressed independently
+	[[nodiscard]] inline constexpr bool isMultiband() const { return multiband; }
+	void setMultiband(bool newMultiband);
+
+	/// Whether the detector listens to the shared sidechain key (see SideChainKey) instead of this compressor's own
+	/// output. All compressors keyed like this share one level measurement and envelope per render window, and only
+	/// apply their own threshold and ratio to it.
+	[[nodiscard]] inline constexpr bool isKeyedFromSidechain() const { return keyedFromSidechain; }
+	constexpr void setKeyedFromSidechain(bool keyed) { keyedFromSidechain = keyed; }
+
 	/// Update the internal envelope and gain reduction tracking.
 	void updateER(float numSamples, q31_t finalVolume);
 
 	/// Calculate the RMS amplitude, post internal HPF, of the samples.
 	float calcRMS(std::span<StereoSample> buffer);
 
+	/// Calculate the log-RMS amplitude of the samples without any filtering, smoothing against (and updating) mean in
+	/// the same way as calcRMS()
+	static float calcLogRMS(std::span<const StereoSample> buffer, float& mean);
+
 	/// Amount of gain reduction applied during the last render pass, in 6.2 fixed point decibels
 	uint8_t gainReduction = 0;
 
@@ -210,6 +271,52 @@ private:
 	uint32_t lastSaturationTanHWorkingValue[2] = {0};
 	bool onLastTime = false;
 
+	/// Detector and gain state for each band in multiband mode
+	struct Band {
+		float state = 0;
+		float rms = 0;
+		float mean = 0;
+		float lastDBGain = 0;
+		q31_t currentVolumeL = 0;
+		q31_t currentVolumeR = 0;
+	};
+	std::array<Band, kNumBands> bands;
+
+	/// Splits a signal into three bands which sum back to the original
+	struct Crossover {
+		void split(std::span<const StereoSample> input, std::span<StereoSample> low, std::span<StereoSample> mid,
+		           std::span<StereoSample> high);
+		deluge::dsp::filter::BasicFilterComponent lowL;
+		deluge::dsp::filter::BasicFilterComponent lowR;
+		deluge::dsp::filter::BasicFilterComponent highL;
+		deluge::dsp::filter::BasicFilterComponent highR;
+	};
+	/// Splits the audio that gets compressed
+	Crossover crossover;
+	/// Splits the undelayed audio for detection, only used with lookahead
+	Crossover lookaheadCrossover;
+	bool multiband = false;
+
+	/// Work out the gain to apply over the next render window for a detected log-RMS level, running the envelope.
+	/// Returns the log gain, and writes the (negative) reduction in neppers to reduction.
+	float getDBGain(float& envelope, float level, float numSamples, float& reduction);
+	/// Same as getDBGain(), but for the shared envelope of the sidechain key, which has already been run
+	float getKeyedDBGain(float& reduction);
+	/// Ramp the volume from currentL/R to targetL/R (13.18 fixed point) over the buffer, applying it as we go
+	static void applyVolume(std::span<StereoSample> buffer, q31_t& currentL, q31_t& currentR, float targetL,
+	                        float targetR);
+	/// Swap the buffer through the lookahead delay line
+	void delayForLookahead(std::span<StereoSample> buffer);
+	void clearLookahead();
+	/// The log gain applied during the last render, used to predict the output level when looking ahead
+	float lastDBGain = 0;
+
+	StereoSample* lookaheadBuffer = nullptr;
+	size_t lookaheadSamples = 0;
+	size_t lookaheadPos = 0;
+	bool lookaheadHasAudio = false;
+	bool keyedFromSidechain = false;
+
 	// sidechain filter
 	deluge::dsp::filter::BasicFilterComponent hpfL;
 	deluge::dsp::filter::BasicFilterComponent hpfR;
@@ -229,6 +336,7 @@ private:
 	q31_t attackKnobPos = 0;
 	q31_t releaseKnobPos = 0;
 	q31_t sideChainKnobPos = 0;
+	q31_t lookaheadKnobPos = 0;
 	q31_t dry;
 	q31_t wet;
 };
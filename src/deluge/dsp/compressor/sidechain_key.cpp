@@ -0,0 +1,61 @@
+/*
+ * Copyright © 2025 Synthstrom Audible Limited
+ *
+ * This file is part of The Synthstrom Audible Deluge Firmware.
+ *
+ * The Synthstrom Audible Deluge Firmware is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program.
+ * If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "dsp/compressor/sidechain_key.h"
+#include "dsp/compressor/rms_feedback.h"
+#include "util/fixedpoint.h"
+#include <algorithm>
+#include <cstring>
+
+void SideChainKey::feed(std::span<const StereoSample> buffer) {
+	size_t numSamples = std::min(buffer.size(), mix_.size());
+	// the first source this window overwrites whatever was left from the last one, saving a clear
+	if (numFed_ == 0) {
+		memcpy(mix_.data(), buffer.data(), numSamples * sizeof(StereoSample));
+	}
+	else {
+		for (size_t i = 0; i < numSamples; i++) {
+			mix_[i].l = add_saturate(mix_[i].l, buffer[i].l);
+			mix_[i].r = add_saturate(mix_[i].r, buffer[i].r);
+		}
+	}
+	numFed_++;
+}
+
+void SideChainKey::requestTimeConstants(float attack, float release) {
+	// time constants are negative, so the fastest is the lowest
+	requestedAttack_ = std::min(requestedAttack_, attack);
+	requestedRelease_ = std::min(requestedRelease_, release);
+}
+
+void SideChainKey::finishWindow(size_t numSamples) {
+	active_ = (numFed_ != 0);
+	if (!active_) {
+		// nothing playing into the key, so let the level fall away rather than holding the last value
+		memset(mix_.data(), 0, numSamples * sizeof(StereoSample));
+	}
+	logRMS_ = RMSFeedbackCompressor::calcLogRMS({mix_.data(), numSamples}, mean_);
+	numFed_ = 0;
+
+	if (requestedAttack_ != 0) {
+		attack_ = requestedAttack_;
+		release_ = requestedRelease_;
+		requestedAttack_ = 0;
+		requestedRelease_ = 0;
+	}
+	envelope_ = RMSFeedbackCompressor::runEnvelope(envelope_, logRMS_, numSamples, attack_, release_);
+}
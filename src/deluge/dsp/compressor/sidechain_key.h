@@ -0,0 +1,65 @@
+/*
+ * Copyright © 2025 Synthstrom Audible Limited
+ *
+ * This file is part of The Synthstrom Audible Deluge Firmware.
+ *
+ * The Synthstrom Audible Deluge Firmware is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program.
+ * If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "definitions_cxx.hpp"
+#include "dsp/stereo_sample.h"
+#include <array>
+#include <span>
+
+/// A level detector and envelope shared by every compressor keyed from the sidechain.
+///
+/// Each sound with a sidechain send feeds its output in while the song renders, and once the window is finished the
+/// mix of all of them is measured and its envelope run, once. Keyed compressors then read that envelope instead of
+/// running their own detector, so the work doesn't grow with the number of compressed tracks.
+class SideChainKey {
+public:
+	/// Mix a sidechain source's output into the current render window
+	void feed(std::span<const StereoSample> buffer);
+
+	/// Ask for the envelope to move at least this fast, with time constants in inverse samples like
+	/// RMSFeedbackCompressor's. The fastest attack and release asked for during a window are used when it's finished,
+	/// and the last ones carry on if nobody asks.
+	void requestTimeConstants(float attack, float release);
+
+	/// Measure everything fed since the last call and run the envelope, making them what compressors see until the next
+	/// call
+	void finishWindow(size_t numSamples);
+
+	/// Log-RMS level of the key, on the same scale as RMSFeedbackCompressor's own detector
+	[[nodiscard]] float getLogRMS() const { return logRMS_; }
+
+	/// Envelope of getLogRMS()
+	[[nodiscard]] float getEnvelope() const { return envelope_; }
+
+	/// Whether anything has fed the key recently
+	[[nodiscard]] bool isActive() const { return active_; }
+
+private:
+	std::array<StereoSample, SSI_TX_BUFFER_NUM_SAMPLES> mix_{};
+	size_t numFed_ = 0;
+	float mean_ = 0;
+	float logRMS_ = 0;
+	float envelope_ = 0;
+	// Time constants in use, and the fastest asked for this window (0 if nobody has asked)
+	float attack_ = -1000.0f / kSampleRate;
+	float release_ = -1000.0f / kSampleRate;
+	float requestedAttack_ = 0;
+	float requestedRelease_ = 0;
+	bool active_ = false;
+};
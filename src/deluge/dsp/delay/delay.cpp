@@ -21,14 +21,17 @@
 #include "dsp/stereo_sample.h"
 #include "io/debug/log.h"
 #include "memory/general_memory_allocator.h"
+#include "model/settings/runtime_feature_settings.h"
 #include "model/sync.h"
 #include "processing/engines/audio_engine.h"
+#include "util/cfunctions.h"
+#include <array>
 #include <cstdlib>
 #include <ranges>
 
 extern int32_t spareRenderingBuffer[][SSI_TX_BUFFER_NUM_SAMPLES];
 
-void Delay::informWhetherActive(bool newActive, int32_t userDelayRate) {
+void Delay::informWhetherActive(bool newActive, int32_t userDelayRate, bool allowSlipping) {
 
 	bool previouslyActive = isActive();
 
@@ -39,7 +42,7 @@ void Delay::informWhetherActive(bool newActive, int32_t userDelayRate) {
 		}
 
 setupSecondaryBuffer:
-		Error result = secondaryBuffer.init(userDelayRate);
+		Error result = secondaryBuffer.init(userDelayRate, 0, true, allowSlipping);
 		if (result != Error::NONE) {
 			return;
 		}
@@ -115,11 +118,14 @@ void Delay::setupWorkingState(Delay::State& workingState, uint32_t timePerIntern
 				workingState.userDelayRate = workingState.userDelayRate * 2 / 3;
 			}
 			workingState.userDelayRate <<= (syncLevel + 5);
+
+			workingState.syncedWithoutResampling =
+			    runtimeFeatureSettings.isOn(RuntimeFeatureSettingType::SyncedDelayWithoutResampling);
 		}
 	}
 
 	// Tell it to allocate memory if that hasn't already happened
-	informWhetherActive(mightDoDelay, workingState.userDelayRate);
+	informWhetherActive(mightDoDelay, workingState.userDelayRate, workingState.syncedWithoutResampling);
 	workingState.doDelay = isActive(); // Check that ram actually is allocated
 
 	if (workingState.doDelay) {
@@ -201,8 +207,9 @@ void Delay::discardBuffers() {
 	repeatsUntilAbandon = 0;
 }
 
-void Delay::initializeSecondaryBuffer(int32_t newNativeRate, bool makeNativeRatePreciseRelativeToOtherBuffer) {
-	Error result = secondaryBuffer.init(newNativeRate, primaryBuffer.size());
+void Delay::initializeSecondaryBuffer(int32_t newNativeRate, bool makeNativeRatePreciseRelativeToOtherBuffer,
+                                      bool allowSlipping) {
+	Error result = secondaryBuffer.init(newNativeRate, primaryBuffer.size(), true, allowSlipping);
 	if (result != Error::NONE) {
 		return;
 	}
@@ -234,34 +241,44 @@ void Delay::process(std::span<StereoSample> buffer, const State& delayWorkingSta
 		countCyclesWithoutChange += buffer.size();
 	}
 
+	// A synced delay can follow small tempo changes by slipping its buffer length towards the new rate, which
+	// avoids both resampling and the cost of filling a secondary buffer
+	bool slipping = delayWorkingState.syncedWithoutResampling && !secondaryBuffer.isActive()
+	                && primaryBuffer.isActive() && primaryBuffer.isNative()
+	                && primaryBuffer.slipTowardsRate(delayWorkingState.userDelayRate);
+
 	// If just a single buffer is being used for reading and writing, we can consider making a 2nd buffer
-	if (!secondaryBuffer.isActive()) {
+	if (!slipping && !secondaryBuffer.isActive()) {
 
 		// If resampling previously recorded as happening, or just about to be recorded as happening
 		if (primaryBuffer.resampling() || delayWorkingState.userDelayRate != primaryBuffer.nativeRate()) {
 
+			bool allowSlipping = delayWorkingState.syncedWithoutResampling;
+
 			// If delay speed has settled for a split second...
 			if (countCyclesWithoutChange >= (kSampleRate >> 3)) {
 				// D_PRINTLN("settling");
-				initializeSecondaryBuffer(delayWorkingState.userDelayRate, true);
+				initializeSecondaryBuffer(delayWorkingState.userDelayRate, true, allowSlipping);
 			}
 
 			// If spinning at double native rate, there's no real need to be using such a big buffer, so make a new
 			// (smaller) buffer at our new rate
 			else if (delayWorkingState.userDelayRate >= (primaryBuffer.nativeRate() << 1)) {
-				initializeSecondaryBuffer(delayWorkingState.userDelayRate, false);
+				initializeSecondaryBuffer(delayWorkingState.userDelayRate, false, allowSlipping);
 			}
 
 			// If spinning below native rate, the quality's going to be suffering, so make a new buffer whose native
 			// rate is half our current rate (double the quality)
 			else if (delayWorkingState.userDelayRate < primaryBuffer.nativeRate() >> 1) {
-				initializeSecondaryBuffer(delayWorkingState.userDelayRate >> 1, false);
+				initializeSecondaryBuffer(delayWorkingState.userDelayRate >> 1, false, allowSlipping);
 			}
 		}
 	}
 
 	// Figure some stuff out for the primary buffer
-	primaryBuffer.setupForRender(delayWorkingState.userDelayRate);
+	if (!slipping) {
+		primaryBuffer.setupForRender(delayWorkingState.userDelayRate);
+	}
 
 	// Figure some stuff out for the secondary buffer - only if it's active
 	if (secondaryBuffer.isActive()) {
@@ -292,37 +309,12 @@ void Delay::process(std::span<StereoSample> buffer, const State& delayWorkingSta
 
 		// Native read
 		if (primaryBuffer.isNative()) {
-			for (StereoSample& sample : working_buffer) {
-				wrapped = primaryBuffer.clearAndMoveOn() || wrapped;
-				sample = primaryBuffer.current();
-			}
+			wrapped = primaryBuffer.readNativeBlock(working_buffer);
 		}
 
 		// Or, resampling read
 		else {
-
-			for (StereoSample& sample : working_buffer) {
-				// Move forward, and clear buffer as we go
-				int32_t primaryStrength2 = primaryBuffer.advance([&] {
-					wrapped = primaryBuffer.clearAndMoveOn() || wrapped; //<
-				});
-
-				int32_t primaryStrength1 = 65536 - primaryStrength2;
-
-				StereoSample* nextPos = &primaryBuffer.current() + 1;
-				if (nextPos == primaryBuffer.end()) {
-					nextPos = primaryBuffer.begin();
-				}
-				StereoSample fromDelay1 = primaryBuffer.current();
-				StereoSample fromDelay2 = *nextPos;
-
-				sample.l = (multiply_32x32_rshift32(fromDelay1.l, primaryStrength1 << 14)
-				            + multiply_32x32_rshift32(fromDelay2.l, primaryStrength2 << 14))
-				           << 2;
-				sample.r = (multiply_32x32_rshift32(fromDelay1.r, primaryStrength1 << 14)
-				            + multiply_32x32_rshift32(fromDelay2.r, primaryStrength2 << 14))
-				           << 2;
-			}
+			wrapped = primaryBuffer.readResampledBlock(working_buffer);
 		}
 	}
 
@@ -395,9 +387,7 @@ void Delay::process(std::span<StereoSample> buffer, const State& delayWorkingSta
 				writePos += primaryBuffer.sizeIncludingExtra;
 			}
 
-			for (StereoSample sample : working_buffer) {
-				primaryBuffer.writeNativeAndMoveOn(sample, &writePos);
-			}
+			primaryBuffer.writeNativeBlock(writePos, working_buffer);
 		}
 
 		// Resampling
@@ -427,13 +417,8 @@ void Delay::process(std::span<StereoSample> buffer, const State& delayWorkingSta
 
 		// Native
 		if (secondaryBuffer.isNative()) {
-			for (StereoSample sample : working_buffer) {
-				wrapped = secondaryBuffer.clearAndMoveOn() || wrapped;
-				sizeLeftUntilBufferSwap--;
-
-				// Write to secondary buffer
-				secondaryBuffer.writeNative(sample);
-			};
+			wrapped = secondaryBuffer.clearAndWriteNativeBlock(working_buffer);
+			sizeLeftUntilBufferSwap -= working_buffer.size();
 		}
 
 		// Resampled
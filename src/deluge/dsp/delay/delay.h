@@ -32,6 +32,9 @@ public:
 		int32_t userDelayRate;
 		int32_t delayFeedbackAmount;
 		int32_t analog_saturation = 8;
+		// Follow tempo changes by slipping the buffer length instead of resampling - see
+		// DelayBuffer::slipTowardsRate()
+		bool syncedWithoutResampling = false;
 	};
 
 	Delay() = default;
@@ -47,10 +50,11 @@ public:
 
 	[[nodiscard]] constexpr bool isActive() const { return (primaryBuffer.isActive() || secondaryBuffer.isActive()); }
 
-	void informWhetherActive(bool newActive, int32_t userDelayRate = 0);
+	void informWhetherActive(bool newActive, int32_t userDelayRate = 0, bool allowSlipping = false);
 	void copySecondaryToPrimary();
 	void copyPrimaryToSecondary();
-	void initializeSecondaryBuffer(int32_t newNativeRate, bool makeNativeRatePreciseRelativeToOtherBuffer);
+	void initializeSecondaryBuffer(int32_t newNativeRate, bool makeNativeRatePreciseRelativeToOtherBuffer,
+	                               bool allowSlipping = false);
 	void setupWorkingState(State& workingState, uint32_t timePerInternalTickInverse, bool anySoundComingIn = true);
 	void discardBuffers();
 	void setTimeToAbandon(const State& workingState);
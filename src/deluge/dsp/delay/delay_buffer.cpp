@@ -19,11 +19,16 @@
 #include "dsp/stereo_sample.h"
 #include "mem_functions.h"
 #include "memory/memory_allocator_interface.h"
+#include <array>
 #include <cmath>
 #include <optional>
 
+#if defined(__arm__)
+#include "arm_neon_shim.h"
+#endif
+
 // Returns error status
-Error DelayBuffer::init(uint32_t rate, uint32_t failIfThisSize, bool includeExtraSpace) {
+Error DelayBuffer::init(uint32_t rate, uint32_t failIfThisSize, bool includeExtraSpace, bool allowSlipping) {
 
 	// Uart::println("init buffer");
 	auto [size, make_precise] = getIdealBufferSizeFromRate(rate);
@@ -44,7 +49,13 @@ Error DelayBuffer::init(uint32_t rate, uint32_t failIfThisSize, bool includeExtr
 
 	sizeIncludingExtra = size_ + (includeExtraSpace ? delaySpaceBetweenReadAndWrite : 0);
 
-	start_ = (StereoSample*)allocLowSpeed(sizeIncludingExtra * sizeof(StereoSample));
+	// Leave room for slipTowardsRate() to grow the buffer into
+	capacity_ = sizeIncludingExtra;
+	if (allowSlipping) {
+		capacity_ += std::min(size_ >> kSlipRangeMagnitude, kMaxSize - size_);
+	}
+
+	start_ = (StereoSample*)allocLowSpeed(capacity_ * sizeof(StereoSample));
 
 	if (start_ == nullptr) {
 		return Error::INSUFFICIENT_RAM;
@@ -189,3 +200,167 @@ void DelayBuffer::setupForRender(int32_t rate) {
 	    .writeSizeAdjustment = writeSizeAdjustment,
 	};
 }
+
+bool DelayBuffer::clearAndMoveOnBlock(size_t numSamples) {
+	size_t firstPart = std::min<size_t>(numSamples, end_ - current_);
+	memset(current_, 0, firstPart * sizeof(StereoSample));
+	memset(start_, 0, (numSamples - firstPart) * sizeof(StereoSample));
+
+	current_ += numSamples;
+	bool wrapped = (current_ >= end_);
+	if (wrapped) {
+		current_ -= sizeIncludingExtra;
+	}
+	return wrapped;
+}
+
+bool DelayBuffer::readNativeBlock(std::span<StereoSample> output) {
+	size_t numSamples = output.size();
+
+	// Tiny buffers could wrap more than once per block - just do those the slow way
+	if (numSamples >= sizeIncludingExtra) {
+		bool wrapped = false;
+		for (StereoSample& sample : output) {
+			wrapped = clearAndMoveOn() || wrapped;
+			sample = *current_;
+		}
+		return wrapped;
+	}
+
+	// Each sample gets read one step before the read head would clear it, so copy everything out before clearing
+	StereoSample* readPos = wrap(current_ + 1);
+	size_t firstPart = std::min<size_t>(numSamples, end_ - readPos);
+	memcpy(output.data(), readPos, firstPart * sizeof(StereoSample));
+	memcpy(output.data() + firstPart, start_, (numSamples - firstPart) * sizeof(StereoSample));
+
+	return clearAndMoveOnBlock(numSamples);
+}
+
+bool DelayBuffer::readResampledBlock(std::span<StereoSample> output) {
+	bool wrapped = false;
+	auto sample = output.begin();
+
+#if defined(__arm__)
+	// The read positions don't advance by a fixed amount, so gather the samples either side of four of them at a
+	// time, then do the interpolation for all four at once
+	std::array<StereoSample, 4> from1;
+	std::array<StereoSample, 4> from2;
+	std::array<int32_t, 4> strength2;
+
+	for (; output.end() - sample >= 4; sample += 4) {
+		for (size_t i = 0; i < 4; i++) {
+			strength2[i] = advance([&] {
+				wrapped = clearAndMoveOn() || wrapped; //<
+			});
+			from1[i] = *current_;
+			from2[i] = *wrap(current_ + 1);
+		}
+
+		int32x4_t strength2Vector = vshlq_n_s32(vld1q_s32(strength2.data()), 14);
+		int32x4_t strength1Vector = vsubq_s32(vdupq_n_s32(65536 << 14), strength2Vector);
+
+		int32x4x2_t fromDelay1 = vld2q_s32(&from1[0].l); // De-interleaves into l and r
+		int32x4x2_t fromDelay2 = vld2q_s32(&from2[0].l);
+
+		// vqdmulh gives the product >> 31, so halve it again to get exactly what multiply_32x32_rshift32() gives in the
+		// leftovers loop below. The strengths are at most 1 << 30, so vqdmulh never saturates
+		int32x4x2_t result;
+		for (size_t c = 0; c < 2; c++) {
+			result.val[c] = vshlq_n_s32(vaddq_s32(vshrq_n_s32(vqdmulhq_s32(fromDelay1.val[c], strength1Vector), 1),
+			                                      vshrq_n_s32(vqdmulhq_s32(fromDelay2.val[c], strength2Vector), 1)),
+			                            2);
+		}
+		vst2q_s32(&sample->l, result);
+	}
+#endif
+
+	// Any leftovers
+	for (; sample != output.end(); ++sample) {
+		int32_t primaryStrength2 = advance([&] {
+			wrapped = clearAndMoveOn() || wrapped; //<
+		});
+		int32_t primaryStrength1 = 65536 - primaryStrength2;
+
+		StereoSample fromDelay1 = *current_;
+		StereoSample fromDelay2 = *wrap(current_ + 1);
+
+		sample->l = (multiply_32x32_rshift32(fromDelay1.l, primaryStrength1 << 14)
+		             + multiply_32x32_rshift32(fromDelay2.l, primaryStrength2 << 14))
+		            << 2;
+		sample->r = (multiply_32x32_rshift32(fromDelay1.r, primaryStrength1 << 14)
+		             + multiply_32x32_rshift32(fromDelay2.r, primaryStrength2 << 14))
+		            << 2;
+	}
+
+	return wrapped;
+}
+
+bool DelayBuffer::clearAndWriteNativeBlock(std::span<const StereoSample> input) {
+	size_t numSamples = input.size();
+
+	if (numSamples + delaySpaceBetweenReadAndWrite >= sizeIncludingExtra) {
+		bool wrapped = false;
+		for (StereoSample sample : input) {
+			wrapped = clearAndMoveOn() || wrapped;
+			writeNative(sample);
+		}
+		return wrapped;
+	}
+
+	// Where writeNative() will write after the first moveOn(). Everything gets cleared at least
+	// delaySpaceBetweenReadAndWrite samples before it's written to, so clear the lot first
+	StereoSample* writePos = current_ + 1 - delaySpaceBetweenReadAndWrite;
+	if (writePos < start_) {
+		writePos += sizeIncludingExtra;
+	}
+
+	bool wrapped = clearAndMoveOnBlock(numSamples);
+	writeNativeBlock(writePos, input);
+	return wrapped;
+}
+
+void DelayBuffer::writeNativeBlock(StereoSample* writePos, std::span<const StereoSample> input) {
+	// Usually at most two spans, but tiny buffers can wrap more than once per block
+	while (!input.empty()) {
+		size_t numThisTime = std::min<size_t>(input.size(), end_ - writePos);
+		memcpy(writePos, input.data(), numThisTime * sizeof(StereoSample));
+		input = input.subspan(numThisTime);
+		writePos = start_;
+	}
+}
+
+bool DelayBuffer::slipTowardsRate(uint32_t rate) {
+	auto [targetSize, clamped] = getIdealBufferSizeFromRate(rate);
+	int32_t sizeDifference = targetSize - (int32_t)size_;
+	size_t extraSpace = sizeIncludingExtra - size_;
+
+	if (clamped || targetSize + extraSpace > capacity_ || std::abs(sizeDifference) > (size_ >> kSlipRangeMagnitude)) {
+		return false;
+	}
+
+	if (sizeDifference != 0) {
+		// The frame that gets repeated or dropped is the last one in the buffer, so both heads need to be clear of it:
+		// the write head mustn't have wrapped around behind the read head, and the read head mustn't be about to read
+		// it. If they're not, we'll just try again next time.
+		ptrdiff_t readIndex = current_ - start_;
+		if (readIndex >= delaySpaceBetweenReadAndWrite && readIndex + 2 < (ptrdiff_t)sizeIncludingExtra) {
+			if (sizeDifference > 0) {
+				*end_ = *(end_ - 1);
+				end_++;
+				size_++;
+				sizeIncludingExtra++;
+			}
+			else {
+				end_--;
+				size_--;
+				sizeIncludingExtra--;
+			}
+			makeNativeRatePrecise();
+		}
+	}
+
+	if ((int32_t)size_ == targetSize) {
+		native_rate_ = rate;
+	}
+	return true;
+}
@@ -22,6 +22,7 @@
 #include <cstdint>
 #include <expected>
 #include <optional>
+#include <span>
 
 class StereoSample;
 
@@ -32,10 +33,13 @@ public:
 	constexpr static size_t kMaxSize = 88200;
 	constexpr static size_t kMinSize = 1;
 	constexpr static size_t kNeutralSize = 16384;
+	// How far (as a right-shift of the size) a buffer may grow or shrink by slipping, rather than resampling
+	constexpr static size_t kSlipRangeMagnitude = 3;
 
 	DelayBuffer() = default;
 	~DelayBuffer() { discard(); }
-	Error init(uint32_t newRate, uint32_t failIfThisSize = 0, bool includeExtraSpace = true);
+	Error init(uint32_t newRate, uint32_t failIfThisSize = 0, bool includeExtraSpace = true,
+	           bool allowSlipping = false);
 
 	// Prevent the delaybuffer from deallocing the Sample array on destruction
 	// TODO (Kate): investigate a shared_ptr for start_
@@ -75,6 +79,27 @@ public:
 
 	void setupForRender(int32_t rate);
 
+	// Block-oriented versions of the per-sample read / write helpers below. Each one gives bit-for-bit the same result
+	// as calling its per-sample counterpart once for every sample, but works on (at most two) contiguous spans of the
+	// buffer. They return whether the read head wrapped, like moveOn() does.
+
+	/// Equivalent to clearAndMoveOn() then current(), for each sample of output
+	bool readNativeBlock(std::span<StereoSample> output);
+	/// Equivalent to advance() with clearAndMoveOn(), then a linear interpolation between current() and the sample
+	/// after it, weighted by multiply_32x32_rshift32() with the strengths << 14 and the sum << 2, for each sample of
+	/// output
+	bool readResampledBlock(std::span<StereoSample> output);
+	/// Equivalent to clearAndMoveOn() then writeNative(), for each sample of input
+	bool clearAndWriteNativeBlock(std::span<const StereoSample> input);
+	/// Equivalent to writeNativeAndMoveOn(), for each sample of input
+	void writeNativeBlock(StereoSample* writePos, std::span<const StereoSample> input);
+
+	/// For tempo-synced delays: instead of resampling to a new rate, lengthen or shorten the buffer by a single
+	/// frame (repeating or dropping one sample) per call until its size matches the rate. Only possible for small
+	/// changes which still fit in the memory allocated with allowSlipping. Returns false if the new rate is too far
+	/// away for this, in which case the caller should fall back to resampling.
+	bool slipTowardsRate(uint32_t rate);
+
 	static std::pair<int32_t, bool> getIdealBufferSizeFromRate(uint32_t rate);
 
 	[[nodiscard]] constexpr bool isActive() const { return (start_ != nullptr); }
@@ -295,6 +320,10 @@ private:
 	};
 
 	void setupResample();
+	bool clearAndMoveOnBlock(size_t numSamples);
+	[[nodiscard]] constexpr StereoSample* wrap(StereoSample* pos) const {
+		return (pos >= end_) ? pos - sizeIncludingExtra : pos;
+	}
 
 	uint32_t native_rate_ = 0;
 
@@ -304,6 +333,9 @@ private:
 
 	size_t size_;
 
+	// Number of samples actually allocated, which may exceed sizeIncludingExtra if slipping is allowed
+	size_t capacity_;
+
 public:
 	std::optional<ResampleConfig> resample_config_{};
 };
@@ -0,0 +1,104 @@
+/*
+ * Copyright © 2025 Synthstrom Audible Limited
+ *
+ * This file is part of The Synthstrom Audible Deluge Firmware.
+ *
+ * The Synthstrom Audible Deluge Firmware is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program.
+ * If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "dsp/timestretch/hop_search.h"
+#include "util/misc.h"
+#include <algorithm>
+#include <cstdlib>
+
+#if defined(__arm__)
+#include "arm_neon_shim.h"
+#endif
+
+namespace deluge::dsp::timestretch {
+
+uint32_t sumAbsDifference(const int16_t* a, const int16_t* b, size_t length) {
+	size_t i = 0;
+	uint32_t total = 0;
+
+#if defined(__arm__)
+	// Each lane of the accumulator takes two differences of at most 65535 per pass, so this won't overflow until
+	// windows get longer than about 65000 samples
+	uint32x4_t accumulator = vdupq_n_u32(0);
+	for (; i + 8 <= length; i += 8) {
+		uint16x8_t difference = vreinterpretq_u16_s16(vabdq_s16(vld1q_s16(&a[i]), vld1q_s16(&b[i])));
+		accumulator = vpadalq_u16(accumulator, difference);
+	}
+	uint64x2_t pairs = vpaddlq_u32(accumulator);
+	total = vgetq_lane_u64(pairs, 0) + vgetq_lane_u64(pairs, 1);
+#endif
+
+	for (; i < length; i++) {
+		total += std::abs(a[i] - b[i]);
+	}
+	return total;
+}
+
+HopSearchResult findBestOffset(std::span<const int16_t> reference, std::span<const int16_t> candidates,
+                               int32_t maxOffset, int32_t coarseStep) {
+	const size_t length = reference.size();
+	auto differenceAt = [&](int32_t offset) {
+		return sumAbsDifference(reference.data(), &candidates[maxOffset + offset], length);
+	};
+
+	coarseStep = std::max(coarseStep, 1_i32);
+
+	// Start at zero so that, all else being equal, we stay where the hop length search put us
+	int32_t bestOffset = 0;
+	uint32_t bestDifference = differenceAt(0);
+
+	for (int32_t offset = coarseStep; offset <= maxOffset; offset += coarseStep) {
+		for (int32_t signedOffset : {offset, -offset}) {
+			uint32_t difference = differenceAt(signedOffset);
+			if (difference < bestDifference) {
+				bestDifference = difference;
+				bestOffset = signedOffset;
+			}
+		}
+	}
+
+	// Refine around the coarse result
+	int32_t coarseBest = bestOffset;
+	int32_t refineFrom = std::max(coarseBest - coarseStep + 1, -maxOffset);
+	int32_t refineTo = std::min(coarseBest + coarseStep - 1, maxOffset);
+	for (int32_t offset = refineFrom; offset <= refineTo; offset++) {
+		if (offset == coarseBest) {
+			continue;
+		}
+		uint32_t difference = differenceAt(offset);
+		if (difference < bestDifference) {
+			bestDifference = difference;
+			bestOffset = offset;
+		}
+	}
+
+	// Fit a parabola through the best lag and its neighbours to get closer than one sample
+	int32_t fraction = 0;
+	if (bestOffset > -maxOffset && bestOffset < maxOffset) {
+		int64_t before = differenceAt(bestOffset - 1);
+		int64_t after = differenceAt(bestOffset + 1);
+		int64_t curvature = before + after - 2 * (int64_t)bestDifference;
+		if (curvature > 0) {
+			fraction = ((before - after) << 23) / curvature;
+			fraction = std::clamp(fraction, -(1_i32 << 23), 1_i32 << 23);
+		}
+	}
+
+	return {bestOffset, fraction};
+}
+
+} // namespace deluge::dsp::timestretch
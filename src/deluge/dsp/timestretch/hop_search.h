@@ -0,0 +1,48 @@
+/*
+ * Copyright © 2025 Synthstrom Audible Limited
+ *
+ * This file is part of The Synthstrom Audible Deluge Firmware.
+ *
+ * The Synthstrom Audible Deluge Firmware is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program.
+ * If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+/// Waveform matching used by TimeStretcher to line up the two play-heads of a crossfade. Works on mono 16-bit
+/// windows that the caller has already gathered from the sample, so it has no idea about clusters or byte depths.
+namespace deluge::dsp::timestretch {
+
+/// Sum of absolute differences between a and b over length samples - the average magnitude difference function
+/// (AMDF) at a single lag, without the division since every lag we compare uses the same length.
+uint32_t sumAbsDifference(const int16_t* a, const int16_t* b, size_t length);
+
+struct HopSearchResult {
+	/// Lag of the best match, in samples, from -maxOffset to maxOffset
+	int32_t offset;
+	/// Fractional correction to offset from fitting a parabola through the neighbouring lags, in 8.24 fixed point
+	/// from -0.5 to 0.5 (i.e. -(1 << 23) to (1 << 23))
+	int32_t fraction;
+};
+
+/// Find where in candidates the waveform best lines up with reference, using the AMDF.
+///
+/// candidates must hold reference.size() + 2 * maxOffset samples, with lag zero starting at candidates[maxOffset].
+/// Lags are first tried every coarseStep samples across the whole range, then every sample either side of the best
+/// coarse match.
+HopSearchResult findBestOffset(std::span<const int16_t> reference, std::span<const int16_t> candidates,
+                               int32_t maxOffset, int32_t coarseStep = 2);
+
+} // namespace deluge::dsp::timestretch
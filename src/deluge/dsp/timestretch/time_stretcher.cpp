@@ -17,6 +17,7 @@
 
 #include "dsp/timestretch/time_stretcher.h"
 #include "definitions_cxx.hpp"
+#include "dsp/timestretch/hop_search.h"
 #include "deluge/model/sample/sample_low_level_reader.h"
 #include "io/debug/log.h"
 #include "memory/memory_allocator_interface.h"
@@ -24,6 +25,7 @@
 #include "model/sample/sample_cache.h"
 #include "model/sample/sample_holder.h"
 #include "model/sample/sample_playback_guide.h"
+#include "model/settings/runtime_feature_settings.h"
 #include "model/voice/voice_sample.h"
 #include "playback/playback_handler.h"
 #include "processing/engines/audio_engine.h"
@@ -238,6 +240,85 @@ const int16_t lookaheadFine[] = {
 };
 */
 
+// When a hop last ran at better than the fast tier in automatic mode, and whether one ever has
+static uint32_t timeLastAutoHopAboveFast = 0;
+static bool anyAutoHopAboveFast = false;
+
+// Picks the quality tier for the next hop. In automatic mode this steps down as the audio engine falls behind, so
+// time-stretched voices get cheaper before the engine has to resort to culling them
+static TimeStretch::Quality getQualityForHop() {
+	switch (static_cast<RuntimeFeatureStateTimeStretchQuality>(
+	    runtimeFeatureSettings.get(RuntimeFeatureSettingType::TimeStretchQuality))) {
+	case RuntimeFeatureStateTimeStretchQuality::Fast:
+		return TimeStretch::Quality::FAST;
+	case RuntimeFeatureStateTimeStretchQuality::High:
+		return TimeStretch::Quality::HIGH;
+	case RuntimeFeatureStateTimeStretchQuality::Auto:
+		if (AudioEngine::cpuDireness >= TimeStretch::kAutoQualityFastDireness) {
+			return TimeStretch::Quality::FAST;
+		}
+		timeLastAutoHopAboveFast = AudioEngine::audioSampleTimer;
+		anyAutoHopAboveFast = true;
+		if (AudioEngine::cpuDireness > 0) {
+			return TimeStretch::Quality::STANDARD;
+		}
+		return TimeStretch::Quality::HIGH;
+	default:
+		return TimeStretch::Quality::STANDARD;
+	}
+}
+
+bool TimeStretcher::autoQualityCanStillDrop() {
+	return anyAutoHopAboveFast
+	       && (int32_t)(AudioEngine::audioSampleTimer - timeLastAutoHopAboveFast) < (kSampleRate >> 3);
+}
+
+namespace {
+int16_t hopSearchReference[TimeStretch::Crossfade::kCorrelationWindowLength];
+int16_t hopSearchCandidates[TimeStretch::Crossfade::kCorrelationWindowLength
+                            + 2 * TimeStretch::Crossfade::kMaxCorrelationOffset];
+} // namespace
+
+// Gathers numSamples of the waveform as mono 16-bit for the AMDF search, starting at startByte and going in
+// playDirection. Returns false if that would run off the waveform or into a Cluster that isn't loaded
+static bool readMonoForHopSearch(Sample* sample, int32_t startByte, int32_t numSamples, int32_t numChannels,
+                                 int32_t playDirection, int16_t* output) {
+	int32_t byteDepth = sample->byteDepth;
+	int32_t bytesPerSample = byteDepth * numChannels;
+	int32_t bytesPerSampleTimesPlayDirection = bytesPerSample * playDirection;
+
+	int32_t endByte = startByte + (numSamples - 1) * bytesPerSampleTimesPlayDirection;
+	if (std::min(startByte, endByte) < (int32_t)sample->audioDataStartPosBytes
+	    || std::max(startByte, endByte) + bytesPerSample
+	           > (int32_t)(sample->audioDataStartPosBytes + sample->audioDataLengthBytes)) {
+		return false;
+	}
+
+	int32_t byte = startByte;
+	int32_t currentClusterIndex = -1;
+	Cluster* cluster = nullptr;
+	for (int32_t i = 0; i < numSamples; i++) {
+		int32_t whichCluster = byte >> Cluster::size_magnitude;
+		if (whichCluster != currentClusterIndex) {
+			cluster = sample->clusters.getElement(whichCluster)->cluster;
+			if (!cluster || !cluster->loaded) {
+				return false;
+			}
+			currentClusterIndex = whichCluster;
+		}
+
+		char const* pos = &cluster->data[byte & (Cluster::size - 1)] - 4 + byteDepth;
+		int32_t value = *(int32_t*)pos >> 16;
+		if (numChannels == 2) {
+			value = (value + (*(int32_t*)(pos + byteDepth) >> 16)) >> 1;
+		}
+		output[i] = value;
+
+		byte += bytesPerSampleTimesPlayDirection;
+	}
+	return true;
+}
+
 // Returns false if sound needs to cut due to a load error or similar
 bool TimeStretcher::hopEnd(SamplePlaybackGuide* guide, VoiceSample* voiceSample, Sample* sample, int32_t numChannels,
                            int32_t timeStretchRatio, int32_t phaseIncrement, uint64_t combinedIncrement,
@@ -277,6 +358,9 @@ bool TimeStretcher::hopEnd(SamplePlaybackGuide* guide, VoiceSample* voiceSample,
 
 	int32_t oldHeadBytePos;
 
+	TimeStretch::Quality quality = getQualityForHop();
+	bool searchedByAMDF = false;
+
 	// D_PRINTLN("");
 	// D_PRINTLN("hopEnd ------");
 
@@ -486,9 +570,13 @@ bool TimeStretcher::hopEnd(SamplePlaybackGuide* guide, VoiceSample* voiceSample,
 
 		int32_t beamPosAtTop = samplePos >> kPercBufferReductionMagnitude; // Pixellated
 
+		// The cheap tier skips the percussiveness search and just sticks with the middle of the range
 		int32_t earliestPixellatedPos, latestPixellatedPos;
-		uint8_t* percCache =
-		    sample->prepareToReadPercCache(beamPosAtTop, playDirection, &earliestPixellatedPos, &latestPixellatedPos);
+		uint8_t* percCache = nullptr;
+		if (quality != TimeStretch::Quality::FAST) {
+			percCache = sample->prepareToReadPercCache(beamPosAtTop, playDirection, &earliestPixellatedPos,
+			                                           &latestPixellatedPos);
+		}
 
 		if (percCache) {
 
@@ -609,7 +697,58 @@ skipPercStuff:
 	// Search for minimum phase disruption on crossfade. Crucially, the exact instant in time we're going to be
 	// examining is not the beginning play-point of the new play-head, but the point half-way through the crossfade
 	// later. Remember that!
-	if (playHeadStillActive[PLAY_HEAD_OLDER]) { // Added condition, Aug 2019. Surely this makes sense...
+	if (playHeadStillActive[PLAY_HEAD_OLDER] && quality == TimeStretch::Quality::HIGH
+	    && oldHeadBytePos >= (int32_t)sample->audioDataStartPosBytes) {
+		constexpr int32_t windowLength = TimeStretch::Crossfade::kCorrelationWindowLength;
+
+		int32_t crossfadeLengthSamplesSource = ((uint64_t)crossfadeLengthSamples * phaseIncrement) >> 24;
+
+		int32_t maxSearchSize = (samplesTilHopEnd * 40) >> 8; // Same range as the moving average search below
+		maxSearchSize = ((uint64_t)maxSearchSize * phaseIncrement) >> 24;
+		maxSearchSize = std::min({maxSearchSize, (int32_t)(sample->sampleRate / 30) >> 1,
+		                          TimeStretch::Crossfade::kMaxCorrelationOffset});
+
+		// Both windows are centred on the middle of the crossfade
+		int32_t bytesToWindowStart =
+		    ((crossfadeLengthSamplesSource >> 1) - (windowLength >> 1)) * bytesPerSample * playDirection;
+
+		if (readMonoForHopSearch(sample, oldHeadBytePos + bytesToWindowStart, windowLength, numChannels,
+		                         playDirection, hopSearchReference)
+		    && readMonoForHopSearch(sample,
+		                            newHeadBytePos + bytesToWindowStart - maxSearchSize * bytesPerSample * playDirection,
+		                            windowLength + 2 * maxSearchSize, numChannels, playDirection,
+		                            hopSearchCandidates)) {
+
+			deluge::dsp::timestretch::HopSearchResult result = deluge::dsp::timestretch::findBestOffset(
+			    {hopSearchReference, windowLength}, {hopSearchCandidates, (size_t)(windowLength + 2 * maxSearchSize)},
+			    maxSearchSize);
+
+			int32_t offset = result.offset;
+			if (phaseIncrement != kMaxSampleValue) {
+				// As below, additionalOscPos is a fraction of a sample forwards from the new head's position
+				int32_t fraction = result.fraction;
+				if (fraction < 0) {
+					fraction += kMaxSampleValue;
+					offset--;
+				}
+				additionalOscPos = fraction + olderPartReader.oscPos;
+				if (additionalOscPos >= kMaxSampleValue) {
+					additionalOscPos -= kMaxSampleValue;
+					offset++;
+				}
+			}
+
+			newHeadBytePos += offset * bytesPerSample * playDirection;
+			if ((newHeadBytePos - waveformStartByte) * playDirection < 0) {
+				newHeadBytePos = waveformStartByte;
+			}
+			searchedByAMDF = true;
+		}
+	}
+
+	// Otherwise, or if we couldn't read what the AMDF search needed, use the moving averages
+	if (!searchedByAMDF
+	    && playHeadStillActive[PLAY_HEAD_OLDER]) { // Added condition, Aug 2019. Surely this makes sense...
 		int32_t lengthToAverageEach = ((uint64_t)phaseIncrement * TimeStretch::Crossfade::kMovingAverageLength) >> 24;
 		lengthToAverageEach = std::clamp(lengthToAverageEach, 1_i32,
 		                                 TimeStretch::Crossfade::kMovingAverageLength * 2); // Keep things sensible
@@ -665,15 +804,27 @@ skipPercStuff:
 		maxSearchSize = 441;
 #endif
 
-		// Allow tracking down to around 45Hz, at input. We >>1 again because this limit is just
-		// for searching in one direction, and we're going to do both directions.
-		int32_t limit = (sample->sampleRate / 45) >> 1;
+		// Allow tracking down to around 45Hz, at input (30Hz for the high quality tier). We >>1 again because this limit
+		// is just for searching in one direction, and we're going to do both directions.
+		int32_t limit = (sample->sampleRate / ((quality == TimeStretch::Quality::HIGH) ? 30 : 45)) >> 1;
 		maxSearchSize = std::min(maxSearchSize, limit);
+		if (quality == TimeStretch::Quality::FAST) {
+			maxSearchSize >>= 1;
+		}
 		//		D_PRINTLN("max search length:  %d", maxSearchSize);
 
 		int32_t numFullDirectionsSearched = 0;
 		int32_t timesSignFlipped = 0;
 
+		// The high quality tier never stops early, and always ends up with the best match over the whole range
+		int32_t maxTimesSignFlipped = 4;
+		if (quality == TimeStretch::Quality::FAST) {
+			maxTimesSignFlipped = 2;
+		}
+		else if (quality == TimeStretch::Quality::HIGH) {
+			maxTimesSignFlipped = 2147483647;
+		}
+
 		// Do the search. We'll come back again to search in the other direction too. Or we may come back sooner if we
 		// quickly decide that the other search direction would be better
 
@@ -826,7 +977,7 @@ entryPoint:
 					// of bad alignments - I did tests. But 4 sounds basically as good as no limit.
 					timesSignFlipped++;
 #if !MEASURE_HOP_END_PERFORMANCE
-					if (timesSignFlipped >= 4) {
+					if (timesSignFlipped >= maxTimesSignFlipped) {
 						goto stopSearch;
 					}
 #endif
@@ -50,6 +50,10 @@ public:
 	            int32_t timeStretchRatio, int32_t phaseIncrement, uint64_t combinedIncrement, int32_t playDirection,
 	            LoopType loopingType, int32_t priorityRating);
 
+	/// Whether, in the automatic quality mode, voices have recently been stretching at better than the fast tier, so
+	/// dropping them to it could still save some time. The audio engine holds off soft culling while this is true.
+	static bool autoQualityCanStillDrop();
+
 	void rememberPercCacheCluster(Cluster* cluster);
 	void updateClustersForPercLookahead(Sample* sample, uint32_t sourceBytePos, int32_t playDirection);
 
@@ -0,0 +1,122 @@
+/*
+ * Copyright © 2025 Synthstrom Audible Limited
+ *
+ * This file is part of The Synthstrom Audible Deluge Firmware.
+ *
+ * The Synthstrom Audible Deluge Firmware is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program.
+ * If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "OSLikeStuff/scheduler_api.h"
+#include "definitions_cxx.hpp"
+#include <array>
+
+/// How registerTasks() schedules one of the firmware's repeating tasks - see addRepeatingTask()
+struct FirmwareTask {
+	const char* name;
+	/// lower = more important
+	uint8_t priority;
+	double backOffTime;
+	double targetTimeBetweenCalls;
+	double maxTimeBetweenCalls;
+	ResourceID resources;
+	/// passed to setMaxLatencyForTask(), if set
+	double maxLatency{0};
+};
+
+/// The firmware's repeating tasks. Kept apart from the functions they run, so the task scheduler simulator
+/// (tests/unit/scheduler_simulator.cpp) can run the same task set as registerTasks().
+namespace FirmwareTasks {
+
+enum Index : uint8_t {
+	AUDIO_ROUTINE,
+	CHECK_USB_MIDI,
+	INTERPRET_ENCODERS,
+	PLAYBACK_ROUTINE,
+	MIDI_ROUTINE,
+	LOAD_CLUSTERS,
+	AUDIO_SLOW,
+	BUTTONS_AND_PADS,
+	PENDING_UI,
+	PENDING_SYSEX,
+	AUDIO_FILE_SLOW,
+	AUDIO_RECORDER_SLOW,
+	PLAYBACK_SLOW_ROUTINE,
+	PIC_FLUSH,
+	OLED_ROUTINE,
+	UI_ROUTINE,
+	kNumTasks,
+};
+
+/// How many samples the audio routine renders at a time, for each AudioLatencyTier. 0 means it varies
+constexpr std::array<size_t, kNumAudioLatencyTiers> kRenderBlockSizes{0, 32, 64, 128};
+
+/// The audio routine's scheduling for a latency tier. Each block has to be rendered in the time it takes the one
+/// before it to play, so the routine has to be back within a block - and in AUTO, it can have rendered up to a whole
+/// output buffer ahead. The rest of the output buffer has to last while the render happens.
+constexpr FirmwareTask audioRoutine(AudioLatencyTier tier) {
+	size_t blockSize = kRenderBlockSizes[util::to_underlying(tier)];
+	double window = double(blockSize ? blockSize : SSI_TX_BUFFER_NUM_SAMPLES) / kSampleRate;
+	return {"audio  routine", 0, 8. / kSampleRate, window / 2, window, RESOURCE_NONE, window / 4};
+}
+
+// Priorities: 0-9 high, 11-19 medium, 21-29 low, 31-39 idle. The gaps at 10, 20, 30 and 40 are for dynamic tasks.
+constexpr std::array<FirmwareTask, kNumTasks> kTasks{{
+    audioRoutine(AudioLatencyTier::AUTO),
+    {"check usb midi", 1, 0.0005, 0.0005, 0.001, RESOURCE_USB},
+    // this will block itself unless an encoder is actually moved so can have a fast rate
+    {"interpret encoders fast", 2, 0.001, 0.001, 0.002, RESOURCE_NONE},
+    // formerly part of audio routine, updates midi and clock
+    {"playback routine", 3, 0.0005, 0.001, 0.002, RESOURCE_NONE, 0.0005},
+    {"midi routine", 4, 0.0005, 0.001, 0.002, RESOURCE_SD | RESOURCE_USB},
+    {"load clusters", 5, 0.0001, 0.0001, 0.0002, RESOURCE_NONE},
+    // handles sd card recorders
+    // named "slow" but isn't actually, it handles audio recording setup
+    {"audio slow", 6, 0.001, 0.005, 0.05, RESOURCE_NONE},
+    {"buttons and pads", 7, 0.005, 0.005, 0.01, RESOURCE_NONE},
+
+    // 30 Hz update desired?
+    {"pending UI", 11, 0.01, 0.01, 0.03, RESOURCE_NONE},
+    // Check for and handle queued SysEx traffic
+    {"Handle pending SysEx traffic.", 12, 0.0002, 0.0002, 0.01, RESOURCE_SD},
+
+    // these ones are actually "slow" -> file manager just checks if an sd card has been inserted, audio recorder
+    // checks if recordings are finished
+    {"audio file slow", 21, 0.1, 0.1, 0.2, RESOURCE_SD},
+    // Needs the SD resources: it can call finishRecording(), which frees the SampleRecorder, and that must not happen
+    // while the card routine is part-way through using it.
+    {"audio recorder slow", 22, 0.01, 0.09, 0.1, RESOURCE_SD | RESOURCE_SD_ROUTINE},
+    // formerly part of cluster loading (why? no idea), actions undo/redo midi commands
+    {"playback slow routine", 23, 0.01, 0.09, 0.1, RESOURCE_SD},
+
+    {"PIC flush", 31, 0.001, 0.001, 0.02, RESOURCE_NONE},
+    // only registered with an OLED screen
+    {"oled routine", 32, 0.01, 0.01, 0.02, RESOURCE_NONE},
+    // needs to be called very frequently,
+    // handles animations and checks on the timers for any infrequent actions
+    // long term this should probably be made into an idle task
+    {"ui routine", 33, 0.0001, 0.0007, 0.01, RESOURCE_NONE},
+}};
+
+/// Register the task at index to run handle. @returns its ID
+inline TaskID add(Index index, TaskHandle handle) {
+	FirmwareTask const& task = kTasks[index];
+	TaskID id = addRepeatingTask(handle, task.priority, task.backOffTime, task.targetTimeBetweenCalls,
+	                             task.maxTimeBetweenCalls, task.name, task.resources);
+	if (task.maxLatency) {
+		setMaxLatencyForTask(id, task.maxLatency);
+	}
+	return id;
+}
+
+} // namespace FirmwareTasks
@@ -439,6 +439,7 @@ PLACE_SDRAM_DATA Language english{
         {STRING_FOR_BATTERY_LEVEL, "Battery level"},
         {STRING_FOR_COMMUNITY_FTS, "Community features"},
         {STRING_FOR_MIDI_THRU, "MIDI-thru"},
+        {STRING_FOR_INPUT_LATENCY, "Input latency"},
         {STRING_FOR_TAKEOVER, "TAKEOVER"},
         {STRING_FOR_RECORD, "Record"},
         {STRING_FOR_COMMANDS, "Commands"},
@@ -544,6 +545,14 @@ PLACE_SDRAM_DATA Language english{
         {STRING_FOR_COMMUNITY_FEATURE_TRIM_FROM_START_OF_AUDIO_CLIP, "Trim From Start Of Audio Clips"},
         {STRING_FOR_COMMUNITY_FEATURE_SHOW_BATTERY_LEVEL, "Show Battery Level"},
         {STRING_FOR_COMMUNITY_FEATURE_ROUNDED_CORNERS, "Rounded Corners"},
+        {STRING_FOR_COMMUNITY_FEATURE_SYNCED_DELAY_WITHOUT_RESAMPLING, "Synced Delay Slip"},
+        {STRING_FOR_COMMUNITY_FEATURE_TIME_STRETCH_QUALITY, "Time Stretch Quality"},
+        {STRING_FOR_COMMUNITY_FEATURE_PERSIST_SAMPLE_CACHES, "Save Stretch Cache"},
+        {STRING_FOR_COMMUNITY_FEATURE_BINARY_SONG_FILES, "Binary Song Files"},
+        {STRING_FOR_COMMUNITY_FEATURE_PRELOAD_NEXT_SONG, "Preload Next Song"},
+        {STRING_FOR_COMMUNITY_FEATURE_SET_LIST, "Set List"},
+        {STRING_FOR_NEXT_SONG_WONT_FIT, "Next song won't fit in RAM"},
+        {STRING_FOR_COMMUNITY_FEATURE_UNDO_MEMORY_LIMIT, "Undo Memory Limit"},
         {STRING_FOR_TRACK_STILL_HAS_CLIPS_IN_SESSION, "Track still has clips in session"},
         {STRING_FOR_DELETE_ALL_TRACKS_CLIPS_FIRST, "Delete all track's clips first"},
         {STRING_FOR_CANT_DELETE_FINAL_CLIP, "Can't delete final Clip"},
@@ -668,6 +677,10 @@ PLACE_SDRAM_DATA Language english{
         {STRING_FOR_BLEND, "Blend"},
         {STRING_FOR_ATTACK, "ATTACK"},
         {STRING_FOR_ATTACK_SHORT, "ATK"},
+        {STRING_FOR_LOOKAHEAD, "Lookahead"},
+        {STRING_FOR_MULTIBAND, "Multiband"},
+        {STRING_FOR_SIDECHAIN_KEY, "Sidechain key"},
+        {STRING_FOR_SIDECHAIN_KEY_SHORT, "Key"},
         {STRING_FOR_FX, "FX"},
         {STRING_FOR_VOLTS_PER_OCTAVE, "Volts per octave"},
         {STRING_FOR_TRANSPOSE, "TRANSPOSE"},
@@ -945,6 +958,10 @@ PLACE_SDRAM_DATA Language english{
         {STRING_FOR_TRANSPOSE_CHORD, "Chord"},
         {STRING_FOR_CANT_ENTER_SCALE, "Can't enter scale mode, MIDI transpose is chromatic"},
         {STRING_FOR_DEFAULT_HIGH_CPU_USAGE_INDICATOR, "High CPU Indicator"},
+        {STRING_FOR_AUDIO_LATENCY, "Audio latency"},
+        {STRING_FOR_32_SAMPLES, "32 samples"},
+        {STRING_FOR_64_SAMPLES, "64 samples"},
+        {STRING_FOR_128_SAMPLES, "128 samples"},
         {STRING_FOR_HOLD_TIME, "Hold Press Time"},
         {STRING_FOR_EXPORT_AUDIO, "Export Audio"},
         {STRING_FOR_START_EXPORT, "Start Export"},
@@ -335,6 +335,7 @@ PLACE_SDRAM_DATA Language seven_segment{
         {STRING_FOR_BATTERY_LEVEL, "BATT"},
         {STRING_FOR_COMMUNITY_FTS, "FEAT"},
         {STRING_FOR_MIDI_THRU, "THRU"},
+        {STRING_FOR_INPUT_LATENCY, "LATE"},
         {STRING_FOR_TAKEOVER, "TOVR"},
         {STRING_FOR_RECORD, "REC"},
         {STRING_FOR_COMMANDS, "CMD"},
@@ -438,6 +439,14 @@ PLACE_SDRAM_DATA Language seven_segment{
         {STRING_FOR_COMMUNITY_FEATURE_ALTERNATIVE_TAP_TEMPO_BEHAVIOUR, "TAPT"},
         {STRING_FOR_COMMUNITY_FEATURE_TRIM_FROM_START_OF_AUDIO_CLIP, "TRIM"},
         {STRING_FOR_COMMUNITY_FEATURE_SHOW_BATTERY_LEVEL, "BATT"},
+        {STRING_FOR_COMMUNITY_FEATURE_SYNCED_DELAY_WITHOUT_RESAMPLING, "SLIP"},
+        {STRING_FOR_COMMUNITY_FEATURE_TIME_STRETCH_QUALITY, "STRE"},
+        {STRING_FOR_COMMUNITY_FEATURE_PERSIST_SAMPLE_CACHES, "CACH"},
+        {STRING_FOR_COMMUNITY_FEATURE_BINARY_SONG_FILES, "BSNG"},
+        {STRING_FOR_COMMUNITY_FEATURE_PRELOAD_NEXT_SONG, "PREL"},
+        {STRING_FOR_COMMUNITY_FEATURE_SET_LIST, "SETL"},
+        {STRING_FOR_NEXT_SONG_WONT_FIT, "FULL"},
+        {STRING_FOR_COMMUNITY_FEATURE_UNDO_MEMORY_LIMIT, "UNDO"},
         {STRING_FOR_TRACK_STILL_HAS_CLIPS_IN_SESSION, "CANT"},
         {STRING_FOR_DELETE_ALL_TRACKS_CLIPS_FIRST, "CANT"},
         {STRING_FOR_CANT_DELETE_FINAL_CLIP, "CANT"},
@@ -501,6 +510,10 @@ PLACE_SDRAM_DATA Language seven_segment{
         {STRING_FOR_TRANSPOSE_CHORD, "CHRD"},
         {STRING_FOR_CANT_ENTER_SCALE, "CANT"},
         {STRING_FOR_DEFAULT_HIGH_CPU_USAGE_INDICATOR, "CPU"},
+        {STRING_FOR_AUDIO_LATENCY, "ALAT"},
+        {STRING_FOR_32_SAMPLES, "32"},
+        {STRING_FOR_64_SAMPLES, "64"},
+        {STRING_FOR_128_SAMPLES, "128"},
         {STRING_FOR_HOLD_TIME, "HOLD"},
         {STRING_FOR_EXPORT_AUDIO, "EXPO"},
         {STRING_FOR_START_EXPORT, "START"},
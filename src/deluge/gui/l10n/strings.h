@@ -463,6 +463,7 @@ enum class String : size_t {
 	STRING_FOR_BATTERY_LEVEL,
 	STRING_FOR_COMMUNITY_FTS,
 	STRING_FOR_MIDI_THRU,
+	STRING_FOR_INPUT_LATENCY,
 	STRING_FOR_TAKEOVER,
 	STRING_FOR_RECORD,
 	STRING_FOR_COMMANDS,
@@ -574,6 +575,14 @@ enum class String : size_t {
 	STRING_FOR_COMMUNITY_FEATURE_TRIM_FROM_START_OF_AUDIO_CLIP,
 	STRING_FOR_COMMUNITY_FEATURE_SHOW_BATTERY_LEVEL,
 	STRING_FOR_COMMUNITY_FEATURE_ROUNDED_CORNERS,
+	STRING_FOR_COMMUNITY_FEATURE_SYNCED_DELAY_WITHOUT_RESAMPLING,
+	STRING_FOR_COMMUNITY_FEATURE_TIME_STRETCH_QUALITY,
+	STRING_FOR_COMMUNITY_FEATURE_PERSIST_SAMPLE_CACHES,
+	STRING_FOR_COMMUNITY_FEATURE_BINARY_SONG_FILES,
+	STRING_FOR_COMMUNITY_FEATURE_PRELOAD_NEXT_SONG,
+	STRING_FOR_COMMUNITY_FEATURE_SET_LIST,
+	STRING_FOR_NEXT_SONG_WONT_FIT,
+	STRING_FOR_COMMUNITY_FEATURE_UNDO_MEMORY_LIMIT,
 	STRING_FOR_TRACK_STILL_HAS_CLIPS_IN_SESSION,
 	STRING_FOR_DELETE_ALL_TRACKS_CLIPS_FIRST,
 	STRING_FOR_CANT_DELETE_FINAL_CLIP,
@@ -722,6 +731,10 @@ enum class String : size_t {
 	STRING_FOR_RATIO,
 	STRING_FOR_ATTACK,
 	STRING_FOR_ATTACK_SHORT,
+	STRING_FOR_LOOKAHEAD,
+	STRING_FOR_MULTIBAND,
+	STRING_FOR_SIDECHAIN_KEY,
+	STRING_FOR_SIDECHAIN_KEY_SHORT,
 	STRING_FOR_FX,
 	STRING_FOR_VOLTS_PER_OCTAVE,
 	STRING_FOR_TRANSPOSE,
@@ -1046,6 +1059,10 @@ enum class String : size_t {
 
 	// string for high CPU usage indicator default setting
 	STRING_FOR_DEFAULT_HIGH_CPU_USAGE_INDICATOR,
+	STRING_FOR_AUDIO_LATENCY,
+	STRING_FOR_32_SAMPLES,
+	STRING_FOR_64_SAMPLES,
+	STRING_FOR_128_SAMPLES,
 
 	// string for configuring hold time for sticky shift / perf view / keyboard sidebars
 	STRING_FOR_HOLD_TIME,
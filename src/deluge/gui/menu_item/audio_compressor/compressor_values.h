@@ -3,7 +3,9 @@
 #include "dsp/compressor/rms_feedback.h"
 #include "gui/menu_item/decimal.h"
 #include "gui/menu_item/integer.h"
+#include "gui/menu_item/toggle.h"
 #include "gui/ui/sound_editor.h"
+#include "hid/display/display.h"
 #include "model/drum/drum.h"
 #include "model/instrument/kit.h"
 #include "model/mod_controllable/mod_controllable_audio.h"
@@ -123,4 +125,64 @@ public:
 	[[nodiscard]] int32_t getNumDecimalPlaces() const override { return 0; }
 	[[nodiscard]] int32_t getOccupiedSlots() const override { return 1; }
 };
+class Lookahead final : public CompressorValue {
+public:
+	using CompressorValue::CompressorValue;
+	uint64_t getCompressorValue() override {
+		return (uint64_t)soundEditor.currentModControllable->compressor.getLookahead();
+	}
+	void setCompressorValue(q31_t value, RMSFeedbackCompressor* compressor) override {
+		if (!compressor->setLookahead(value)) {
+			display->displayPopup(l10n::get(l10n::String::STRING_FOR_ERROR_INSUFFICIENT_RAM));
+		}
+	}
+	float getDisplayValue() override { return soundEditor.currentModControllable->compressor.getLookaheadMS(); }
+};
+
+class CompressorToggle : public Toggle {
+	using Toggle::Toggle;
+	void readCurrentValue() final { this->setValue(getCompressorValue(soundEditor.currentModControllable->compressor)); }
+	void writeCurrentValue() final {
+		bool value = this->getValue();
+
+		// If affect-entire button held, do whole kit
+		if (currentUIMode == UI_MODE_HOLDING_AFFECT_ENTIRE_IN_SOUND_EDITOR && soundEditor.editingKitRow()) {
+
+			Kit* kit = getCurrentKit();
+
+			for (Drum* thisDrum = kit->firstDrum; thisDrum != nullptr; thisDrum = thisDrum->next) {
+				if (thisDrum->type == DrumType::SOUND) {
+					auto* soundDrum = static_cast<SoundDrum*>(thisDrum);
+
+					setCompressorValue(value, &soundDrum->compressor);
+				}
+			}
+		}
+		// Or, the normal case of just one sound
+		else {
+			setCompressorValue(value, &soundEditor.currentModControllable->compressor);
+		}
+	}
+	virtual bool getCompressorValue(RMSFeedbackCompressor& compressor) = 0;
+	virtual void setCompressorValue(bool value, RMSFeedbackCompressor* compressor) = 0;
+};
+
+class Multiband final : public CompressorToggle {
+public:
+	using CompressorToggle::CompressorToggle;
+	bool getCompressorValue(RMSFeedbackCompressor& compressor) override { return compressor.isMultiband(); }
+	void setCompressorValue(bool value, RMSFeedbackCompressor* compressor) override { compressor->setMultiband(value); }
+};
+
+class SidechainKey final : public CompressorToggle {
+public:
+	using CompressorToggle::CompressorToggle;
+	bool getCompressorValue(RMSFeedbackCompressor& compressor) override { return compressor.isKeyedFromSidechain(); }
+	void setCompressorValue(bool value, RMSFeedbackCompressor* compressor) override {
+		compressor->setKeyedFromSidechain(value);
+	}
+	void getColumnLabel(StringBuf& label) override {
+		label.append(l10n::get(l10n::String::STRING_FOR_SIDECHAIN_KEY_SHORT));
+	}
+};
 } // namespace deluge::gui::menu_item::audio_compressor
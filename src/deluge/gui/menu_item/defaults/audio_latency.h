@@ -0,0 +1,40 @@
+/*
+ * Copyright (c) 2025 Synthstrom Audible Limited
+ *
+ * This file is part of The Synthstrom Audible Deluge Firmware.
+ *
+ * The Synthstrom Audible Deluge Firmware is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program.
+ * If not, see <https://www.gnu.org/licenses/>.
+ */
+#pragma once
+#include "definitions_cxx.hpp"
+#include "gui/l10n/l10n.h"
+#include "gui/l10n/strings.h"
+#include "gui/menu_item/selection.h"
+#include "processing/engines/audio_engine.h"
+
+namespace deluge::gui::menu_item::defaults {
+class AudioLatency final : public Selection {
+public:
+	using Selection::Selection;
+	void readCurrentValue() override { this->setValue(AudioEngine::latencyTier); }
+	void writeCurrentValue() override { AudioEngine::setLatencyTier(this->getValue<AudioLatencyTier>()); }
+	deluge::vector<std::string_view> getOptions(OptType optType) override {
+		(void)optType;
+		return {
+		    l10n::getView(l10n::String::STRING_FOR_AUTO),
+		    l10n::getView(l10n::String::STRING_FOR_32_SAMPLES),
+		    l10n::getView(l10n::String::STRING_FOR_64_SAMPLES),
+		    l10n::getView(l10n::String::STRING_FOR_128_SAMPLES),
+		};
+	}
+};
+} // namespace deluge::gui::menu_item::defaults
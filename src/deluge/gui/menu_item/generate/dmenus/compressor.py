@@ -49,11 +49,35 @@ blend = Menu(
     name="STRING_FOR_BLEND",
 )
 
+lookahead = Menu(
+    "audio_compressor::Lookahead",
+    "compLookahead",
+    ["{name}", "{title}"],
+    "compressor/lookahead.md",
+    name="STRING_FOR_LOOKAHEAD",
+)
+
+multiband = Menu(
+    "audio_compressor::Multiband",
+    "compMultiband",
+    ["{name}", "{title}"],
+    "compressor/multiband.md",
+    name="STRING_FOR_MULTIBAND",
+)
+
+sidechain_key = Menu(
+    "audio_compressor::SidechainKey",
+    "compSidechainKey",
+    ["{name}", "{title}"],
+    "compressor/sidechain_key.md",
+    name="STRING_FOR_SIDECHAIN_KEY",
+)
+
 menu = Submenu(
     "HorizontalMenu",
     "audioCompMenu",
     ["{name}", "%%CHILDREN%%"],
     "compressor/index.md",
-    [threshold, ratio, blend, attack, release, hpf],
+    [threshold, ratio, blend, attack, release, hpf, lookahead, multiband, sidechain_key],
     name="STRING_FOR_COMMUNITY_FEATURE_MASTER_COMPRESSOR",
 )
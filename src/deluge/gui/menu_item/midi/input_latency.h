@@ -0,0 +1,33 @@
+/*
+ * Copyright © 2025 Synthstrom Audible Limited
+ *
+ * This file is part of The Synthstrom Audible Deluge Firmware.
+ *
+ * The Synthstrom Audible Deluge Firmware is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program.
+ * If not, see <https://www.gnu.org/licenses/>.
+ */
+#pragma once
+#include "gui/menu_item/integer.h"
+#include "io/midi/midi_engine.h"
+
+namespace deluge::gui::menu_item::midi {
+
+/// @brief Sets how long after it arrives incoming MIDI gets played, in milliseconds, so that it all plays with the
+///        same delay no matter when in the audio render it came in. OFF plays it as soon as it's read.
+class InputLatency final : public IntegerWithOff {
+public:
+	using IntegerWithOff::IntegerWithOff;
+	void readCurrentValue() override { this->setValue(midiEngine.inputLatencyMS); }
+	void writeCurrentValue() override { midiEngine.inputLatencyMS = this->getValue(); }
+	[[nodiscard]] int32_t getMaxValue() const override { return kMaxMIDIInputLatencyMS; }
+	const char* getUnit() override { return " MS"; }
+};
+} // namespace deluge::gui::menu_item::midi
@@ -22,6 +22,7 @@
 #include "hid/display/oled_canvas/canvas.h"
 #include "setting.h"
 #include "shift_is_sticky.h"
+#include "storage/set_list.h"
 #include <array>
 
 extern deluge::gui::menu_item::runtime_feature::Setting runtimeFeatureSettingMenuItem;
@@ -48,6 +49,16 @@ public:
 	}
 };
 
+// The set list is read when it's turned on, rather than whenever it's first looked at - which could be mid song load
+class SetListSettingToggle final : public SettingToggle {
+public:
+	using SettingToggle::SettingToggle;
+	void writeCurrentValue() override {
+		SettingToggle::writeCurrentValue();
+		setList.readFromFile();
+	}
+};
+
 // Generic menu item instances
 SettingToggle menuDrumRandomizer(RuntimeFeatureSettingType::DrumRandomizer);
 SettingToggle menuFineTempo(RuntimeFeatureSettingType::FineTempoKnob);
@@ -73,6 +84,13 @@ OledOnlySettingToggle menuHorizontalMenus(RuntimeFeatureSettingType::HorizontalM
 SettingToggle menuTrimFromStartOfAudioClip(RuntimeFeatureSettingType::TrimFromStartOfAudioClip);
 SettingToggle menuShowBatteryLevel(RuntimeFeatureSettingType::ShowBatteryLevel);
 RoundedCornersSettingToggle menuRoundedCorners(RuntimeFeatureSettingType::RoundedCorners);
+SettingToggle menuSyncedDelayWithoutResampling(RuntimeFeatureSettingType::SyncedDelayWithoutResampling);
+Setting menuTimeStretchQuality(RuntimeFeatureSettingType::TimeStretchQuality);
+SettingToggle menuPersistSampleCaches(RuntimeFeatureSettingType::PersistSampleCaches);
+SettingToggle menuBinarySongFiles(RuntimeFeatureSettingType::BinarySongFiles);
+SettingToggle menuPreloadNextSong(RuntimeFeatureSettingType::PreloadNextSong);
+SetListSettingToggle menuSetList(RuntimeFeatureSettingType::SetListMode);
+Setting menuUndoMemoryLimit(RuntimeFeatureSettingType::UndoMemoryLimit);
 
 std::array<MenuItem*, RuntimeFeatureSettingType::MaxElement - kNonTopLevelSettings> subMenuEntries{
     &menuDrumRandomizer,
@@ -98,7 +116,14 @@ std::array<MenuItem*, RuntimeFeatureSettingType::MaxElement - kNonTopLevelSettin
     &menuHorizontalMenus,
     &menuRoundedCorners,
     &menuTrimFromStartOfAudioClip,
-    &menuShowBatteryLevel};
+    &menuShowBatteryLevel,
+    &menuSyncedDelayWithoutResampling,
+    &menuTimeStretchQuality,
+    &menuPersistSampleCaches,
+    &menuBinarySongFiles,
+    &menuPreloadNextSong,
+    &menuSetList,
+    &menuUndoMemoryLimit};
 
 Settings::Settings(l10n::String name, l10n::String title) : menu_item::Submenu(name, title, subMenuEntries) {
 }
@@ -65,6 +65,8 @@ int8_t Browser::numberEditPos;
 NumericLayerScrollingText* Browser::scrollingText;
 
 char const* allowedFileExtensionsXML[] = {"XML", "Json", NULL};
+// Songs may also be binary - see BinarySerializer. Presets are only ever XML
+char const* allowedFileExtensionsSong[] = {"XML", "Json", "DBIN", NULL};
 
 Browser::Browser() {
 	fileIcon = deluge::hid::display::OLED::songIcon;
@@ -128,15 +130,11 @@ void Browser::emptyFileItems() {
 
 	AudioEngine::logAction("emptyFileItems");
 
-	for (int32_t i = 0; i < fileItems.getNumElements();) {
+	AUDIO_BUDGETED_SECTION(section);
+	for (int32_t i = 0; i < fileItems.getNumElements(); i++) {
 		FileItem* item = (FileItem*)fileItems.getElementAddress(i);
 		item->~FileItem();
-
-		i++;
-		if (!(i & 63)) { //  &127 was even fine, even with only -Og compiler optimization.
-			AudioEngine::logAction("emptyFileItems in loop");
-			AudioEngine::routineWithClusterLoading();
-		}
+		section.check();
 	}
 
 	AudioEngine::logAction("emptyFileItems 2");
@@ -149,14 +147,11 @@ void Browser::emptyFileItems() {
 void Browser::deleteSomeFileItems(int32_t startAt, int32_t stopAt) {
 
 	// Call destructors.
-	for (int32_t i = startAt; i < stopAt;) {
+	AUDIO_BUDGETED_SECTION(section);
+	for (int32_t i = startAt; i < stopAt; i++) {
 		FileItem* item = (FileItem*)fileItems.getElementAddress(i);
 		item->~FileItem();
-
-		i++;
-		if (!(i & 63)) { //  &127 was even fine, even with only -Og compiler optimization.
-			AudioEngine::routineWithClusterLoading();
-		}
+		section.check();
 	}
 
 	fileItems.deleteAtIndex(startAt, stopAt - startAt);
@@ -58,6 +58,7 @@ struct Slot {
 #define FILE_ITEMS_MAX_NUM_ELEMENTS_FOR_NAVIGATION 20 // It "should" be able to be way less than this.
 
 extern char const* allowedFileExtensionsXML[];
+extern char const* allowedFileExtensionsSong[];
 
 class Browser : public QwertyUI {
 public:
@@ -28,10 +28,12 @@ constexpr size_t kMaxSlotDigits = 3;
 constexpr int32_t kMaxNumericSuffix = 9999;
 
 bool exists(FileListView const& files, std::string const& nameWithoutExtension) {
-	// The browser lists both extensions (allowedFileExtensionsXML), and saving picks between them via writeJsonFlag, so
-	// a name is taken if *either* form is on the card. Probing only .XML would hand back a name that already exists.
+	// The browser lists several extensions (allowedFileExtensionsXML, and for songs allowedFileExtensionsSong), and
+	// saving picks between them, so a name is taken if *any* form is on the card. Probing only .XML would hand back a
+	// name that already exists.
 	return files.contains((nameWithoutExtension + ".XML").c_str())
-	       || files.contains((nameWithoutExtension + ".Json").c_str());
+	       || files.contains((nameWithoutExtension + ".Json").c_str())
+	       || files.contains((nameWithoutExtension + ".DBIN").c_str());
 }
 
 char upper(char c) {
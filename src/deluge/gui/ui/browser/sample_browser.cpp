@@ -1155,14 +1155,16 @@ void sortSamples(bool (*sortFunction)(Sample*, Sample*), int32_t numSamples, Sam
 
 	int32_t whichComparison = 0;
 
+	AUDIO_BUDGETED_SECTION(section);
+
 	// Go through various iterations of numComparing
 	while (numComparing < numSamples) {
 
-		AudioEngine::routineWithClusterLoading();
-
 		// And now, for this selected comparison size, do a number of comparisions
 		for (int32_t whichComparison = 0; whichComparison * numComparing * 2 < numSamples; whichComparison++) {
 
+			section.check();
+
 			int32_t a = numComparing * (whichComparison * 2);
 			int32_t b = numComparing * (whichComparison * 2 + 1);
 
@@ -1768,11 +1770,10 @@ skipOctaveCorrection:
 
 	D_PRINTLN("creating ranges");
 
+	AUDIO_BUDGETED_SECTION(rangesSection);
 	for (int32_t s = 0; s < numSamples; s++) {
 
-		if (!(s & 31)) {
-			AudioEngine::routineWithClusterLoading();
-		}
+		rangesSection.check();
 
 		Sample* thisSample = sortArea[s];
 
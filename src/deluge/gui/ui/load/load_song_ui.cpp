@@ -42,8 +42,11 @@
 #include "processing/engines/audio_engine.h"
 #include "scheduler_api.h"
 #include "storage/audio/audio_file_manager.h"
+#include "storage/audio/sample_cache_store.h"
 #include "storage/file_item.h"
 #include "storage/flash_storage.h"
+#include "storage/set_list.h"
+#include "storage/song_preloader.h"
 #include "storage/storage_manager.h"
 #include "util/try.h"
 #include <string.h>
@@ -79,6 +82,7 @@ bool LoadSongUI::opened() {
 	currentDir.set(&currentSong->dirPath);
 
 	Error error = beginSlotSession(false, true);
+	allowedFileExtensions = allowedFileExtensionsSong;
 	if (error != Error::NONE) {
 gotError:
 		display->displayError(error);
@@ -101,7 +105,8 @@ gotError:
 	searchFilename.set(&currentSong->name);
 
 	if (!searchFilename.isEmpty() && !searchFilename.contains(".XML")) {
-		error = searchFilename.concatenate(".XML");
+		error = searchFilename.concatenate(
+		    runtimeFeatureSettings.isOn(RuntimeFeatureSettingType::BinarySongFiles) ? ".DBIN" : ".XML");
 		if (error != Error::NONE) {
 			goto gotError;
 		}
@@ -255,7 +260,7 @@ void LoadSongUI::queueLoadNextSongIfAvailable(int8_t offset) {
 		// If another load is in progress, ignore this request
 		return;
 	}
-	if (fileIndexSelected == -1) {
+	if (fileIndexSelected == -1 && !setList.isActive()) {
 		// If no song is loaded/selected yet, we have nothing to do
 		return;
 	}
@@ -265,6 +270,22 @@ void LoadSongUI::queueLoadNextSongIfAvailable(int8_t offset) {
 // This method actually executes the loading of next song (by offset)
 void LoadSongUI::doQueueLoadNextSongIfAvailable(int8_t offset) {
 	outputTypeToLoad = OutputType::NONE;
+
+	// In a set list, the next song is whichever the set says, wherever it lives. Once we're off the end of the set,
+	// there's nothing more to load
+	if (setList.isActive()) {
+		char const* path = setList.getSongPath(offset);
+		if (path && selectSongByFullPath(path) == Error::NONE) {
+			AudioEngine::logAction("performLoad");
+			performLoad();
+			if (FlashStorage::defaultStartupSongMode == StartupSongMode::LASTOPENED) {
+				runtimeFeatureSettings.writeSettingsToFile();
+			}
+		}
+		currentUIMode = UI_MODE_NONE;
+		return;
+	}
+
 	currentDir.set(&currentSong->dirPath);
 
 	int32_t currentFileIndexSelected = fileIndexSelected;
@@ -327,7 +348,11 @@ void LoadSongUI::performLoad() {
 	}
 	Error error;
 
-	error = StorageManager::openDelugeFile(currentFileItem, "song");
+	// If this song has already been read in the background, we get to skip straight past the file parsing
+	Song* backgroundLoadedSong = songPreloader.take(&currentDir, currentFileItem);
+	if (!backgroundLoadedSong) {
+		error = StorageManager::openDelugeFile(currentFileItem, "song");
+	}
 
 	currentUIMode = UI_MODE_LOADING_SONG_ESSENTIAL_SAMPLES;
 	indicator_leds::setLedState(IndicatorLED::LOAD, false);
@@ -343,7 +368,14 @@ void LoadSongUI::performLoad() {
 		// Otherwise, a timer might get called and try to access Clips that we may have deleted below (really?)
 		uiTimerManager.unsetTimer(TimerName::PLAY_ENABLE_FLASH);
 
-		deleteOldSongBeforeLoadingNew();
+		// ...unless it's the next song in a set list, and we've already found the two fit. Then the old one stays in
+		// RAM until the swap, so the samples they share are never let go of
+		if (setList.isActive() && setList.fitsAlongsideCurrentSong(&currentDir, &currentFileItem->filename)) {
+			silenceOldSongBeforeLoadingNew();
+		}
+		else {
+			deleteOldSongBeforeLoadingNew();
+		}
 	}
 	else {
 		// Note: this is dodgy, but in this case we don't reset view.activeControllableClip here - we let the user keep
@@ -354,14 +386,23 @@ void LoadSongUI::performLoad() {
 		playbackHandler.songSwapShouldPreserveTempo = Buttons::isButtonPressed(deluge::hid::button::TEMPO_ENC);
 	}
 
-	void* songMemory = GeneralMemoryAllocator::get().allocMaxSpeed(sizeof(Song));
+	void* songMemory;
+	if (backgroundLoadedSong) {
+		preLoadedSong = backgroundLoadedSong;
+		AudioEngine::logAction("took preloaded song");
+		goto haveReadSong;
+	}
+
+	songMemory = GeneralMemoryAllocator::get().allocMaxSpeed(sizeof(Song));
 	if (!songMemory) {
 ramError:
 		error = Error::INSUFFICIENT_RAM;
 
 someError:
-		display->displayError(error);
 		activeDeserializer->closeWriter();
+gotErrorAfterReadingSong:
+		// The file's closed by now - or if the song was read in the background, was never opened here at all
+		display->displayError(error);
 fail:
 		// We couldn't load the requested song. Recover to a usable state and stop.
 		//
@@ -413,27 +454,28 @@ gotErrorAfterCreatingSong:
 	}
 	AudioEngine::logAction("read new song from file");
 
-	FRESULT success = activeDeserializer->closeWriter();
-	if (success != FR_OK) {
+	if (activeDeserializer->closeWriter() != FR_OK) {
 		display->displayPopup(deluge::l10n::get(deluge::l10n::String::STRING_FOR_ERROR_LOADING_SONG));
 		goto fail;
 	}
 
+haveReadSong:
 	preLoadedSong->dirPath.set(&currentDir);
 
 	String currentFilenameWithoutExtension;
 	error = currentFileItem->getFilenameWithoutExtension(&currentFilenameWithoutExtension);
 	if (error != Error::NONE) {
-		goto gotErrorAfterCreatingSong;
+		goto gotErrorAfterReadingSong;
 	}
 
 	error = audioFileManager.setupAlternateAudioFileDir(audioFileManager.alternateAudioFileLoadPath, currentDir.get(),
 	                                                    currentFilenameWithoutExtension.get());
 	if (error != Error::NONE) {
-		goto gotErrorAfterCreatingSong;
+		goto gotErrorAfterReadingSong;
 	}
 
 	audioFileManager.thingBeginningLoading(ThingType::SONG);
+	sampleCacheStore.songLoading();
 
 	// Search existing RAM for all samples, to lay a claim to any which will be needed for this new Song.
 	// Do this before loading any new Samples from file, in case we were in danger of discarding any from RAM that we
@@ -568,9 +610,65 @@ swapDone:
 		}
 	}
 
+	setList.songLoaded(&currentDir, &currentFileItem->filename);
+	preloadNextSong();
+
 	performingLoad = false;
 }
 
+// With the "preload next song" community feature on, start reading whichever song comes after the one just loaded,
+// so that moving on to it (e.g. by the "next song" MIDI command) doesn't have to wait for the card
+void LoadSongUI::preloadNextSong() {
+	if (setList.isActive()) {
+		setList.preloadNextSong();
+		return;
+	}
+
+	if (!runtimeFeatureSettings.isOn(RuntimeFeatureSettingType::PreloadNextSong)) {
+		return;
+	}
+
+	int32_t numFileItems = fileItems.getNumElements();
+	if (fileIndexSelected < 0 || fileIndexSelected >= numFileItems) {
+		return;
+	}
+
+	for (int32_t offset = 1; offset < numFileItems; offset++) {
+		FileItem* fileItem = (FileItem*)fileItems.getElementAddress((fileIndexSelected + offset) % numFileItems);
+		if (!fileItem->isFolder) {
+			songPreloader.preload(&currentDir, fileItem);
+			return;
+		}
+	}
+}
+
+// Points the browser at the song with the given full path, without any of the UI that goes with browsing to it
+Error LoadSongUI::selectSongByFullPath(char const* fullPath) {
+	char const* slashPos = strrchr(fullPath, '/');
+	if (!slashPos) {
+		return Error::FILE_NOT_FOUND;
+	}
+	char const* filename = slashPos + 1;
+
+	currentDir.set(fullPath, (int32_t)(slashPos - fullPath));
+	allowedFileExtensions = allowedFileExtensionsSong;
+
+	Error error = readFileItemsFromFolderAndMemory(currentSong, OutputType::NONE, filePrefix, filename, nullptr, false,
+	                                               Availability::ANY, CATALOG_SEARCH_BOTH);
+	if (error != Error::NONE) {
+		return error;
+	}
+
+	bool foundExact;
+	int32_t i = fileItems.search(filename, &foundExact);
+	if (!foundExact) {
+		fileIndexSelected = -1;
+		return Error::FILE_NOT_FOUND;
+	}
+	fileIndexSelected = i;
+	return setEnteredTextFromCurrentFilename();
+}
+
 ActionResult LoadSongUI::timerCallback() {
 	// Progress vertical scrolling
 	if (currentUIMode == UI_MODE_VERTICAL_SCROLL) {
@@ -57,6 +57,8 @@ private:
 	bool scrollingIntoSlot;
 	bool qwertyCurrentlyDrawnOnscreen;
 	void doQueueLoadNextSongIfAvailable(int8_t offset);
+	void preloadNextSong();
+	Error selectSongByFullPath(char const* fullPath);
 	// int32_t findNextFile(int32_t offset);
 	void exitThisUI();
 	void exitActionWithError();
@@ -39,6 +39,7 @@
 #include "gui/menu_item/cv/transpose.h"
 #include "gui/menu_item/cv/volts.h"
 #include "gui/menu_item/defaults/accessibility_menu_highlighting.h"
+#include "gui/menu_item/defaults/audio_latency.h"
 #include "gui/menu_item/defaults/bend_range.h"
 #include "gui/menu_item/defaults/favourites_layout.h"
 #include "gui/menu_item/defaults/grid_default_active_mode.h"
@@ -106,6 +107,7 @@
 #include "gui/menu_item/midi/follow/follow_feedback_automation.h"
 #include "gui/menu_item/midi/follow/follow_feedback_channel_type.h"
 #include "gui/menu_item/midi/follow/follow_kit_root_note.h"
+#include "gui/menu_item/midi/input_latency.h"
 #include "gui/menu_item/midi/mpe_to_mono.h"
 #include "gui/menu_item/midi/pgm.h"
 #include "gui/menu_item/midi/program.h"
@@ -1060,6 +1062,9 @@ PLACE_SDRAM_BSS runtime_feature::Settings runtimeFeatureSettingsMenu{STRING_FOR_
 // MIDI thru
 PLACE_SDRAM_BSS ToggleBool midiThruMenu{STRING_FOR_MIDI_THRU, STRING_FOR_MIDI_THRU, midiEngine.midiThru};
 
+// MIDI input latency
+PLACE_SDRAM_BSS midi::InputLatency midiInputLatencyMenu{STRING_FOR_INPUT_LATENCY, STRING_FOR_INPUT_LATENCY};
+
 // MIDI Takeover
 PLACE_SDRAM_BSS midi::Takeover midiTakeoverMenu{STRING_FOR_TAKEOVER};
 
@@ -1235,6 +1240,7 @@ PLACE_SDRAM_BSS Submenu midiMenu{
         &midiFollowSubmenu,
         &midiSelectKitRowMenu,
         &midiThruMenu,
+        &midiInputLatencyMenu,
         &midiTransposeMenu,
         &midiTakeoverMenu,
         &midiCommandsMenu,
@@ -1412,6 +1418,7 @@ PLACE_SDRAM_BSS defaults::SliceMode defaultSliceMode{STRING_FOR_DEFAULT_SLICE_MO
 PLACE_SDRAM_BSS ToggleBool defaultHighCPUUsageIndicatorMode{STRING_FOR_DEFAULT_HIGH_CPU_USAGE_INDICATOR,
                                                             STRING_FOR_DEFAULT_HIGH_CPU_USAGE_INDICATOR,
                                                             FlashStorage::highCPUUsageIndicator};
+PLACE_SDRAM_BSS defaults::AudioLatency defaultAudioLatencyMenu{STRING_FOR_AUDIO_LATENCY, STRING_FOR_AUDIO_LATENCY};
 PLACE_SDRAM_BSS defaults::HoldTime defaultHoldTimeMenu{STRING_FOR_HOLD_TIME, STRING_FOR_HOLD_TIME};
 
 PLACE_SDRAM_BSS ActiveScaleMenu defaultActiveScaleMenu{STRING_FOR_ACTIVE_SCALES, ActiveScaleMenu::DEFAULT};
@@ -1453,6 +1460,7 @@ PLACE_SDRAM_BSS Submenu defaultsSubmenu{
         &defaultPadBrightness,
         &defaultSliceMode,
         &defaultHighCPUUsageIndicatorMode,
+        &defaultAudioLatencyMenu,
         &defaultHoldTimeMenu,
         &screensaverSubmenu,
     },
@@ -50,6 +50,28 @@ SaveSongUI::SaveSongUI() {
 	title = "Save song";
 }
 
+// The community setting chooses between the binary format and the usual XML (or Json)
+static char const* getSongFileExtension() {
+	if (runtimeFeatureSettings.isOn(RuntimeFeatureSettingType::BinarySongFiles)) {
+		return ".DBIN";
+	}
+	return writeJsonFlag ? ".Json" : ".XML";
+}
+
+Error SaveSongUI::getCurrentFilePath(String* path) {
+	path->set(&currentDir);
+
+	Error error = path->concatenate("/");
+	if (error != Error::NONE) {
+		return error;
+	}
+	error = path->concatenate(&enteredText);
+	if (error != Error::NONE) {
+		return error;
+	}
+	return path->concatenate(getSongFileExtension());
+}
+
 bool SaveSongUI::opened() {
 	outputTypeToLoad = OutputType::NONE;
 
@@ -63,18 +85,14 @@ doReturnFalse:
 		                                 // the pads.
 		return false;
 	}
+	allowedFileExtensions = allowedFileExtensionsSong;
 
 	Error error;
 
 	String searchFilename;
 	searchFilename.set(&currentSong->name);
 	if (!searchFilename.isEmpty()) {
-		if (writeJsonFlag) {
-			error = searchFilename.concatenate(".Json");
-		}
-		else {
-			error = searchFilename.concatenate(".XML");
-		}
+		error = searchFilename.concatenate(getSongFileExtension());
 		if (error != Error::NONE) {
 gotError:
 			display->displayError(error);
@@ -430,12 +448,7 @@ gotError:
 			if (error != Error::NONE) {
 				goto gotError;
 			}
-			if (writeJsonFlag) {
-				error = filePathDuringWrite.concatenate(".Json");
-			}
-			else {
-				error = filePathDuringWrite.concatenate(".XML");
-			}
+			error = filePathDuringWrite.concatenate(getSongFileExtension());
 			if (error != Error::NONE) {
 				goto gotError;
 			}
@@ -453,7 +466,13 @@ gotError:
 
 	D_PRINTLN("creating:  %s", filePathDuringWrite.get());
 
-	if (writeJsonFlag) {
+	if (runtimeFeatureSettings.isOn(RuntimeFeatureSettingType::BinarySongFiles)) {
+		error = StorageManager::createBinaryFile(filePathDuringWrite.get(), smBinarySerializer, false, false);
+		if (error != Error::NONE) {
+			goto gotError;
+		}
+	}
+	else if (writeJsonFlag) {
 		// Write the actual song file
 		error = StorageManager::createJsonFile(filePathDuringWrite.get(), smJsonSerializer, false, false);
 		if (error != Error::NONE) {
@@ -17,6 +17,7 @@
 
 #include "gui/ui_timer_manager.h"
 #include "definitions_cxx.hpp"
+#include "extern.h"
 #include "gui/ui/keyboard/keyboard_screen.h"
 #include "gui/ui/sound_editor.h"
 #include "gui/views/automation_view.h"
@@ -32,8 +33,10 @@
 #include "hid/led/pad_leds.h"
 #include "io/midi/midi_engine.h"
 #include "io/midi/midi_follow.h"
+#include "model/action/action_logger.h"
 #include "playback/playback_handler.h"
 #include "processing/engines/audio_engine.h"
+#include "storage/set_list.h"
 #include "util/functions.h"
 
 #include <algorithm>
@@ -148,6 +151,19 @@ void UITimerManager::routine() {
 					PadLEDs::timerRoutine();
 					break;
 
+				case TimerName::SET_LIST_NEXT_SONG:
+					setList.checkNextSongFits();
+					break;
+
+				case TimerName::UNDO_MEMORY_BUDGET:
+					if (sdRoutineLock) {
+						timer.active = true; // Come back soon and try again.
+					}
+					else {
+						actionLogger.enforceMemoryBudget();
+					}
+					break;
+
 				case TimerName::UI_SPECIFIC: {
 					ActionResult result = getCurrentUI()->timerCallback();
 					if (result == ActionResult::REMIND_ME_OUTSIDE_CARD_ROUTINE) {
@@ -51,6 +51,10 @@ enum class TimerName {
 	SELECTED_CLIP_PULSE,
 	/// Idle countdown before the screensaver appears, then its frame clock while it shows
 	SCREENSAVER,
+	/// Set by the song preloader's task once a set list's next song is ready, so it's checked from here instead
+	SET_LIST_NEXT_SONG,
+	/// Set whenever an undo Action gets closed, so the undo history is trimmed to its RAM budget from here instead
+	UNDO_MEMORY_BUDGET,
 	/// Total number of timers
 	NUM_TIMERS
 };
@@ -2590,6 +2590,8 @@ void ArrangerView::navigateThroughPresets(int32_t offset) {
 		return;
 	}
 
+	AUDIO_BUDGETED_SECTION(section);
+
 	endAudition(output);
 
 	output = currentSong->navigateThroughPresetsForInstrument(output, offset);
@@ -2598,7 +2600,7 @@ void ArrangerView::navigateThroughPresets(int32_t offset) {
 
 	view.setActiveModControllableTimelineCounter(output->getActiveClip());
 
-	AudioEngine::routineWithClusterLoading();
+	section.check();
 
 	beginAudition(output);
 }
@@ -139,9 +139,11 @@ bool InstrumentClipView::opened() {
 void InstrumentClipView::openedInBackground() {
 	bool rendering_to_store = (currentUIMode == UI_MODE_ANIMATION_FADE);
 
+	AUDIO_BUDGETED_SECTION(section);
+
 	recalculateColours();
 
-	AudioEngine::routineWithClusterLoading();
+	section.check();
 
 	AudioEngine::logAction("InstrumentClipView::beginSession 2");
 
@@ -23,6 +23,7 @@
 #include "gui/ui_timer_manager.h"
 #include "hid/display/display.h"
 #include "hid/display/oled.h"
+#include "hid/display/oled_canvas/dirty_pages.h"
 #include "hid/display/screensaver.h"
 #include "hid/hid_sysex.h"
 #include "io/debug/log.h"
@@ -60,6 +61,11 @@ oled_canvas::Canvas OLED::console;
 
 bool OLED::needsSending;
 
+// A copy of what the panel is showing, or was last sent anyway, so sendMainImage() can tell what's actually changed.
+// Until the first frame goes out, the panel's showing whatever it powered up with.
+[[gnu::aligned(CACHE_LINE_SIZE)]] static ImageStore panelImage;
+static bool panelImageKnown = false;
+
 static int32_t working_animation_count;
 static bool started_animation;
 static bool loading;
@@ -370,6 +376,10 @@ void copyBackgroundAroundForeground(ImageStore backgroundImage, ImageStore foreg
 	}
 }
 
+void OLED::forgetPanelImage() {
+	panelImageKnown = false;
+}
+
 void OLED::sendMainImage() {
 	if (!needsSending) {
 		return;
@@ -418,7 +428,26 @@ void OLED::sendMainImage() {
 	uartPrint("oled render time: ");
 	uartPrintNumber((uint16_t)(renderStopTime - renderStartTime));
 #endif
+	// Lots of things mark the display changed and then redraw exactly what was there already - so only send a frame if
+	// it's different from the last one. The panel still gets sent whole frames: it's in horizontal addressing mode
+	// with its D/C line driven by the PIC, so sending just a window of it would cost two more PIC round trips a frame.
+	oled_canvas::DirtyPages dirty;
+	ImageStore const& currentImage = *reinterpret_cast<ImageStore*>(oledCurrentImage);
+	if (panelImageKnown) {
+		dirty.markChanges(currentImage, panelImage);
+		if (dirty.isEmpty()) {
+			needsSending = false;
+			return;
+		}
+	}
+	else {
+		dirty.markAll();
+		panelImageKnown = true;
+	}
+	dirty.copyDirty(currentImage, panelImage);
+
 	enqueueOLEDFrame(oledCurrentImage[0]);
+	HIDSysex::oledChanged(dirty);
 	HIDSysex::sendDisplayIfChanged();
 	needsSending = false;
 }
@@ -1293,7 +1322,8 @@ void OLED::freezeWithError(char const* text) {
 	}
 	oledWaitingForMessage = 256;
 
-	// Send data via DMA
+	// Send data via DMA - past sendMainImage(), so if we do get resumed it'll have to send its next frame whole
+	forgetPanelImage();
 	RSPI(SPI_CHANNEL_OLED_MAIN).SPDCR = 0x20u;               // 8-bit
 	RSPI(SPI_CHANNEL_OLED_MAIN).SPCMD0 = 0b0000011100000010; // 8-bit
 	RSPI(SPI_CHANNEL_OLED_MAIN).SPBFCR.BYTE = 0b01100000;    // 0b00100000;
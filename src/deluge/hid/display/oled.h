@@ -46,6 +46,7 @@ public:
 		if (l10n::chosenLanguage == nullptr || l10n::chosenLanguage == &l10n::built_in::seven_segment) {
 			l10n::chosenLanguage = &l10n::built_in::english;
 		}
+		forgetPanelImage();
 	}
 
 	/// Clear the canvas currently being used as the main image.
@@ -59,6 +60,9 @@ public:
 	static void stopBlink();
 
 	static void sendMainImage();
+	/// Call when the panel has been initialised, or sent a frame some other way than sendMainImage(), so the next
+	/// sendMainImage() sends the whole frame rather than just what's changed since its last one.
+	static void forgetPanelImage();
 
 	static void setupPopup(PopupType type, int32_t width, int32_t height, std::optional<int32_t> startX = std::nullopt,
 	                       std::optional<int32_t> startY = std::nullopt);
@@ -0,0 +1,123 @@
+/*
+ * Copyright © 2025 Synthstrom Audible Limited
+ *
+ * This file is part of The Synthstrom Audible Deluge Firmware.
+ *
+ * The Synthstrom Audible Deluge Firmware is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program.
+ * If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "dirty_pages.h"
+#include <algorithm>
+#include <cstring>
+
+using deluge::hid::display::oled_canvas::Canvas;
+using deluge::hid::display::oled_canvas::DirtyPages;
+
+namespace {
+constexpr int32_t kNumPages = Canvas::kImageHeight;
+constexpr int32_t kWidth = Canvas::kImageWidth;
+constexpr int32_t kWordsPerPage = kWidth / sizeof(uint32_t);
+
+uint32_t loadWord(uint8_t const* row, int32_t word) {
+	uint32_t value;
+	memcpy(&value, row + word * sizeof(uint32_t), sizeof(uint32_t));
+	return value;
+}
+} // namespace
+
+void DirtyPages::clear() {
+	memset(minX_, 255, sizeof(minX_));
+	memset(maxX_, 0, sizeof(maxX_));
+}
+
+void DirtyPages::markAll() {
+	memset(minX_, 0, sizeof(minX_));
+	memset(maxX_, kWidth - 1, sizeof(maxX_));
+}
+
+void DirtyPages::markColumns(int32_t page, int32_t minX, int32_t maxX) {
+	minX_[page] = std::min<int32_t>(minX_[page], minX);
+	maxX_[page] = std::max<int32_t>(maxX_[page], maxX);
+}
+
+void DirtyPages::add(DirtyPages const& other) {
+	for (int32_t page = 0; page < kNumPages; page++) {
+		if (other.isPageDirty(page)) {
+			markColumns(page, other.minX_[page], other.maxX_[page]);
+		}
+	}
+}
+
+void DirtyPages::markChanges(Canvas::ImageStore const& image, Canvas::ImageStore const& previous) {
+	for (int32_t page = 0; page < kNumPages; page++) {
+		uint8_t const* newRow = image[page];
+		uint8_t const* oldRow = previous[page];
+
+		// Most pages don't change from one frame to the next, so find that out a word at a time
+		int32_t firstWord = 0;
+		while (firstWord < kWordsPerPage && loadWord(newRow, firstWord) == loadWord(oldRow, firstWord)) {
+			firstWord++;
+		}
+		if (firstWord == kWordsPerPage) {
+			continue;
+		}
+		int32_t lastWord = kWordsPerPage - 1;
+		while (loadWord(newRow, lastWord) == loadWord(oldRow, lastWord)) {
+			lastWord--;
+		}
+
+		// And then narrow it down to the bytes
+		int32_t minX = firstWord * sizeof(uint32_t);
+		while (newRow[minX] == oldRow[minX]) {
+			minX++;
+		}
+		int32_t maxX = lastWord * sizeof(uint32_t) + sizeof(uint32_t) - 1;
+		while (newRow[maxX] == oldRow[maxX]) {
+			maxX--;
+		}
+		markColumns(page, minX, maxX);
+	}
+}
+
+void DirtyPages::copyDirty(Canvas::ImageStore const& image, Canvas::ImageStore& previous) const {
+	for (int32_t page = 0; page < kNumPages; page++) {
+		if (isPageDirty(page)) {
+			memcpy(&previous[page][minX_[page]], &image[page][minX_[page]], maxX_[page] - minX_[page] + 1);
+		}
+	}
+}
+
+bool DirtyPages::isEmpty() const {
+	for (int32_t page = 0; page < kNumPages; page++) {
+		if (isPageDirty(page)) {
+			return false;
+		}
+	}
+	return true;
+}
+
+bool DirtyPages::getByteRange(int32_t& first, int32_t& last) const {
+	int32_t firstPage = 0;
+	while (firstPage < kNumPages && !isPageDirty(firstPage)) {
+		firstPage++;
+	}
+	if (firstPage == kNumPages) {
+		return false;
+	}
+	int32_t lastPage = kNumPages - 1;
+	while (!isPageDirty(lastPage)) {
+		lastPage--;
+	}
+	first = firstPage * kWidth + minX_[firstPage];
+	last = lastPage * kWidth + maxX_[lastPage];
+	return true;
+}
@@ -0,0 +1,68 @@
+/*
+ * Copyright © 2025 Synthstrom Audible Limited
+ *
+ * This file is part of The Synthstrom Audible Deluge Firmware.
+ *
+ * The Synthstrom Audible Deluge Firmware is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program.
+ * If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "canvas.h"
+#include <cstdint>
+
+namespace deluge::hid::display::oled_canvas {
+
+/// Which columns of each page (row of 8 pixels, one byte tall) of an image have changed since some earlier frame.
+///
+/// Each page keeps a single inclusive column range, so two separate changes on one page get merged into one range
+/// spanning both. That's what both things that send the image out want anyway: the panel and the sysex display mirror
+/// each send whole runs of bytes.
+class DirtyPages {
+public:
+	DirtyPages() { clear(); }
+
+	/// Mark everything clean
+	void clear();
+
+	/// Mark the whole image dirty - e.g. when whatever it's being sent to doesn't know what it's showing
+	void markAll();
+
+	/// Mark columns minX to maxX, inclusive, of a page dirty
+	void markColumns(int32_t page, int32_t minX, int32_t maxX);
+
+	/// Mark dirty everything that's dirty in other too
+	void add(DirtyPages const& other);
+
+	/// Compare image against previous, a copy of some earlier frame, marking dirty whatever differs
+	void markChanges(Canvas::ImageStore const& image, Canvas::ImageStore const& previous);
+
+	/// Copy just the dirty parts of image into previous
+	void copyDirty(Canvas::ImageStore const& image, Canvas::ImageStore& previous) const;
+
+	[[nodiscard]] bool isEmpty() const;
+	[[nodiscard]] bool isPageDirty(int32_t page) const { return minX_[page] <= maxX_[page]; }
+	[[nodiscard]] int32_t getMinX(int32_t page) const { return minX_[page]; }
+	[[nodiscard]] int32_t getMaxX(int32_t page) const { return maxX_[page]; }
+
+	/// Get the first and last dirty byte, inclusive, with the image laid out page after page as it gets sent.
+	///
+	/// @returns false if nothing is dirty
+	bool getByteRange(int32_t& first, int32_t& last) const;
+
+private:
+	// A clean page has minX_ > maxX_
+	uint8_t minX_[Canvas::kImageHeight];
+	uint8_t maxX_[Canvas::kImageHeight];
+};
+
+} // namespace deluge::hid::display::oled_canvas
@@ -7,14 +7,14 @@
 #include "io/midi/midi_device.h"
 #include "io/midi/midi_engine.h"
 #include "io/midi/sysex.h"
-#include "memory/general_memory_allocator.h"
 #include "processing/engines/audio_engine.h"
 #include "util/pack.h"
 #include <cstring>
 
 MIDICable* midiDisplayCable = nullptr;
 int32_t midiDisplayUntil = 0;
-uint8_t* oledDeltaImage = nullptr;
+// What's changed in the OLED image since we last sent it to midiDisplayCable
+deluge::hid::display::oled_canvas::DirtyPages oledDeltaDirty;
 bool oledDeltaForce = true;
 
 void HIDSysex::sysexReceived(MIDICable& cable, uint8_t* data, int32_t len) {
@@ -57,11 +57,6 @@ void HIDSysex::requestOLEDDisplay(MIDICable& cable, uint8_t* data, int32_t len)
 			if (force) {
 				oledDeltaForce = true;
 			}
-
-			if (oledDeltaImage == nullptr) {
-				oledDeltaImage = (uint8_t*)GeneralMemoryAllocator::get().allocMaxSpeed(
-				    sizeof(uint8_t[OLED_MAIN_HEIGHT_PIXELS >> 3][OLED_MAIN_WIDTH_PIXELS]));
-			}
 		}
 		sendDisplayIfChanged();
 		if (force && display->have7SEG()) {
@@ -155,40 +150,28 @@ void HIDSysex::send7SegData(MIDICable& cable) {
 	}
 }
 
+void HIDSysex::oledChanged(deluge::hid::display::oled_canvas::DirtyPages const& dirty) {
+	oledDeltaDirty.add(dirty);
+}
+
 void HIDSysex::sendOLEDDataDelta(MIDICable& cable, bool force) {
-	const int32_t data_size = 768;
 	const int32_t max_packed_size = 922;
 
 	uint8_t* current = deluge::hid::display::OLED::oledCurrentImage[0];
 
-	int32_t first_change = 9000;
-	int32_t last_change = 0;
-	int32_t* blkdata_new = (int32_t*)current;
-	int32_t* blkdata_old = (int32_t*)oledDeltaImage;
-
-	const int32_t word_size = data_size >> 2;
-
+	// No need to diff against a copy of what we last sent - sendMainImage() has already worked out what changed
 	if (force || oledDeltaForce) {
-		first_change = 0;
-		last_change = word_size - 1;
-	}
-	else {
-		for (int32_t blk = 0; blk < word_size; blk++) {
-			if (blkdata_new[blk] != blkdata_old[blk]) {
-				if (first_change > blk) {
-					first_change = blk;
-				}
-				last_change = blk;
-			}
-		}
+		oledDeltaDirty.markAll();
 	}
-
-	if (first_change > word_size) {
+	int32_t first_change;
+	int32_t last_change;
+	if (!oledDeltaDirty.getByteRange(first_change, last_change)) {
 		return;
 	}
 
-	int start = first_change / 2;
-	int len = (last_change / 2) - start + 1;
+	// In 8-byte blocks
+	int start = first_change / 8;
+	int len = (last_change / 8) - start + 1;
 	//	int8_t reply_hdr[5] = {0xf0, 0x7d, 0x02, 0x40, 0x02};
 	uint8_t reply_hdr[8] = {0xF0, 0x00, 0x21, 0x7B, 0x01, 0x02, 0x40, 0x02};
 	uint8_t* reply = midiEngine.sysex_fmt_buffer;
@@ -202,7 +185,7 @@ void HIDSysex::sendOLEDDataDelta(MIDICable& cable, bool force) {
 	if (packed <= 0) {
 		return;
 	}
-	memcpy(oledDeltaImage + (8 * start), current + (8 * start), 8 * len);
+	oledDeltaDirty.clear();
 	oledDeltaForce = false;
 	// reply[7 + packed] = 0xf7; // end of transmission
 	reply[10 + packed] = 0xf7; // end of transmission //
@@ -1,4 +1,5 @@
 #include "definitions_cxx.hpp"
+#include "hid/display/oled_canvas/dirty_pages.h"
 #include "io/midi/midi_device_manager.h"
 
 namespace HIDSysex {
@@ -9,5 +10,7 @@ void sendOLEDData(MIDICable& cable, bool rle);
 void sendOLEDDataDelta(MIDICable& cable, bool force);
 void send7SegData(MIDICable& cable);
 void sendDisplayIfChanged();
+/// Tell the display mirror which parts of the OLED image changed in a frame that's just been sent to the panel
+void oledChanged(deluge::hid::display::oled_canvas::DirtyPages const& dirty);
 void readBlock(MIDICable& cable);
 } // namespace HIDSysex
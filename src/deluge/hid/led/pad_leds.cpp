@@ -89,6 +89,17 @@ uint8_t flashCursor;
 uint8_t slowFlashSquares[kDisplayHeight];
 uint8_t slowFlashColours[kDisplayHeight];
 
+// What the PIC was last sent for each double column (the sidebar being the last one), so sortLedsForCol() can skip
+// any it's already got - lots of re-renders only change a few pads, if any. Only trusted where the bit in
+// sentDoubleColumnsKnown is set: anything that makes the PIC change pad colours itself, like scrolling, clears it.
+constexpr int32_t kNumDoubleColumns = (kDisplayWidth + kSideBarWidth) >> 1;
+std::array<RGB, kDisplayHeight * 2> sentDoubleColumns[kNumDoubleColumns];
+uint32_t sentDoubleColumnsKnown = 0;
+
+PICTraffic picTraffic{};
+uint32_t picTrafficSecondStartTime = 0;
+uint32_t picTrafficBytesThisSecond = 0;
+
 int32_t explodeAnimationYOriginBig;
 int32_t explodeAnimationXStartBig;
 int32_t explodeAnimationXWidthBig;
@@ -272,7 +283,37 @@ void sortLedsForCol(int32_t x) {
 	for (size_t y = 0; y < kDisplayHeight; y++) {
 		doubleColumn[total++] = prepareColour(x + 1, y, image[y][x + 1]);
 	}
-	PIC::setColourForTwoColumns((x >> 1), doubleColumn);
+
+	int32_t doubleColumnIdx = x >> 1;
+	if ((sentDoubleColumnsKnown & (1 << doubleColumnIdx)) && sentDoubleColumns[doubleColumnIdx] == doubleColumn) {
+		picTraffic.doubleColumnsSkipped++;
+		return;
+	}
+	PIC::setColourForTwoColumns(doubleColumnIdx, doubleColumn);
+	sentDoubleColumns[doubleColumnIdx] = doubleColumn;
+	sentDoubleColumnsKnown |= (1 << doubleColumnIdx);
+	picTraffic.doubleColumnsSent++;
+	countBytesSentToPIC(kNumBytesInColUpdateMessage);
+}
+
+void forgetSentColours() {
+	sentDoubleColumnsKnown = 0;
+}
+
+void forgetSentColour(int32_t x) {
+	sentDoubleColumnsKnown &= ~(1 << (x >> 1));
+}
+
+void countBytesSentToPIC(uint32_t numBytes) {
+	uint32_t timeSinceSecondStart = AudioEngine::audioSampleTimer - picTrafficSecondStartTime;
+	if (timeSinceSecondStart >= kSampleRate) {
+		// If nothing got sent for more than a whole second, then the last whole second was a quiet one
+		picTraffic.bytesPerSecond = (timeSinceSecondStart < 2 * kSampleRate) ? picTrafficBytesThisSecond : 0;
+		picTrafficSecondStartTime = AudioEngine::audioSampleTimer;
+		picTrafficBytesThisSecond = 0;
+	}
+	picTrafficBytesThisSecond += numBytes;
+	picTraffic.bytesSent += numBytes;
 }
 
 const RGB flashColours[3] = {
@@ -1398,11 +1439,15 @@ void horizontal::renderScroll() {
 			}
 
 			PIC::sendScrollRow(row, prepareColour(endSquare, row, image[row][endSquare]));
+			countBytesSentToPIC(1 + sizeof(RGB));
 		}
 	}
 
 	PIC::doneSendingRows();
 	PIC::flush();
+	countBytesSentToPIC(1);
+	// The PIC has shifted its own pad colours along
+	forgetSentColours();
 
 	if (squaresScrolled >= areaToScroll) {
 		getCurrentUI()->scrollFinished();
@@ -1456,6 +1501,8 @@ void vertical::renderScroll() {
 	}
 	PIC::doVerticalScroll(scrollDirection > 0, colours);
 	PIC::flush();
+	countBytesSentToPIC(1 + sizeof(colours));
+	forgetSentColours();
 }
 
 void vertical::setupScroll(int8_t thisScrollDirection, bool scrollIntoNothing) {
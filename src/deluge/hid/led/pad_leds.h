@@ -128,7 +128,25 @@ void setupAudioClipCollapseOrExplodeAnimation(AudioClip* clip);
 
 void setGreyoutAmount(float newAmount);
 
+/// Counts of what's been sent to the PIC to set pad colours, to see how much of its UART that's taking up
+struct PICTraffic {
+	uint32_t bytesSent;            // Since boot
+	uint32_t bytesPerSecond;       // Over the last whole second
+	uint32_t doubleColumnsSent;    // Since boot
+	uint32_t doubleColumnsSkipped; // Since boot - because the PIC already had those colours
+};
+extern PICTraffic picTraffic;
+
+void countBytesSentToPIC(uint32_t numBytes);
+
+/// Make the next sortLedsForCol() send every double column, even any the PIC should already have
+void forgetSentColours();
+/// Same, for just the double column containing x
+void forgetSentColour(int32_t x);
+
 static inline void flashMainPad(int32_t x, int32_t y, int32_t colour = 0) {
+	// The PIC flashes the pad itself, so don't count on it still having the colour we last sent
+	forgetSentColour(x);
 	auto idx = y + (x * kDisplayHeight);
 	if (colour > 0) {
 		PIC::flashMainPadWithColourIdx(idx, colour);
@@ -24,6 +24,10 @@ extern "C" {
 #include "gui/l10n/l10n.h"
 #include "io/midi/midi_engine.h"
 #include "storage/storage_manager.h"
+#include "timers_interrupts/timers_interrupts.h"
+#include <algorithm>
+
+constexpr int32_t kSysexBytesPerChunk = 64;
 
 void MIDICableDINPorts::writeReferenceAttributesToFile(Serializer& writer) {
 	// Same line. Usually the user wouldn't have default velocity sensitivity set
@@ -51,10 +55,21 @@ void MIDICableDINPorts::sendSysex(const uint8_t* data, int32_t len) {
 		return;
 	}
 
-	// NB: beware of MIDI_TX_BUFFER_SIZE
-	for (int32_t i = 0; i < len; i++) {
-		bufferMIDIUart(data[i]);
+	// Keep the DIN output queue's messages - and the TX-finished ISR topping the UART up with them - out of the middle
+	// of the sysex. What's already due goes ahead of it; anything timed for later stays queued, to follow it.
+	midiEngine.beginSerialSysex();
+
+	// NB: beware of MIDI_TX_BUFFER_SIZE. Interrupts only get held off for a chunk at a time, so a long sysex doesn't
+	// make the audio and timer ISRs wait for it.
+	for (int32_t chunkStart = 0; chunkStart < len; chunkStart += kSysexBytesPerChunk) {
+		CriticalSectionGuard guard;
+		int32_t chunkEnd = std::min(len, chunkStart + kSysexBytesPerChunk);
+		for (int32_t i = chunkStart; i < chunkEnd; i++) {
+			bufferMIDIUart(data[i]);
+		}
 	}
+
+	midiEngine.endSerialSysex();
 }
 
 bool MIDICableDINPorts::wantsToOutputMIDIOnChannel(MIDIMessage message, int32_t filter) const {
@@ -46,7 +46,7 @@ void MIDICableUSB::sendMessage(MIDIMessage message) {
 			ConnectedUSBMIDIDevice* connectedDevice = &connectedUSBMIDIDevices[ip][d];
 			if (connectedDevice->canHaveMIDISent) {
 				uint32_t channeledMessage = fullMessage | (portNumber << 4);
-				connectedDevice->bufferMessage(fullMessage);
+				connectedDevice->bufferMessage(channeledMessage);
 			}
 		}
 	}
@@ -69,7 +69,7 @@ size_t MIDICableUSB::sendBufferSpace() const {
 		return 0;
 	}
 
-	return connectedDevice->sendBufferSpace();
+	return connectedDevice->sendBufferSpace(portNumber);
 }
 
 extern bool developerSysexCodeReceived;
@@ -96,16 +96,27 @@ void MIDICableUSB::sendSysex(const uint8_t* data, int32_t len) {
 	}
 
 	int32_t pos = 0;
+	bool sendingDeveloperHeader = developerSysexCodeReceived && (data[1] != 0x7D);
+
+	// Replies to file reads can be longer than the queue holds. Whatever doesn't fit waits in the overflow, to be moved
+	// into the queue as it empties - but if even that can't take the whole thing, none of it gets sent.
+	USBMIDISysexOverflow& overflow = MIDIDeviceManager::usbSysexOverflow;
+	int32_t numPackets = sendingDeveloperHeader ? 1 + (len - 6 + 2) / 3 : (len + 2) / 3;
+	if (overflow.getSpace(connectedDevice->sendQueue, portNumber) < numPackets) {
+		overflow.countDropped();
+		return;
+	}
+	auto bufferPacket = [&](uint32_t packed) { connectedDevice->bufferSysexMessage(packed); };
 
 	// While we are standardizing on using the 4 byte Synthstrom Deluge in our messages, it is possible that client
 	// programs have not been updated yet, so if we get a SysEx request with 0x7D as the ID, we respond in-kind. This
 	// involves skipping the the first 5 bytes and sending 0xF0, 0x7D instead. Since the USB driver batches things in 3
 	// byte groups, we must include the first byte after the address in that first group.
-	if (developerSysexCodeReceived && (data[1] != 0x7D)) {
+	if (sendingDeveloperHeader) {
 		// Since the message ends with 0xF7, we can assume that data[5] does exist.
 		// fake 0xF0, 0x7D, data[5] for first send
 		uint32_t packed = ((uint32_t)data[5] << 24) | 0x007DF004 | (portNumber << 4);
-		connectedDevice->bufferMessage(packed);
+		bufferPacket(packed);
 		pos = 6;
 	}
 
@@ -130,7 +141,7 @@ void MIDICableUSB::sendSysex(const uint8_t* data, int32_t len) {
 		}
 		status |= (portNumber << 4);
 		uint32_t packed = ((uint32_t)byte2 << 24) | ((uint32_t)byte1 << 16) | ((uint32_t)byte0 << 8) | status;
-		connectedDevice->bufferMessage(packed);
+		bufferPacket(packed);
 	}
 }
 
@@ -0,0 +1,163 @@
+/*
+ * Copyright © 2025 Synthstrom Audible Limited
+ *
+ * This file is part of The Synthstrom Audible Deluge Firmware.
+ *
+ * The Synthstrom Audible Deluge Firmware is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program.
+ * If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "din_output_queue.h"
+#include <algorithm>
+
+namespace {
+bool isChannelMessage(uint8_t status) {
+	return status < 0xF0;
+}
+
+bool isNote(uint8_t status) {
+	return (status >> 4) == 0x8 || (status >> 4) == 0x9;
+}
+} // namespace
+
+bool DINOutputQueue::isController(Entry const& entry) {
+	switch (entry.status >> 4) {
+	case 0xA: // Polyphonic aftertouch
+	case 0xD: // Channel aftertouch
+	case 0xE: // Pitch bend
+		return true;
+
+	case 0xB:
+		// Not the CCs that only mean something in sequence with others - bank select, and the data entry and (N)RPN
+		// numbers - nor the channel mode messages like all notes off, which need to stay where they are among the notes
+		switch (entry.data1) {
+		case 0:
+		case 6:
+		case 32:
+		case 38:
+		case 96:
+		case 97:
+		case 98:
+		case 99:
+		case 100:
+		case 101:
+			return false;
+		default:
+			return entry.data1 < 120;
+		}
+
+	default:
+		return false;
+	}
+}
+
+bool DINOutputQueue::push(MIDIMessage message) {
+	uint8_t status = (message.statusType << 4) | message.channel;
+
+	if (status >= 0xF8) {
+		if (numRealtime_ == kMaxRealtimeMessages) {
+			return false;
+		}
+		realtime_[numRealtime_++] = status;
+		return true;
+	}
+
+	Entry entry{status, message.data1, message.data2};
+	uint8_t channel = status & 0x0F;
+
+	// Replace a value for the same controller that's still waiting - as long as nothing on this channel that has to
+	// stay in order with it has been queued since
+	if (isController(entry)) {
+		for (int32_t i = numMessages_ - 1; i >= 0; i--) {
+			Entry& waiting = messages_[i];
+			if (!isChannelMessage(waiting.status)) {
+				break;
+			}
+			if ((waiting.status & 0x0F) != channel) {
+				continue;
+			}
+			// Channel aftertouch and pitch bend have just the one value per channel. The others have one per note or CC
+			bool oneValuePerChannel = (status >> 4) == 0xD || (status >> 4) == 0xE;
+			if (waiting.status == status && (oneValuePerChannel || waiting.data1 == entry.data1)) {
+				waiting.data1 = entry.data1;
+				waiting.data2 = entry.data2;
+				stats_.bytesSavedByCoalescing += bytesPerStatusMessage(status);
+				return true;
+			}
+			if (!isController(waiting)) {
+				break;
+			}
+		}
+	}
+
+	if (numMessages_ == kMaxMessages) {
+		return false;
+	}
+
+	// Notes go ahead of controller values still waiting on other channels - but not ahead of anything already released
+	int32_t pos = numMessages_;
+	if (isNote(status)) {
+		while (pos > numReleased_ && isController(messages_[pos - 1])
+		       && (messages_[pos - 1].status & 0x0F) != channel) {
+			pos--;
+		}
+	}
+	auto begin = messages_.begin();
+	std::copy_backward(begin + pos, begin + numMessages_, begin + numMessages_ + 1);
+	messages_[pos] = entry;
+	numMessages_++;
+	return true;
+}
+
+int32_t DINOutputQueue::pop(uint8_t* out, int32_t maxBytes, bool includeUnreleased) {
+	int32_t written = 0;
+
+	int32_t numRealtime = std::min(includeUnreleased ? numRealtime_ : numRealtimeReleased_, maxBytes);
+	std::copy_n(realtime_.begin(), numRealtime, out);
+	std::copy(realtime_.begin() + numRealtime, realtime_.begin() + numRealtime_, realtime_.begin());
+	numRealtime_ -= numRealtime;
+	numRealtimeReleased_ = std::max<int32_t>(numRealtimeReleased_ - numRealtime, 0);
+	written += numRealtime;
+
+	int32_t numAvailable = includeUnreleased ? numMessages_ : numReleased_;
+	int32_t num = 0;
+	for (; num < numAvailable; num++) {
+		Entry const& entry = messages_[num];
+		int32_t length = bytesPerStatusMessage(entry.status);
+		bool useRunningStatus = isChannelMessage(entry.status) && entry.status == runningStatus_;
+		if (written + length - useRunningStatus > maxBytes) {
+			break;
+		}
+
+		if (useRunningStatus) {
+			stats_.bytesSavedByRunningStatus++;
+		}
+		else {
+			out[written++] = entry.status;
+		}
+		// System common messages cancel running status. (Real-time ones don't.)
+		runningStatus_ = isChannelMessage(entry.status) ? entry.status : 0;
+
+		if (length >= 2) {
+			out[written++] = entry.data1;
+			if (length == 3) {
+				out[written++] = entry.data2;
+			}
+		}
+	}
+	std::copy(messages_.begin() + num, messages_.begin() + numMessages_, messages_.begin());
+	numMessages_ -= num;
+	numReleased_ = std::max<int32_t>(numReleased_ - num, 0);
+
+	stats_.messagesSent += numRealtime + num;
+	stats_.bytesSent += written;
+	return written;
+}
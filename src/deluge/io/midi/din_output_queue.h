@@ -0,0 +1,91 @@
+/*
+ * Copyright © 2025 Synthstrom Audible Limited
+ *
+ * This file is part of The Synthstrom Audible Deluge Firmware.
+ *
+ * The Synthstrom Audible Deluge Firmware is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program.
+ * If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "model/midi/message.h"
+#include <array>
+#include <cstdint>
+
+/// Holds messages on their way out of the MIDI DIN port, which at 31250 baud can't keep up with everything we can throw
+/// at it - dense automation going to a MIDI instrument, or MIDI follow feedback, easily saturates it.
+///
+/// While a controller value (CC, pitch bend or aftertouch) is still waiting to go out, a newer value for the same
+/// channel and controller replaces it rather than queueing up behind it. Notes jump ahead of controller values waiting
+/// on other channels, and real-time messages (clock, start, stop...) ahead of everything. Messages on any one channel
+/// still go out in the order they were pushed, and running status leaves out repeated status bytes.
+///
+/// Nothing is popped until it's been released, which MidiEngine does at the moment messages are due - so the timing
+/// the audio engine schedules output for, clock especially, is kept.
+class DINOutputQueue {
+public:
+	struct Stats {
+		uint32_t messagesSent;
+		uint32_t bytesSent;
+		uint32_t bytesSavedByRunningStatus;
+		/// Bytes that would have been sent for controller values that got replaced by newer ones before going out
+		uint32_t bytesSavedByCoalescing;
+		/// Messages that never went out, because the queue was full and the UART's buffer had no room to make any
+		uint32_t messagesDropped;
+	};
+
+	static constexpr int32_t kMaxMessages = 64;
+	static constexpr int32_t kMaxRealtimeMessages = 16;
+	/// Enough room for pop() to write out everything that could be queued
+	static constexpr int32_t kMaxBytes = kMaxMessages * 3 + kMaxRealtimeMessages;
+
+	/// @returns false if there was no room, in which case nothing was queued and the caller needs to pop() some first
+	bool push(MIDIMessage message);
+
+	/// Let everything pushed so far be popped
+	void release() {
+		numReleased_ = numMessages_;
+		numRealtimeReleased_ = numRealtime_;
+	}
+
+	/// Write out as many whole messages as fit in maxBytes, in the order they should be sent.
+	///
+	/// @param includeUnreleased whether to pop messages that haven't been released yet too
+	/// @returns the number of bytes written
+	int32_t pop(uint8_t* out, int32_t maxBytes, bool includeUnreleased = false);
+
+	/// Send the next channel message's status byte even if it's the same as the last one's - because something else
+	/// has been sent in between, or because the line's gone idle and a receiver might have been plugged in since
+	void forgetRunningStatus() { runningStatus_ = 0; }
+
+	[[nodiscard]] bool isEmpty() const { return !numMessages_ && !numRealtime_; }
+	[[nodiscard]] Stats const& getStats() const { return stats_; }
+	void countDropped() { stats_.messagesDropped++; }
+
+private:
+	struct Entry {
+		uint8_t status;
+		uint8_t data1;
+		uint8_t data2;
+	};
+
+	static bool isController(Entry const& entry);
+
+	std::array<Entry, kMaxMessages> messages_;
+	std::array<uint8_t, kMaxRealtimeMessages> realtime_;
+	int32_t numMessages_ = 0;
+	int32_t numReleased_ = 0;
+	int32_t numRealtime_ = 0;
+	int32_t numRealtimeReleased_ = 0;
+	uint8_t runningStatus_ = 0;
+	Stats stats_{};
+};
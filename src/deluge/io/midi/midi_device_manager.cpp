@@ -68,6 +68,8 @@ PLACE_SDRAM_BSS MIDICableUSBUpstream upstreamUSBMIDICable2{1, true, false};
 PLACE_SDRAM_BSS MIDICableUSBUpstream upstreamUSBMIDICable3{2, false, false};
 PLACE_SDRAM_BSS MIDICableDINPorts dinMIDIPorts{};
 
+PLACE_SDRAM_BSS USBMIDISysexOverflow usbSysexOverflow;
+
 uint8_t lowestLastMemberChannelOfLowerZoneOnConnectedOutput = 15;
 uint8_t highestLastMemberChannelOfUpperZoneOnConnectedOutput = 0;
 
@@ -287,6 +289,7 @@ extern "C" void hostedDeviceDetached(int32_t ip, int32_t midiDeviceNum) {
 		}
 		connectedDevice->cable[i] = nullptr;
 	}
+	usbSysexOverflow.forget(connectedDevice->sendQueue);
 	recountSmallestMPEZones();
 }
 
@@ -317,6 +320,7 @@ extern "C" void detachedAsPeripheral(int32_t ip) {
 	for (int32_t i = 0; i <= ports; i++) {
 		connectedUSBMIDIDevices[ip][0].cable[i] = nullptr;
 	}
+	usbSysexOverflow.forget(connectedUSBMIDIDevices[ip][0].sendQueue);
 	upstreamUSBMIDICable1.connectionFlags = 0;
 	upstreamUSBMIDICable2.connectionFlags = 0;
 	upstreamUSBMIDICable3.connectionFlags = 0;
@@ -659,48 +663,41 @@ checkDevice:
 } // namespace MIDIDeviceManager
 
 void ConnectedUSBMIDIDevice::bufferMessage(uint32_t fullMessage) {
-	uint32_t queued = ringBufWriteIdx - ringBufReadIdx;
-	if (queued > 16) {
-		if (!anyUSBSendingStillHappening[0]) {
-			midiEngine.flushUSBMIDIOutput();
-		}
-		queued = ringBufWriteIdx - ringBufReadIdx;
+	if (sendQueue.getNumQueued() > 16 && !anyUSBSendingStillHappening[0]) {
+		midiEngine.flushUSBMIDIOutput();
 	}
-	if (queued > MIDI_SEND_BUFFER_LEN_RING) {
+	if (!sendQueue.push(fullMessage)) {
 		// TODO: show some error message
 		return;
 	}
 
-	sendDataRingBuf[ringBufWriteIdx & MIDI_SEND_RING_MASK] = fullMessage;
-	ringBufWriteIdx++;
+	anythingInUSBOutputBuffer = true;
+}
+
+void ConnectedUSBMIDIDevice::bufferSysexMessage(uint32_t fullMessage) {
+	if (sendQueue.getNumQueued() > 16 && !anyUSBSendingStillHappening[0]) {
+		midiEngine.flushUSBMIDIOutput();
+	}
+	MIDIDeviceManager::usbSysexOverflow.push(sendQueue, fullMessage);
 
 	anythingInUSBOutputBuffer = true;
 }
 
 bool ConnectedUSBMIDIDevice::hasBufferedSendData() {
-	// must be the same unsigned type as ringBufWriteIdx/ringBufReadIdx
-	uint32_t queued = ringBufWriteIdx - ringBufReadIdx;
-	return queued > 0;
+	return !sendQueue.isEmpty();
 }
 
-int ConnectedUSBMIDIDevice::sendBufferSpace() {
-	// must be the same unsigned type as ringBufWriteIdx/ringBufReadIdx
-	uint32_t queued = ringBufWriteIdx - ringBufReadIdx;
-	// each 4-byte MIDI-USB message contains 3 bytes of serial MIDI data
-	return (MIDI_SEND_BUFFER_LEN_RING - queued) * 3;
+int ConnectedUSBMIDIDevice::sendBufferSpace(int32_t cable) {
+	// each 4-byte MIDI-USB message contains 3 bytes of serial MIDI data. Only sysex can overflow, but it's only sysex
+	// that's long enough for anyone to need to ask
+	return MIDIDeviceManager::usbSysexOverflow.getSpace(sendQueue, cable) * 3;
 }
 
-// This tries to read data from the ring buffer, and
+// This tries to read data from the send queue, and
 // moves data into the smaller "dataSendingNow" buffer where
 // it is ready to be used by the hardware driver.
 bool ConnectedUSBMIDIDevice::consumeSendData() {
-	uint32_t queued = ringBufWriteIdx - ringBufReadIdx;
-	if (queued == 0) {
-		return false;
-	}
-
-	int32_t i = 0;
-	uint32_t max_size = MIDI_SEND_BUFFER_LEN_INNER;
+	int32_t max_size = MIDI_SEND_BUFFER_LEN_INNER;
 	if (g_usb_usbmode == USB_HOST) {
 		// many devices do not accept more than 64 bytes of data at a time
 		// likely this can be inferred from the device metadata somehow?
@@ -711,11 +708,12 @@ bool ConnectedUSBMIDIDevice::consumeSendData() {
 		max_size = MIDI_SEND_BUFFER_LEN_INNER_HOST;
 	}
 
-	int32_t to_send = std::min(queued, max_size);
-	for (i = 0; i < to_send; i++) {
-		memcpy(dataSendingNow + (i * 4), &sendDataRingBuf[ringBufReadIdx & MIDI_SEND_RING_MASK], 4);
-		ringBufReadIdx++;
+	uint32_t packets[MIDI_SEND_BUFFER_LEN_INNER];
+	int32_t to_send = sendQueue.pop(packets, max_size);
+	if (to_send == 0) {
+		return false;
 	}
+	memcpy(dataSendingNow, packets, to_send * 4);
 
 	numBytesSendingNow = to_send * 4;
 	return true;
@@ -723,6 +721,9 @@ bool ConnectedUSBMIDIDevice::consumeSendData() {
 
 void ConnectedUSBMIDIDevice::setup() {
 	numBytesSendingNow = 0;
+	// Anything left from whatever was connected here before isn't meant for this device
+	sendQueue.clear();
+	MIDIDeviceManager::usbSysexOverflow.forget(sendQueue);
 	currentlyWaitingToReceive = false;
 	numBytesReceived = 0;
 
@@ -737,9 +738,7 @@ ConnectedUSBMIDIDevice::ConnectedUSBMIDIDevice() {
 	memset(receiveData, 0, sizeof(receiveData));
 	memset(dataSendingNow, 0, MIDI_SEND_BUFFER_LEN_INNER * 4);
 	numBytesSendingNow = 0;
-	memset(sendDataRingBuf, 0, MIDI_SEND_BUFFER_LEN_RING);
-	ringBufWriteIdx = 0;
-	ringBufReadIdx = 0;
+	sendQueue.clear();
 
 	maxPortConnected = 0;
 }
@@ -29,6 +29,7 @@ class Deserializer;
 #include "definitions.h"
 struct MIDICableUSB;
 #endif
+#include "io/midi/usb_send_queue.h"
 
 // size in 32-bit messages
 // NOTE: increasing this even more doesn't work.
@@ -38,10 +39,6 @@ struct MIDICableUSB;
 // haven't seen anything below this yet. Widi bud's can do 3, both do fine at 16 without a hub involved
 #define MIDI_SEND_BUFFER_LEN_INNER_HOST 2
 
-// MUST be an exact power of two
-#define MIDI_SEND_BUFFER_LEN_RING 1024
-#define MIDI_SEND_RING_MASK (MIDI_SEND_BUFFER_LEN_RING - 1)
-
 #ifdef __cplusplus
 /*A ConnectedUSBMIDIDevice is used directly to interface with the USB driver
  * When a ConnectedUSBMIDIDevice has a numMessagesQueued>=MIDI_SEND_BUFFER_LEN and tries to add another,
@@ -63,12 +60,14 @@ public:
 	MIDICableUSB* cable[4]; // If NULL, then no cable is connected here
 	ConnectedUSBMIDIDevice();
 	void bufferMessage(uint32_t fullMessage);
+	/// As bufferMessage(), but for a packet of sysex, which goes through MIDIDeviceManager::usbSysexOverflow
+	void bufferSysexMessage(uint32_t fullMessage);
 	void setup();
 
-	// move data from ring buffer to dataSendingNow, assuming it is free
+	// move data from the send queue to dataSendingNow, assuming it is free
 	bool consumeSendData();
 	bool hasBufferedSendData();
-	int sendBufferSpace();
+	int sendBufferSpace(int32_t cable);
 #else
 // warning - accessed as a C struct from usb driver
 struct ConnectedUSBMIDIDevice {
@@ -89,13 +88,10 @@ struct ConnectedUSBMIDIDevice {
 	// this one, and until we've completed our send
 	uint8_t numBytesSendingNow;
 
-	// This is a ring buffer for data waiting to be sent which doesn't fit the smaller buffer above.
-	// Any code which wants to send midi data would use the writing side and append more messages.
-	// When we are ready to send data on this device, we consume data on the reading side and move it into the
-	// smaller dataSendingNow buffer above.
-	uint32_t sendDataRingBuf[MIDI_SEND_BUFFER_LEN_RING];
-	uint32_t ringBufWriteIdx;
-	uint32_t ringBufReadIdx;
+	// Data waiting to be sent which doesn't fit the smaller buffer above. Any code which wants to send midi data
+	// pushes more messages onto it. When we are ready to send data on this device, we pop some off and move them into
+	// the smaller dataSendingNow buffer above.
+	struct USBMIDISendQueue sendQueue;
 
 	uint8_t maxPortConnected;
 };
@@ -113,6 +109,9 @@ void readAHostedDeviceFromFile(Deserializer& reader);
 void readDevicesFromFile();
 void factoryReset(bool showPopup = true);
 
+/// Holds the rest of any sysex too long for its cable's send queue - see MIDICableUSB::sendSysex()
+extern USBMIDISysexOverflow usbSysexOverflow;
+
 extern MIDICableUSBUpstream upstreamUSBMIDICable1;
 extern MIDICableUSBUpstream upstreamUSBMIDICable2;
 extern MIDICableUSBUpstream upstreamUSBMIDICable3;
@@ -35,6 +35,7 @@
 #include "timers_interrupts/timers_interrupts.h"
 #include "version.h"
 #include <algorithm>
+#include <utility>
 
 extern "C" {
 #include "RZA1/uart/sio_char.h"
@@ -52,7 +53,6 @@ void usb_cstd_usb_task();
 
 extern uint16_t g_usb_peri_connected;
 
-uint8_t stopSendingAfterDeviceNum[USB_NUM_USBIP];
 uint8_t usbDeviceNumBeingSentToNow[USB_NUM_USBIP];
 uint8_t anyUSBSendingStillHappening[USB_NUM_USBIP];
 
@@ -77,6 +77,16 @@ void flushUSBMIDIToHostedDevice(int32_t ip, int32_t d, bool resume = false);
 uint8_t currentDeviceNumWithSendPipe[USB_NUM_USBIP][2] = {
     MAX_NUM_USB_MIDI_DEVICES, MAX_NUM_USB_MIDI_DEVICES}; // One without, and one with, interrupt endpoints
 
+// Which hosted device should get the next transfer - see pickNextUSBMIDIDeviceToSendTo()
+int32_t findNextHostedDeviceToSendTo(int32_t ip) {
+	USBMIDISendQueue const* queues[MAX_NUM_USB_MIDI_DEVICES];
+	for (int32_t d = 0; d < MAX_NUM_USB_MIDI_DEVICES; d++) {
+		ConnectedUSBMIDIDevice* connectedDevice = &connectedUSBMIDIDevices[ip][d];
+		queues[d] = connectedDevice->cable[0] ? &connectedDevice->sendQueue : nullptr;
+	}
+	return pickNextUSBMIDIDeviceToSendTo(queues, MAX_NUM_USB_MIDI_DEVICES, usbDeviceNumBeingSentToNow[ip]);
+}
+
 // We now bypass calling this for successful as peripheral on A1 (see usb_pstd_bemp_pipe_process_rohan_midi())
 void usbSendCompleteAsHost(int32_t ip) {
 
@@ -86,41 +96,16 @@ void usbSendCompleteAsHost(int32_t ip) {
 
 	connectedDevice->numBytesSendingNow = 0; // We just do this instead from caller on A1 (see comment above)
 
-	// check if there was more to send on the same device, then resume sending
-	bool has_more = connectedDevice->consumeSendData();
-	if (has_more) {
-		// TODO: do some cooperative scheduling here. so if there is a flood of data
-		// on connected device 1 and we just want to send a few notes on device 2,
-		// make sure device 2 ges a fair shot now and then
-
-		flushUSBMIDIToHostedDevice(ip, midiDeviceNum, true);
-		return;
-	}
-
-	// If that was the last device we were going to send to, that send's been done, so we can just get out.
-	if (midiDeviceNum == stopSendingAfterDeviceNum[ip]) {
+	// Rather than carrying on with this device until it's got nothing left, move on to the next one with something to
+	// send - so a flood of data to one device can't hold up clock and notes going to the others. Each transfer is
+	// filled just before it goes, so it takes any real-time messages that have come up since.
+	int32_t nextDeviceNum = findNextHostedDeviceToSendTo(ip);
+	if (nextDeviceNum < 0) {
 		anyUSBSendingStillHappening[ip] = 0;
 		return;
 	}
-
-	while (true) {
-		midiDeviceNum++;
-		if (midiDeviceNum >= MAX_NUM_USB_MIDI_DEVICES) {
-			midiDeviceNum -= MAX_NUM_USB_MIDI_DEVICES;
-		}
-		connectedDevice = &connectedUSBMIDIDevices[ip][midiDeviceNum];
-		if (connectedDevice->cable[0] && connectedDevice->numBytesSendingNow) {
-			// If here, we got a connected device, so flush
-			flushUSBMIDIToHostedDevice(ip, midiDeviceNum);
-			return;
-		}
-		if (midiDeviceNum == stopSendingAfterDeviceNum[ip]) { // If reached end of devices and last one got disconnected
-			                                                  // in the interim (very rare)
-			usbDeviceNumBeingSentToNow[ip] = stopSendingAfterDeviceNum[ip];
-			anyUSBSendingStillHappening[ip] = 0;
-			return;
-		}
-	}
+	connectedUSBMIDIDevices[ip][nextDeviceNum].consumeSendData();
+	flushUSBMIDIToHostedDevice(ip, nextDeviceNum, nextDeviceNum == midiDeviceNum);
 }
 
 // We now bypass calling this for successful as peripheral on A1 (see usb_pstd_bemp_pipe_process_rohan_midi())
@@ -221,6 +206,7 @@ MidiEngine::MidiEngine() {
 	numSerialMidiInput = 0;
 	currentlyReceivingSysExSerial = false;
 	midiThru = false;
+	inputLatencyMS = 0;
 	for (auto& midiChannelType : midiFollowChannelType) {
 		midiChannelType.clear();
 	}
@@ -344,78 +330,25 @@ void MidiEngine::flushUSBMIDIOutput() {
 		}
 
 		else if (potentiallyAHost) {
-			// This next bit was written with multiple devices on hubs in mind, but seems to work for a single MIDI
-			// device too
-
-			int32_t midiDeviceNumToSendTo = currentDeviceNumWithSendPipe[ip][0]; // This will do
-			if (midiDeviceNumToSendTo >= MAX_NUM_USB_MIDI_DEVICES) {
-				midiDeviceNumToSendTo = 0; // In case it was set to "none", I think
-			}
-
-			int32_t newStopSendingAfter = midiDeviceNumToSendTo - 1;
-			if (newStopSendingAfter < 0) {
-				newStopSendingAfter += MAX_NUM_USB_MIDI_DEVICES;
-			}
-
-			// Make sure that's on a connected device - it probably would be...
-			while (true) {
-				ConnectedUSBMIDIDevice* connectedDevice = &connectedUSBMIDIDevices[ip][midiDeviceNumToSendTo];
-				if (connectedDevice->cable[0] && connectedDevice->hasBufferedSendData()) {
-					break; // We found a connected one
-				}
-				if (midiDeviceNumToSendTo == newStopSendingAfter) {
-					goto getOut; // If back where we started, none are connected. Could this really happen? Probably.
-				}
-				midiDeviceNumToSendTo++;
-				if (midiDeviceNumToSendTo >= MAX_NUM_USB_MIDI_DEVICES) {
-					midiDeviceNumToSendTo = 0; // Wrap back to start of list
-				}
-			}
-
-			// Stop after a device which we know is connected
-			while (true) {
-				ConnectedUSBMIDIDevice* connectedDevice = &connectedUSBMIDIDevices[ip][newStopSendingAfter];
-
-				if (connectedDevice->cable[0] && connectedDevice->hasBufferedSendData()) {
-					break; // We found a connected one
-				}
-
-				newStopSendingAfter--;
-				if (newStopSendingAfter < 0) {
-					newStopSendingAfter += MAX_NUM_USB_MIDI_DEVICES;
-				}
-			}
-
-			// Copy the buffers for all devices
-			int32_t d = midiDeviceNumToSendTo;
-			while (true) {
-				ConnectedUSBMIDIDevice* connectedDevice = &connectedUSBMIDIDevices[ip][d];
-
-				if (connectedDevice->cable[0]) {
-					connectedDevice->consumeSendData();
-				}
-				if (d == newStopSendingAfter) {
-					break;
-				}
-				d++;
-				if (d >= MAX_NUM_USB_MIDI_DEVICES) {
-					d = 0;
-				}
+			int32_t midiDeviceNumToSendTo = findNextHostedDeviceToSendTo(ip);
+			if (midiDeviceNumToSendTo < 0) {
+				continue;
 			}
 
-			stopSendingAfterDeviceNum[ip] = newStopSendingAfter;
+			// From here on, usbSendCompleteAsHost() takes each device with something to send in turn, until none has
+			connectedUSBMIDIDevices[ip][midiDeviceNumToSendTo].consumeSendData();
 			anyUSBSendingStillHappening[ip] = 1;
 
 			flushUSBMIDIToHostedDevice(ip, midiDeviceNumToSendTo);
 		}
-getOut: {}
 	}
 
 	usbLock = 0;
 }
 
 bool MidiEngine::anythingInOutputBuffer() {
-	return anythingInUSBOutputBuffer || (bool)uartGetTxBufferFullnessByItem(UART_ITEM_MIDI);
+	return anythingInUSBOutputBuffer || (bool)uartGetTxBufferFullnessByItem(UART_ITEM_MIDI)
+	       || !serialMidiOutput.isEmpty();
 }
 
 void MidiEngine::sendNote(MIDISource source, bool on, int32_t note, uint8_t velocity, uint8_t channel, int32_t filter) {
@@ -585,24 +518,89 @@ void MidiEngine::sendUsbMidi(MIDIMessage message, int32_t filter) {
 // Warning - this will sometimes (not always) be called in an ISR
 void MidiEngine::flushMIDI() {
 	flushUSBMIDIOutput();
+	{
+		CriticalSectionGuard guard;
+		// If the line's gone idle, a receiver could have been plugged in since the last status byte
+		if (!uartItems[UART_ITEM_MIDI].txSending) {
+			serialMidiOutput.forgetRunningStatus();
+		}
+		serialMidiOutput.release();
+		refillSerialMidi();
+	}
 	uartFlushIfNotSending(UART_ITEM_MIDI);
 }
 
-void MidiEngine::sendSerialMidi(MIDIMessage message) {
+void MidiEngine::sendOverflowedUSBSysex() {
+	if (MIDIDeviceManager::usbSysexOverflow.isEmpty()) {
+		return;
+	}
+	MIDIDeviceManager::usbSysexOverflow.refill();
+	anythingInUSBOutputBuffer = true;
 
-	uint8_t statusByte = message.channel | (message.statusType << 4);
-	int32_t messageLength = bytesPerStatusMessage(statusByte);
-	bufferMIDIUart(statusByte);
+	// Once a transfer's started, the send-complete interrupt carries on until there's nothing left - but something has
+	// to start it
+	if (!anyUSBSendingStillHappening[0]) {
+		flushUSBMIDIOutput();
+	}
+}
 
-	if (messageLength >= 2) {
-		bufferMIDIUart(message.data1);
+void MidiEngine::sendSerialMidi(MIDIMessage message) {
+	CriticalSectionGuard guard;
+	if (serialMidiOutput.push(message)) {
+		return;
+	}
 
-		if (messageLength == 3) {
-			bufferMIDIUart(message.data2);
+	// Full - so hand over whatever's already been released, ahead of its turn
+	moveSerialMidiToUart(uartGetTxBufferSpace(UART_ITEM_MIDI) - 1, false);
+	while (!serialMidiOutput.push(message)) {
+		// Still full of messages that aren't due yet. Rather than lose this one, send the oldest early, a message at a
+		// time - only as many as it takes to make room
+		if (!moveSerialMidiToUart(std::min<int32_t>(3, uartGetTxBufferSpace(UART_ITEM_MIDI) - 1), true)) {
+			serialMidiOutput.countDropped();
+			return;
 		}
 	}
 }
 
+void MidiEngine::beginSerialSysex() {
+	CriticalSectionGuard guard;
+	moveSerialMidiToUart(uartGetTxBufferSpace(UART_ITEM_MIDI) - 1, false);
+	serialMidiOutput.forgetRunningStatus();
+	sendingSerialSysex = true;
+}
+
+void MidiEngine::endSerialSysex() {
+	{
+		CriticalSectionGuard guard;
+		sendingSerialSysex = false;
+		refillSerialMidi();
+	}
+	uartFlushIfNotSending(UART_ITEM_MIDI);
+}
+
+bool MidiEngine::refillSerialMidi() {
+	CriticalSectionGuard guard;
+	if (sendingSerialSysex) {
+		return false;
+	}
+	int32_t room = kSerialMidiBytesInFlight - uartGetTxBufferFullnessByItem(UART_ITEM_MIDI);
+	return room > 0 && moveSerialMidiToUart(room, false);
+}
+
+int32_t MidiEngine::moveSerialMidiToUart(int32_t maxBytes, bool includeUnreleased) {
+	uint8_t bytes[DINOutputQueue::kMaxBytes];
+	int32_t numBytes = serialMidiOutput.pop(bytes, std::clamp<int32_t>(maxBytes, 0, sizeof(bytes)), includeUnreleased);
+	for (int32_t i = 0; i < numBytes; i++) {
+		bufferMIDIUart(bytes[i]);
+	}
+	return numBytes;
+}
+
+// Called from the UART's TX-finished ISR, so the line can be kept busy between calls to flushMIDI()
+extern "C" uint8_t midiUartTransferEnded() {
+	return midiEngine.refillSerialMidi();
+}
+
 bool MidiEngine::checkIncomingSerialMidi() {
 
 	uint8_t thisSerialByte;
@@ -939,7 +937,9 @@ void MidiEngine::checkIncomingUsbMidi() {
 
 					// Only allowed to setup receive-transfer if not in the process of sending to various devices.
 					// (Wait, still? Was this just because of that insane bug that's now fixed?)
-					if (usbDeviceNumBeingSentToNow[ip] == stopSendingAfterDeviceNum[ip]) {
+					int32_t nextDeviceNumToSendTo = findNextHostedDeviceToSendTo(ip);
+					if (!anyUSBSendingStillHappening[ip] || nextDeviceNumToSendTo < 0
+					    || nextDeviceNumToSendTo == usbDeviceNumBeingSentToNow[ip]) {
 						usbLock = 1;
 						setupUSBHostReceiveTransfer(ip, d);
 						usbLock = 0;
@@ -950,6 +950,56 @@ void MidiEngine::checkIncomingUsbMidi() {
 	}
 }
 
+bool MidiEngine::scheduleInput(MIDICable& cable, uint8_t statusType, uint8_t channel, uint8_t data1, uint8_t data2,
+                               uint32_t const& timer) {
+	// The timestamp is where the SSI DMA was reading from when the message arrived. Everything up to i2sTXBufferPos
+	// has been rendered - that's up to audioSampleTimer - so the gap between the two says which sample was playing then.
+	// If we've been slow enough getting to the message for the DMA to have lapped since, it'll come out a buffer late.
+	uint32_t samplesAheadOfArrival =
+	    ((uint32_t)(AudioEngine::i2sTXBufferPos - timer) >> (2 + NUM_MONO_OUTPUT_CHANNELS_MAGNITUDE))
+	    & (SSI_TX_BUFFER_NUM_SAMPLES - 1);
+	uint32_t timeArrived = AudioEngine::audioSampleTimer - samplesAheadOfArrival;
+	uint32_t time = timeArrived + (uint32_t)inputLatencyMS * kSampleRate / 1000;
+
+	// Anything that's come due has to be played first, so nothing gets overtaken
+	playDueScheduledInput();
+	if (scheduledInput_.isFull()) {
+		playScheduledInput(scheduledInput_.popOldest());
+	}
+
+	// If there's nothing ahead of it and it's already too late to hold it back - the latency must be set shorter than
+	// we're able to render ahead - push() turns it away to be played straight away
+	return scheduledInput_.push(
+	    {
+	        .cable = &cable,
+	        .time = time,
+	        .statusType = statusType,
+	        .channel = channel,
+	        .data1 = data1,
+	        .data2 = data2,
+	    },
+	    AudioEngine::audioSampleTimer);
+}
+
+void MidiEngine::playScheduledInput(ScheduledInputQueue::Entry const& input) {
+	midiMessageReceived(*input.cable, input.statusType, input.channel, input.data1, input.data2);
+}
+
+void MidiEngine::playDueScheduledInput() {
+	while (auto input = scheduledInput_.popDue(AudioEngine::audioSampleTimer)) {
+		playScheduledInput(*input);
+	}
+}
+
+void MidiEngine::stopRenderAtScheduledInput(size_t& numSamples) const {
+	// If it's due already, the playback routine hasn't got to it yet - no use holding the render up for it
+	if (auto timeTilInput = scheduledInput_.timeTilNext(AudioEngine::audioSampleTimer)) {
+		if (*timeTilInput > 0 && std::cmp_less(*timeTilInput, numSamples)) {
+			numSamples = *timeTilInput;
+		}
+	}
+}
+
 #define MISSING_MESSAGE_CHECK 0
 
 #if MISSING_MESSAGE_CHECK
@@ -959,6 +1009,13 @@ bool lastWasNoteOn = false;
 void MidiEngine::midiMessageReceived(MIDICable& cable, uint8_t statusType, uint8_t channel, uint8_t data1,
                                      uint8_t data2, uint32_t* timer) {
 
+	// Channel messages that know when they arrived might need holding back, to be played a fixed time after that - or
+	// behind ones that still are, if the latency has just been turned off
+	if (timer && (inputLatencyMS || !scheduledInput_.isEmpty()) && statusType >= 0x08 && statusType < 0x0F
+	    && scheduleInput(cable, statusType, channel, data1, data2, *timer)) {
+		return;
+	}
+
 	bool shouldDoMidiThruNow = midiThru;
 
 	// Make copies of these, cos we might modify the variables, and we need the originals to do MIDI thru at the end.
@@ -21,6 +21,8 @@
 
 #include "OSLikeStuff/scheduler_api.h"
 #include "definitions_cxx.hpp"
+#include "io/midi/din_output_queue.h"
+#include "io/midi/scheduled_input_queue.h"
 #include "io/midi/learned_midi.h"
 #include "playback/playback_handler.h"
 
@@ -83,6 +85,18 @@ public:
 	void flushMIDI();
 	void sendUsbMidi(MIDIMessage message, int32_t filter);
 	void sendSerialMidi(MIDIMessage message);
+	/// Call before writing sysex to the UART directly. Hands everything released for the DIN port over to the UART
+	/// straight away, rather than kSerialMidiBytesInFlight at a time, so the sysex goes out after what's already due.
+	/// Then until endSerialSysex(), nothing more gets added - so the sysex can be written a bit at a time without
+	/// anything landing in the middle of it. Messages that aren't due yet stay queued, to go out after it at their
+	/// proper time - with their status bytes, as the sysex breaks running status.
+	void beginSerialSysex();
+	void endSerialSysex();
+	/// Top the UART up with released DIN output, up to kSerialMidiBytesInFlight. Safe to call from an ISR.
+	///
+	/// @returns whether anything was added
+	bool refillSerialMidi();
+	[[nodiscard]] DINOutputQueue::Stats const& getSerialMidiStats() const { return serialMidiOutput.getStats(); }
 
 	void sendPGMChange(MIDISource source, int32_t channel, int32_t pgm, int32_t filter);
 	void sendAllNotesOff(MIDISource source, int32_t channel, int32_t filter);
@@ -99,11 +113,18 @@ public:
 	bool anythingInOutputBuffer();
 	void setupUSBHostReceiveTransfer(int32_t ip, int32_t midiDeviceNum);
 	void flushUSBMIDIOutput();
+	/// Move sysex waiting in MIDIDeviceManager::usbSysexOverflow into its send queue as that empties, and keep the
+	/// USB sending it. Main thread only - it pushes to the queues.
+	void sendOverflowedUSBSysex();
 
 	// If bit "16" (actually bit 4) is 1, this is a program change. (Wait, still?)
 	LearnedMIDI globalMIDICommands[kNumGlobalMIDICommands];
 
 	bool midiThru;
+	/// How long after a timestamped channel message (note, CC, bend etc.) arrives over DIN or USB it gets played, in
+	/// ms. Holding every one back by the same amount takes out the jitter of when we happen to poll for it and where
+	/// the audio render window boundaries fall. 0 means no holding back: play it when it's polled.
+	uint8_t inputLatencyMS;
 	LearnedMIDI midiFollowChannelType[kNumMIDIFollowChannelTypesIncludingTracks]; // A, B, C, Track 1-16
 	MIDIFollowFeedbackChannelType midiFollowFeedbackChannelType;                  // NONE, A, B, C, Track, Track + A/B/C
 	uint8_t midiFollowKitRootNote;
@@ -137,10 +158,35 @@ public:
 	/// @param len number of bytes in data
 	void midiSysexReceived(MIDICable& cable, uint8_t* data, int32_t len);
 
+	/// Play any timestamped input that's now due (see inputLatencyMS), by the audio sample clock. Called from the
+	/// playback routine rather than the audio render, so the render never has to act on the messages itself.
+	void playDueScheduledInput();
+
+	/// Make sure the coming audio render window stops short of the next timestamped input that isn't due yet - so it
+	/// starts a window of its own, and as long as playDueScheduledInput() gets called before that window is rendered,
+	/// lands on its exact sample. Only reads the time it's due.
+	///
+	/// @param numSamples The length of the window about to be rendered, shortened if necessary
+	void stopRenderAtScheduledInput(size_t& numSamples) const;
+
 private:
+	ScheduledInputQueue scheduledInput_;
+
+	bool scheduleInput(MIDICable& cable, uint8_t statusType, uint8_t channel, uint8_t data1, uint8_t data2,
+	                   uint32_t const& timer);
+	void playScheduledInput(ScheduledInputQueue::Entry const& input);
+
 	uint8_t serialMidiInput[3];
 	uint8_t numSerialMidiInput;
 
+	/// DIN output waits here rather than in the UART's buffer, so newer controller values can replace it while it does
+	DINOutputQueue serialMidiOutput;
+	/// How far ahead of the line the UART's buffer gets kept - a few ms at 31250 baud, which is as long as anything
+	/// queued behind it, clock included, can be held up
+	static constexpr int32_t kSerialMidiBytesInFlight = 8;
+	int32_t moveSerialMidiToUart(int32_t maxBytes, bool includeUnreleased);
+	bool sendingSerialSysex = false;
+
 	bool currentlyReceivingSysExSerial;
 
 	using EventStackStorage = std::array<MIDISource, 16>;
@@ -0,0 +1,55 @@
+/*
+ * Copyright © 2025 Synthstrom Audible Limited
+ *
+ * This file is part of The Synthstrom Audible Deluge Firmware.
+ *
+ * The Synthstrom Audible Deluge Firmware is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program.
+ * If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "io/midi/scheduled_input_queue.h"
+
+bool ScheduledInputQueue::push(Entry entry, uint32_t now) {
+	if (isEmpty()) {
+		if ((int32_t)(entry.time - now) <= 0) {
+			return false;
+		}
+	}
+	else {
+		// Wait for whatever's ahead
+		uint32_t lastTime = entries_[(writePos_ - 1) & (kSize - 1)].time;
+		if ((int32_t)(entry.time - lastTime) < 0) {
+			entry.time = lastTime;
+		}
+	}
+
+	entries_[writePos_ & (kSize - 1)] = entry;
+	writePos_++;
+	return true;
+}
+
+std::optional<ScheduledInputQueue::Entry> ScheduledInputQueue::popDue(uint32_t now) {
+	if (isEmpty() || (int32_t)(entries_[readPos_ & (kSize - 1)].time - now) > 0) {
+		return std::nullopt;
+	}
+	return popOldest();
+}
+
+ScheduledInputQueue::Entry ScheduledInputQueue::popOldest() {
+	return entries_[readPos_++ & (kSize - 1)];
+}
+
+std::optional<int32_t> ScheduledInputQueue::timeTilNext(uint32_t now) const {
+	if (isEmpty()) {
+		return std::nullopt;
+	}
+	return (int32_t)(entries_[readPos_ & (kSize - 1)].time - now);
+}
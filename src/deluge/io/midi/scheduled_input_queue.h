@@ -0,0 +1,66 @@
+/*
+ * Copyright © 2025 Synthstrom Audible Limited
+ *
+ * This file is part of The Synthstrom Audible Deluge Firmware.
+ *
+ * The Synthstrom Audible Deluge Firmware is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program.
+ * If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <optional>
+
+class MIDICable;
+
+/// Channel messages held back to be played a fixed latency after they arrived (see MidiEngine::inputLatencyMS), in the
+/// order they arrived. A message never overtakes one queued before it: if its own time would come sooner - because it
+/// was read later than it arrived, say - it waits for the one ahead. So a note-off can never get played before its
+/// note-on.
+class ScheduledInputQueue {
+public:
+	struct Entry {
+		MIDICable* cable;
+		/// When to play it, as an AudioEngine::audioSampleTimer value
+		uint32_t time;
+		uint8_t statusType;
+		uint8_t channel;
+		uint8_t data1;
+		uint8_t data2;
+	};
+
+	static constexpr uint32_t kSize = 64;
+
+	/// Anything queued that's due by now must be popped before pushing, so it's played before the new message.
+	///
+	/// @returns false if nothing was queued, because the message was already due with nothing ahead of it - so it
+	/// should be played straight away. Otherwise it's queued, and isFull() must have been checked first.
+	bool push(Entry entry, uint32_t now);
+
+	/// @returns the oldest message if it's due by now
+	std::optional<Entry> popDue(uint32_t now);
+
+	/// @returns the oldest message regardless - for making room when full
+	Entry popOldest();
+
+	/// @returns how many samples until the oldest message is due, if there is one
+	std::optional<int32_t> timeTilNext(uint32_t now) const;
+
+	[[nodiscard]] bool isEmpty() const { return readPos_ == writePos_; }
+	[[nodiscard]] bool isFull() const { return writePos_ - readPos_ >= kSize; }
+
+private:
+	std::array<Entry, kSize> entries_;
+	uint32_t readPos_ = 0;
+	uint32_t writePos_ = 0;
+};
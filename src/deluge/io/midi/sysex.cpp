@@ -18,15 +18,57 @@
  */
 
 #include "io/midi/sysex.h"
+#include "OSLikeStuff/scheduler_api.h"
 #include "hid/display/screensaver.h"
 #include "io/debug/print.h"
 #include "io/midi/midi_device.h"
+#include "io/midi/midi_device_manager.h"
 #include "io/midi/midi_engine.h"
 #include "storage/flash_storage.h"
 #include "util/chainload.h"
 
 #include "util/pack.h"
 
+/// Reply with one message per task: its ID, its TaskStatsSummary numbers 7-bit packed, then its name
+static void sendTaskStats(MIDICable& cable) {
+	uint8_t reply_hdr[] = {0xF0, 0x00, 0x21, 0x7B, 0x01, 0x03, 0x41};
+	uint8_t* reply = midiEngine.sysex_fmt_buffer;
+	memcpy(reply, reply_hdr, sizeof(reply_hdr));
+
+	TaskStatsSummary stats;
+	for (TaskID id = getNextTaskStats(-1, &stats); id >= 0; id = getNextTaskStats(id, &stats)) {
+		uint32_t numbers[] = {stats.timesCalled, stats.deadlineMissesCaused, stats.latencyP50, stats.latencyP99,
+		                      stats.latencyMax,  stats.durationP50,          stats.durationP99, stats.durationMax};
+		int32_t len = sizeof(reply_hdr);
+		reply[len++] = id;
+		len += pack_8bit_to_7bit(reply + len, sizeof(midiEngine.sysex_fmt_buffer) - len, (uint8_t*)numbers,
+		                         sizeof(numbers));
+		for (const char* c = stats.name; *c && len < 128; c++) {
+			reply[len++] = *c & 0x7F;
+		}
+		reply[len++] = 0xF7;
+		cable.sendSysex(reply, len);
+	}
+}
+
+/// Reply with the DIN output queue's DINOutputQueue::Stats numbers, then how many sysex were dropped for want of room
+/// to send them over USB, 7-bit packed
+static void sendMidiOutputStats(MIDICable& cable) {
+	uint8_t reply_hdr[] = {0xF0, 0x00, 0x21, 0x7B, 0x01, 0x03, 0x42};
+	uint8_t* reply = midiEngine.sysex_fmt_buffer;
+	memcpy(reply, reply_hdr, sizeof(reply_hdr));
+
+	DINOutputQueue::Stats const& stats = midiEngine.getSerialMidiStats();
+	uint32_t numbers[] = {stats.messagesSent, stats.bytesSent, stats.bytesSavedByRunningStatus,
+	                      stats.bytesSavedByCoalescing, stats.messagesDropped,
+	                      MIDIDeviceManager::usbSysexOverflow.getNumSysexDropped()};
+	int32_t len = sizeof(reply_hdr);
+	len += pack_8bit_to_7bit(reply + len, sizeof(midiEngine.sysex_fmt_buffer) - len, (uint8_t*)numbers,
+	                         sizeof(numbers));
+	reply[len++] = 0xF7;
+	cable.sendSysex(reply, len);
+}
+
 void Debug::sysexReceived(MIDICable& cable, uint8_t* data, int32_t len) {
 	if (len < 3) {
 		return;
@@ -55,6 +97,19 @@ void Debug::sysexReceived(MIDICable& cable, uint8_t* data, int32_t len) {
 #endif
 		break;
 
+	case 3:
+		sendTaskStats(cable);
+		break;
+
+	case 4:
+		// 1 to choose tasks earliest deadline first, 0 to go back to choosing by priority
+		setEarliestDeadlineFirstScheduling(data[2] == 1);
+		break;
+
+	case 5:
+		sendMidiOutputStats(cable);
+		break;
+
 	default:
 		break;
 	}
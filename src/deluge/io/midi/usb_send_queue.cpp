@@ -0,0 +1,159 @@
+/*
+ * Copyright © 2025 Synthstrom Audible Limited
+ *
+ * This file is part of The Synthstrom Audible Deluge Firmware.
+ *
+ * The Synthstrom Audible Deluge Firmware is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program.
+ * If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "usb_send_queue.h"
+#include <cstring>
+
+static_assert((USB_MIDI_CABLE_QUEUE_LEN & (USB_MIDI_CABLE_QUEUE_LEN - 1)) == 0);
+static_assert((USB_MIDI_REALTIME_QUEUE_LEN & (USB_MIDI_REALTIME_QUEUE_LEN - 1)) == 0);
+static_assert(USB_MIDI_REALTIME_QUEUE_LEN <= 256);
+
+namespace {
+bool isRealtime(uint32_t packet) {
+	// Code index number 0xF is a single byte, which as a status byte from 0xF8 up is a real-time message
+	return (packet & 0x0F) == 0x0F && ((packet >> 8) & 0xFF) >= 0xF8;
+}
+} // namespace
+
+void USBMIDISendQueue::clear() {
+	memset(cableWriteIdx, 0, sizeof(cableWriteIdx));
+	memset(cableReadIdx, 0, sizeof(cableReadIdx));
+	realtimeWriteIdx = 0;
+	realtimeReadIdx = 0;
+	nextCable = 0;
+}
+
+bool USBMIDISendQueue::push(uint32_t packet) {
+	if (isRealtime(packet) && (uint8_t)(realtimeWriteIdx - realtimeReadIdx) < USB_MIDI_REALTIME_QUEUE_LEN) {
+		realtimeQueue[realtimeWriteIdx & (USB_MIDI_REALTIME_QUEUE_LEN - 1)] = packet;
+		realtimeWriteIdx++;
+		return true;
+	}
+
+	// (If the real-time queue is full, the message just takes its place in the cable's queue)
+	int32_t cable = (packet >> 4) & 0x0F;
+	if (cable >= USB_MIDI_NUM_CABLES || getSpace(cable) == 0) {
+		return false;
+	}
+	cableQueue[cable][cableWriteIdx[cable] & (USB_MIDI_CABLE_QUEUE_LEN - 1)] = packet;
+	cableWriteIdx[cable]++;
+	return true;
+}
+
+int32_t USBMIDISendQueue::pop(uint32_t* out, int32_t maxPackets) {
+	int32_t num = 0;
+
+	while (num < maxPackets && hasRealtime()) {
+		out[num++] = realtimeQueue[realtimeReadIdx & (USB_MIDI_REALTIME_QUEUE_LEN - 1)];
+		realtimeReadIdx++;
+	}
+
+	// Then a packet from each cable in turn, until there's no room or nothing left
+	int32_t numCablesFoundEmpty = 0;
+	while (num < maxPackets && numCablesFoundEmpty < USB_MIDI_NUM_CABLES) {
+		int32_t cable = nextCable;
+		nextCable = (nextCable + 1) % USB_MIDI_NUM_CABLES;
+		if (cableWriteIdx[cable] == cableReadIdx[cable]) {
+			numCablesFoundEmpty++;
+			continue;
+		}
+		out[num++] = cableQueue[cable][cableReadIdx[cable] & (USB_MIDI_CABLE_QUEUE_LEN - 1)];
+		cableReadIdx[cable]++;
+		numCablesFoundEmpty = 0;
+	}
+
+	return num;
+}
+
+bool USBMIDISendQueue::isEmpty() const {
+	return getNumQueued() == 0;
+}
+
+int32_t USBMIDISendQueue::getNumQueued() const {
+	int32_t num = (uint8_t)(realtimeWriteIdx - realtimeReadIdx);
+	for (int32_t cable = 0; cable < USB_MIDI_NUM_CABLES; cable++) {
+		num += (uint16_t)(cableWriteIdx[cable] - cableReadIdx[cable]);
+	}
+	return num;
+}
+
+int32_t USBMIDISendQueue::getSpace(int32_t cable) const {
+	return USB_MIDI_CABLE_QUEUE_LEN - (uint16_t)(cableWriteIdx[cable] - cableReadIdx[cable]);
+}
+
+int32_t pickNextUSBMIDIDeviceToSendTo(USBMIDISendQueue const* const* queues, int32_t numDevices, int32_t lastDevice) {
+	int32_t firstWithAnything = -1;
+	for (int32_t i = 1; i <= numDevices; i++) {
+		int32_t d = (lastDevice + i) % numDevices;
+		USBMIDISendQueue const* queue = queues[d];
+		if (!queue) {
+			continue;
+		}
+		if (queue->hasRealtime()) {
+			return d;
+		}
+		if (firstWithAnything < 0 && !queue->isEmpty()) {
+			firstWithAnything = d;
+		}
+	}
+	return firstWithAnything;
+}
+
+int32_t USBMIDISysexOverflow::getSpace(USBMIDISendQueue const& queue, int32_t cable) const {
+	if (isEmpty()) {
+		return queue.getSpace(cable) + kMaxPackets;
+	}
+	// Anything more for the cable that's waiting has to wait behind it
+	if (isWaitingFor(queue, cable)) {
+		return kMaxPackets - (writePos_ - readPos_);
+	}
+	return queue.getSpace(cable);
+}
+
+void USBMIDISysexOverflow::push(USBMIDISendQueue& queue, uint32_t packet) {
+	int32_t cable = (packet >> 4) & 0x0F;
+	if (!isWaitingFor(queue, cable) && queue.push(packet)) {
+		return;
+	}
+
+	if (isEmpty()) {
+		queue_ = &queue;
+		cable_ = cable;
+		readPos_ = 0;
+		writePos_ = 0;
+	}
+	else if (writePos_ == kMaxPackets) {
+		// Shuffle what's still waiting back to the start, to make room at the end
+		memmove(packets_, packets_ + readPos_, (writePos_ - readPos_) * sizeof(uint32_t));
+		writePos_ -= readPos_;
+		readPos_ = 0;
+	}
+	packets_[writePos_++] = packet;
+}
+
+bool USBMIDISysexOverflow::refill() {
+	while (!isEmpty() && queue_->push(packets_[readPos_])) {
+		readPos_++;
+	}
+	return !isEmpty();
+}
+
+void USBMIDISysexOverflow::forget(USBMIDISendQueue const& queue) {
+	if (queue_ == &queue) {
+		readPos_ = writePos_;
+	}
+}
@@ -0,0 +1,126 @@
+/*
+ * Copyright © 2025 Synthstrom Audible Limited
+ *
+ * This file is part of The Synthstrom Audible Deluge Firmware.
+ *
+ * The Synthstrom Audible Deluge Firmware is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program.
+ * If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+// Cables (virtual ports) we send to. The cable number nibble of a USB MIDI event packet allows for 16, but we
+// only ever use 3 as a peripheral, and just the first as a host
+#define USB_MIDI_NUM_CABLES 3
+
+// Event packets each cable's queue holds. MUST be an exact power of two. Enough for the sysex display mirror, which
+// waits for 512 bytes of room before sending a frame. Longer sysex - replies to sysex file reads run to about 820
+// packets (a kReadBlockMax block, packed 7 bits to the byte) - overflows into the one USBMIDISysexOverflow, rather
+// than every cable's queue being made big enough for it. Every connected device has a queue for each cable, so this
+// costs MAX_NUM_USB_MIDI_DEVICES * USB_MIDI_NUM_CABLES * 4 bytes per packet - 18kB, plus 4kB of overflow, against the
+// 24kB that each device's 1024-packet ring buffer took before.
+#define USB_MIDI_CABLE_QUEUE_LEN 256
+
+// MUST be an exact power of two, and no more than 256
+#define USB_MIDI_REALTIME_QUEUE_LEN 16
+
+/* The USB MIDI event packets waiting to be sent to one connected device.
+ *
+ * Each cable gets its own queue, and transfers take a packet from each cable with anything waiting in turn - so a
+ * cable with a lot queued up, like the one the sysex display mirror is streaming frames to, can't hold up the notes on
+ * the others. (Every packet is 4 bytes, so that round robin is as fair as a deficit-based one would be.) Real-time
+ * messages - clock, start, stop, continue - get their own queue, and go at the start of the next transfer ahead of
+ * everything.
+ *
+ * Packets are pushed from the main thread and popped from the USB send-complete ISR, so each queue has just the one
+ * writer and the one reader. Accessed as a C struct from the USB driver, as part of ConnectedUSBMIDIDevice.
+ */
+#ifdef __cplusplus
+class USBMIDISendQueue {
+public:
+	void clear();
+
+	/// @returns false if the packet's cable's queue was full, so the packet has been dropped
+	bool push(uint32_t packet);
+
+	/// Take up to maxPackets packets for the next transfer. @returns how many were taken
+	int32_t pop(uint32_t* out, int32_t maxPackets);
+
+	[[nodiscard]] bool isEmpty() const;
+	[[nodiscard]] bool hasRealtime() const { return realtimeWriteIdx != realtimeReadIdx; }
+	[[nodiscard]] int32_t getNumQueued() const;
+	/// How many more packets cable's queue can take - so senders of long sysex can hold off until there's room
+	[[nodiscard]] int32_t getSpace(int32_t cable) const;
+#else
+struct USBMIDISendQueue {
+#endif
+	uint32_t cableQueue[USB_MIDI_NUM_CABLES][USB_MIDI_CABLE_QUEUE_LEN];
+	uint32_t realtimeQueue[USB_MIDI_REALTIME_QUEUE_LEN];
+	uint16_t cableWriteIdx[USB_MIDI_NUM_CABLES];
+	uint16_t cableReadIdx[USB_MIDI_NUM_CABLES];
+	uint8_t realtimeWriteIdx;
+	uint8_t realtimeReadIdx;
+	// The cable whose turn it is to have a packet taken next
+	uint8_t nextCable;
+};
+
+#ifdef __cplusplus
+/// Pick which of a host's connected devices gets the next transfer, given the one that got the last. Those with
+/// real-time messages waiting come first, then the rest take turns, one transfer each.
+///
+/// @param queues Each device's send queue, or nullptr for one that's not connected or can't be sent to
+/// @returns The index of the chosen device, or -1 if none has anything to send
+int32_t pickNextUSBMIDIDeviceToSendTo(USBMIDISendQueue const* const* queues, int32_t numDevices, int32_t lastDevice);
+
+/// Where a sysex too long for its cable's send queue waits for the rest of it to fit. Rather than its sender waiting
+/// for the queue to empty, the packets that don't fit get kept here, and refill() moves them into the queue as it
+/// empties. There's just the one, as it's only long replies to sysex file reads that need it - so a sysex for any other
+/// cable has to fit its queue while this one's in use.
+///
+/// Like the queue it feeds, only to be used from the main thread - the USB send-complete ISR only ever pops.
+class USBMIDISysexOverflow {
+public:
+	static constexpr int32_t kMaxPackets = 1024;
+
+	/// @returns how many packets of sysex for queue's cable could be pushed right now
+	[[nodiscard]] int32_t getSpace(USBMIDISendQueue const& queue, int32_t cable) const;
+
+	/// Push a packet of sysex to queue, or keep it here if it has to wait. Check getSpace() for the whole sysex first,
+	/// so none of it gets pushed unless all of it can be.
+	void push(USBMIDISendQueue& queue, uint32_t packet);
+
+	/// Move as many waiting packets into their queue as it has room for. @returns whether any are still waiting
+	bool refill();
+
+	/// Drop anything waiting for queue, as what it was for isn't connected any more
+	void forget(USBMIDISendQueue const& queue);
+
+	[[nodiscard]] bool isEmpty() const { return readPos_ == writePos_; }
+
+	/// For sysex that never got queued at all, because there was no room for it
+	void countDropped() { numSysexDropped_++; }
+	[[nodiscard]] uint32_t getNumSysexDropped() const { return numSysexDropped_; }
+
+private:
+	[[nodiscard]] bool isWaitingFor(USBMIDISendQueue const& queue, int32_t cable) const {
+		return !isEmpty() && queue_ == &queue && cable_ == cable;
+	}
+
+	USBMIDISendQueue* queue_ = nullptr;
+	int32_t cable_ = 0;
+	uint32_t packets_[kMaxPackets];
+	int32_t readPos_ = 0;
+	int32_t writePos_ = 0;
+	uint32_t numSysexDropped_ = 0;
+};
+#endif
@@ -109,6 +109,25 @@ void Action::deleteAllConsequences(int32_t whichQueueActionIn, Song* song, bool
 	}
 }
 
+// Bytes of RAM this Action and everything it holds on to take up
+uint32_t Action::getMemoryUsage() {
+	uint32_t bytes = GeneralMemoryAllocator::get().getAllocatedSize(this);
+	if (clipStates) {
+		bytes += GeneralMemoryAllocator::get().getAllocatedSize(clipStates);
+	}
+	for (Consequence* thisCons = firstConsequence; thisCons; thisCons = thisCons->next) {
+		bytes += thisCons->getMemoryUsage();
+	}
+	return bytes;
+}
+
+void Action::compressConsequences() {
+	for (Consequence* thisCons = firstConsequence; thisCons; thisCons = thisCons->next) {
+		AudioEngine::routineWithClusterLoading();
+		thisCons->compress();
+	}
+}
+
 void Action::addConsequence(Consequence* consequence) {
 	consequence->next = firstConsequence;
 	firstConsequence = consequence;
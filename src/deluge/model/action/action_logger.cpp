@@ -20,6 +20,7 @@
 #include "gui/ui/keyboard/keyboard_screen.h"
 #include "gui/ui/load/load_pattern_ui.h"
 #include "gui/ui/ui.h"
+#include "gui/ui_timer_manager.h"
 #include "gui/views/arranger_view.h"
 #include "gui/views/audio_clip_view.h"
 #include "gui/views/automation_view.h"
@@ -42,6 +43,7 @@
 #include "model/consequence/consequence_swing_change.h"
 #include "model/consequence/consequence_tempo_change.h"
 #include "model/instrument/kit.h"
+#include "model/settings/runtime_feature_settings.h"
 #include "model/song/clip_iterators.h"
 #include "model/song/song.h"
 #include "playback/mode/arrangement.h"
@@ -138,7 +140,7 @@ Action* ActionLogger::getNewAction(ActionType newActionType, ActionAddition addT
 
 		// Make sure we close off any existing action
 		if (firstAction[BEFORE]) {
-			firstAction[BEFORE]->openForAdditions = false;
+			closeLastAction();
 		}
 
 		// And make a new one
@@ -752,14 +754,23 @@ currentClipSwitchedOver:
 
 void ActionLogger::closeAction(ActionType actionType) {
 	if (firstAction[BEFORE] && firstAction[BEFORE]->type == actionType) {
-		firstAction[BEFORE]->openForAdditions = false;
+		closeLastAction();
 	}
 }
 
 void ActionLogger::closeActionUnlessCreatedJustNow(ActionType actionType) {
 	if (firstAction[BEFORE] && firstAction[BEFORE]->type == actionType
 	    && firstAction[BEFORE]->creationTime != AudioEngine::audioSampleTimer) {
-		firstAction[BEFORE]->openForAdditions = false;
+		closeLastAction();
+	}
+}
+
+// Once an Action's finished with, the undo history might have grown past its RAM budget - but that gets seen to from
+// the UI timer, rather than holding up whatever edit is happening now
+void ActionLogger::closeLastAction() {
+	firstAction[BEFORE]->openForAdditions = false;
+	if (getMemoryBudget()) {
+		uiTimerManager.setTimer(TimerName::UNDO_MEMORY_BUDGET, 0);
 	}
 }
 
@@ -768,6 +779,86 @@ void ActionLogger::deleteAllLogs() {
 	deleteLog(AFTER);
 }
 
+uint32_t ActionLogger::getMemoryBudget() {
+	switch (runtimeFeatureSettings.get(RuntimeFeatureSettingType::UndoMemoryLimit)) {
+	case RuntimeFeatureStateUndoMemoryLimit::UndoMemory512K:
+		return 512 << 10;
+	case RuntimeFeatureStateUndoMemoryLimit::UndoMemory2M:
+		return 2 << 20;
+	case RuntimeFeatureStateUndoMemoryLimit::UndoMemory8M:
+		return 8 << 20;
+	default:
+		return 0;
+	}
+}
+
+// Keeps the undo history within the RAM budget set in the community features menu, so a long editing session doesn't
+// gradually eat into the memory available for caching samples. Once over budget, every Action but the newest gets its
+// snapshots packed down - and if that's still not enough, the oldest Actions go. Called from the UI timer, some time
+// after an Action gets closed.
+void ActionLogger::enforceMemoryBudget() {
+	uint32_t budget = getMemoryBudget();
+	if (!budget || !firstAction[BEFORE]) {
+		return;
+	}
+
+	uint32_t bytesUsed = 0;
+	for (Action* action = firstAction[BEFORE]; action; action = action->nextAction) {
+		bytesUsed += action->getMemoryUsage();
+	}
+	if (bytesUsed <= budget) {
+		return;
+	}
+
+	// The newest Action is the most likely to get undone, and might still be open for additions, so leave that one be
+	for (Action* action = firstAction[BEFORE]->nextAction; action; action = action->nextAction) {
+		action->compressConsequences();
+	}
+
+	// Then keep as many of the newest Actions as fit, and discard the rest
+	bytesUsed = firstAction[BEFORE]->getMemoryUsage();
+	Action** prevPointer = &firstAction[BEFORE]->nextAction;
+	while (*prevPointer) {
+		bytesUsed += (*prevPointer)->getMemoryUsage();
+		if (bytesUsed > budget) {
+			break;
+		}
+		prevPointer = &(*prevPointer)->nextAction;
+	}
+
+	int32_t numDiscarded = 0;
+	while (*prevPointer) {
+		Action* toDelete = *prevPointer;
+		*prevPointer = toDelete->nextAction;
+
+		toDelete->prepareForDestruction(BEFORE, currentSong);
+		toDelete->~Action();
+		delugeDealloc(toDelete);
+		numDiscarded++;
+	}
+	numActionsDiscarded += numDiscarded;
+
+#if ENABLE_TEXT_OUTPUT
+	UndoMemoryStats stats = getMemoryStats();
+	D_PRINTLN("Undo history over %d KB budget - compressed it, and discarded %d oldest actions. Now %d KB in %d "
+	          "actions, %d discarded since boot",
+	          budget >> 10, numDiscarded, stats.bytesUsed >> 10, stats.numActions, stats.numActionsDiscarded);
+#endif
+}
+
+UndoMemoryStats ActionLogger::getMemoryStats() {
+	UndoMemoryStats stats{};
+	stats.bytesBudget = getMemoryBudget();
+	stats.numActionsDiscarded = numActionsDiscarded;
+	for (int32_t time = BEFORE; time <= AFTER; time++) {
+		for (Action* action = firstAction[time]; action; action = action->nextAction) {
+			stats.bytesUsed += action->getMemoryUsage();
+			stats.numActions++;
+		}
+	}
+	return stats;
+}
+
 void ActionLogger::deleteLog(int32_t time) {
 	while (firstAction[time]) {
 		Action* toDelete = firstAction[time];
@@ -26,6 +26,14 @@ class ParamCollection;
 class Sound;
 class ModelStack;
 
+/// How much RAM the undo history is taking up
+struct UndoMemoryStats {
+	uint32_t bytesUsed;
+	uint32_t bytesBudget; // 0 if unlimited
+	int32_t numActions;
+	int32_t numActionsDiscarded; // To stay within the budget, since boot
+};
+
 enum class ActionAddition {
 	NOT_ALLOWED,
 	ALLOWED,
@@ -56,6 +64,8 @@ public:
 	bool undoJustOneConsequencePerNoteRow(ModelStack* modelStack);
 	bool allowedToDoReversion();
 	void notifyClipRecordingAborted(Clip* clip);
+	UndoMemoryStats getMemoryStats();
+	void enforceMemoryBudget();
 
 	Action* firstAction[2];
 
@@ -63,6 +73,10 @@ private:
 	void revertAction(Action* action, bool updateVisually, bool doNavigation, TimeType time);
 	void deleteLastActionIfEmpty();
 	void deleteLastAction();
+	void closeLastAction();
+	uint32_t getMemoryBudget();
+
+	int32_t numActionsDiscarded = 0;
 };
 
 extern ActionLogger actionLogger;
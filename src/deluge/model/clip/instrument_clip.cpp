@@ -389,6 +389,7 @@ void InstrumentClip::setPos(ModelStackWithTimelineCounter* modelStack, int32_t n
 
 	for (int32_t i = 0; i < noteRows.getNumElements(); i++) {
 		NoteRow* thisNoteRow = noteRows.getElement(i);
+		thisNoteRow->ticksSinceProcessed = 0;
 
 		// This function is "supposed" to call setPosForParamManagers() on this InstrumentClip, but instead, we'll do
 		// our own thing here, so we only have to iterate through NoteRows once.
@@ -706,12 +707,14 @@ void InstrumentClip::processCurrentPos(ModelStackWithTimelineCounter* modelStack
 		// Ok, time to do some ticks
 
 		// We need to at least come back when the Clip wraps
+		int32_t ticksTilWrap;
 		if (lastProcessedPos && currentlyPlayingReversed) {
-			ticksTilNextNoteRowEvent = lastProcessedPos;
+			ticksTilWrap = lastProcessedPos;
 		}
 		else {
-			ticksTilNextNoteRowEvent = loopLength - lastProcessedPos;
+			ticksTilWrap = loopLength - lastProcessedPos;
 		}
+		ticksTilNextNoteRowEvent = ticksTilWrap;
 
 		static PendingNoteOnList pendingNoteOnList; // Making this static, which it really should have always been,
 		                                            // actually didn't help max stack usage at all somehow...
@@ -720,13 +723,29 @@ void InstrumentClip::processCurrentPos(ModelStackWithTimelineCounter* modelStack
 		for (int32_t i = 0; i < noteRows.getNumElements(); i++) {
 			NoteRow* thisNoteRow = noteRows.getElement(i);
 
+			thisNoteRow->ticksSinceProcessed += noteRowsNumTicksBehindClip;
+			thisNoteRow->ticksTilNextEvent -= noteRowsNumTicksBehindClip;
+
+			// Most NoteRows in a big Kit have nothing happening on any given tick - those can wait until they do.
+			// NoteRows with their own play-pos get moved along with the Clip's events though, so always see to them
+			if (thisNoteRow->ticksTilNextEvent > 0 && !thisNoteRow->hasIndependentPlayPos()) {
+				if (thisNoteRow->ticksTilNextEvent < ticksTilNextNoteRowEvent) {
+					ticksTilNextNoteRowEvent = thisNoteRow->ticksTilNextEvent;
+				}
+				continue;
+			}
+
 			ModelStackWithNoteRow* modelStackWithNoteRow =
 			    modelStack->addNoteRow(getNoteRowId(thisNoteRow, i), thisNoteRow);
 
-			int32_t noteRowTicksTilNextEvent =
-			    thisNoteRow->processCurrentPos(modelStackWithNoteRow, noteRowsNumTicksBehindClip, &pendingNoteOnList);
-			if (noteRowTicksTilNextEvent < ticksTilNextNoteRowEvent) {
-				ticksTilNextNoteRowEvent = noteRowTicksTilNextEvent;
+			int32_t noteRowTicksTilNextEvent = thisNoteRow->processCurrentPos(
+			    modelStackWithNoteRow, thisNoteRow->ticksSinceProcessed, &pendingNoteOnList);
+
+			// Come back at the wrap regardless, same as for the Clip as a whole
+			thisNoteRow->ticksTilNextEvent = std::min(noteRowTicksTilNextEvent, ticksTilWrap);
+			thisNoteRow->ticksSinceProcessed = 0;
+			if (thisNoteRow->ticksTilNextEvent < ticksTilNextNoteRowEvent) {
+				ticksTilNextNoteRowEvent = thisNoteRow->ticksTilNextEvent;
 			}
 		}
 
@@ -4400,6 +4419,11 @@ returnNull:
 
 void InstrumentClip::expectEvent() {
 	ticksTilNextNoteRowEvent = 0;
+
+	// Whatever changed could be on any NoteRow, so they all get looked at next time
+	for (int32_t i = 0; i < noteRows.getNumElements(); i++) {
+		noteRows.getElement(i)->ticksTilNextEvent = 0;
+	}
 	Clip::expectEvent();
 }
 
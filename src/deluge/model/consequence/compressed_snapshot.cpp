@@ -0,0 +1,284 @@
+/*
+ * Copyright © 2025 Synthstrom Audible Limited
+ *
+ * This file is part of The Synthstrom Audible Deluge Firmware.
+ *
+ * The Synthstrom Audible Deluge Firmware is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program.
+ * If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "model/consequence/compressed_snapshot.h"
+#include "memory/general_memory_allocator.h"
+#include "model/note/note.h"
+#include "model/note/note_vector.h"
+#include "modulation/params/param_node.h"
+#include "modulation/params/param_node_vector.h"
+
+namespace {
+
+// Which of a Note's values differ from the previous Note's, and so follow its position and length
+enum NoteChangeFlags : uint8_t {
+	VELOCITY_CHANGED = 1 << 0,
+	PROBABILITY_CHANGED = 1 << 1,
+	ITERANCE_CHANGED = 1 << 2,
+	FILL_CHANGED = 1 << 3,
+	LIFT_CHANGED = 1 << 4,
+};
+
+// The values we diff each Note against - those of the previous one
+struct PreviousNote {
+	int32_t pos = 0;
+	uint8_t velocity = 0;
+	uint8_t probability = 0;
+	Iterance iterance{};
+	uint8_t fill = 0;
+	uint8_t lift = 0;
+
+	void set(Note const* note) {
+		pos = note->pos;
+		velocity = note->velocity;
+		probability = note->probability;
+		iterance = note->iterance;
+		fill = note->fill;
+		lift = note->lift;
+	}
+};
+
+// Writes variable-length integers - or with no output, just counts how many bytes they'd take, so we can allocate
+// exactly the right amount before writing for real
+struct Writer {
+	uint8_t* out;
+	uint32_t numBytes = 0;
+
+	void writeByte(uint8_t byte) {
+		if (out) {
+			out[numBytes] = byte;
+		}
+		numBytes++;
+	}
+
+	void writeUnsigned(uint64_t value) {
+		while (value >= 0x80) {
+			writeByte((uint8_t)value | 0x80);
+			value >>= 7;
+		}
+		writeByte(value);
+	}
+
+	// Zigzag-encoded, so small negative differences stay small too
+	void writeSigned(int32_t value) { writeUnsigned(((uint32_t)value << 1) ^ (uint32_t)(value >> 31)); }
+};
+
+struct Reader {
+	uint8_t const* in;
+
+	uint8_t readByte() { return *in++; }
+
+	uint64_t readUnsigned() {
+		uint64_t value = 0;
+		int32_t shift = 0;
+		uint8_t byte;
+		do {
+			byte = readByte();
+			value |= (uint64_t)(byte & 0x7F) << shift;
+			shift += 7;
+		} while (byte & 0x80);
+		return value;
+	}
+
+	int32_t readSigned() {
+		uint32_t value = readUnsigned();
+		return (int32_t)(value >> 1) ^ -(int32_t)(value & 1);
+	}
+};
+
+void writeNotes(Writer& writer, NoteVector* notes) {
+	PreviousNote previous;
+	for (int32_t i = 0; i < notes->getNumElements(); i++) {
+		Note* note = notes->getElement(i);
+
+		uint8_t flags = 0;
+		if (note->velocity != previous.velocity) {
+			flags |= VELOCITY_CHANGED;
+		}
+		if (note->probability != previous.probability) {
+			flags |= PROBABILITY_CHANGED;
+		}
+		if (!(note->iterance == previous.iterance)) {
+			flags |= ITERANCE_CHANGED;
+		}
+		if (note->fill != previous.fill) {
+			flags |= FILL_CHANGED;
+		}
+		if (note->lift != previous.lift) {
+			flags |= LIFT_CHANGED;
+		}
+
+		// Notes are in order, so the position only ever goes up
+		writer.writeUnsigned((uint32_t)note->pos - (uint32_t)previous.pos);
+		writer.writeUnsigned((uint32_t)note->length);
+		writer.writeByte(flags);
+		if (flags & VELOCITY_CHANGED) {
+			writer.writeByte(note->velocity);
+		}
+		if (flags & PROBABILITY_CHANGED) {
+			writer.writeByte(note->probability);
+		}
+		if (flags & ITERANCE_CHANGED) {
+			writer.writeByte(note->iterance.divisor);
+			writer.writeByte(note->iterance.iteranceStep.to_ulong());
+		}
+		if (flags & FILL_CHANGED) {
+			writer.writeByte(note->fill);
+		}
+		if (flags & LIFT_CHANGED) {
+			writer.writeByte(note->lift);
+		}
+
+		previous.set(note);
+	}
+}
+
+void writeParamNodes(Writer& writer, ParamNodeVector* nodes) {
+	ParamNode previous{};
+	for (int32_t i = 0; i < nodes->getNumElements(); i++) {
+		ParamNode* node = nodes->getElement(i);
+
+		// Nodes are in order too - and the interpolation flag can ride along in the bottom bit of the position
+		writer.writeUnsigned((uint64_t)((uint32_t)node->pos - (uint32_t)previous.pos) << 1 | node->interpolated);
+		writer.writeSigned((int32_t)((uint32_t)node->value - (uint32_t)previous.value));
+
+		previous = *node;
+	}
+}
+
+} // namespace
+
+bool CompressedSnapshot::compressNotes(NoteVector* notes) {
+	Writer counter{nullptr};
+	writeNotes(counter, notes);
+
+	if (counter.numBytes) {
+		uint8_t* newData = (uint8_t*)GeneralMemoryAllocator::get().allocLowSpeed(counter.numBytes);
+		if (!newData) {
+			return false;
+		}
+		clear();
+		data = newData;
+		Writer writer{data};
+		writeNotes(writer, notes);
+	}
+	else {
+		clear();
+	}
+
+	numElements = notes->getNumElements();
+	compressed = true;
+	notes->empty();
+	return true;
+}
+
+Error CompressedSnapshot::decompressNotes(NoteVector* notes) {
+	if (numElements) {
+		Error error = notes->insertAtIndex(0, numElements);
+		if (error != Error::NONE) {
+			return error;
+		}
+
+		Reader reader{data};
+		PreviousNote previous;
+		for (int32_t i = 0; i < numElements; i++) {
+			Note* note = notes->getElement(i);
+
+			note->pos = previous.pos + (uint32_t)reader.readUnsigned();
+			note->length = (uint32_t)reader.readUnsigned();
+			uint8_t flags = reader.readByte();
+			note->velocity = (flags & VELOCITY_CHANGED) ? reader.readByte() : previous.velocity;
+			note->probability = (flags & PROBABILITY_CHANGED) ? reader.readByte() : previous.probability;
+			if (flags & ITERANCE_CHANGED) {
+				note->iterance.divisor = reader.readByte();
+				note->iterance.iteranceStep = reader.readByte();
+			}
+			else {
+				note->iterance = previous.iterance;
+			}
+			note->fill = (flags & FILL_CHANGED) ? reader.readByte() : previous.fill;
+			note->lift = (flags & LIFT_CHANGED) ? reader.readByte() : previous.lift;
+
+			previous.set(note);
+		}
+	}
+
+	clear();
+	return Error::NONE;
+}
+
+bool CompressedSnapshot::compressParamNodes(ParamNodeVector* nodes) {
+	Writer counter{nullptr};
+	writeParamNodes(counter, nodes);
+
+	if (counter.numBytes) {
+		uint8_t* newData = (uint8_t*)GeneralMemoryAllocator::get().allocLowSpeed(counter.numBytes);
+		if (!newData) {
+			return false;
+		}
+		clear();
+		data = newData;
+		Writer writer{data};
+		writeParamNodes(writer, nodes);
+	}
+	else {
+		clear();
+	}
+
+	numElements = nodes->getNumElements();
+	compressed = true;
+	nodes->empty();
+	return true;
+}
+
+Error CompressedSnapshot::decompressParamNodes(ParamNodeVector* nodes) {
+	if (numElements) {
+		Error error = nodes->insertAtIndex(0, numElements);
+		if (error != Error::NONE) {
+			return error;
+		}
+
+		Reader reader{data};
+		ParamNode previous{};
+		for (int32_t i = 0; i < numElements; i++) {
+			ParamNode* node = nodes->getElement(i);
+
+			uint64_t posAndInterpolated = reader.readUnsigned();
+			node->pos = previous.pos + (uint32_t)(posAndInterpolated >> 1);
+			node->interpolated = posAndInterpolated & 1;
+			node->value = (int32_t)((uint32_t)previous.value + (uint32_t)reader.readSigned());
+
+			previous = *node;
+		}
+	}
+
+	clear();
+	return Error::NONE;
+}
+
+uint32_t CompressedSnapshot::getMemoryUsage() {
+	return data ? GeneralMemoryAllocator::get().getAllocatedSize(data) : 0;
+}
+
+void CompressedSnapshot::clear() {
+	if (data) {
+		delugeDealloc(data);
+		data = nullptr;
+	}
+	numElements = 0;
+	compressed = false;
+}
@@ -0,0 +1,55 @@
+/*
+ * Copyright © 2025 Synthstrom Audible Limited
+ *
+ * This file is part of The Synthstrom Audible Deluge Firmware.
+ *
+ * The Synthstrom Audible Deluge Firmware is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program.
+ * If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "definitions_cxx.hpp"
+#include <cstdint>
+
+class NoteVector;
+class ParamNodeVector;
+
+/// A snapshot of a NoteVector or ParamNodeVector, packed down for keeping in the undo history. Each Note or ParamNode
+/// is stored as its difference from the one before, in variable-length integers - so the ascending positions, and the
+/// velocities, probabilities etc. which mostly repeat from one Note to the next, take a byte or so each rather than the
+/// full width of the struct.
+class CompressedSnapshot {
+public:
+	CompressedSnapshot() = default;
+	CompressedSnapshot(CompressedSnapshot const&) = delete;
+	CompressedSnapshot& operator=(CompressedSnapshot const&) = delete;
+	~CompressedSnapshot() { clear(); }
+
+	/// Packs the Notes down. If successful, empties the NoteVector and returns true. If there's no RAM to compress
+	/// into, leaves everything as it was and returns false.
+	bool compressNotes(NoteVector* notes);
+	/// Unpacks into the supplied (empty) NoteVector, and empties the snapshot.
+	Error decompressNotes(NoteVector* notes);
+
+	bool compressParamNodes(ParamNodeVector* nodes);
+	Error decompressParamNodes(ParamNodeVector* nodes);
+
+	bool holdsData() { return compressed; }
+	/// Bytes of RAM taken up by the packed data.
+	uint32_t getMemoryUsage();
+	void clear();
+
+private:
+	uint8_t* data = nullptr;
+	int32_t numElements = 0;
+	bool compressed = false;
+};
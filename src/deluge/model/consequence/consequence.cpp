@@ -16,6 +16,7 @@
  */
 
 #include "model/consequence/consequence.h"
+#include "memory/general_memory_allocator.h"
 
 Consequence::Consequence() {
 	type = 0;
@@ -24,3 +25,7 @@ Consequence::Consequence() {
 Consequence::~Consequence() {
 	// TODO Auto-generated destructor stub
 }
+
+uint32_t Consequence::getMemoryUsage() {
+	return GeneralMemoryAllocator::get().getAllocatedSize(this);
+}
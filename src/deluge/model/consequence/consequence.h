@@ -38,6 +38,11 @@ public:
 
 	virtual void prepareForDestruction(int32_t whichQueueActionIn, Song* song) {}
 	virtual Error revert(TimeType time, ModelStack* modelStack) = 0;
+	/// Bytes of RAM this takes up in the undo history, including any data it holds on to.
+	virtual uint32_t getMemoryUsage();
+	/// Packs down any data being held on to, for once this is further back in the undo history and less likely to be
+	/// reverted. Reverting unpacks it again.
+	virtual void compress() {}
 	Consequence* next;
 	uint8_t type;
 };
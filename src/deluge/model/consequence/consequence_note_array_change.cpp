@@ -44,7 +44,24 @@ Error ConsequenceNoteArrayChange::revert(TimeType time, ModelStack* modelStack)
 		return Error::BUG;
 	}
 
+	if (compressedNotes.holdsData()) {
+		Error error = compressedNotes.decompressNotes(&backedUpNoteVector);
+		if (error != Error::NONE) {
+			return error;
+		}
+	}
+
 	noteRow->notes.swapStateWith(&backedUpNoteVector);
 
 	return Error::NONE;
 }
+
+uint32_t ConsequenceNoteArrayChange::getMemoryUsage() {
+	return Consequence::getMemoryUsage() + backedUpNoteVector.getMemoryUsage() + compressedNotes.getMemoryUsage();
+}
+
+void ConsequenceNoteArrayChange::compress() {
+	if (!compressedNotes.holdsData()) {
+		compressedNotes.compressNotes(&backedUpNoteVector); // If there's no RAM for it, we just keep it as it is
+	}
+}
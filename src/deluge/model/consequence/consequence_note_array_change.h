@@ -17,6 +17,7 @@
 
 #pragma once
 
+#include "model/consequence/compressed_snapshot.h"
 #include "model/consequence/consequence.h"
 #include "model/note/note_vector.h"
 #include <cstdint>
@@ -28,9 +29,12 @@ public:
 	ConsequenceNoteArrayChange(InstrumentClip* newClip, int32_t newNoteRowId, NoteVector* newNoteVector,
 	                           bool stealData);
 	Error revert(TimeType time, ModelStack* modelStack) override;
+	uint32_t getMemoryUsage() override;
+	void compress() override;
 
 	InstrumentClip* clip;
 	int32_t noteRowId;
 
 	NoteVector backedUpNoteVector;
+	CompressedSnapshot compressedNotes; // Holds backedUpNoteVector's contents instead, once compressed
 };
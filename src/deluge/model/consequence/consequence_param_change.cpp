@@ -46,7 +46,24 @@ Error ConsequenceParamChange::revert(TimeType time, ModelStack* modelStackWithSo
 	// we swap our stored state with that of the param in question - like, actually swap the pointer to the
 	// ParamNodeVector, so it's real efficient!
 
+	if (compressedNodes.holdsData()) {
+		Error error = compressedNodes.decompressParamNodes(&state.nodes);
+		if (error != Error::NONE) {
+			return error;
+		}
+	}
+
 	modelStack.paramCollection->remotelySwapParamState(&state, &modelStack);
 
 	return Error::NONE;
 }
+
+uint32_t ConsequenceParamChange::getMemoryUsage() {
+	return Consequence::getMemoryUsage() + state.nodes.getMemoryUsage() + compressedNodes.getMemoryUsage();
+}
+
+void ConsequenceParamChange::compress() {
+	if (!compressedNodes.holdsData()) {
+		compressedNodes.compressParamNodes(&state.nodes); // If there's no RAM for it, we just keep it as it is
+	}
+}
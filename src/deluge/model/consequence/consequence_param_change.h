@@ -17,6 +17,7 @@
 
 #pragma once
 
+#include "model/consequence/compressed_snapshot.h"
 #include "model/consequence/consequence.h"
 #include "model/model_stack.h"
 #include "modulation/automation/auto_param.h"
@@ -26,10 +27,13 @@ class ConsequenceParamChange final : public Consequence {
 public:
 	ConsequenceParamChange(ModelStackWithAutoParam const* modelStack, bool stealData);
 	Error revert(TimeType time, ModelStack* modelStackWithSong) override;
+	uint32_t getMemoryUsage() override;
+	void compress() override;
 
 	union {
 		char modelStackMemory[MODEL_STACK_MAX_SIZE];
 		ModelStackWithParamId modelStack; // TODO: yikes, is this safe? What about NoteRow pointers etc?
 	};
 	AutoParamState state;
+	CompressedSnapshot compressedNodes; // Holds state.nodes' contents instead, once compressed
 };
@@ -469,14 +469,7 @@ void ModControllableAudio::writeTagsToFile(Serializer& writer) {
 	writer.closeTag();
 
 	// Audio compressor (this section is all new so we write it at the end)
-	writer.writeOpeningTagBeginning("audioCompressor");
-	writer.writeAttribute("attack", compressor.getAttack());
-	writer.writeAttribute("release", compressor.getRelease());
-	writer.writeAttribute("thresh", compressor.getThreshold());
-	writer.writeAttribute("ratio", compressor.getRatio());
-	writer.writeAttribute("compHPF", compressor.getSidechain());
-	writer.writeAttribute("compBlend", compressor.getBlend());
-	writer.closeTag();
+	compressor.writeToFile(writer, "audioCompressor");
 
 	// Stutter
 	writer.writeOpeningTagBeginning("stutter");
@@ -842,41 +835,7 @@ doReadPatchedParam:
 
 	else if (!strcmp(tagName, "audioCompressor")) {
 		reader.match('{');
-		while (*(tagName = reader.readNextTagOrAttributeName())) {
-			if (!strcmp(tagName, "attack")) {
-				q31_t masterCompressorAttack = reader.readTagOrAttributeValueInt();
-				compressor.setAttack(masterCompressorAttack);
-				reader.exitTag("attack");
-			}
-			else if (!strcmp(tagName, "release")) {
-				q31_t masterCompressorRelease = reader.readTagOrAttributeValueInt();
-				compressor.setRelease(masterCompressorRelease);
-				reader.exitTag("release");
-			}
-			else if (!strcmp(tagName, "thresh")) {
-				q31_t masterCompressorThresh = reader.readTagOrAttributeValueInt();
-				compressor.setThreshold(masterCompressorThresh);
-				reader.exitTag("thresh");
-			}
-			else if (!strcmp(tagName, "ratio")) {
-				q31_t masterCompressorRatio = reader.readTagOrAttributeValueInt();
-				compressor.setRatio(masterCompressorRatio);
-				reader.exitTag("ratio");
-			}
-			else if (!strcmp(tagName, "compHPF")) {
-				q31_t masterCompressorSidechain = reader.readTagOrAttributeValueInt();
-				compressor.setSidechain(masterCompressorSidechain);
-				reader.exitTag("compHPF");
-			}
-			else if (!strcmp(tagName, "compBlend")) {
-				q31_t masterCompressorBlend = reader.readTagOrAttributeValueInt();
-				compressor.setBlend(masterCompressorBlend);
-				reader.exitTag("compBlend");
-			}
-			else {
-				reader.exitTag(tagName);
-			}
-		}
+		compressor.readFromFile(reader);
 		reader.exitTag("audioCompressor", true);
 	}
 	// this is actually the sidechain but pre c1.1 songs save it as compressor
@@ -57,6 +57,8 @@ NoteRow::NoteRow(int16_t newY) {
 	firstOldDrumName = nullptr;
 	sequenced = false;
 	ignoreNoteOnsBefore_ = 0;
+	ticksTilNextEvent = 0;
+	ticksSinceProcessed = 0;
 	probabilityValue = kNumProbabilityValues;
 	iteranceValue = kDefaultIteranceValue;
 	fillValue = FillMode::OFF;
@@ -1686,50 +1688,9 @@ Error NoteRow::quantize(ModelStackWithNoteRow* modelStack, int32_t increment, in
 		notes.deleteAtIndex(noteWriteIdx, notes.getNumElements() - noteWriteIdx);
 	}
 
-	int32_t finalNumElements = notes.getNumElements();
-
-	// If the first note has ended up with a negative position, we need to rotate the vector left by the number of notes
-	// with a negative position
-	{
-		int32_t rotateAmount = 0;
-		while (rotateAmount < finalNumElements && notes.getElement(rotateAmount)->pos < 0) {
-			rotateAmount++;
-		}
-
-		// We make a memory-speed tradeoff here and only rotate by 1 note at a time. It would be more CPU-efficient to
-		// have a buffer of rotateAmount notes and cycle the notes through there, but creating such a buffer requires
-		// allocation which makes it not worthwhile in the common case of only rotating by 1 or 2 notes.
-		while (rotateAmount >= 0) {
-			// Swap the notes to the right, so the note with a negative position ends up at the end.
-			int32_t lastNoteIdx = finalNumElements - 1;
-			for (auto i = 1; i < finalNumElements; ++i) {
-				notes.swapElements(i - 1, i);
-			}
-			notes.getElement(lastNoteIdx)->pos += effectiveLength;
-
-			rotateAmount--;
-		}
-	}
-
-	// Similarly, if the last note has ended up with a position greater than the effectiveLength, we need to rotate the
-	// note vector to the right.
-	{
-		int32_t rotateAmount = 0;
-		while (rotateAmount < notes.getNumElements()
-		       && notes.getElement(finalNumElements - rotateAmount - 1)->pos >= effectiveLength) {
-			rotateAmount++;
-		}
-
-		// See comment in the left rotation about why we rotate one note at a time
-		while (rotateAmount > 0) {
-			// Swap the notes to the left, so the note with a too-large position ends up at the start
-			for (auto i = finalNumElements - 1; i > 0; i--) {
-				notes.swapElements(i - 1, i);
-			}
-			notes.getElement(0)->pos -= effectiveLength;
-			rotateAmount--;
-		}
-	}
+	// Notes which have ended up with a negative position need to wrap round to the end, and ones which have ended up
+	// at or past the effectiveLength need to wrap round to the start
+	notes.wrapRound(effectiveLength);
 
 	// Fix up note lengths so there are no overlaps
 	for (auto i = 1; i < notes.getNumElements(); ++i) {
@@ -3198,8 +3159,6 @@ Error NoteRow::readFromFile(Deserializer& reader, int32_t* minY, InstrumentClip*
 	while (*(tagName = reader.readNextTagOrAttributeName())) {
 		// D_PRINTLN(tagName); delayMS(50);
 
-		uint16_t noteHexLength;
-
 		if (!strcmp(tagName, "muted")) {
 			muted = reader.readTagOrAttributeValueInt();
 		}
@@ -3339,185 +3298,36 @@ finishedNormalStuff:
 
 		// Notes stored as hex data (V1.4 onwards)
 		else if (!strcmp(tagName, "noteData")) {
-			noteHexLength = 20;
-doReadNoteData:
-			int32_t minPos = 0;
-
-			int32_t numElementsToAllocateFor = 0;
-
-			if (!reader.prepareToReadTagOrAttributeValueOneCharAtATime()) {
-				goto getOut;
-			}
-
-			{
-				char const* firstChars = reader.readNextCharsOfTagOrAttributeValue(2);
-				if (!firstChars || *(uint16_t*)firstChars != charsToIntegerConstant('0', 'x')) {
-					goto getOut;
-				}
-			}
-
-			while (true) {
-
-				// Every time we've reached the end of a cluster...
-				if (numElementsToAllocateFor <= 0) {
-
-					// See how many more chars before the end of the cluster. If there are any...
-					uint32_t charsRemaining = reader.getNumCharsRemainingInValueBeforeEndOfCluster();
-					if (charsRemaining) {
-
-						// Allocate space for the right number of notes, and remember how long it'll be before
-						// we need to do this check again
-						numElementsToAllocateFor = (uint32_t)(charsRemaining - 1) / noteHexLength + 1;
-						notes.ensureEnoughSpaceAllocated(
-						    numElementsToAllocateFor); // If it returns false... oh well. We'll fail later
-					}
-				}
-
-				char const* hexChars = reader.readNextCharsOfTagOrAttributeValue(noteHexLength);
-				if (!hexChars) {
-					goto getOut;
-				}
-
-				int32_t pos = hexToIntFixedLength(hexChars, 8);
-				int32_t length = hexToIntFixedLength(&hexChars[8], 8);
-				uint8_t velocity = hexToIntFixedLength(&hexChars[16], 2);
-				uint8_t lift, probability, fill;
-				Iterance iterance;
-
-				if (noteHexLength == 28) { // if reading custom iterance and fill
-					fill = hexToIntFixedLength(&hexChars[26], 2);
-					iterance = Iterance::fromInt(hexToIntFixedLength(&hexChars[22], 4));
-					probability = hexToIntFixedLength(&hexChars[20], 2);
-					lift = hexToIntFixedLength(&hexChars[18], 2);
-					if (lift == 0 || lift > 127) {
-						goto useDefaultLift;
-					}
-				}
-				else if (noteHexLength == 26) { // if nightly firmware 1.3 with no custom iterances
-					fill = hexToIntFixedLength(&hexChars[24], 2);
-					iterance = Iterance::fromPresetIndex(hexToIntFixedLength(&hexChars[22], 2));
-					probability = hexToIntFixedLength(&hexChars[20], 2);
-					lift = hexToIntFixedLength(&hexChars[18], 2);
-					if (lift == 0 || lift > 127) {
-						goto useDefaultLift;
-					}
-				}
-				else if (noteHexLength == 22) { // If reading lift...
-					probability = hexToIntFixedLength(&hexChars[20], 2);
-
-					if (probability == kOldFillProbabilityValue || probability == kOldNotFillProbabilityValue) {
-						if (probability == kOldFillProbabilityValue) {
-							fill = FillMode::FILL;
-						}
-						else {
-							fill = FillMode::NOT_FILL;
-						}
-						iterance = kDefaultIteranceValue;    // iterance off
-						probability = kNumProbabilityValues; // 100% probability
-					}
-					else if (probability > kNumProbabilityValues
-					         && probability <= kNumProbabilityValues + kNumIterancePresets) {
-						fill = FillMode::OFF;
-						iterance = iterancePresets[probability - kNumProbabilityValues - 1];
-						probability = kNumProbabilityValues; // 100% probability
-					}
-					else {
-						fill = FillMode::OFF;
-						iterance = kDefaultIteranceValue; // iterance off
-					}
-					lift = hexToIntFixedLength(&hexChars[18], 2);
-					if (lift == 0 || lift > 127) {
-						goto useDefaultLift;
-					}
-				}
-				else { // Or if no lift here to read
-					probability = hexToIntFixedLength(&hexChars[18], 2);
-
-					if (probability == kOldFillProbabilityValue || probability == kOldNotFillProbabilityValue) {
-						if (probability == kOldFillProbabilityValue) {
-							fill = FillMode::FILL;
-						}
-						else {
-							fill = FillMode::NOT_FILL;
-						}
-						iterance = kDefaultIteranceValue;    // iterance off
-						probability = kNumProbabilityValues; // 100% probability
-					}
-					else if (probability > kNumProbabilityValues
-					         && probability <= kNumProbabilityValues + kNumIterancePresets) {
-						fill = FillMode::OFF;
-						iterance = iterancePresets[probability - kNumProbabilityValues - 1];
-						probability = kNumProbabilityValues; // 100% probability
-					}
-					else {
-						fill = FillMode::OFF;
-						iterance = kDefaultIteranceValue; // iterance off
-					}
-
-					lift = hexToIntFixedLength(&hexChars[18], 2);
-					if (lift == 0 || lift > 127) {
-						goto useDefaultLift;
-					}
-
-useDefaultLift:
-					lift = kDefaultLiftValue;
-				}
-
-				// See if that's all allowed
-				if (length <= 0) {
-					length = 1; // This happened somehow in Simon Wollwage's song, May 2020
-				}
-				if (pos < minPos || pos > kMaxSequenceLength - length) {
-					continue;
-				}
-				if (velocity == 0 || velocity > 127) {
-					velocity = 64;
-				}
-				if ((probability & 127) > kNumProbabilityValues || probability >= (kNumProbabilityValues | 128)) {
-					probability = kNumProbabilityValues;
-				}
-				if (fill < FillMode::OFF || fill > FillMode::FILL) {
-					fill = FillMode::OFF;
-				}
-
-				minPos = pos + length;
-
-				// Ok, make the note
-				int32_t i = notes.insertAtKey(pos, true);
-				if (i == -1) {
-					return Error::INSUFFICIENT_RAM;
-				}
-				Note* newNote = notes.getElement(i);
-				newNote->setLength(length);
-				newNote->setVelocity(velocity);
-				newNote->setLift(lift);
-				newNote->setProbability(probability);
-				newNote->setIterance(iterance);
-				newNote->setFill(fill);
-
-				numElementsToAllocateFor--;
+			Error error = notes.readFromFile(reader, 20);
+			if (error != Error::NONE) {
+				return error;
 			}
-getOut: {}
 		}
 
 		// Notes stored as hex data including lift (V3.2 onwards)
 		else if (song_firmware_version < FirmwareVersion::community({1, 3, 0})
 		         && !strcmp(tagName, "noteDataWithLift")) {
-			noteHexLength = 22;
-			goto doReadNoteData;
+			Error error = notes.readFromFile(reader, 22);
+			if (error != Error::NONE) {
+				return error;
+			}
 		}
 #if ALPHA_OR_BETA_VERSION
 		// Notes stored as hex data in nightly firmware 1.3 previous to the addition of custom iterances
 		else if (song_firmware_version < FirmwareVersion::community({1, 3, 0})
 		         && !strcmp(tagName, "noteDataWithIteranceAndFill")) {
-			noteHexLength = 26;
-			goto doReadNoteData;
+			Error error = notes.readFromFile(reader, 26);
+			if (error != Error::NONE) {
+				return error;
+			}
 		}
 #endif
 		// Notes stored as hex data including custom iterance and fill (community firmware 1.3 onwards)
 		else if (!strcmp(tagName, "noteDataWithSplitProb")) {
-			noteHexLength = 28;
-			goto doReadNoteData;
+			Error error = notes.readFromFile(reader, 28);
+			if (error != Error::NONE) {
+				return error;
+			}
 		}
 
 		else if (!strcmp(tagName, "expressionData")) {
@@ -3574,32 +3384,7 @@ void NoteRow::writeToFile(Serializer& writer, int32_t drumIndex, InstrumentClip*
 		writer.printIndents();
 		writer.writeTagNameAndSeperator("noteDataWithSplitProb");
 		writer.write("\"0x");
-		for (int32_t n = 0; n < notes.getNumElements(); n++) {
-			Note* thisNote = notes.getElement(n);
-
-			char buffer[9];
-
-			intToHex(thisNote->pos, buffer);
-			writer.write(buffer);
-
-			intToHex(thisNote->getLength(), buffer);
-			writer.write(buffer);
-
-			intToHex(thisNote->getVelocity(), buffer, 2);
-			writer.write(buffer);
-
-			intToHex(thisNote->getLift(), buffer, 2);
-			writer.write(buffer);
-
-			intToHex(thisNote->getProbability(), buffer, 2);
-			writer.write(buffer);
-
-			intToHex(thisNote->getIterance().toInt(), buffer, 4);
-			writer.write(buffer);
-
-			intToHex(thisNote->getFill(), buffer, 2);
-			writer.write(buffer);
-		}
+		notes.writeToFile(writer);
 		writer.write("\"");
 
 #if ALPHA_OR_BETA_VERSION
@@ -3612,19 +3397,10 @@ void NoteRow::writeToFile(Serializer& writer, int32_t drumIndex, InstrumentClip*
 			for (int32_t n = 0; n < notes.getNumElements(); n++) {
 				Note* thisNote = notes.getElement(n);
 
-				char buffer[9];
-
-				intToHex(thisNote->pos, buffer);
-				writer.write(buffer);
-
-				intToHex(thisNote->getLength(), buffer);
-				writer.write(buffer);
-
-				intToHex(thisNote->getVelocity(), buffer, 2);
-				writer.write(buffer);
-
-				intToHex(thisNote->getLift(), buffer, 2);
-				writer.write(buffer);
+				writer.writeHexDigits(thisNote->pos);
+				writer.writeHexDigits(thisNote->getLength());
+				writer.writeHexDigits(thisNote->getVelocity(), 2);
+				writer.writeHexDigits(thisNote->getLift(), 2);
 
 				// Do here an attempt to keep the most significant information, in order of priority
 				// 1st - Iterance preset
@@ -3652,8 +3428,7 @@ void NoteRow::writeToFile(Serializer& writer, int32_t drumIndex, InstrumentClip*
 					// we found the note has a probability different than 100%, use it
 					oldProbability = probability;
 				}
-				intToHex(oldProbability, buffer, 2);
-				writer.write(buffer);
+				writer.writeHexDigits(oldProbability, 2);
 			}
 			writer.write("\"");
 		}
@@ -4077,15 +3852,12 @@ bool NoteRow::paste(ModelStackWithNoteRow* modelStack, CopiedNoteRow* copiedNote
 	int32_t effectiveLength = modelStack->getLoopLength();
 	int32_t maxPos = std::min(screenEndPos, effectiveLength);
 
-	if (action) {
-		// Snapshot how Notes were before, in bulk. It's quite likely that this has already been done as the
-		// area was cleared - but not if notes was empty
-		action->recordNoteArrayChangeIfNotAlreadySnapshotted((InstrumentClip*)modelStack->getTimelineCounter(),
-		                                                     modelStack->noteRowId, &notes, false);
+	// Merge the pasted Notes in with the existing ones in a single pass, into a new NoteVector
+	NoteVectorMerge merge(notes, effectiveLength);
+	if (merge.prepare(copiedNoteRow->numNotes) != Error::NONE) {
+		return false;
 	}
 
-	// TODO: this could be done without all these many inserts, and could be improved further by "stealing" the
-	// data into the action, above
 	for (int32_t n = 0; n < copiedNoteRow->numNotes; n++) {
 
 		Note* noteSource = &copiedNoteRow->notes[n];
@@ -4102,13 +3874,37 @@ bool NoteRow::paste(ModelStackWithNoteRow* modelStack, CopiedNoteRow* copiedNote
 		int32_t newLength = roundf((float)noteSource->length * scaleFactor);
 		newLength = std::max(newLength, (int32_t)1);
 		newLength = std::min(newLength, maxPos - newPos);
+		minPos = newPos + newLength;
+
+		// Skipped if there's already a Note overlapping this space
+		Note* newNote = merge.addNote(newPos, newLength);
+		if (!newNote) {
+			continue;
+		}
+		newNote->setVelocity(noteSource->velocity);
+		newNote->setLift(kDefaultLiftValue);
+		newNote->setProbability(noteSource->probability);
+		newNote->setIterance(noteSource->iterance);
+		newNote->setFill(noteSource->fill);
+	}
 
-		// Prevents pasting of overlapping notes, which leads to sequentialTest Error "E319"
-		attemptNoteAdd(newPos, newLength, noteSource->velocity, noteSource->probability, noteSource->iterance,
-		               noteSource->fill, modelStack, nullptr);
+	merge.finish();
 
-		minPos = newPos + newLength;
+	if (action) {
+		// Snapshot how Notes were before, stealing the old note data. It's quite likely that this has already been
+		// done as the area was cleared - but not if notes was empty
+		action->recordNoteArrayChangeIfNotAlreadySnapshotted((InstrumentClip*)modelStack->getTimelineCounter(),
+		                                                     modelStack->noteRowId, &notes, true);
 	}
+
+	// Swap the new temporary note data into the permanent place
+	notes.swapStateWith(&merge.newNotes);
+
+#if ENABLE_SEQUENTIALITY_TESTS
+	notes.testSequentiality("E455");
+#endif
+
+	modelStack->getTimelineCounter()->expectEvent();
 	return true;
 }
 
@@ -166,6 +166,12 @@ public:
 	/// compared with the time since this NoteRow started (i.e., time from the end during reversed playback).
 	uint32_t ignoreNoteOnsBefore_;
 
+	/// Countdown to when this NoteRow next needs processCurrentPos() calling, and the ticks that have gone by since it
+	/// last was. Kept by InstrumentClip::processCurrentPos(), which skips NoteRows with nothing due yet.
+	/// InstrumentClip::expectEvent() makes every NoteRow due again.
+	int32_t ticksTilNextEvent;
+	int32_t ticksSinceProcessed;
+
 	int32_t getDefaultProbability();
 	Iterance getDefaultIterance();
 	int32_t getDefaultFill(ModelStackWithNoteRow* modelStack);
@@ -17,6 +17,11 @@
 
 #include "model/note/note_vector.h"
 #include "model/note/note.h"
+#include "storage/storage_manager.h"
+#include "util/d_stringbuf.h"
+#include "util/functions.h"
+#include "util/lookuptables/lookuptables.h"
+#include <algorithm>
 #include <cstring>
 
 NoteVector::NoteVector() : OrderedResizeableArrayWith32bitKey(sizeof(Note)) {
@@ -32,3 +37,296 @@ Note* NoteVector::getElement(int32_t index) {
 Note* NoteVector::getLast() {
 	return getElement(getNumElements() - 1);
 }
+
+// Writes each Note as a noteDataWithSplitProb record, into the "0x..." value the caller has opened
+void NoteVector::writeToFile(Serializer& writer) {
+	for (int32_t n = 0; n < getNumElements(); n++) {
+		Note* thisNote = getElement(n);
+
+		writer.writeHexDigits(thisNote->pos);
+		writer.writeHexDigits(thisNote->getLength());
+		writer.writeHexDigits(thisNote->getVelocity(), 2);
+		writer.writeHexDigits(thisNote->getLift(), 2);
+		writer.writeHexDigits(thisNote->getProbability(), 2);
+		writer.writeHexDigits(thisNote->getIterance().toInt(), 4);
+		writer.writeHexDigits(thisNote->getFill(), 2);
+	}
+}
+
+// Reads a note data value from any firmware version, whose records are noteHexLength hex chars each. Running out of
+// RAM is the only error - anything unreadable is just the end of the Notes.
+Error NoteVector::readFromFile(Deserializer& reader, int32_t noteHexLength) {
+	int32_t minPos = 0;
+
+	int32_t numElementsToAllocateFor = 0;
+
+	// Binary song files hand us the raw bytes, saving us decoding the hex
+	bool readingBytes = reader.prepareToReadHexValueAsBytes();
+
+	if (!readingBytes) {
+		if (!reader.prepareToReadTagOrAttributeValueOneCharAtATime()) {
+			return Error::NONE;
+		}
+
+		char const* firstChars = reader.readNextCharsOfTagOrAttributeValue(2);
+		if (!firstChars || *(uint16_t*)firstChars != charsToIntegerConstant('0', 'x')) {
+			return Error::NONE;
+		}
+	}
+
+	while (true) {
+
+		// Every time we've reached the end of a cluster...
+		if (numElementsToAllocateFor <= 0) {
+
+			// See how many more chars before the end of the cluster. If there are any...
+			uint32_t charsRemaining = reader.getNumCharsRemainingInValueBeforeEndOfCluster();
+			if (charsRemaining) {
+
+				// Allocate space for the right number of notes, and remember how long it'll be before
+				// we need to do this check again
+				numElementsToAllocateFor = (uint32_t)(charsRemaining - 1) / noteHexLength + 1;
+				ensureEnoughSpaceAllocated(numElementsToAllocateFor); // If it returns false... oh well. We'll fail later
+			}
+		}
+
+		char const* hexChars =
+		    readingBytes ? (char const*)reader.readNextBytesOfHexValue(noteHexLength >> 1)
+		                 : reader.readNextCharsOfTagOrAttributeValue(noteHexLength);
+		if (!hexChars) {
+			return Error::NONE;
+		}
+
+		// Takes the position and length in hex chars either way
+		auto field = [&](int32_t charPos, int32_t numChars) -> uint32_t {
+			return readingBytes ? bytesToIntFixedLength((uint8_t const*)&hexChars[charPos >> 1], numChars >> 1)
+			                    : hexToIntFixedLength(&hexChars[charPos], numChars);
+		};
+
+		int32_t pos = field(0, 8);
+		int32_t length = field(8, 8);
+		uint8_t velocity = field(16, 2);
+		uint8_t lift, probability, fill;
+		Iterance iterance;
+
+		if (noteHexLength == 28) { // if reading custom iterance and fill
+			fill = field(26, 2);
+			iterance = Iterance::fromInt(field(22, 4));
+			probability = field(20, 2);
+			lift = field(18, 2);
+			if (lift == 0 || lift > 127) {
+				goto useDefaultLift;
+			}
+		}
+		else if (noteHexLength == 26) { // if nightly firmware 1.3 with no custom iterances
+			fill = field(24, 2);
+			iterance = Iterance::fromPresetIndex(field(22, 2));
+			probability = field(20, 2);
+			lift = field(18, 2);
+			if (lift == 0 || lift > 127) {
+				goto useDefaultLift;
+			}
+		}
+		else if (noteHexLength == 22) { // If reading lift...
+			probability = field(20, 2);
+
+			if (probability == kOldFillProbabilityValue || probability == kOldNotFillProbabilityValue) {
+				if (probability == kOldFillProbabilityValue) {
+					fill = FillMode::FILL;
+				}
+				else {
+					fill = FillMode::NOT_FILL;
+				}
+				iterance = kDefaultIteranceValue;    // iterance off
+				probability = kNumProbabilityValues; // 100% probability
+			}
+			else if (probability > kNumProbabilityValues
+			         && probability <= kNumProbabilityValues + kNumIterancePresets) {
+				fill = FillMode::OFF;
+				iterance = iterancePresets[probability - kNumProbabilityValues - 1];
+				probability = kNumProbabilityValues; // 100% probability
+			}
+			else {
+				fill = FillMode::OFF;
+				iterance = kDefaultIteranceValue; // iterance off
+			}
+			lift = field(18, 2);
+			if (lift == 0 || lift > 127) {
+				goto useDefaultLift;
+			}
+		}
+		else { // Or if no lift here to read
+			probability = field(18, 2);
+
+			if (probability == kOldFillProbabilityValue || probability == kOldNotFillProbabilityValue) {
+				if (probability == kOldFillProbabilityValue) {
+					fill = FillMode::FILL;
+				}
+				else {
+					fill = FillMode::NOT_FILL;
+				}
+				iterance = kDefaultIteranceValue;    // iterance off
+				probability = kNumProbabilityValues; // 100% probability
+			}
+			else if (probability > kNumProbabilityValues
+			         && probability <= kNumProbabilityValues + kNumIterancePresets) {
+				fill = FillMode::OFF;
+				iterance = iterancePresets[probability - kNumProbabilityValues - 1];
+				probability = kNumProbabilityValues; // 100% probability
+			}
+			else {
+				fill = FillMode::OFF;
+				iterance = kDefaultIteranceValue; // iterance off
+			}
+
+			lift = field(18, 2);
+			if (lift == 0 || lift > 127) {
+				goto useDefaultLift;
+			}
+
+useDefaultLift:
+			lift = kDefaultLiftValue;
+		}
+
+		// See if that's all allowed
+		if (length <= 0) {
+			length = 1; // This happened somehow in Simon Wollwage's song, May 2020
+		}
+		if (pos < minPos || pos > kMaxSequenceLength - length) {
+			continue;
+		}
+		if (velocity == 0 || velocity > 127) {
+			velocity = 64;
+		}
+		if ((probability & 127) > kNumProbabilityValues || probability >= (kNumProbabilityValues | 128)) {
+			probability = kNumProbabilityValues;
+		}
+		if (fill < FillMode::OFF || fill > FillMode::FILL) {
+			fill = FillMode::OFF;
+		}
+
+		minPos = pos + length;
+
+		// Ok, make the note
+		int32_t i = insertAtKey(pos, true);
+		if (i == -1) {
+			return Error::INSUFFICIENT_RAM;
+		}
+		Note* newNote = getElement(i);
+		newNote->setLength(length);
+		newNote->setVelocity(velocity);
+		newNote->setLift(lift);
+		newNote->setProbability(probability);
+		newNote->setIterance(iterance);
+		newNote->setFill(fill);
+
+		numElementsToAllocateFor--;
+	}
+}
+
+// Notes with a negative position wrap round to the end, and ones at or past loopLength wrap round to the start. That
+// means swapping the order of those blocks of Notes and the one in between - which we do in place by reversing the
+// whole lot, then each block back again. That touches each Note just twice, with no allocation, however many wrap.
+void NoteVector::wrapRound(int32_t loopLength) {
+	int32_t numNotes = getNumElements();
+
+	int32_t numWrappingRight = 0;
+	while (numWrappingRight < numNotes && getElement(numWrappingRight)->pos < 0) {
+		numWrappingRight++;
+	}
+
+	int32_t numWrappingLeft = 0;
+	while (numWrappingLeft < numNotes - numWrappingRight
+	       && getElement(numNotes - numWrappingLeft - 1)->pos >= loopLength) {
+		numWrappingLeft++;
+	}
+
+	if (!numWrappingRight && !numWrappingLeft) {
+		return;
+	}
+
+	reverseOrder(0, numNotes);
+	reverseOrder(0, numWrappingLeft);
+	reverseOrder(numWrappingLeft, numNotes - numWrappingRight);
+	reverseOrder(numNotes - numWrappingRight, numNotes);
+
+	for (int32_t i = 0; i < numWrappingLeft; i++) {
+		getElement(i)->pos -= loopLength;
+	}
+	for (int32_t i = numNotes - numWrappingRight; i < numNotes; i++) {
+		getElement(i)->pos += loopLength;
+	}
+}
+
+// Reverses the order of the Notes from start up to (but not including) end
+void NoteVector::reverseOrder(int32_t start, int32_t end) {
+	for (end--; start < end; start++, end--) {
+		swapElements(start, end);
+	}
+}
+
+// Pre-allocates the max amount of memory we might need
+Error NoteVectorMerge::prepare(int32_t maxNumNewNotes) {
+	numOldNotes = oldNotes.getNumElements();
+	newNotesInitialSize = numOldNotes + maxNumNewNotes;
+	if (!newNotesInitialSize) {
+		return Error::NONE;
+	}
+	return newNotes.insertAtIndex(0, newNotesInitialSize);
+}
+
+// Returns the new Note, with its pos and length set, or nullptr if there's already a Note overlapping its pos.
+Note* NoteVectorMerge::addNote(int32_t pos, int32_t length) {
+	// Copy across all existing Notes up to and including this position
+	while (nextIndexToCopyFrom < numOldNotes && oldNotes.getElement(nextIndexToCopyFrom)->pos <= pos) {
+		*newNotes.getElement(nextIndexToCopyTo++) = *oldNotes.getElement(nextIndexToCopyFrom++);
+	}
+
+	// If there's already a Note overlapping this space, we can't - which prevents overlapping notes, which lead to
+	// sequentialTest Error "E319". With nothing to the left, look at the final Note, wrapping round
+	int32_t noteLeftEnd;
+	if (nextIndexToCopyTo) {
+		Note* noteLeft = newNotes.getElement(nextIndexToCopyTo - 1);
+		noteLeftEnd = noteLeft->pos + noteLeft->length;
+	}
+	else if (numOldNotes) {
+		Note* noteLeft = oldNotes.getElement(numOldNotes - 1);
+		noteLeftEnd = noteLeft->pos + noteLeft->length - loopLength;
+	}
+	else {
+		noteLeftEnd = pos;
+	}
+	if (noteLeftEnd > pos) {
+		return nullptr;
+	}
+
+	// Limit length to the distance to the next Note - which might mean wrapping round to the first one
+	int32_t distanceToNextNote;
+	if (nextIndexToCopyFrom < numOldNotes) {
+		distanceToNextNote = oldNotes.getElement(nextIndexToCopyFrom)->pos - pos;
+	}
+	else if (nextIndexToCopyTo) {
+		distanceToNextNote = newNotes.getElement(0)->pos + loopLength - pos;
+	}
+	else {
+		distanceToNextNote = loopLength;
+	}
+
+	Note* newNote = newNotes.getElement(nextIndexToCopyTo++);
+	newNote->pos = pos;
+	newNote->setLength(std::min(length, distanceToNextNote));
+	return newNote;
+}
+
+void NoteVectorMerge::finish() {
+	// Copy the final Notes too - after the last added one
+	while (nextIndexToCopyFrom < numOldNotes) {
+		*newNotes.getElement(nextIndexToCopyTo++) = *oldNotes.getElement(nextIndexToCopyFrom++);
+	}
+
+	// Delete any Notes we initially created but then ended up not using
+	int32_t numToDelete = newNotesInitialSize - nextIndexToCopyTo;
+	if (numToDelete > 0) {
+		newNotes.deleteAtIndex(nextIndexToCopyTo, numToDelete);
+	}
+}
@@ -22,6 +22,8 @@
 #include "util/container/array/ordered_resizeable_array.h"
 
 class Note;
+class Serializer;
+class Deserializer;
 
 class NoteVector : public OrderedResizeableArrayWith32bitKey {
 public:
@@ -29,6 +31,32 @@ public:
 
 	Note* getElement(int32_t index);
 	Note* getLast();
+	void wrapRound(int32_t loopLength);
+	void writeToFile(Serializer& writer);
+	Error readFromFile(Deserializer& reader, int32_t noteHexLength);
 
 private:
+	void reverseOrder(int32_t start, int32_t end);
+};
+
+/// Builds a new NoteVector from an existing one with more Notes merged in, in a single pass. New Notes must be added
+/// in order of position. One which would start inside a Note already there is skipped, and the rest have their length
+/// cut to the distance to the next Note - wrapping round the loop - as NoteRow::attemptNoteAdd() does.
+class NoteVectorMerge {
+public:
+	NoteVectorMerge(NoteVector& oldNotes, int32_t loopLength) : oldNotes(oldNotes), loopLength(loopLength) {}
+
+	Error prepare(int32_t maxNumNewNotes);
+	Note* addNote(int32_t pos, int32_t length);
+	void finish();
+
+	NoteVector newNotes;
+
+private:
+	NoteVector& oldNotes;
+	int32_t loopLength;
+	int32_t numOldNotes = 0;
+	int32_t newNotesInitialSize = 0;
+	int32_t nextIndexToCopyFrom = 0;
+	int32_t nextIndexToCopyTo = 0;
 };
@@ -265,13 +265,8 @@ bool Output::writeDataToFile(Serializer& writer, Clip* clipForSavingOutputOnly,
 			for (int32_t i = 0; i < clipInstances.getNumElements(); i++) {
 				ClipInstance* thisInstance = clipInstances.getElement(i);
 
-				char buffer[9];
-
-				intToHex(thisInstance->pos, buffer);
-				writer.write(buffer);
-
-				intToHex(thisInstance->length, buffer);
-				writer.write(buffer);
+				writer.writeHexDigits(thisInstance->pos);
+				writer.writeHexDigits(thisInstance->length);
 
 				uint32_t clipCode;
 
@@ -285,8 +280,7 @@ bool Output::writeDataToFile(Serializer& writer, Clip* clipForSavingOutputOnly,
 					}
 				}
 
-				intToHex(clipCode, buffer);
-				writer.write(buffer);
+				writer.writeHexDigits(clipCode);
 			}
 			writer.write("\"");
 		}
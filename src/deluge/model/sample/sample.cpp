@@ -26,6 +26,7 @@
 #include "model/sample/sample_perc_cache_zone.h"
 #include "processing/engines/audio_engine.h"
 #include "storage/audio/audio_file_manager.h"
+#include "storage/audio/sample_cache_store.h"
 #include "storage/cluster/cluster.h"
 #include "storage/multi_range/multisample_range.h"
 #include <cmath>
@@ -179,6 +180,31 @@ SampleCache* Sample::getOrCreateCache(SampleHolder* sampleHolder, int32_t phaseI
 		skipSamplesAtStart = lengthInSamples - sampleHolder->getEndPos(false);
 	}
 
+	*created = false;
+	SampleCache* cache = getOrCreateCache(phaseIncrement, timeStretchRatio, skipSamplesAtStart, reversed, false, created);
+	if (cache) {
+		// Still being read back in from the card - til it's all there, this voice goes without
+		return cache->restoring ? nullptr : cache;
+	}
+	if (!mayCreate) {
+		return nullptr;
+	}
+
+	// If there's a copy on the card, it'll get read back in shortly - til then, this voice just goes without
+	if (sampleCacheStore.requestRestore(this, phaseIncrement, timeStretchRatio, skipSamplesAtStart, reversed)) {
+		return nullptr;
+	}
+
+	cache = getOrCreateCache(phaseIncrement, timeStretchRatio, skipSamplesAtStart, reversed, true, created);
+	if (cache && *created) {
+		sampleCacheStore.cacheCreated(cache);
+	}
+	return cache;
+}
+
+SampleCache* Sample::getOrCreateCache(int32_t phaseIncrement, int32_t timeStretchRatio, int32_t skipSamplesAtStart,
+                                      bool reversed, bool mayCreate, bool* created) {
+
 	uint32_t keyWords[4];
 	keyWords[0] = phaseIncrement;
 	keyWords[1] = timeStretchRatio;
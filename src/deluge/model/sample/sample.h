@@ -60,6 +60,8 @@ public:
 	uint32_t getLengthInMSec();
 	SampleCache* getOrCreateCache(SampleHolder* sampleHolder, int32_t phaseIncrement, int32_t timeStretchRatio,
 	                              bool reversed, bool mayCreate, bool* created);
+	SampleCache* getOrCreateCache(int32_t phaseIncrement, int32_t timeStretchRatio, int32_t skipSamplesAtStart,
+	                              bool reversed, bool mayCreate, bool* created);
 	void deleteCache(SampleCache* cache);
 	int32_t getFirstClusterIndexWithAudioData();
 	int32_t getFirstClusterIndexWithNoAudioData();
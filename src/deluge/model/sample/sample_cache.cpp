@@ -20,6 +20,7 @@
 #include "memory/general_memory_allocator.h"
 #include "model/sample/sample.h"
 #include "storage/audio/audio_file_manager.h"
+#include "storage/audio/sample_cache_store.h"
 #include "storage/cluster/cluster.h"
 #include "util/misc.h"
 
@@ -36,6 +37,7 @@ SampleCache::SampleCache(Sample* newSample, int32_t newNumClusters, int32_t newW
 	waveformLengthBytes = newWaveformLengthBytes;
 	skipSamplesAtStart = newSkipSamplesAtStart;
 	reversed = newReversed;
+	restoring = false;
 	/*
 	for (int32_t i = 0; i < numClusters; i++) {
 	    clusters[i] = NULL; // We don't actually have to initialize these, since writeBytePos tells us how many are
@@ -45,6 +47,7 @@ SampleCache::SampleCache(Sample* newSample, int32_t newNumClusters, int32_t newW
 }
 
 SampleCache::~SampleCache() {
+	sampleCacheStore.cacheDestroyed(this);
 	unlinkClusters(0, true);
 }
 
@@ -61,6 +64,8 @@ void SampleCache::clusterStolen(int32_t clusterIndex) {
 
 	D_PRINTLN("cache Cluster stolen");
 
+	sampleCacheStore.cacheInvalidated(this);
+
 	// There's now no point in having any further Clusters
 	unlinkClusters(clusterIndex + 1, false); // Must do this before changing writeBytePos
 
@@ -126,6 +131,10 @@ void SampleCache::setWriteBytePos(int32_t newWriteBytePos) {
 	// When setting it earlier, we may have to discard some Clusters.
 	// Remember, a cache cluster actually gets (bytesPerSample - 1) extra usable bytes after it.
 
+	if (newWriteBytePos < writeBytePos) {
+		sampleCacheStore.cacheInvalidated(this);
+	}
+
 	int32_t newNumExistentClusters = getNumExistentClusters(newWriteBytePos);
 	unlinkClusters(newNumExistentClusters, false);
 
@@ -136,6 +145,15 @@ void SampleCache::setWriteBytePos(int32_t newWriteBytePos) {
 	}
 }
 
+// For a Cluster from setupNewCluster() which never got filled. writeBytePos doesn't cover it yet, so unlinkClusters()
+// would never free it.
+void SampleCache::discardNewCluster(int32_t clusterIndex) {
+	if (clusters[clusterIndex]) {
+		clusters[clusterIndex]->destroy();
+		clusters[clusterIndex] = nullptr;
+	}
+}
+
 // Does not move the new Cluster to the appropriate "availability queue", because it's expected that the caller is just
 // about to call getCluster(), to get it, which will call prioritizeNotStealingCluster(), and that'll do it
 bool SampleCache::setupNewCluster(int32_t clusterIndex) {
@@ -30,7 +30,9 @@ public:
 	void clusterStolen(int32_t clusterIndex);
 	bool setupNewCluster(int32_t cachedClusterIndex);
 	Cluster* getCluster(int32_t clusterIndex);
+	Cluster* getClusterWithoutPrioritizing(int32_t clusterIndex) { return clusters[clusterIndex]; }
 	void setWriteBytePos(int32_t newWriteBytePos);
+	void discardNewCluster(int32_t clusterIndex);
 
 	int32_t writeBytePos;
 #if ALPHA_OR_BETA_VERSION
@@ -42,6 +44,7 @@ public:
 	int32_t timeStretchRatio;
 	int32_t skipSamplesAtStart;
 	bool reversed;
+	bool restoring; // Being read back in from the card by sampleCacheStore. Voices leave it alone til it's done
 
 private:
 	void unlinkClusters(int32_t startAtIndex, bool beingDestructed);
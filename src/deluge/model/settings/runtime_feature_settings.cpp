@@ -102,6 +102,58 @@ static void SetupEmulatedDisplaySetting(RuntimeFeatureSetting& setting, deluge::
 	};
 }
 
+static void SetupTimeStretchQualitySetting(RuntimeFeatureSetting& setting, deluge::l10n::String displayName,
+                                           std::string_view xmlName, RuntimeFeatureStateTimeStretchQuality def) {
+	setting.displayName = displayName;
+	setting.xmlName = xmlName;
+	setting.value = static_cast<uint32_t>(def);
+
+	setting.options = {
+	    {
+	        .displayName = display->haveOLED() ? "Fast" : "FAST",
+	        .value = static_cast<uint32_t>(RuntimeFeatureStateTimeStretchQuality::Fast),
+	    },
+	    {
+	        .displayName = display->haveOLED() ? "Standard" : "STD",
+	        .value = static_cast<uint32_t>(RuntimeFeatureStateTimeStretchQuality::Standard),
+	    },
+	    {
+	        .displayName = display->haveOLED() ? "High" : "HIGH",
+	        .value = static_cast<uint32_t>(RuntimeFeatureStateTimeStretchQuality::High),
+	    },
+	    {
+	        .displayName = display->haveOLED() ? "Auto" : "AUTO",
+	        .value = static_cast<uint32_t>(RuntimeFeatureStateTimeStretchQuality::Auto),
+	    },
+	};
+}
+
+static void SetupUndoMemoryLimitSetting(RuntimeFeatureSetting& setting, deluge::l10n::String displayName,
+                                        std::string_view xmlName, RuntimeFeatureStateUndoMemoryLimit def) {
+	setting.displayName = displayName;
+	setting.xmlName = xmlName;
+	setting.value = static_cast<uint32_t>(def);
+
+	setting.options = {
+	    {
+	        .displayName = display->haveOLED() ? "512 KB" : "512K",
+	        .value = RuntimeFeatureStateUndoMemoryLimit::UndoMemory512K,
+	    },
+	    {
+	        .displayName = display->haveOLED() ? "2 MB" : "2M",
+	        .value = RuntimeFeatureStateUndoMemoryLimit::UndoMemory2M,
+	    },
+	    {
+	        .displayName = display->haveOLED() ? "8 MB" : "8M",
+	        .value = RuntimeFeatureStateUndoMemoryLimit::UndoMemory8M,
+	    },
+	    {
+	        .displayName = display->haveOLED() ? "Unlimited" : "NONE",
+	        .value = RuntimeFeatureStateUndoMemoryLimit::UndoMemoryUnlimited,
+	    },
+	};
+}
+
 void RuntimeFeatureSettings::init() {
 	using enum deluge::l10n::String;
 	// Drum randomizer
@@ -204,6 +256,40 @@ void RuntimeFeatureSettings::init() {
 	// Rounded Corners
 	SetupOnOffSetting(settings[RuntimeFeatureSettingType::RoundedCorners], STRING_FOR_COMMUNITY_FEATURE_ROUNDED_CORNERS,
 	                  "roundedCorners", RuntimeFeatureStateToggle::On);
+
+	// Synced delay without resampling
+	SetupOnOffSetting(settings[RuntimeFeatureSettingType::SyncedDelayWithoutResampling],
+	                  STRING_FOR_COMMUNITY_FEATURE_SYNCED_DELAY_WITHOUT_RESAMPLING, "syncedDelayWithoutResampling",
+	                  RuntimeFeatureStateToggle::Off);
+
+	// Time stretch quality
+	SetupTimeStretchQualitySetting(settings[RuntimeFeatureSettingType::TimeStretchQuality],
+	                               STRING_FOR_COMMUNITY_FEATURE_TIME_STRETCH_QUALITY, "timeStretchQuality",
+	                               RuntimeFeatureStateTimeStretchQuality::Standard);
+
+	// Persist sample caches
+	SetupOnOffSetting(settings[RuntimeFeatureSettingType::PersistSampleCaches],
+	                  STRING_FOR_COMMUNITY_FEATURE_PERSIST_SAMPLE_CACHES, "persistSampleCaches",
+	                  RuntimeFeatureStateToggle::Off);
+
+	// Binary song files
+	SetupOnOffSetting(settings[RuntimeFeatureSettingType::BinarySongFiles],
+	                  STRING_FOR_COMMUNITY_FEATURE_BINARY_SONG_FILES, "binarySongFiles",
+	                  RuntimeFeatureStateToggle::Off);
+
+	// Preload next song
+	SetupOnOffSetting(settings[RuntimeFeatureSettingType::PreloadNextSong],
+	                  STRING_FOR_COMMUNITY_FEATURE_PRELOAD_NEXT_SONG, "preloadNextSong",
+	                  RuntimeFeatureStateToggle::Off);
+
+	// Set list
+	SetupOnOffSetting(settings[RuntimeFeatureSettingType::SetListMode], STRING_FOR_COMMUNITY_FEATURE_SET_LIST,
+	                  "setList", RuntimeFeatureStateToggle::Off);
+
+	// Undo memory limit
+	SetupUndoMemoryLimitSetting(settings[RuntimeFeatureSettingType::UndoMemoryLimit],
+	                            STRING_FOR_COMMUNITY_FEATURE_UNDO_MEMORY_LIMIT, "undoMemoryLimit",
+	                            RuntimeFeatureStateUndoMemoryLimit::UndoMemoryUnlimited);
 }
 
 void RuntimeFeatureSettings::factoryReset(bool showPopup) {
@@ -41,6 +41,15 @@ enum RuntimeFeatureStateSyncScalingAction : uint32_t { SyncScaling = 0, Fill = 1
 
 enum RuntimeFeatureStateEmulatedDisplay : uint32_t { Hardware = 0, Toggle = 1, OnBoot = 2 };
 
+enum class RuntimeFeatureStateTimeStretchQuality : uint32_t { Standard = 0, Fast = 1, High = 2, Auto = 3 };
+
+enum RuntimeFeatureStateUndoMemoryLimit : uint32_t {
+	UndoMemoryUnlimited = 0,
+	UndoMemory512K = 1,
+	UndoMemory2M = 2,
+	UndoMemory8M = 3
+};
+
 /// Every setting needs to be declared in here
 enum RuntimeFeatureSettingType : uint32_t {
 	DrumRandomizer,
@@ -67,6 +76,13 @@ enum RuntimeFeatureSettingType : uint32_t {
 	TrimFromStartOfAudioClip,
 	ShowBatteryLevel,
 	RoundedCorners,
+	SyncedDelayWithoutResampling,
+	TimeStretchQuality,
+	PersistSampleCaches,
+	BinarySongFiles,
+	PreloadNextSong,
+	SetListMode,
+	UndoMemoryLimit,
 	MaxElement // Keep as boundary
 };
 
@@ -1739,36 +1739,7 @@ unknownTag:
 
 			// legacy section, read as part of global effectable (songParams tag) post c1.1
 			else if (!strcmp(tagName, "songCompressor")) {
-				while (*(tagName = reader.readNextTagOrAttributeName())) {
-					if (!strcmp(tagName, "attack")) {
-						q31_t masterCompressorAttack = reader.readTagOrAttributeValueInt();
-						globalEffectable.compressor.setAttack(masterCompressorAttack);
-						reader.exitTag("attack");
-					}
-					else if (!strcmp(tagName, "release")) {
-						q31_t masterCompressorRelease = reader.readTagOrAttributeValueInt();
-						globalEffectable.compressor.setRelease(masterCompressorRelease);
-						reader.exitTag("release");
-					}
-					else if (!strcmp(tagName, "thresh")) {
-						q31_t masterCompressorThresh = reader.readTagOrAttributeValueInt();
-						globalEffectable.compressor.setThreshold(masterCompressorThresh);
-						reader.exitTag("thresh");
-					}
-					else if (!strcmp(tagName, "ratio")) {
-						q31_t masterCompressorRatio = reader.readTagOrAttributeValueInt();
-						globalEffectable.compressor.setRatio(masterCompressorRatio);
-						reader.exitTag("ratio");
-					}
-					else if (!strcmp(tagName, "compHPF")) {
-						q31_t masterCompressorSidechain = reader.readTagOrAttributeValueInt();
-						globalEffectable.compressor.setSidechain(masterCompressorSidechain);
-						reader.exitTag("compHPF");
-					}
-					else {
-						reader.exitTag(tagName);
-					}
-				}
+				globalEffectable.compressor.readFromFile(reader);
 				reader.exitTag("songCompressor");
 			}
 
@@ -55,6 +55,7 @@
 AutoParam::AutoParam() {
 	init();
 	currentValue = 0;
+	nodeIndexLastSearched = 0;
 	resetInterpolationIncrement();
 	renewedOverridingAtTime = 0;
 }
@@ -411,15 +412,14 @@ int32_t AutoParam::processCurrentPos(ModelStackWithAutoParam const* modelStack,
 	int32_t effectiveLength = modelStack->getLoopLength();
 
 	// Find next node - here or further along in our direction
-	int32_t searchDirection = -(int32_t)reversed;
-	int32_t searchPos = currentPos + (int32_t)reversed;
-	int32_t iJustReached = nodes.search(searchPos, searchDirection);
+	int32_t iJustReached = nodes.searchNearIndex(currentPos, reversed, nodeIndexLastSearched);
 	if (iJustReached < 0) {
 		iJustReached += nodes.getNumElements();
 	}
 	else if (iJustReached >= nodes.getNumElements()) {
 		iJustReached = 0;
 	}
+	nodeIndexLastSearched = iJustReached;
 
 	ParamNode* nodeJustReached = nodes.getElement(iJustReached);
 	int32_t howFarUntilThisNode = nodeJustReached->pos - currentPos;
@@ -1989,29 +1989,14 @@ addNewNodeAt0IfNecessary:
 }
 
 void AutoParam::writeToFile(Serializer& writer, bool writeAutomation, int32_t* valueForOverride) {
-	char buffer[9];
-
 	writer.write("0x");
 
 	int32_t valueNow = (valueForOverride && isAutomated()) ? *valueForOverride : currentValue;
 
-	intToHex(valueNow, buffer);
-	writer.write(buffer);
+	writer.writeHexDigits(valueNow);
 
 	if (writeAutomation) {
-
-		for (int32_t i = 0; i < nodes.getNumElements(); i++) {
-			ParamNode* thisNode = nodes.getElement(i);
-			intToHex(thisNode->value, buffer);
-			writer.write(buffer);
-
-			uint32_t pos = thisNode->pos;
-			if (thisNode->interpolated) {
-				pos |= ((uint32_t)1 << 31);
-			}
-			intToHex(pos, buffer);
-			writer.write(buffer);
-		}
+		nodes.writeToFile(writer);
 	}
 }
 
@@ -2024,112 +2009,54 @@ Error AutoParam::readFromFile(Deserializer& reader, int32_t readAutomationUpToPo
 	// files, we'll be overwriting a cloned ParamManager, which might have had automation.
 	deleteAutomationBasicForSetup();
 
-	if (!reader.prepareToReadTagOrAttributeValueOneCharAtATime()) {
-		return Error::NONE;
-	}
+	// Binary song files hand us the raw bytes, saving us decoding the hex
+	bool readingBytes = reader.prepareToReadHexValueAsBytes();
 
-	// char buffer[12];
-	char const* firstChars = reader.readNextCharsOfTagOrAttributeValue(2);
-	if (!firstChars) {
-		return Error::NONE;
-	}
+	if (!readingBytes) {
+		if (!reader.prepareToReadTagOrAttributeValueOneCharAtATime()) {
+			return Error::NONE;
+		}
 
-	// If a decimal, then read the rest of the digits
-	if (*(uint16_t*)firstChars != charsToIntegerConstant('0', 'x')) {
-		char buffer[12];
-		buffer[0] = firstChars[0];
-		buffer[1] = firstChars[1];
+		// char buffer[12];
+		char const* firstChars = reader.readNextCharsOfTagOrAttributeValue(2);
+		if (!firstChars) {
+			return Error::NONE;
+		}
 
-		for (int32_t i = 2; i < 12 && (buffer[i] = reader.readNextCharOfTagOrAttributeValue()); i++) {}
-		buffer[11] = 0;
-		currentValue = stringToInt(buffer);
-		return Error::NONE;
+		// If a decimal, then read the rest of the digits
+		if (*(uint16_t*)firstChars != charsToIntegerConstant('0', 'x')) {
+			char buffer[12];
+			buffer[0] = firstChars[0];
+			buffer[1] = firstChars[1];
+
+			for (int32_t i = 2; i < 12 && (buffer[i] = reader.readNextCharOfTagOrAttributeValue()); i++) {}
+			buffer[11] = 0;
+			currentValue = stringToInt(buffer);
+			return Error::NONE;
+		}
 	}
 
 	// Or, normal case - hex and automation...
 
 	// First, read currentValue
-	char const* hexChars = reader.readNextCharsOfTagOrAttributeValue(8);
-	if (!hexChars) {
-		return Error::NONE;
+	if (readingBytes) {
+		uint8_t const* bytes = reader.readNextBytesOfHexValue(4);
+		if (!bytes) {
+			return Error::NONE;
+		}
+		currentValue = bytesToIntFixedLength(bytes, 4);
+	}
+	else {
+		char const* hexChars = reader.readNextCharsOfTagOrAttributeValue(8);
+		if (!hexChars) {
+			return Error::NONE;
+		}
+		currentValue = hexToIntFixedLength(hexChars, 8);
 	}
-	currentValue = hexToIntFixedLength(hexChars, 8);
 
 	// And now read in the automation
-	int32_t numElementsToAllocateFor = 0;
-
 	if (readAutomationUpToPos) {
-
-		int32_t prevPos = -1;
-
-		while (true) {
-
-			// Every time we've reached the end of a cluster...
-			if (numElementsToAllocateFor <= 0) {
-
-				// See how many more chars before the end of the cluster. If there are any...
-				uint32_t charsRemaining = reader.getNumCharsRemainingInValueBeforeEndOfCluster();
-				if (charsRemaining) {
-
-					// Allocate space for the right number of notes, and remember how long it'll be before we need to do
-					// this check again
-					numElementsToAllocateFor = (uint32_t)(charsRemaining - 1) / 16 + 1;
-					nodes.ensureEnoughSpaceAllocated(
-					    numElementsToAllocateFor); // If it returns false... oh well. We'll fail later
-				}
-			}
-
-			hexChars = reader.readNextCharsOfTagOrAttributeValue(16);
-			if (!hexChars) {
-				return Error::NONE;
-			}
-			int32_t value = hexToIntFixedLength(hexChars, 8);
-			int32_t pos = hexToIntFixedLength(&hexChars[8], 8);
-
-			bool interpolated = (pos & ((uint32_t)1 << 31));
-			if (interpolated) {
-				pos &= ~((uint32_t)1 << 31);
-			}
-
-			// Ensure there isn't some problem where nodes are out of order...
-			if (pos <= prevPos) {
-				D_PRINTLN("Automation nodes out of order");
-				continue;
-			}
-
-			// If we've reached the end of our allowed timeline length for automation...
-			if (pos >= readAutomationUpToPos) {
-
-				// If there's a node actually right on the end-point - well, firmware <= 3.1.5 sometimes put one there
-				// when it should have been at pos 0. So, reinterpret that data to make it right.
-				if (pos == readAutomationUpToPos) {
-					ParamNode* firstNode = nodes.getElement(0);
-					if (!firstNode || firstNode->pos) {
-						Error error = nodes.insertAtIndex(0);
-						if (error != Error::NONE) {
-							return error;
-						}
-						firstNode = nodes.getElement(0);
-						firstNode->pos = 0;
-						firstNode->value = value;
-						firstNode->interpolated = interpolated;
-					}
-				}
-				break;
-			}
-
-			prevPos = pos;
-
-			int32_t nodeI = nodes.insertAtKey(pos, true);
-			if (nodeI == -1) {
-				return Error::INSUFFICIENT_RAM;
-			}
-			ParamNode* node = nodes.getElement(nodeI);
-			node->value = value;
-			node->interpolated = interpolated;
-
-			numElementsToAllocateFor--;
-		}
+		return nodes.readFromFile(reader, readingBytes, readAutomationUpToPos);
 	}
 
 	return Error::NONE;
@@ -139,6 +139,9 @@ public:
 
 	uint32_t renewedOverridingAtTime; // If 0, it's off. If 1, it's latched until we hit some nodes / automation
 
+	/// Where processCurrentPos() found the node it was heading for last time - where it'll look first next time.
+	int32_t nodeIndexLastSearched;
+
 	// "Latching" happens when you start recording values, but then stops if you arrive at any pre-existing values. So
 	// it only works in empty stretches of time.
 
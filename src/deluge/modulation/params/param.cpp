@@ -23,6 +23,7 @@
 #include "model/mod_controllable/mod_controllable_audio.h"
 #include "model/song/song.h"
 #include "util/container/enum_to_string_map.hpp"
+#include <array>
 #include <cstring>
 
 namespace deluge::modulation::params {
@@ -762,7 +763,73 @@ constexpr ParamType fileStringToParamConst(Kind kind, char const* name, bool all
 
 	return util::to_underlying(GLOBAL_NONE);
 }
+
+namespace {
+
+constexpr uint32_t hashParamName(std::string_view name) {
+	uint32_t hash = 2166136261u; // FNV-1a
+	for (char c : name) {
+		hash = (hash ^ (uint8_t)c) * 16777619u;
+	}
+	return hash;
+}
+
+/// Hash table from file name to ParamType, built by the compiler, so that reading a file doesn't have to compare each
+/// name against every param in turn. Gives exactly what fileStringToParamConst() would - including the first of any
+/// params which share a name.
+class ParamNameTable {
+public:
+	constexpr ParamNameTable(Kind kind, bool allowPatched) : kind_(kind) {
+		for (int32_t p = allowPatched ? 0 : UNPATCHED_START; p < kUnpatchedAndPatchedMaximum; ++p) {
+			std::string_view name = paramNameForFileConst(kind, p);
+			uint32_t slot = hashParamName(name) & (kNumSlots - 1);
+			while (slots_[slot] && name != paramNameForFileConst(kind, slots_[slot] - 1)) {
+				slot = (slot + 1) & (kNumSlots - 1);
+			}
+			if (!slots_[slot]) {
+				slots_[slot] = p + 1;
+			}
+		}
+	}
+
+	constexpr ParamType find(std::string_view name) const {
+		uint32_t slot = hashParamName(name) & (kNumSlots - 1);
+		while (slots_[slot]) {
+			ParamType p = slots_[slot] - 1;
+			if (name == paramNameForFileConst(kind_, p)) {
+				return p;
+			}
+			slot = (slot + 1) & (kNumSlots - 1);
+		}
+
+		if (name == "range") {
+			return util::to_underlying(PLACEHOLDER_RANGE); // For compatibility reading files from before V3.2.0
+		}
+
+		return util::to_underlying(GLOBAL_NONE);
+	}
+
+private:
+	static constexpr int32_t kNumSlots = 512;
+	static_assert(kUnpatchedAndPatchedMaximum < 255, "Param table slots are 8 bits");
+
+	Kind kind_;
+	std::array<uint8_t, kNumSlots> slots_{}; // Param + 1, or 0 if empty
+};
+
+// The only combinations files are read with
+constexpr ParamNameTable soundParamNames{Kind::UNPATCHED_SOUND, true};
+constexpr ParamNameTable globalParamNames{Kind::UNPATCHED_GLOBAL, false};
+
+} // namespace
+
 ParamType fileStringToParam(Kind kind, char const* name, bool allowPatched) {
+	if (kind == Kind::UNPATCHED_SOUND && allowPatched) {
+		return soundParamNames.find(name);
+	}
+	if (kind == Kind::UNPATCHED_GLOBAL && !allowPatched) {
+		return globalParamNames.find(name);
+	}
 	return fileStringToParamConst(kind, name, allowPatched);
 }
 uint32_t expressionParamFromShortcut(int x, int y) {
@@ -799,4 +866,20 @@ constexpr bool validateParams() {
 	return m;
 }
 static_assert(validateParams());
+
+constexpr bool validateParamNameTables() {
+	for (int32_t p = 0; p < kUnpatchedAndPatchedMaximum; ++p) {
+		auto name = paramNameForFileConst(Kind::UNPATCHED_SOUND, p);
+		if (soundParamNames.find(name) != fileStringToParamConst(Kind::UNPATCHED_SOUND, name, true)) {
+			return false;
+		}
+		name = paramNameForFileConst(Kind::UNPATCHED_GLOBAL, p);
+		if (globalParamNames.find(name) != fileStringToParamConst(Kind::UNPATCHED_GLOBAL, name, false)) {
+			return false;
+		}
+	}
+	return soundParamNames.find("range") == fileStringToParamConst(Kind::UNPATCHED_SOUND, "range", true)
+	       && soundParamNames.find("notAParam") == fileStringToParamConst(Kind::UNPATCHED_SOUND, "notAParam", true);
+}
+static_assert(validateParamNameTables());
 } // namespace deluge::modulation::params
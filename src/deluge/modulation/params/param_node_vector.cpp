@@ -17,7 +17,10 @@
 
 #include "modulation/params/param_node_vector.h"
 
+#include "io/debug/log.h"
 #include "modulation/params/param_node.h"
+#include "storage/storage_manager.h"
+#include "util/d_stringbuf.h"
 #include <cstdint>
 #include <string.h>
 
@@ -38,3 +41,132 @@ ParamNode* ParamNodeVector::getFirst() {
 ParamNode* ParamNodeVector::getLast() {
 	return getElement(getNumElements() - 1);
 }
+
+// Gives the same result as searching for the next node at or beyond pos in our direction, but during playback that's
+// nearly always the node the last search found, or the one after it - so check those before binary searching. Edits
+// can leave lastIndexFound pointing anywhere, so the neighbours are always checked rather than trusted.
+int32_t ParamNodeVector::searchNearIndex(int32_t pos, bool reversed, int32_t lastIndexFound) {
+	int32_t numNodes = getNumElements();
+
+	if (reversed) {
+		// Looking for the last node at or before pos - or -1 if there isn't one
+		for (int32_t i = lastIndexFound; i >= lastIndexFound - 1; i--) {
+			if (i >= -1 && i < numNodes && (i == -1 || getElement(i)->pos <= pos)
+			    && (i == numNodes - 1 || getElement(i + 1)->pos > pos)) {
+				return i;
+			}
+		}
+		return search(pos + 1, LESS);
+	}
+	else {
+		// Looking for the first node at or after pos - or numNodes if there isn't one
+		for (int32_t i = lastIndexFound; i <= lastIndexFound + 1; i++) {
+			if (i >= 0 && i <= numNodes && (i == numNodes || getElement(i)->pos >= pos)
+			    && (i == 0 || getElement(i - 1)->pos < pos)) {
+				return i;
+			}
+		}
+		return search(pos, GREATER_OR_EQUAL);
+	}
+}
+
+// Writes each node's value and position, into the "0x..." value the caller has opened
+void ParamNodeVector::writeToFile(Serializer& writer) {
+	for (int32_t i = 0; i < getNumElements(); i++) {
+		ParamNode* thisNode = getElement(i);
+		writer.writeHexDigits(thisNode->value);
+
+		uint32_t pos = thisNode->pos;
+		if (thisNode->interpolated) {
+			pos |= ((uint32_t)1 << 31);
+		}
+		writer.writeHexDigits(pos);
+	}
+}
+
+// Reads the nodes which follow the current value in an AutoParam's "0x..." value, as far as readAutomationUpToPos.
+// Running out of RAM is the only error - anything unreadable is just the end of the nodes.
+Error ParamNodeVector::readFromFile(Deserializer& reader, bool readingBytes, int32_t readAutomationUpToPos) {
+	int32_t numElementsToAllocateFor = 0;
+	int32_t prevPos = -1;
+
+	while (true) {
+
+		// Every time we've reached the end of a cluster...
+		if (numElementsToAllocateFor <= 0) {
+
+			// See how many more chars before the end of the cluster. If there are any...
+			uint32_t charsRemaining = reader.getNumCharsRemainingInValueBeforeEndOfCluster();
+			if (charsRemaining) {
+
+				// Allocate space for the right number of nodes, and remember how long it'll be before we need to do
+				// this check again
+				numElementsToAllocateFor = (uint32_t)(charsRemaining - 1) / 16 + 1;
+				ensureEnoughSpaceAllocated(numElementsToAllocateFor); // If it returns false... oh well. We'll fail later
+			}
+		}
+
+		int32_t value;
+		int32_t pos;
+		if (readingBytes) {
+			uint8_t const* bytes = reader.readNextBytesOfHexValue(8);
+			if (!bytes) {
+				return Error::NONE;
+			}
+			value = bytesToIntFixedLength(bytes, 4);
+			pos = bytesToIntFixedLength(&bytes[4], 4);
+		}
+		else {
+			char const* hexChars = reader.readNextCharsOfTagOrAttributeValue(16);
+			if (!hexChars) {
+				return Error::NONE;
+			}
+			value = hexToIntFixedLength(hexChars, 8);
+			pos = hexToIntFixedLength(&hexChars[8], 8);
+		}
+
+		bool interpolated = (pos & ((uint32_t)1 << 31));
+		if (interpolated) {
+			pos &= ~((uint32_t)1 << 31);
+		}
+
+		// Ensure there isn't some problem where nodes are out of order...
+		if (pos <= prevPos) {
+			D_PRINTLN("Automation nodes out of order");
+			continue;
+		}
+
+		// If we've reached the end of our allowed timeline length for automation...
+		if (pos >= readAutomationUpToPos) {
+
+			// If there's a node actually right on the end-point - well, firmware <= 3.1.5 sometimes put one there when
+			// it should have been at pos 0. So, reinterpret that data to make it right.
+			if (pos == readAutomationUpToPos) {
+				ParamNode* firstNode = getElement(0);
+				if (!firstNode || firstNode->pos) {
+					Error error = insertAtIndex(0);
+					if (error != Error::NONE) {
+						return error;
+					}
+					firstNode = getElement(0);
+					firstNode->pos = 0;
+					firstNode->value = value;
+					firstNode->interpolated = interpolated;
+				}
+			}
+			return Error::NONE;
+		}
+
+		prevPos = pos;
+
+		int32_t nodeI = insertAtKey(pos, true);
+		if (nodeI == -1) {
+			return Error::INSUFFICIENT_RAM;
+		}
+		ParamNode* node = getElement(nodeI);
+		node->value = value;
+		node->interpolated = interpolated;
+
+		numElementsToAllocateFor--;
+	}
+}
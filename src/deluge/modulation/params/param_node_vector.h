@@ -20,6 +20,8 @@
 #include "util/container/array/ordered_resizeable_array.h"
 
 class ParamNode;
+class Serializer;
+class Deserializer;
 
 class ParamNodeVector : public OrderedResizeableArrayWith32bitKey {
 public:
@@ -28,4 +30,7 @@ public:
 	ParamNode* getElement(int32_t index);
 	ParamNode* getFirst();
 	ParamNode* getLast();
+	int32_t searchNearIndex(int32_t pos, bool reversed, int32_t lastIndexFound);
+	void writeToFile(Serializer& writer);
+	Error readFromFile(Deserializer& reader, bool readingBytes, int32_t readAutomationUpToPos);
 };
@@ -507,11 +507,9 @@ bool PatchCableSet::patchCableIsUsable(uint8_t c, ModelStackWithThreeMainThings
 	        == PatchCableAcceptance::ALLOWED);
 }
 
-int32_t PatchCableSet::getModifiedPatchCableAmount(int32_t c, int32_t p) {
-	// For some params, we square the cable strength, to make it slope up more slowly at first, so we have access
-	// to small effects as well as big
-	int32_t output;
-	int32_t amount = patchCables[c].param.getCurrentValue();
+// For some params, we square the cable strength, to make it slope up more slowly at first, so we have access to small
+// effects as well as big
+bool PatchCableSet::isPatchCableAmountModifiedForParam(int32_t p) {
 	switch (p) {
 	case params::LOCAL_PITCH_ADJUST:
 	case params::LOCAL_OSC_A_PITCH_ADJUST:
@@ -519,6 +517,16 @@ int32_t PatchCableSet::getModifiedPatchCableAmount(int32_t c, int32_t p) {
 	case params::LOCAL_MODULATOR_0_PITCH_ADJUST:
 	case params::LOCAL_MODULATOR_1_PITCH_ADJUST:
 	case params::GLOBAL_DELAY_RATE:
+		return true;
+	default:
+		return false;
+	}
+}
+
+int32_t PatchCableSet::getModifiedPatchCableAmount(int32_t c, int32_t p) {
+	int32_t output;
+	int32_t amount = patchCables[c].param.getCurrentValue();
+	if (isPatchCableAmountModifiedForParam(p)) {
 		output = (amount >> 15) * (amount >> 16);
 		if (amount < 0) {
 			output = -output;
@@ -538,9 +546,8 @@ int32_t PatchCableSet::getModifiedPatchCableAmount(int32_t c, int32_t p) {
 		}
 
 		return output;
-	default:
-		return amount;
 	}
+	return amount;
 }
 
 // No need to supply Sound if you don't need setupPatching() to be called now (cos you're gonna call it later)
@@ -51,6 +51,7 @@ public:
 	void deletePatchCable(ModelStackWithParamCollection const* modelStack, uint8_t c);
 	bool patchCableIsUsable(uint8_t c, ModelStackWithThreeMainThings const* modelStack);
 	int32_t getModifiedPatchCableAmount(int32_t c, int32_t p);
+	static bool isPatchCableAmountModifiedForParam(int32_t p);
 	void removeAllPatchingToParam(ModelStackWithParamCollection* modelStack, uint8_t p);
 	bool isSourcePatchedToSomething(PatchSource s);
 	bool isSourcePatchedToSomethingManuallyCheckCables(PatchSource s);
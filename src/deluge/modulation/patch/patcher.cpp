@@ -21,39 +21,34 @@
 #include "modulation/patch/patch_cable.h"
 #include "modulation/patch/patch_cable_set.h"
 #include "processing/sound/sound.h"
-#include <etl/vector.h>
 #include <utility>
 
 namespace params = deluge::modulation::params;
 
-// If NULL Destination, that means no cables - just the preset value
-void Patcher::recalculateFinalValueForParamWithNoCables(int32_t p, Sound& sound,
-                                                        ParamManagerForTimeline& param_manager) {
-
-	int32_t cable_combination = (p < config.firstHybridParam) ? combineCablesLinear(nullptr, p, sound, param_manager)
-	                                                          : combineCablesExp(nullptr, p, sound, param_manager);
-
-	int32_t final_value = 0;
+// Turns a "cable combination", as worked out by combineCablesLinear() or combineCablesExp(), into the final value
+[[gnu::always_inline]] inline int32_t Patcher::getFinalValue(int32_t p, int32_t cable_combination) {
 	int32_t param_neutral_value = paramNeutralValues[p];
 
 	if (p < config.firstHybridParam) {
 		if (p < config.firstNonVolumeParam) {
-			final_value = getFinalParameterValueVolume(param_neutral_value, cable_combination);
-		}
-		else {
-			final_value = getFinalParameterValueLinear(param_neutral_value, cable_combination);
+			return getFinalParameterValueVolume(param_neutral_value, cable_combination);
 		}
+		return getFinalParameterValueLinear(param_neutral_value, cable_combination);
 	}
-	else {
-		if (p < config.firstExpParam) {
-			final_value = getFinalParameterValueHybrid(param_neutral_value, cable_combination); // Hybrid - add
-		}
-		else {
-			final_value = getFinalParameterValueExpWithDumbEnvelopeHack(param_neutral_value, cable_combination, p);
-		}
+	if (p < config.firstExpParam) {
+		return getFinalParameterValueHybrid(param_neutral_value, cable_combination); // Hybrid - add
 	}
+	return getFinalParameterValueExpWithDumbEnvelopeHack(param_neutral_value, cable_combination, p);
+}
+
+// If NULL Destination, that means no cables - just the preset value
+void Patcher::recalculateFinalValueForParamWithNoCables(int32_t p, Sound& sound,
+                                                        ParamManagerForTimeline& param_manager) {
+
+	int32_t cable_combination = (p < config.firstHybridParam) ? combineCablesLinear(nullptr, p, sound, param_manager)
+	                                                          : combineCablesExp(nullptr, p, sound, param_manager);
 
-	param_final_values_[p - config.firstParam] = final_value;
+	param_final_values_[p - config.firstParam] = getFinalValue(p, cable_combination);
 }
 
 int32_t rangeFinalValues[kMaxNumPatchCables]; // TODO: storing these in permanent memory per voice could save a tiny bit
@@ -84,17 +79,16 @@ void Patcher::performPatching(uint32_t sourcesChanged, Sound& sound, ParamManage
 		rangeFinalValues[i] = getFinalParameterValueLinear(536870912, cables_combination);
 	}
 
-	// param_id, cable_combo
-	etl::vector<std::pair<int32_t, int32_t>, params::kNumParams> cable_combos;
-
-	// Now normal, actual params/destinations
+	// Now normal, actual params/destinations. Only the ones with a source that's changed need recomputing - and each
+	// one goes to a different param, so we can turn its cable combination into its final value straight away.
 	for (; destination->destinationParamDescriptor.data < (config.firstHybridParam | 0xFFFFFF00); destination++) {
 		if ((destination->sources & sourcesChanged) == 0u) {
 			continue;
 		}
 
 		int32_t param = destination->destinationParamDescriptor.getJustTheParam();
-		cable_combos.push_back({param, combineCablesLinear(destination, param, sound, param_manager)});
+		param_final_values_[param - config.firstParam] =
+		    getFinalValue(param, combineCablesLinear(destination, param, sound, param_manager));
 	}
 
 	for (; destination->sources != 0u; destination++) {
@@ -103,40 +97,8 @@ void Patcher::performPatching(uint32_t sourcesChanged, Sound& sound, ParamManage
 		}
 
 		int32_t param = destination->destinationParamDescriptor.getJustTheParam();
-		cable_combos.push_back({param, combineCablesExp(destination, param, sound, param_manager)});
-	}
-
-	// sort by param_id
-	std::ranges::sort(cable_combos, std::less(), &std::pair<int32_t, int32_t>::first);
-
-	auto* iterator = cable_combos.begin();
-
-	// Now, turn those cableCombinations into paramFinalValues.
-	// Volume params
-	for (; iterator < cable_combos.end() && iterator->first < config.firstNonVolumeParam; iterator++) {
-		auto [param, combo] = *iterator;
-		param_final_values_[param - config.firstParam] = getFinalParameterValueVolume(paramNeutralValues[param], combo);
-	}
-
-	// Linear params
-	for (; iterator < cable_combos.end() && iterator->first < config.firstHybridParam; iterator++) {
-		auto [param, cable_combo] = *iterator;
 		param_final_values_[param - config.firstParam] =
-		    getFinalParameterValueLinear(paramNeutralValues[param], cable_combo);
-	}
-
-	// Hybrid params
-	for (; iterator < cable_combos.end() && iterator->first < config.firstExpParam; iterator++) {
-		auto [param, cable_combo] = *iterator;
-		param_final_values_[param - config.firstParam] =
-		    getFinalParameterValueHybrid(paramNeutralValues[param], cable_combo);
-	}
-
-	// Exp params
-	for (; iterator < cable_combos.end() && iterator->first < config.endParams; iterator++) {
-		auto [param, cable_combo] = *iterator;
-		param_final_values_[param - config.firstParam] =
-		    getFinalParameterValueExpWithDumbEnvelopeHack(paramNeutralValues[param], cable_combo, param);
+		    getFinalValue(param, combineCablesExp(destination, param, sound, param_manager));
 	}
 }
 
@@ -245,12 +207,16 @@ int32_t Patcher::cableToExpParam(int32_t running_total, const PatchCable& patch_
 	PatchCableSet& patch_cable_set = *param_manager.getPatchCableSet();
 
 	if (destination != nullptr) {
+		// Only a few params modify their cables' amounts, so find out once rather than for every cable
+		bool amounts_modified = PatchCableSet::isPatchCableAmountModifiedForParam(param);
+
 		// For each patch cable affecting this parameter
 		for (int32_t c = destination->firstCable; c < destination->endCable; c++) {
 			PatchCable& patch_cable = patch_cable_set.patchCables[c];
 			int32_t source_value = source_values_[std::to_underlying(patch_cable.from)];
 			source_value = patch_cable.toPolarity(source_value);
-			int32_t cable_strength = patch_cable_set.getModifiedPatchCableAmount(c, param);
+			int32_t cable_strength = amounts_modified ? patch_cable_set.getModifiedPatchCableAmount(c, param)
+			                                          : patch_cable.param.getCurrentValue();
 			running_total = cableToExpParam(running_total, patch_cable, source_value, cable_strength);
 		}
 
@@ -53,6 +53,7 @@ public:
 	void recalculateFinalValueForParamWithNoCables(int32_t param, Sound& sound, ParamManagerForTimeline& param_manager);
 
 private:
+	int32_t getFinalValue(int32_t p, int32_t cable_combination);
 	int32_t combineCablesLinearForRangeParam(Destination const* destination, ParamManager& param_manager);
 	int32_t combineCablesLinear(Destination const* destination, uint32_t param, Sound& sound,
 	                            ParamManager& param_manager);
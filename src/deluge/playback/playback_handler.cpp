@@ -142,6 +142,10 @@ void PlaybackHandler::routine() {
 		//  todo - should add the ability to block the task in the task manager instead but whatever
 		return;
 	}
+	// Play any MIDI input that's been held back for the input latency and is now due. The audio routine stops its
+	// render windows at these, so this gets them in before the window that should start with them
+	midiEngine.playDueScheduledInput();
+
 	// Check analog clock input
 	if (triggerClockRisingEdgesProcessed != triggerClockRisingEdgesReceived) {
 		uint32_t time =
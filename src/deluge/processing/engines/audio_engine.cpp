@@ -20,9 +20,11 @@
 #include "chrono"
 #include "definitions.h"
 #include "definitions_cxx.hpp"
+#include "dsp/compressor/sidechain_key.h"
 #include "dsp/reverb/reverb.hpp"
 #include "dsp/timestretch/time_stretcher.h"
 #include "extern.h"
+#include "firmware_tasks.h"
 #include "gui/context_menu/sample_browser/kit.h"
 #include "gui/context_menu/sample_browser/synth.h"
 #include "gui/ui/audio_recorder.h"
@@ -141,6 +143,7 @@ int32_t reverbSidechainShapeInEffect;
 bool mustUpdateReverbParamsBeforeNextRender = false;
 
 int32_t sideChainHitPending = false;
+SideChainKey sideChainKey{};
 
 uint32_t timeLastSideChainHit = 2147483648;
 int32_t sizeLastSideChainHit;
@@ -200,6 +203,17 @@ uint32_t saddr;
 deluge::fast_vector<Sound*> sounds;
 TaskID routine_task_id = -1;
 
+AudioLatencyTier latencyTier = AudioLatencyTier::AUTO;
+std::array<uint32_t, kNumAudioLatencyTiers> numUnderruns{};
+
+// How many samples were queued for the DMA when routine() last finished, and when - to tell if it's run dry since
+int32_t samplesQueuedAtLastOutput = 0;
+double timeOfLastOutput = 0;
+
+// Underruns get counted by the audio routine, but logged later from slowRoutine(), to keep printing out of it
+uint32_t numUnderrunsSinceLogged = 0;
+double lastUnderrunGap = 0;
+
 // You must set up dynamic memory allocation before calling this, because of its call to setupWithPatching()
 void init() {
 	paramManagerForSamplePreview = new ((void*)paramManagerForSamplePreviewMemory) ParamManagerForTimeline();
@@ -402,6 +416,17 @@ void routineWithClusterLoading(bool mayProcessUserActionsBetween) {
 	}
 }
 
+void setLatencyTier(AudioLatencyTier tier) {
+	latencyTier = tier;
+	if (routine_task_id == -1) {
+		return; // registerTasks() will call this again once the task exists
+	}
+	FirmwareTask task = FirmwareTasks::audioRoutine(tier);
+	setTimeBetweenCallsForTask(routine_task_id, task.backOffTime, task.targetTimeBetweenCalls,
+	                           task.maxTimeBetweenCalls);
+	setMaxLatencyForTask(routine_task_id, task.maxLatency);
+}
+
 void runRoutine() {
 	// check if we've setup the audio routine task
 	if (routine_task_id != -1) [[likely]] {
@@ -469,8 +494,9 @@ void cullVoices(size_t numSamples, int32_t numAudio, int32_t numVoice) {
 		}
 
 		// Or if it's just a little bit dire, do a soft cull with fade-out, but only cull for sure if numSamples
-		// is increasing
-		else if (num_samples_over_limit >= 0) {
+		// is increasing. In the automatic time stretch quality mode, dropping stretched voices to the fast tier
+		// comes first, so wait until that's happened
+		else if (num_samples_over_limit >= 0 && !TimeStretcher::autoQualityCanStillDrop()) {
 			if (last_num_samples_over > 0 && num_samples_over_limit >= last_num_samples_over) {
 				forceReleaseOneVoice(numSamples);
 				if (numRoutines > 0) {
@@ -561,13 +587,6 @@ bool calledFromScheduler = false;
 
 /// inner loop of audio rendering, deliberately not in header
 [[gnu::hot]] void routine_() {
-	static double last_call_time = getSystemTime();
-	double current_time = getSystemTime();
-	if (current_time - last_call_time > 0.003) {
-		// If the audio routine is called at less than a 3ms interval, something is wrong
-		D_PRINTLN("Audio routine latency high: %.3fms", (current_time - last_call_time) * 1000.);
-	}
-	last_call_time = current_time;
 #ifndef USE_TASK_MANAGER // if not using task manager, midi and analog clock are processed together with audio
 	// process midi clock
 	playbackHandler.midiRoutine();
@@ -583,7 +602,12 @@ bool calledFromScheduler = false;
 	size_t numSamples = ((uint32_t)(saddr - i2sTXBufferPos) >> (2 + NUM_MONO_OUTPUT_CHANNELS_MAGNITUDE))
 	                    & (SSI_TX_BUFFER_NUM_SAMPLES - 1);
 
-	if (numSamples <= (10 * numRoutines)) {
+	// With fixed size blocks, wait until there's no more than a block left for the DMA to play - it plays that while
+	// the next one renders
+	size_t blockSize = FirmwareTasks::kRenderBlockSizes[util::to_underlying(latencyTier)];
+	bool waitingForBlock = blockSize && (SSI_TX_BUFFER_NUM_SAMPLES - numSamples) > blockSize;
+
+	if (numSamples <= (10 * numRoutines) || waitingForBlock) {
 		if (!numRoutines && calledFromScheduler) {
 			ignoreForStats();
 		}
@@ -592,28 +616,37 @@ bool calledFromScheduler = false;
 	flushMIDIGateBuffers();
 	setDireness(numSamples);
 
-	// Double the number of samples we're going to do - within some constraints
-	int32_t sampleThreshold = 6; // If too low, it'll lead to bigger audio windows and stuff
-	constexpr size_t maxAdjustedNumSamples = SSI_TX_BUFFER_NUM_SAMPLES;
-
 	int32_t unadjustedNumSamplesBeforeLappingPlayHead = numSamples;
 
-	if (numSamples < maxAdjustedNumSamples) {
-		int32_t samplesOverThreshold = numSamples - sampleThreshold;
-		if (samplesOverThreshold > 0) {
-			samplesOverThreshold = samplesOverThreshold << 1;
-			numSamples = sampleThreshold + samplesOverThreshold;
-		}
+	if (blockSize) {
+		// Render up to the end of the block - a whole one, unless the last window got cut short for a tick, so that
+		// blocks keep to the same boundaries
+		numSamples = blockSize - (audioSampleTimer & (blockSize - 1));
 	}
-	numSamples = std::min(numSamples, maxAdjustedNumSamples);
+	else {
+		// Double the number of samples we're going to do - within some constraints
+		int32_t sampleThreshold = 6; // If too low, it'll lead to bigger audio windows and stuff
+		constexpr size_t maxAdjustedNumSamples = SSI_TX_BUFFER_NUM_SAMPLES;
+
+		if (numSamples < maxAdjustedNumSamples) {
+			int32_t samplesOverThreshold = numSamples - sampleThreshold;
+			if (samplesOverThreshold > 0) {
+				samplesOverThreshold = samplesOverThreshold << 1;
+				numSamples = sampleThreshold + samplesOverThreshold;
+			}
+		}
+		numSamples = std::min(numSamples, maxAdjustedNumSamples);
 
-	// Want to round to be doing a multiple of 4 samples, so the NEON functions can be utilized most efficiently.
-	// Note - this can take numSamples up as high as SSI_TX_BUFFER_NUM_SAMPLES (currently 128).
-	if (numSamples >= 3) {
-		numSamples = (numSamples + 2) & ~3;
+		// Want to round to be doing a multiple of 4 samples, so the NEON functions can be utilized most efficiently.
+		// Note - this can take numSamples up as high as SSI_TX_BUFFER_NUM_SAMPLES (currently 128).
+		if (numSamples >= 3) {
+			numSamples = (numSamples + 2) & ~3;
+		}
 	}
 	voices_started_this_render = 0;
 
+	midiEngine.stopRenderAtScheduledInput(numSamples);
+
 	int32_t timeWithinWindowAtWhichMIDIOrGateOccurs = tickSongFinalizeWindows(numSamples);
 
 	numSamplesLastTime = numSamples;
@@ -650,6 +683,7 @@ void renderAudio(size_t numSamples) {
 	if (currentSong != nullptr) {
 		currentSong->renderAudio(renderingBuffer, reverbBuffer.data(), sideChainHitPending);
 	}
+	sideChainKey.finishWindow(numSamples);
 
 	renderReverb(numSamples);
 
@@ -685,6 +719,7 @@ void renderAudioForStemExport(size_t numSamples) {
 	if (currentSong != nullptr) {
 		currentSong->renderAudio(renderingBuffer, reverbBuffer.data(), sideChainHitPending);
 	}
+	sideChainKey.finishWindow(numSamples);
 
 	if (stemExport.includeSongFX) {
 		renderReverb(numSamples);
@@ -1043,6 +1078,39 @@ void routine_task() {
 	routine();
 	calledFromScheduler = false;
 }
+// not in header (private to audio engine)
+int32_t getNumSamplesQueuedForDMA() {
+	uint32_t space = ((uint32_t)getTxBufferCurrentPlace() - i2sTXBufferPos) >> (2 + NUM_MONO_OUTPUT_CHANNELS_MAGNITUDE);
+	// No space means full, as in doSomeOutputting() - we can't tell that from having run dry
+	return SSI_TX_BUFFER_NUM_SAMPLES - (space & (SSI_TX_BUFFER_NUM_SAMPLES - 1));
+}
+
+// not in header (private to audio engine)
+void checkForUnderrun() {
+	if (timeOfLastOutput == 0) {
+		return;
+	}
+	double now = getSystemTime();
+	if ((now - timeOfLastOutput) * kSampleRate > samplesQueuedAtLastOutput) {
+		// The DMA has played everything we'd given it - find out who held us up
+		numUnderruns[util::to_underlying(latencyTier)]++;
+		numUnderrunsSinceLogged++;
+		lastUnderrunGap = now - timeOfLastOutput;
+		reportDeadlineMiss(routine_task_id, timeOfLastOutput);
+	}
+}
+
+// not in header (private to audio engine)
+void logUnderruns() {
+	if (!numUnderrunsSinceLogged) {
+		return;
+	}
+	int32_t tier = util::to_underlying(latencyTier);
+	D_PRINTLN("%d audio underruns, the latest after %.3fms - %d so far at latency tier %d", numUnderrunsSinceLogged,
+	          lastUnderrunGap * 1000., numUnderruns[tier], tier);
+	numUnderrunsSinceLogged = 0;
+}
+
 void routine() {
 
 	logAction("AudioDriver::routine");
@@ -1057,6 +1125,8 @@ void routine() {
 
 	numRoutines = 0;
 	if (!stemExport.processStarted || (stemExport.processStarted && !stemExport.renderOffline)) {
+		checkForUnderrun();
+
 		while (doSomeOutputting() && numRoutines < 2) {
 
 #ifndef USE_TASK_MANAGER
@@ -1068,8 +1138,14 @@ void routine() {
 			routine_();
 			numRoutines += 1;
 		}
+
+		samplesQueuedAtLastOutput = getNumSamplesQueuedForDMA();
+		timeOfLastOutput = getSystemTime();
 	}
 	else {
+		// doesn't keep the DMA fed, so there's nothing to tell from when this last output anything
+		timeOfLastOutput = 0;
+
 		if (!sdRoutineLock) {
 			auto timeNow = getSystemTime();
 			while (getSystemTime() < timeNow + 32 / 44100.) {
@@ -1521,6 +1597,8 @@ void doRecorderCardRoutines() {
 }
 
 void slowRoutine() {
+	logUnderruns();
+
 	if (sdRoutineLock) {
 		// can happen if the SD routine is yielding
 		return;
@@ -18,6 +18,7 @@
 #pragma once
 
 #include "OSLikeStuff/scheduler_api.h"
+#include "OSLikeStuff/task_scheduler/budgeted_section.h"
 #include "definitions_cxx.hpp"
 #include "dsp/compressor/rms_feedback.h"
 #include "dsp/envelope_follower/absolute_value.h"
@@ -48,6 +49,7 @@ class VoiceVector;
 class Freeverb;
 class Metronome;
 class RMSFeedbackCompressor;
+class SideChainKey;
 class ModelStackWithSoundFlags;
 class SoundDrum;
 class AbsValueFollower;
@@ -142,6 +144,10 @@ using TimeStretcherPool = deluge::memory::ObjectPool<TimeStretcher, deluge::memo
 void routine();
 void routine_task();
 void routineWithClusterLoading(bool mayProcessUserActionsBetween = false);
+/// Declares a BudgetedSection for a long stretch of UI work, which calls routineWithClusterLoading() once its budget's
+/// used up. Nothing else gets to run, as the UI is likely to be mid-edit - and button handling could find it that way
+#define AUDIO_BUDGETED_SECTION(name)                                                                                   \
+	BUDGETED_SECTION(name, BudgetedSection::kDefaultBudget, []() { AudioEngine::routineWithClusterLoading(); })
 void runRoutine();
 
 void init();
@@ -166,6 +172,12 @@ void doRecorderCardRoutines();
 
 int32_t getNumSamplesLeftToOutputFromPreviousRender();
 
+/// Choose how many samples to render at a time. AUTO renders whatever's built up, doubled to get ahead - anything up
+/// to SSI_TX_BUFFER_NUM_SAMPLES. The others render fixed blocks of 32, 64 or 128 samples, double buffered: each block
+/// renders while the one before it plays. Smaller blocks mean less latency, bigger ones less overhead per sample and
+/// more time for everything else between calls to the audio routine - which gets scheduled to suit.
+void setLatencyTier(AudioLatencyTier tier);
+
 void registerSideChainHit(int32_t strength);
 
 SampleRecorder* getNewRecorder(int32_t numChannels, AudioRecordingFolder folderID, AudioInputChannel mode,
@@ -212,11 +224,15 @@ extern int32_t reverbPan;
 extern SampleRecorder* firstRecorder;
 extern Metronome metronome;
 extern RMSFeedbackCompressor mastercompressor;
+extern SideChainKey sideChainKey;
 extern uint32_t timeLastSideChainHit;
 extern int32_t sizeLastSideChainHit;
 extern StereoFloatSample approxRMSLevel;
 extern AbsValueFollower envelopeFollower;
 extern TaskID routine_task_id;
+extern AudioLatencyTier latencyTier;
+/// Times the output buffer's run dry since boot, counted against the latency tier in use when it did
+extern std::array<uint32_t, kNumAudioLatencyTiers> numUnderruns;
 void feedReverbBackdoorForGrain(int index, q31_t value);
 
 /// returns whether a voice is allowed to start right now - otherwise it should be deferred to the next tick
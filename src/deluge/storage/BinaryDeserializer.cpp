@@ -0,0 +1,621 @@
+/*
+ * Copyright © 2025 Synthstrom Audible Limited
+ *
+ * This file is part of The Synthstrom Audible Deluge Firmware.
+ *
+ * The Synthstrom Audible Deluge Firmware is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program.
+ * If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "definitions_cxx.hpp"
+#include "processing/engines/audio_engine.h"
+#include "storage/storage_manager.h"
+#include "util/firmware_version.h"
+#include "util/functions.h"
+#include <string.h>
+
+/*******************************************************************************
+
+    BinaryDeserializer
+
+********************************************************************************/
+
+namespace {
+
+char hexDigit(uint8_t nibble) {
+	return (nibble < 10) ? ('0' + nibble) : ('A' + nibble - 10);
+}
+
+bool getHexNibble(char ch, int32_t* nibble) {
+	if (ch >= '0' && ch <= '9') {
+		*nibble = ch - '0';
+	}
+	else if (ch >= 'a' && ch <= 'f') {
+		*nibble = ch - 'a' + 10;
+	}
+	else if (ch >= 'A' && ch <= 'F') {
+		*nibble = ch - 'A' + 10;
+	}
+	else {
+		return false;
+	}
+	return true;
+}
+
+} // namespace
+
+BinaryDeserializer::BinaryDeserializer() {
+	reset();
+}
+
+BinaryDeserializer::BinaryDeserializer(uint8_t* inbuf, size_t buflen) : FileDeserializer(inbuf, buflen) {
+	reset();
+}
+
+void BinaryDeserializer::reset() {
+	resetReader();
+	song_firmware_version = FirmwareVersion{FirmwareVersion::Type::OFFICIAL, {}};
+
+	tagDepthFile = 0;
+	tagDepthCaller = 0;
+
+	valueType = ValueType::NONE;
+	numPendingChars = 0;
+}
+
+// dest may be NULL, to just skip the bytes. Returns false if the file ended first
+bool BinaryDeserializer::readBytes(void* dest, int32_t numBytes) {
+	uint8_t* destBytes = (uint8_t*)dest;
+	while (numBytes > 0) {
+		readFileClusterIfNecessary();
+		if (reachedBufferEnd) {
+			return false;
+		}
+		int32_t numBytesHere = std::min<int32_t>(numBytes, bytesRemainingInBuffer());
+		if (destBytes) {
+			memcpy(destBytes, GetCurrentAddressInBuffer(), numBytesHere);
+			destBytes += numBytesHere;
+		}
+		fileReadBufferCurrentPos += numBytesHere;
+		numBytes -= numBytesHere;
+	}
+	return true;
+}
+
+// If possible, just returns a pointer to the name within the existing buffer - it's stored with its terminating 0
+char const* BinaryDeserializer::readName() {
+	uint8_t length;
+	if (!readBytes(&length, 1) || !length) {
+		return "";
+	}
+
+	readFileClusterIfNecessary();
+	if (!reachedBufferEnd && bytesRemainingInBuffer() >= length) {
+		char* name = GetCurrentAddressInBuffer();
+		fileReadBufferCurrentPos += length;
+		name[length - 1] = 0;
+		return name;
+	}
+
+	if (!readBytes(nameBuffer, length)) {
+		return "";
+	}
+	nameBuffer[length - 1] = 0;
+	return nameBuffer;
+}
+
+// Reads the next record's type and name - but not its value, if it has one. Returns "" for the end of a tag
+char const* BinaryDeserializer::readRecord() {
+	uint8_t type;
+	if (!readBytes(&type, 1)) {
+		return "";
+	}
+	readDone();
+
+	switch (type & ~kBinaryRecordContent) {
+	case kBinaryRecordClose:
+		tagDepthFile--;
+		return "";
+
+	case kBinaryRecordOpen:
+		tagDepthFile++;
+		return readName();
+
+	case kBinaryRecordInt:
+		valueType = ValueType::INT;
+		break;
+
+	case kBinaryRecordString:
+		valueType = ValueType::STRING;
+		break;
+
+	case kBinaryRecordHex:
+		valueType = ValueType::HEX;
+		break;
+
+	case kBinaryRecordBytes:
+		valueType = ValueType::BYTES;
+		break;
+
+	default:
+		// Not something we know. There's no way to skip it, so treat the file as ending here
+		reachedBufferEnd = true;
+		return "";
+	}
+
+	tagDepthFile++;
+	valueHeaderRead = false;
+	valueBytesLeft = 0;
+	numPendingChars = 0;
+	return readName();
+}
+
+char const* BinaryDeserializer::readNextTagOrAttributeName() {
+
+	// If the last name's value wasn't read, it was a tag's contents rather than child tags - so it has no more
+	if (valueType != ValueType::NONE) {
+		skipValue();
+		return "";
+	}
+
+	char const* toReturn = readRecord();
+	if (*toReturn) {
+		tagDepthCaller++;
+		AudioEngine::logAction(toReturn);
+	}
+	return toReturn;
+}
+
+void BinaryDeserializer::loadValueHeader() {
+	if (valueHeaderRead) {
+		return;
+	}
+	valueHeaderRead = true;
+
+	uint8_t bytes[4];
+	if (valueType == ValueType::INT) {
+		valueInt = readBytes(bytes, 4) ? (int32_t)(bytes[0] | (bytes[1] << 8) | (bytes[2] << 16) | (bytes[3] << 24)) : 0;
+	}
+	else if (valueType == ValueType::STRING) {
+		valueBytesLeft = readBytes(bytes, 2) ? (bytes[0] | (bytes[1] << 8)) : 0;
+	}
+}
+
+void BinaryDeserializer::finishValue() {
+	if (valueType != ValueType::NONE) {
+		valueType = ValueType::NONE;
+		numPendingChars = 0;
+		tagDepthFile--;
+	}
+}
+
+void BinaryDeserializer::skipValue() {
+	switch (valueType) {
+	case ValueType::INT:
+	case ValueType::STRING:
+		loadValueHeader();
+		readBytes(nullptr, (valueType == ValueType::STRING) ? valueBytesLeft : 0);
+		break;
+
+	case ValueType::HEX:
+	case ValueType::BYTES:
+		do {
+			readBytes(nullptr, valueBytesLeft);
+			valueBytesLeft = 0;
+		} while (nextChunk());
+		return; // nextChunk() finished the value
+
+	default:
+		break;
+	}
+	finishValue();
+}
+
+// Moves on to a HEX / BYTES value's next chunk. If there isn't one, the value is finished
+bool BinaryDeserializer::nextChunk() {
+	uint8_t bytes[2];
+	if (!readBytes(bytes, 2) || !(valueBytesLeft = bytes[0] | (bytes[1] << 8))) {
+		finishValue();
+		return false;
+	}
+	return true;
+}
+
+bool BinaryDeserializer::readValueByte(uint8_t* byte) {
+	while (!valueBytesLeft) {
+		if (!nextChunk()) {
+			return false;
+		}
+	}
+	if (!readChar((char*)byte)) {
+		finishValue();
+		return false;
+	}
+	valueBytesLeft--;
+	return true;
+}
+
+char BinaryDeserializer::popPendingChar() {
+	char thisChar = pendingChars[0];
+	pendingChars[0] = pendingChars[1];
+	numPendingChars--;
+	return thisChar;
+}
+
+// Gives the value as the text the XML would have had, finishing it. Long values get cut short, as with XML
+char const* BinaryDeserializer::getValueAsText() {
+	int32_t charPos = 0;
+
+	switch (valueType) {
+	case ValueType::INT:
+		loadValueHeader();
+		intToString(valueInt, stringBuffer);
+		finishValue();
+		return stringBuffer;
+
+	case ValueType::INT_AS_TEXT:
+		strcpy(stringBuffer, &textBuffer[valueInt]);
+		finishValue();
+		return stringBuffer;
+
+	case ValueType::STRING: {
+		loadValueHeader();
+		readFileClusterIfNecessary();
+		if (valueBytesLeft && !reachedBufferEnd && bytesRemainingInBuffer() >= valueBytesLeft) {
+			char* string = GetCurrentAddressInBuffer();
+			fileReadBufferCurrentPos += valueBytesLeft;
+			string[valueBytesLeft - 1] = 0;
+			finishValue();
+			return string;
+		}
+		int32_t numChars = std::min<int32_t>((int32_t)valueBytesLeft, kFilenameBufferSize);
+		if (numChars && readBytes(stringBuffer, numChars)) {
+			valueBytesLeft -= numChars;
+			charPos = numChars - 1;
+		}
+		skipValue();
+		break;
+	}
+
+	case ValueType::HEX:
+	case ValueType::BYTES: {
+		while (numPendingChars) {
+			stringBuffer[charPos++] = popPendingChar();
+		}
+		if (valueType == ValueType::HEX && !valueHeaderRead) {
+			stringBuffer[charPos++] = '0';
+			stringBuffer[charPos++] = 'x';
+		}
+		uint8_t byte;
+		while (charPos < (int32_t)kFilenameBufferSize - 2 && readValueByte(&byte)) {
+			stringBuffer[charPos++] = hexDigit(byte >> 4);
+			stringBuffer[charPos++] = hexDigit(byte & 15);
+		}
+		skipValue();
+		break;
+	}
+
+	default:
+		return "";
+	}
+
+	stringBuffer[charPos] = 0;
+	return stringBuffer;
+}
+
+char const* BinaryDeserializer::readTagOrAttributeValue() {
+	return getValueAsText();
+}
+
+int32_t BinaryDeserializer::readTagOrAttributeValueInt() {
+	if (valueType == ValueType::INT) {
+		loadValueHeader();
+		finishValue();
+		return valueInt;
+	}
+	return stringToInt(getValueAsText());
+}
+
+// This isn't super optimal, like the int32_t version is, but only rarely used
+int32_t BinaryDeserializer::readTagOrAttributeValueHex(int32_t errorValue) {
+	char const* string = getValueAsText();
+	if (string[0] != '0' || string[1] != 'x') {
+		return errorValue;
+	}
+	return hexToInt(&string[2]);
+}
+
+int BinaryDeserializer::readTagOrAttributeValueHexBytes(uint8_t* bytes, int32_t maxLen) {
+	int32_t read = 0;
+
+	if (valueType == ValueType::BYTES) {
+		while (read < maxLen && readValueByte(&bytes[read])) {
+			read++;
+		}
+		skipValue();
+		return read;
+	}
+
+	char const* string = getValueAsText();
+	for (; read < maxLen; read++) {
+		int32_t highNibble, lowNibble;
+		if (!getHexNibble(string[read * 2], &highNibble) || !getHexNibble(string[read * 2 + 1], &lowNibble)) {
+			break;
+		}
+		bytes[read] = (highNibble << 4) + lowNibble;
+	}
+	return read;
+}
+
+// Returns memory error
+Error BinaryDeserializer::readTagOrAttributeValueString(String* string) {
+	if (valueType == ValueType::NONE) {
+		return Error::FILE_CORRUPTED;
+	}
+	if (valueType != ValueType::STRING) {
+		return string->set(getValueAsText());
+	}
+
+	loadValueHeader();
+	string->clear();
+	int32_t newStringPos = 0;
+	while (valueBytesLeft > 1) {
+		readFileClusterIfNecessary();
+		if (reachedBufferEnd) {
+			break;
+		}
+		int32_t numCharsHere = std::min<int32_t>(valueBytesLeft - 1, bytesRemainingInBuffer());
+		Error error = string->concatenateAtPos(GetCurrentAddressInBuffer(), newStringPos, numCharsHere);
+		if (error != Error::NONE) {
+			skipValue();
+			return error;
+		}
+		fileReadBufferCurrentPos += numCharsHere;
+		valueBytesLeft -= numCharsHere;
+		newStringPos += numCharsHere;
+	}
+	skipValue();
+	readDone();
+	return Error::NONE;
+}
+
+// Returns whether we're all good to go
+bool BinaryDeserializer::prepareToReadTagOrAttributeValueOneCharAtATime() {
+	switch (valueType) {
+	case ValueType::INT:
+		loadValueHeader();
+		intToString(valueInt, textBuffer);
+		valueInt = 0;
+		valueType = ValueType::INT_AS_TEXT;
+		return true;
+
+	case ValueType::STRING:
+		loadValueHeader();
+		return true;
+
+	case ValueType::HEX:
+		pendingChars[0] = '0';
+		pendingChars[1] = 'x';
+		numPendingChars = 2;
+		valueHeaderRead = true; // Meaning the "0x" has been dealt with
+		// No break
+
+	case ValueType::BYTES:
+		if (!valueBytesLeft) {
+			nextChunk();
+		}
+		return true;
+
+	default:
+		return false;
+	}
+}
+
+bool BinaryDeserializer::prepareToReadHexValueAsBytes() {
+	if (valueType != ValueType::HEX) {
+		return false;
+	}
+	valueHeaderRead = true;
+	if (!valueBytesLeft) {
+		nextChunk();
+	}
+	return true;
+}
+
+char BinaryDeserializer::readNextCharOfTagOrAttributeValue() {
+	if (numPendingChars) {
+		return popPendingChar();
+	}
+
+	char thisChar;
+
+	switch (valueType) {
+	case ValueType::INT_AS_TEXT:
+		thisChar = textBuffer[valueInt];
+		if (!thisChar) {
+			finishValue();
+			return 0;
+		}
+		valueInt++;
+		return thisChar;
+
+	case ValueType::STRING:
+		loadValueHeader();
+		if (valueBytesLeft <= 1 || !readChar(&thisChar)) {
+			skipValue();
+			return 0;
+		}
+		valueBytesLeft--;
+		return thisChar;
+
+	case ValueType::HEX:
+	case ValueType::BYTES: {
+		uint8_t byte;
+		if (!readValueByte(&byte)) {
+			return 0;
+		}
+		pendingChars[0] = hexDigit(byte & 15);
+		numPendingChars = 1;
+		return hexDigit(byte >> 4);
+	}
+
+	default:
+		return 0;
+	}
+}
+
+// Unlike readTagOrAttributeValue(), does not put a null character at the end of the returned "string". And, has a
+// preset number of chars. And, returns NULL when nothing more to return. numChars must be <= kFilenameBufferSize
+char const* BinaryDeserializer::readNextCharsOfTagOrAttributeValue(int32_t numChars) {
+
+	if (valueType == ValueType::STRING) {
+		loadValueHeader();
+	}
+
+	// If we can, just return a pointer to the chars within the existing buffer
+	if (valueType == ValueType::STRING && valueBytesLeft > (uint32_t)numChars) {
+		readFileClusterIfNecessary();
+		if (!reachedBufferEnd && bytesRemainingInBuffer() >= (uint32_t)numChars) {
+			char const* chars = GetCurrentAddressInBuffer();
+			fileReadBufferCurrentPos += numChars;
+			valueBytesLeft -= numChars;
+			readDone();
+			return chars;
+		}
+	}
+
+	for (int32_t charPos = 0; charPos < numChars; charPos++) {
+		if (!(stringBuffer[charPos] = readNextCharOfTagOrAttributeValue())) {
+			return NULL;
+		}
+	}
+	readDone();
+	return stringBuffer;
+}
+
+uint8_t const* BinaryDeserializer::readNextBytesOfHexValue(int32_t numBytes) {
+	if (valueType != ValueType::HEX && valueType != ValueType::BYTES) {
+		return NULL;
+	}
+	if (!valueBytesLeft && !nextChunk()) {
+		return NULL;
+	}
+
+	// If we can, just return a pointer to the bytes within the existing buffer
+	if (valueBytesLeft >= (uint32_t)numBytes) {
+		readFileClusterIfNecessary();
+		if (!reachedBufferEnd && bytesRemainingInBuffer() >= (uint32_t)numBytes) {
+			uint8_t const* bytes = (uint8_t const*)GetCurrentAddressInBuffer();
+			fileReadBufferCurrentPos += numBytes;
+			valueBytesLeft -= numBytes;
+			readDone();
+			return bytes;
+		}
+	}
+
+	for (int32_t i = 0; i < numBytes; i++) {
+		if (!readValueByte((uint8_t*)&stringBuffer[i])) {
+			return NULL;
+		}
+	}
+	readDone();
+	return (uint8_t const*)stringBuffer;
+}
+
+// Only an indication, for callers to allocate space with
+int32_t BinaryDeserializer::getNumCharsRemainingInValueBeforeEndOfCluster() {
+	switch (valueType) {
+	case ValueType::INT_AS_TEXT:
+		return strlen(&textBuffer[valueInt]);
+
+	case ValueType::STRING:
+		return valueBytesLeft ? std::min<int32_t>((int32_t)valueBytesLeft - 1, bytesRemainingInBuffer()) : 0;
+
+	case ValueType::HEX:
+	case ValueType::BYTES:
+		return std::min<int32_t>(valueBytesLeft, bytesRemainingInBuffer()) * 2 + numPendingChars;
+
+	default:
+		return 0;
+	}
+}
+
+void BinaryDeserializer::exitTag(char const* exitTagName, bool closeObject) {
+	// back out the file depth to one less than the caller depth
+	while (tagDepthFile >= tagDepthCaller) {
+		if (reachedBufferEnd) {
+			return;
+		}
+		if (valueType != ValueType::NONE) {
+			skipValue();
+		}
+		else {
+			readRecord();
+		}
+	}
+	tagDepthCaller = tagDepthFile;
+}
+
+Error BinaryDeserializer::openBinaryFile(FilePointer* filePointer, char const* firstTagName, char const* altTagName,
+                                         bool ignoreIncorrectFirmware) {
+
+	AudioEngine::logAction("openBinaryFile");
+
+	reset();
+
+	uint8_t header[8];
+	if (!readBytes(header, 8) || memcmp(header, kBinaryFileMagic, 4) || header[4] > kBinaryFileVersion) {
+		closeWriter();
+		return Error::FILE_CORRUPTED;
+	}
+
+	char const* tagName;
+
+	while (*(tagName = readNextTagOrAttributeName())) {
+
+		if (!strcmp(tagName, firstTagName) || !strcmp(tagName, altTagName)) {
+			return Error::NONE;
+		}
+
+		Error result = tryReadingFirmwareTagFromFile(tagName, ignoreIncorrectFirmware);
+		if (result != Error::NONE && result != Error::RESULT_TAG_UNUSED) {
+			return result;
+		}
+		exitTag(tagName);
+	}
+
+	closeWriter();
+	return Error::FILE_CORRUPTED;
+}
+
+Error BinaryDeserializer::tryReadingFirmwareTagFromFile(char const* tagName, bool ignoreIncorrectFirmware) {
+
+	if (!strcmp(tagName, "firmwareVersion")) {
+		char const* firmware_version_string = readTagOrAttributeValue();
+		song_firmware_version = FirmwareVersion::parse(firmware_version_string);
+	}
+
+	// If this tag doesn't exist, it's from old firmware so is ok
+	else if (!strcmp(tagName, "earliestCompatibleFirmware")) {
+		char const* firmware_version_string = readTagOrAttributeValue();
+		auto earliestFirmware = FirmwareVersion::parse(firmware_version_string);
+		if (earliestFirmware > FirmwareVersion::current() && !ignoreIncorrectFirmware) {
+			closeWriter();
+			return Error::FILE_FIRMWARE_VERSION_TOO_NEW;
+		}
+	}
+
+	else {
+		return Error::RESULT_TAG_UNUSED;
+	}
+
+	return Error::NONE;
+}
@@ -0,0 +1,362 @@
+/*
+ * Copyright © 2025 Synthstrom Audible Limited
+ *
+ * This file is part of The Synthstrom Audible Deluge Firmware.
+ *
+ * The Synthstrom Audible Deluge Firmware is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program.
+ * If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "definitions_cxx.hpp"
+#include "storage/storage_manager.h"
+#include "util/functions.h"
+#include <string.h>
+
+/*******************************************************************************
+
+    BinarySerializer
+
+********************************************************************************/
+
+namespace {
+
+int32_t hexDigitValue(char ch) {
+	if (ch >= '0' && ch <= '9') {
+		return ch - '0';
+	}
+	// Upper case only, as intToHex() writes, so that converting back to XML gives exactly the same text
+	if (ch >= 'A' && ch <= 'F') {
+		return ch - 'A' + 10;
+	}
+	return -1;
+}
+
+bool isHexValue(char const* value, int32_t length) {
+	if (length < 4 || (length & 1) || value[0] != '0' || value[1] != 'x') {
+		return false;
+	}
+	for (int32_t i = 2; i < length; i++) {
+		if (hexDigitValue(value[i]) < 0) {
+			return false;
+		}
+	}
+	return true;
+}
+
+// Only if turning the number back into text with intToString() gives exactly the same value
+bool isDecimalValue(char const* value, int32_t length, int32_t* number) {
+	bool isNegative = (value[0] == '-');
+	int32_t numDigits = length - isNegative;
+	if (numDigits < 1 || numDigits > 10 || (value[isNegative] == '0' && (numDigits > 1 || isNegative))) {
+		return false;
+	}
+	int64_t result = 0;
+	for (int32_t i = isNegative; i < length; i++) {
+		if (value[i] < '0' || value[i] > '9') {
+			return false;
+		}
+		result = result * 10 + (value[i] - '0');
+	}
+	if (isNegative) {
+		result = -result;
+	}
+	if (result < INT32_MIN || result > INT32_MAX) {
+		return false;
+	}
+	*number = (int32_t)result;
+	return true;
+}
+
+} // namespace
+
+BinarySerializer::BinarySerializer() {
+	resetWriter();
+}
+
+void BinarySerializer::reset() {
+	resetWriter();
+	rawState = RawState::NONE;
+	rawName[0] = 0;
+	rawLength = 0;
+
+	writeChars(kBinaryFileMagic);
+	writeByte(kBinaryFileVersion);
+	for (int32_t i = 0; i < 3; i++) {
+		writeByte(0);
+	}
+}
+
+void BinarySerializer::writeName(char const* name) {
+	int32_t length = std::min<int32_t>(strlen(name), 254);
+	writeByte(length + 1);
+	writeBlock((uint8_t*)name, length);
+	writeByte(0);
+}
+
+void BinarySerializer::writeUint16(uint16_t value) {
+	writeByte(value & 0xFF);
+	writeByte(value >> 8);
+}
+
+void BinarySerializer::writeInt32(int32_t value) {
+	for (int32_t i = 0; i < 4; i++) {
+		writeByte(((uint32_t)value >> (i * 8)) & 0xFF);
+	}
+}
+
+void BinarySerializer::writeStringRecord(uint8_t type, char const* name, char const* value, int32_t length) {
+	if (length > 65534) {
+		fileAccessFailedDuringWrite = true;
+		return;
+	}
+	writeByte(kBinaryRecordString | type);
+	writeName(name);
+	writeUint16(length + 1);
+	writeBlock((uint8_t*)value, length);
+	writeByte(0);
+}
+
+// Picks the most compact record for a value which the XML would have had as text. type is 0 or kBinaryRecordContent
+void BinarySerializer::writeValue(uint8_t type, char const* name, char const* value) {
+	int32_t length = strlen(value);
+	int32_t number;
+
+	if (isHexValue(value, length)) {
+		writeByte(kBinaryRecordHex | type);
+		writeName(name);
+		// No value we're handed whole is anywhere near long enough to need more than one chunk
+		int32_t numBytes = (length - 2) >> 1;
+		writeUint16(numBytes);
+		for (int32_t i = 0; i < numBytes; i++) {
+			writeByte((hexDigitValue(value[2 + i * 2]) << 4) | hexDigitValue(value[3 + i * 2]));
+		}
+		writeUint16(0);
+	}
+	else if (isDecimalValue(value, length, &number)) {
+		writeByte(kBinaryRecordInt | type);
+		writeName(name);
+		writeInt32(number);
+	}
+	else {
+		writeStringRecord(type, name, value, length);
+	}
+}
+
+void BinarySerializer::writeAttribute(char const* name, int32_t number, bool onNewLine) {
+	writeByte(kBinaryRecordInt);
+	writeName(name);
+	writeInt32(number);
+}
+
+void BinarySerializer::writeAttribute(char const* name, char const* value, bool onNewLine) {
+	writeValue(0, name, value);
+}
+
+// numChars may be up to 8
+void BinarySerializer::writeAttributeHex(char const* name, int32_t number, int32_t numChars, bool onNewLine) {
+	char buffer[11];
+	buffer[0] = '0';
+	buffer[1] = 'x';
+	intToHex(number, &buffer[2], numChars);
+	writeValue(0, name, buffer);
+}
+
+void BinarySerializer::writeAttributeHexBytes(char const* name, uint8_t* data, int32_t numBytes, bool onNewLine) {
+	writeByte(kBinaryRecordBytes);
+	writeName(name);
+	while (numBytes > 0) {
+		int32_t numBytesThisChunk = std::min<int32_t>(numBytes, 65535);
+		writeUint16(numBytesThisChunk);
+		writeBlock(data, numBytesThisChunk);
+		data += numBytesThisChunk;
+		numBytes -= numBytesThisChunk;
+	}
+	writeUint16(0);
+}
+
+void BinarySerializer::writeTag(char const* tag, int32_t number, bool box) {
+	writeByte(kBinaryRecordInt | kBinaryRecordContent);
+	writeName(tag);
+	writeInt32(number);
+}
+
+void BinarySerializer::writeTag(char const* tag, char const* contents, bool box, bool quote) {
+	writeValue(kBinaryRecordContent, tag, contents);
+}
+
+void BinarySerializer::writeOpeningTag(char const* tag, bool startNewLineAfter, bool box) {
+	writeOpeningTagBeginning(tag, box);
+}
+
+void BinarySerializer::writeOpeningTagBeginning(char const* tag, bool box, bool newLineBefore) {
+	writeByte(kBinaryRecordOpen);
+	writeName(tag);
+}
+
+void BinarySerializer::closeTag(bool box) {
+	writeByte(kBinaryRecordClose);
+}
+
+void BinarySerializer::writeClosingTag(char const* tag, bool shouldPrintIndents, bool box) {
+	writeByte(kBinaryRecordClose);
+}
+
+void BinarySerializer::writeArrayStart(char const* tag, bool startNewLineAfter, bool box) {
+	writeOpeningTagBeginning(tag, box);
+}
+
+void BinarySerializer::writeArrayEnding(char const* tag, bool shouldPrintIndents, bool box) {
+	writeByte(kBinaryRecordClose);
+}
+
+void BinarySerializer::writeTagNameAndSeperator(char const* tag) {
+	strncpy(rawName, tag, sizeof(rawName) - 1);
+	rawName[sizeof(rawName) - 1] = 0;
+	rawState = RawState::BEFORE_VALUE;
+}
+
+void BinarySerializer::flushHexChunk() {
+	if (rawLength) {
+		writeUint16(rawLength);
+		writeBlock((uint8_t*)rawBuffer, rawLength);
+		rawLength = 0;
+	}
+}
+
+void BinarySerializer::endRawValue() {
+	if (rawState == RawState::HEX_VALUE) {
+		if (rawHighNibble >= 0) {
+			fileAccessFailedDuringWrite = true; // Odd number of hex digits
+		}
+		flushHexChunk();
+		writeUint16(0);
+	}
+	else {
+		rawBuffer[rawLength] = 0;
+		writeValue(0, rawName, rawBuffer);
+	}
+	rawState = RawState::NONE;
+	rawName[0] = 0;
+	rawLength = 0;
+}
+
+// Callers write some attributes a piece at a time, as XML text - name="value". We pick out the name and value, and
+// turn them into a record like any other. The big "0x..." note and automation data gets decoded as it arrives, so it
+// never needs buffering in full. Anything else in the text, like whitespace and the "<?xml" line, is ignored
+void BinarySerializer::write(char const* output) {
+	for (char const* c = output; *c; c++) {
+		char thisChar = *c;
+
+		switch (rawState) {
+		case RawState::NONE:
+			if (thisChar == '=' && rawName[0]) {
+				rawState = RawState::BEFORE_VALUE;
+			}
+			else if (thisChar == '<' || thisChar == '>' || thisChar == '?' || thisChar == ' ' || thisChar == '\n'
+			         || thisChar == '\t' || thisChar == '\r' || thisChar == '"') {
+				rawName[0] = 0;
+			}
+			else {
+				int32_t nameLength = strlen(rawName);
+				if (nameLength < (int32_t)sizeof(rawName) - 1) {
+					rawName[nameLength] = thisChar;
+					rawName[nameLength + 1] = 0;
+				}
+			}
+			break;
+
+		case RawState::BEFORE_VALUE:
+			if (thisChar == '"') {
+				rawState = RawState::VALUE_START;
+				rawLength = 0;
+			}
+			break;
+
+		case RawState::VALUE_START:
+			if (thisChar == '"') {
+				endRawValue();
+				break;
+			}
+			rawBuffer[rawLength++] = thisChar;
+			if (rawLength == 2) {
+				if (rawBuffer[0] == '0' && rawBuffer[1] == 'x') {
+					writeByte(kBinaryRecordHex);
+					writeName(rawName);
+					rawLength = 0;
+					rawHighNibble = -1;
+					rawState = RawState::HEX_VALUE;
+				}
+				else {
+					rawState = RawState::STRING_VALUE;
+				}
+			}
+			break;
+
+		case RawState::HEX_VALUE: {
+			if (thisChar == '"') {
+				endRawValue();
+				break;
+			}
+			int32_t nibble = hexDigitValue(thisChar);
+			if (nibble < 0) {
+				fileAccessFailedDuringWrite = true;
+			}
+			else if (rawHighNibble < 0) {
+				rawHighNibble = nibble;
+			}
+			else {
+				rawBuffer[rawLength++] = (rawHighNibble << 4) | nibble;
+				rawHighNibble = -1;
+				if (rawLength == sizeof(rawBuffer)) {
+					flushHexChunk();
+				}
+			}
+			break;
+		}
+
+		case RawState::STRING_VALUE:
+			if (thisChar == '"') {
+				endRawValue();
+			}
+			else if (rawLength < (int32_t)sizeof(rawBuffer) - 1) {
+				rawBuffer[rawLength++] = thisChar;
+			}
+			else {
+				fileAccessFailedDuringWrite = true;
+			}
+			break;
+		}
+	}
+}
+
+// Turning the number into hex digits would only have write() turn them straight back into bytes, so the bytes go in
+// directly. Anywhere but a whole byte into a "0x..." value, it goes the long way round.
+void BinarySerializer::writeHexDigits(uint32_t number, int32_t numChars) {
+	if (rawState != RawState::HEX_VALUE || rawHighNibble >= 0 || (numChars & 1)) {
+		Serializer::writeHexDigits(number, numChars);
+		return;
+	}
+	for (int32_t i = (numChars >> 1) - 1; i >= 0; i--) {
+		rawBuffer[rawLength++] = number >> (i * 8);
+		if (rawLength == sizeof(rawBuffer)) {
+			flushHexChunk();
+		}
+	}
+}
+
+// The beginning and end strings are the XML ones, so we check our own instead
+Error BinarySerializer::closeFileAfterWriting(char const* path, char const* beginningString, char const* endString) {
+	if (rawState != RawState::NONE) {
+		fileAccessFailedDuringWrite = true;
+	}
+	char const endRecord[] = {kBinaryRecordClose, 0};
+	return closeAfterWriting(path, kBinaryFileMagic, endRecord);
+}
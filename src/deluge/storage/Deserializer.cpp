@@ -63,6 +63,55 @@ extern "C" {
 #define PAST_EQUALS_SIGN 5
 #define IN_ATTRIBUTE_VALUE 6
 
+namespace {
+
+// A set of chars, looked up with one load and a bit test, so the buffer can be scanned for the first of several
+// delimiters in a single pass rather than a switch per char
+class CharSet {
+public:
+	constexpr CharSet(char const* chars) {
+		for (; *chars; chars++) {
+			bits[(uint8_t)*chars >> 5] |= 1u << (*chars & 31);
+		}
+	}
+	constexpr bool contains(char c) const { return bits[(uint8_t)c >> 5] & (1u << (c & 31)); }
+
+private:
+	uint32_t bits[8]{};
+};
+
+constexpr CharSet kWhitespace{" \r\n\t"};
+constexpr CharSet kTagNameEnd{" \r\n\t/?>"};
+constexpr CharSet kAttributeNameEnd{" \r\n\t=>"};
+
+// These all return the position of the first matching char in the buffer between pos and end - or end if there isn't
+// one, or pos if it's already at or past end
+
+// newlib's memchr() tests a whole word per iteration, which makes a big difference over long values like note data
+int32_t findChar(char const* buffer, int32_t pos, int32_t end, char c) {
+	if (pos >= end) {
+		return pos;
+	}
+	void const* found = memchr(&buffer[pos], c, end - pos);
+	return found ? (char const*)found - buffer : end;
+}
+
+int32_t findFirstOf(char const* buffer, int32_t pos, int32_t end, CharSet const& set) {
+	while (pos < end && !set.contains(buffer[pos])) {
+		pos++;
+	}
+	return pos;
+}
+
+int32_t findFirstNotOf(char const* buffer, int32_t pos, int32_t end, CharSet const& set) {
+	while (pos < end && set.contains(buffer[pos])) {
+		pos++;
+	}
+	return pos;
+}
+
+} // namespace
+
 XMLDeserializer::XMLDeserializer() {
 
 	reset();
@@ -83,59 +132,73 @@ void XMLDeserializer::reset() {
 }
 
 // Only call this if IN_TAG_NAME
-// TODO: this is very sub-optimal and still calls readChar()
 char const* XMLDeserializer::readTagName() {
 
-	if (false) {
-skipToNextTag:
-		skipUntilChar('>');
-		skipUntilChar('<');
-	}
+	int32_t charPos;
 
-	char thisChar;
-	int32_t charPos = 0;
+startName:
+	charPos = 0;
+	readFileClusterIfNecessary();
 
-	while (readChar(&thisChar)) {
-		switch (thisChar) {
-		case '/':
-			goto skipPastRest;
+	do {
+		int32_t bufferPosAtStart = fileReadBufferCurrentPos;
+		fileReadBufferCurrentPos =
+		    findFirstOf(fileClusterBuffer, bufferPosAtStart, currentReadBufferEndPos, kTagNameEnd);
+		int32_t numCharsHere = fileReadBufferCurrentPos - bufferPosAtStart;
 
-		case ' ':
-		case '\r':
-		case '\n':
-		case '\t':
-			xmlArea = IN_TAG_PAST_NAME;
-			goto getOut;
+		if (numCharsHere > 0 && !charPos) {
+			tagDepthFile++;
+		}
 
-		case '?':
-			goto skipToNextTag;
+		bool haveReachedNameEnd = (fileReadBufferCurrentPos < (int32_t)currentReadBufferEndPos);
+		char endChar = 0;
 
-		case '>':
-			xmlArea = BETWEEN_TAGS;
-			goto getOut;
+		if (haveReachedNameEnd) {
+			endChar = fileClusterBuffer[fileReadBufferCurrentPos];
+			fileReadBufferCurrentPos++; // Gets us past the endChar
 
-		default:
-			if (!charPos) {
-				tagDepthFile++;
+			if (endChar == '?') {
+				skipUntilChar('>');
+				skipUntilChar('<');
+				goto startName;
 			}
 
-			// Store this character, if space in our un-ideal buffer
-			if (charPos < kFilenameBufferSize - 1) {
-				stringBuffer[charPos++] = thisChar;
+			if (endChar != '/') {
+				xmlArea = (endChar == '>') ? BETWEEN_TAGS : IN_TAG_PAST_NAME;
+				// If possible, just return a pointer to the chars within the existing buffer. Not for a '/' though, as
+				// reading on to the '>' could load the next Cluster
+				if (!charPos) {
+					fileClusterBuffer[fileReadBufferCurrentPos - 1] = 0;
+					readDone();
+					return &fileClusterBuffer[bufferPosAtStart];
+				}
 			}
 		}
-	}
 
-getOut:
-	readDone();
+		// Store these characters, if space in our un-ideal buffer
+		int32_t numCharsToCopy = std::min<int32_t>(numCharsHere, kFilenameBufferSize - 1 - charPos);
+		if (numCharsToCopy > 0) {
+			memcpy(&stringBuffer[charPos], &fileClusterBuffer[bufferPosAtStart], numCharsToCopy);
+			charPos += numCharsToCopy;
+		}
 
-	if (false) {
-skipPastRest:
-		tagDepthFile--;
-		skipUntilChar('>');
-		xmlArea = BETWEEN_TAGS;
-	}
+		if (haveReachedNameEnd) {
+			stringBuffer[charPos] = 0;
+			if (endChar == '/') { // Closing tag, or the end of an empty one
+				tagDepthFile--;
+				skipUntilChar('>');
+				xmlArea = BETWEEN_TAGS;
+			}
+			else {
+				readDone();
+			}
+			return stringBuffer;
+		}
+
+	} while (fileReadBufferCurrentPos == currentReadBufferEndPos && readFileClusterIfNecessary());
 
+	// If here, file ended
+	readDone();
 	stringBuffer[charPos] = 0;
 	return stringBuffer;
 }
@@ -146,14 +209,15 @@ char const* XMLDeserializer::readNextAttributeName() {
 	char thisChar;
 	int32_t charPos = 0;
 
-	while (readChar(&thisChar)) {
-		switch (thisChar) {
-		case ' ':
-		case '\r':
-		case '\n':
-		case '\t':
-			break;
+	// Skip the indentation before the name
+	readFileClusterIfNecessary();
+	do {
+		fileReadBufferCurrentPos =
+		    findFirstNotOf(fileClusterBuffer, fileReadBufferCurrentPos, currentReadBufferEndPos, kWhitespace);
+	} while (fileReadBufferCurrentPos == currentReadBufferEndPos && readFileClusterIfNecessary());
 
+	if (readChar(&thisChar)) {
+		switch (thisChar) {
 		case '/':
 			tagDepthFile--;
 			skipUntilChar('>');
@@ -187,17 +251,11 @@ doReadName:
 	// This is basically copied and tweaked from readUntilChar()
 	do {
 		int32_t bufferPosAtStart = fileReadBufferCurrentPos;
-		while (fileReadBufferCurrentPos < currentReadBufferEndPos) {
-			char thisChar = fileClusterBuffer[fileReadBufferCurrentPos];
-
-			switch (thisChar) {
-			case ' ':
-			case '\r':
-			case '\n':
-			case '\t':
-				xmlArea = PAST_ATTRIBUTE_NAME;
-				goto reachedNameEnd;
+		fileReadBufferCurrentPos =
+		    findFirstOf(fileClusterBuffer, bufferPosAtStart, currentReadBufferEndPos, kAttributeNameEnd);
 
+		if (fileReadBufferCurrentPos < (int32_t)currentReadBufferEndPos) {
+			switch (fileClusterBuffer[fileReadBufferCurrentPos]) {
 			case '=':
 				xmlArea = PAST_EQUALS_SIGN;
 				goto reachedNameEnd;
@@ -209,9 +267,11 @@ doReadName:
 				goto noMoreAttributes;
 
 				// TODO: a '/' should get us outta here too...
-			}
 
-			fileReadBufferCurrentPos++;
+			default: // Whitespace
+				xmlArea = PAST_ATTRIBUTE_NAME;
+				goto reachedNameEnd;
+			}
 		}
 
 		if (false) {
@@ -397,11 +457,8 @@ void XMLDeserializer::skipUntilChar(char endChar) {
 
 	readFileClusterIfNecessary(); // Does this need to be here? Originally I didn't have it...
 	do {
-		while (fileReadBufferCurrentPos < currentReadBufferEndPos
-		       && fileClusterBuffer[fileReadBufferCurrentPos] != endChar) {
-			fileReadBufferCurrentPos++;
-		}
-
+		fileReadBufferCurrentPos =
+		    findChar(fileClusterBuffer, fileReadBufferCurrentPos, currentReadBufferEndPos, endChar);
 	} while (fileReadBufferCurrentPos == currentReadBufferEndPos && readFileClusterIfNecessary());
 
 	fileReadBufferCurrentPos++; // Gets us past the endChar
@@ -415,10 +472,8 @@ Error XMLDeserializer::readStringUntilChar(String* string, char endChar) {
 	int32_t newStringPos = 0;
 
 	do {
-		int32_t bufferPosNow = fileReadBufferCurrentPos;
-		while (bufferPosNow < currentReadBufferEndPos && fileClusterBuffer[bufferPosNow] != endChar) {
-			bufferPosNow++;
-		}
+		int32_t bufferPosNow =
+		    findChar(fileClusterBuffer, fileReadBufferCurrentPos, currentReadBufferEndPos, endChar);
 
 		int32_t numCharsHere = bufferPosNow - fileReadBufferCurrentPos;
 
@@ -448,10 +503,7 @@ char const* XMLDeserializer::readUntilChar(char endChar) {
 
 	do {
 		int32_t bufferPosAtStart = fileReadBufferCurrentPos;
-		while (fileReadBufferCurrentPos < currentReadBufferEndPos
-		       && fileClusterBuffer[fileReadBufferCurrentPos] != endChar) {
-			fileReadBufferCurrentPos++;
-		}
+		fileReadBufferCurrentPos = findChar(fileClusterBuffer, bufferPosAtStart, currentReadBufferEndPos, endChar);
 
 		// If possible, just return a pointer to the chars within the existing buffer
 		if (!charPos && fileReadBufferCurrentPos < currentReadBufferEndPos) {
@@ -492,11 +544,12 @@ char const* XMLDeserializer::readNextCharsOfTagOrAttributeValue(int32_t numChars
 
 		int32_t currentReadBufferEndPosNow = std::min<int32_t>(currentReadBufferEndPos, bufferPosAtEnd);
 
-		while (fileReadBufferCurrentPos < currentReadBufferEndPosNow) {
-			if (fileClusterBuffer[fileReadBufferCurrentPos] == charAtEndOfValue) {
+		if (fileReadBufferCurrentPos < currentReadBufferEndPosNow) {
+			fileReadBufferCurrentPos = findChar(fileClusterBuffer, fileReadBufferCurrentPos,
+			                                    currentReadBufferEndPosNow, charAtEndOfValue);
+			if (fileReadBufferCurrentPos < currentReadBufferEndPosNow) {
 				goto reachedEndCharEarly;
 			}
-			fileReadBufferCurrentPos++;
 		}
 
 		int32_t numCharsHere = fileReadBufferCurrentPos - bufferPosAtStart;
@@ -571,16 +624,26 @@ int32_t XMLDeserializer::readIntUntilChar(char endChar) {
 
 	bool isNegative = (thisChar == '-');
 	if (!isNegative) {
-		goto readDigit;
-	}
-
-	while (readChar(&thisChar)) {
-readDigit:
 		if (!(thisChar >= '0' && thisChar <= '9')) {
 			goto getOut;
 		}
-		number *= 10;
-		number += (thisChar - '0');
+		number = thisChar - '0';
+	}
+
+	// The rest of the digits come straight out of the buffer, rather than a readChar() call each
+	while (true) {
+		readFileClusterIfNecessary();
+		if (reachedBufferEnd) {
+			break;
+		}
+		while (fileReadBufferCurrentPos < (int32_t)currentReadBufferEndPos) {
+			thisChar = fileClusterBuffer[fileReadBufferCurrentPos++];
+			if (!(thisChar >= '0' && thisChar <= '9')) {
+				goto getOut;
+			}
+			number *= 10;
+			number += (thisChar - '0');
+		}
 	}
 
 	if (false) {
@@ -755,11 +818,7 @@ Error XMLDeserializer::readTagOrAttributeValueString(String* string) {
 
 int32_t XMLDeserializer::getNumCharsRemainingInValueBeforeEndOfCluster() {
 
-	int32_t pos = fileReadBufferCurrentPos;
-	while (pos < currentReadBufferEndPos && fileClusterBuffer[pos] != charAtEndOfValue) {
-		pos++;
-	}
-
+	int32_t pos = findChar(fileClusterBuffer, fileReadBufferCurrentPos, currentReadBufferEndPos, charAtEndOfValue);
 	return pos - fileReadBufferCurrentPos;
 }
 
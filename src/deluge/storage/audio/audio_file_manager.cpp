@@ -30,7 +30,9 @@
 #include "model/song/song.h"
 #include "playback/playback_handler.h"
 #include "processing/engines/audio_engine.h"
+#include "storage/audio/sample_cache_store.h"
 #include "storage/cluster/cluster.h"
+#include "storage/set_list.h"
 #include "storage/storage_manager.h"
 #include "storage/wave_table/wave_table.h"
 #include "storage/wave_table/wave_table_reader.h"
@@ -97,6 +99,7 @@ void AudioFileManager::init() {
 void AudioFileManager::cardReinserted() {
 
 	cardDisabled = false;
+	setList.cardReinserted();
 	for (int32_t i = 0; i < kNumAudioRecordingFolders; i++) {
 		highestUsedAudioRecordingNumberNeedsReChecking[i] = true;
 	}
@@ -1245,6 +1248,9 @@ void AudioFileManager::slowRoutine() {
 	// see
 	// https://github.com/SynthstromAudible/DelugeFirmware/blob/866a71d0394e259a5b3db9d4fde605511bd1c67d/src/deluge/storage/audio/audio_file_manager.cpp#L1238
 	// for a copy if ever needed
+
+	sampleCacheStore.slowRoutine();
+	setList.slowRoutine();
 }
 
 #define REPORT_AWAY_TIME 0
@@ -1409,6 +1415,19 @@ bool AudioFileManager::loadingQueueHasAnyLowestPriorityElements() {
 	return loadingQueue.hasAnyLowestPriority();
 }
 
+// Adds up the audio data of every Sample something currently has a reason to keep loaded. While a second song is
+// loaded alongside the current one, that's both songs' Samples - with any they share only counted once.
+uint64_t AudioFileManager::getSampleBytesInUse() {
+	uint64_t numBytes = 0;
+	for (int32_t e = 0; e < audioFiles.getNumElements(); e++) {
+		AudioFile* thisAudioFile = (AudioFile*)audioFiles.getElement(e);
+		if (thisAudioFile->numReasonsToBeLoaded > 0 && AudioFile::isSample(thisAudioFile)) {
+			numBytes += ((Sample*)thisAudioFile)->audioDataLengthBytes;
+		}
+	}
+	return numBytes;
+}
+
 // Caller must also set alternateAudioFileLoadPath.
 void AudioFileManager::thingBeginningLoading(ThingType newThingType) {
 	alternateLoadDirStatus = AlternateLoadDirStatus::MIGHT_EXIST;
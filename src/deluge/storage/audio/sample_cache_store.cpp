@@ -0,0 +1,541 @@
+/*
+ * Copyright © 2025 Synthstrom Audible Limited
+ *
+ * This file is part of The Synthstrom Audible Deluge Firmware.
+ *
+ * The Synthstrom Audible Deluge Firmware is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program.
+ * If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "storage/audio/sample_cache_store.h"
+#include "extern.h"
+#include "io/debug/log.h"
+#include "model/sample/sample.h"
+#include "model/sample/sample_cache.h"
+#include "model/settings/runtime_feature_settings.h"
+#include "storage/audio/audio_file_manager.h"
+#include "storage/cluster/cluster.h"
+#include "storage/storage_manager.h"
+#include <cstdio>
+#include <cstring>
+
+SampleCacheStore sampleCacheStore{};
+
+namespace {
+
+constexpr char const* kCacheFolder = "CACHE";
+constexpr uint32_t kCacheFileMagic = 0x31435344; // "DSC1"
+constexpr uint32_t kCacheFileVersion = 2;          // Bump whenever the rendering or this layout changes
+
+struct CacheFileHeader {
+	uint32_t magic;
+	uint32_t version;
+	uint32_t clusterSize;
+	uint32_t cacheByteDepth;
+	uint32_t pathHash;
+	uint32_t sampleFirstSector; // Lets us tell if the Sample's file has been replaced since this was written
+	uint32_t sampleLengthInSamples;
+	uint32_t numChannels;
+	int32_t phaseIncrement;
+	int32_t timeStretchRatio;
+	int32_t skipSamplesAtStart;
+	uint32_t reversed;
+	uint32_t timeStretchQuality;
+	int32_t waveformLengthBytes;
+};
+
+// FNV-1a
+uint32_t hashWords(uint32_t hash, uint8_t const* data, size_t length) {
+	for (size_t i = 0; i < length; i++) {
+		hash = (hash ^ data[i]) * 16777619u;
+	}
+	return hash;
+}
+
+uint32_t getPathHash(Sample* sample) {
+	char const* path = sample->filePath.get();
+	return hashWords(2166136261u, (uint8_t const*)path, strlen(path));
+}
+
+// The quality setting changes what the time stretcher renders, so a cache made at one tier mustn't come back at another.
+// It's meaningless without time stretching, so isn't allowed to split those up.
+int32_t getTimeStretchQuality(int32_t timeStretchRatio) {
+	if (timeStretchRatio == kMaxSampleValue) {
+		return 0;
+	}
+	return runtimeFeatureSettings.get(RuntimeFeatureSettingType::TimeStretchQuality);
+}
+
+uint32_t getKeyHash(int32_t const* keyWords) {
+	return hashWords(2166136261u, (uint8_t const*)keyWords, 5 * sizeof(int32_t));
+}
+
+uint32_t getKeyHash(SampleCache* cache) {
+	int32_t keyWords[5] = {cache->phaseIncrement, cache->timeStretchRatio, cache->skipSamplesAtStart, cache->reversed,
+	                       getTimeStretchQuality(cache->timeStretchRatio)};
+	return getKeyHash(keyWords);
+}
+
+void getCacheFilePath(char* buffer, uint32_t pathHash, uint32_t keyHash) {
+	sprintf(buffer, "%s/%08lX_%08lX.CAC", kCacheFolder, (unsigned long)pathHash, (unsigned long)keyHash);
+}
+
+// Cache Clusters overlap - a Cluster holds every sample which *starts* within it, so the last one may spill up to
+// (bytesPerSample - 1) bytes past Cluster::size. So that a restored cache is byte-for-byte what was rendered, each
+// Cluster's record in the file runs from its start to the end of its last sample.
+int32_t getClusterEndBytePos(SampleCache* cache, int32_t clusterIndex) {
+	int32_t bytesPerSample = cache->sample->numChannels * kCacheByteDepth;
+	int32_t endBytePos =
+	    (uint32_t)(((clusterIndex + 1) << Cluster::size_magnitude) + bytesPerSample - 1) / bytesPerSample
+	    * bytesPerSample;
+	return std::min(endBytePos, cache->waveformLengthBytes);
+}
+
+int32_t getNumClusters(SampleCache* cache) {
+	return ((cache->waveformLengthBytes - 1) >> Cluster::size_magnitude) + 1;
+}
+
+uint32_t getFileLength(SampleCache* cache) {
+	uint32_t length = sizeof(CacheFileHeader);
+	int32_t numClusters = getNumClusters(cache);
+	for (int32_t c = 0; c < numClusters; c++) {
+		length += getClusterEndBytePos(cache, c) - (c << Cluster::size_magnitude);
+	}
+	return length;
+}
+
+bool sampleIsPersistable(Sample* sample) {
+	return !sample->unloadable && !sample->unplayable && !*sample->tempFilePathForRecording.get()
+	       && sample->clusters.getNumElements() != 0;
+}
+
+} // namespace
+
+bool SampleCacheStore::isEnabled() {
+	return runtimeFeatureSettings.get(RuntimeFeatureSettingType::PersistSampleCaches)
+	       == RuntimeFeatureStateToggle::On;
+}
+
+int32_t SampleCacheStore::findCacheFile(uint32_t pathHash, uint32_t keyHash) {
+	for (int32_t i = 0; i < numCacheFiles; i++) {
+		if (cacheFiles[i].pathHash == pathHash && cacheFiles[i].keyHash == keyHash) {
+			return i;
+		}
+	}
+	return -1;
+}
+
+void SampleCacheStore::forgetCacheFile(int32_t i, bool deleteFile) {
+	if (deleteFile) {
+		char filePath[64];
+		getCacheFilePath(filePath, cacheFiles[i].pathHash, cacheFiles[i].keyHash);
+		f_unlink(filePath);
+	}
+	cacheFolderBytes -= cacheFiles[i].size;
+	numCacheFiles--;
+	memmove(&cacheFiles[i], &cacheFiles[i + 1], (numCacheFiles - i) * sizeof(CacheFile));
+}
+
+// Called whenever a new cache starts being rendered. It'll only actually get written once it's complete.
+void SampleCacheStore::cacheCreated(SampleCache* cache) {
+	if (!isEnabled() || !sampleIsPersistable(cache->sample)) {
+		return;
+	}
+	if (!indexNeedsBuilding && findCacheFile(getPathHash(cache->sample), getKeyHash(cache)) != -1) {
+		return; // Already on the card
+	}
+	if (numPendingCaches == kMaxPendingCaches) {
+		// Oldest one is least likely to ever finish rendering
+		memmove(&pendingCaches[0], &pendingCaches[1], (kMaxPendingCaches - 1) * sizeof(SampleCache*));
+		numPendingCaches--;
+	}
+	pendingCaches[numPendingCaches++] = cache;
+}
+
+// Called when a cache gets truncated, so that a half-written file never survives and a half-restored cache isn't
+// added to. This can happen from within our own f_write() / f_read(), when the audio routine steals memory, so the
+// file only gets closed back in writeNextCluster() / restoreNextCluster().
+void SampleCacheStore::cacheInvalidated(SampleCache* cache) {
+	if (cache == currentCache && !currentCacheInvalidated) {
+		currentCacheInvalidated = true;
+		if (job == Job::WRITING) {
+			cacheCreated(cache); // It'll probably get re-rendered, so have another go then
+		}
+	}
+}
+
+void SampleCacheStore::cacheDestroyed(SampleCache* cache) {
+	if (cache == currentCache) {
+		currentCacheInvalidated = true;
+		currentCache = nullptr;
+	}
+	for (int32_t i = 0; i < numPendingCaches; i++) {
+		if (pendingCaches[i] == cache) {
+			numPendingCaches--;
+			memmove(&pendingCaches[i], &pendingCaches[i + 1], (numPendingCaches - i) * sizeof(SampleCache*));
+			return;
+		}
+	}
+}
+
+// Called from the audio routine, by Sample::getOrCreateCache(), when a voice is about to create a cache. Returns true
+// if there's a copy on the card which slowRoutine() will read back in, in which case the voice should go without.
+// Each file only gets one go per song, so if the restore fails, the next voice renders the cache as normal.
+bool SampleCacheStore::requestRestore(Sample* sample, int32_t phaseIncrement, int32_t timeStretchRatio,
+                                      int32_t skipSamplesAtStart, bool reversed) {
+	if (indexNeedsBuilding || !numCacheFiles || numPendingRestores == kMaxPendingRestores || !isEnabled()) {
+		return false;
+	}
+
+	RestoreRequest request = {
+	    .sample = sample,
+	    .pathHash = getPathHash(sample),
+	    .keyWords = {phaseIncrement, timeStretchRatio, skipSamplesAtStart, reversed,
+	                 getTimeStretchQuality(timeStretchRatio)},
+	};
+	int32_t i = findCacheFile(request.pathHash, getKeyHash(request.keyWords));
+	if (i == -1 || cacheFiles[i].restoreRequested) {
+		return false;
+	}
+
+	cacheFiles[i].restoreRequested = true;
+	pendingRestores[numPendingRestores++] = request;
+	return true;
+}
+
+// Samples from the old song may be about to go, and any from the new one get another go at being restored
+void SampleCacheStore::songLoading() {
+	numPendingRestores = 0;
+	indexNeedsBuilding = true;
+}
+
+void SampleCacheStore::slowRoutine() {
+	if (sdRoutineLock || currentlyAccessingCard) {
+		return;
+	}
+
+	// Streaming Sample data for playback always comes first
+	if (!audioFileManager.loadingQueue.empty()) {
+		return;
+	}
+
+	if (job == Job::WRITING) {
+		writeNextCluster();
+		return;
+	}
+	if (job == Job::RESTORING) {
+		restoreNextCluster();
+		return;
+	}
+
+	if (!isEnabled()) {
+		numPendingCaches = 0;
+		numPendingRestores = 0;
+		return;
+	}
+
+	if (indexNeedsBuilding) {
+		buildIndex();
+		return;
+	}
+
+	// Restores first - a voice is already waiting on those
+	if (numPendingRestores) {
+		RestoreRequest request = pendingRestores[0];
+		numPendingRestores--;
+		memmove(&pendingRestores[0], &pendingRestores[1], numPendingRestores * sizeof(RestoreRequest));
+		startRestoring(request);
+		return;
+	}
+
+	for (int32_t i = 0; i < numPendingCaches; i++) {
+		SampleCache* cache = pendingCaches[i];
+		if (cache->writeBytePos == cache->waveformLengthBytes) {
+			numPendingCaches--;
+			memmove(&pendingCaches[i], &pendingCaches[i + 1], (numPendingCaches - i) * sizeof(SampleCache*));
+			startWriting(cache);
+			return;
+		}
+	}
+}
+
+// Just lists the folder - no file gets opened. Anything past kMaxCacheFiles is over the cap anyway, so goes.
+void SampleCacheStore::buildIndex() {
+	if (!StorageManager::checkSDInitialized()) {
+		return;
+	}
+
+	numCacheFiles = 0;
+	cacheFolderBytes = 0;
+
+	DIR dir;
+	if (f_opendir(&dir, kCacheFolder) == FR_OK) {
+		FILINFO fno;
+		char filePath[64];
+		while (f_readdir(&dir, &fno) == FR_OK && fno.fname[0] != 0) {
+			if (fno.fattrib & AM_DIR) {
+				continue;
+			}
+
+			char* end;
+			uint32_t pathHash = strtoul(fno.fname, &end, 16);
+			if (*end != '_') {
+				continue;
+			}
+			uint32_t keyHash = strtoul(end + 1, &end, 16);
+			if (strcmp(end, ".CAC") != 0) {
+				continue;
+			}
+
+			if (numCacheFiles == kMaxCacheFiles || cacheFolderBytes + fno.fsize > kMaxCacheFolderBytes
+			    || fno.fsize < sizeof(CacheFileHeader)) {
+				snprintf(filePath, sizeof(filePath), "%s/%s", kCacheFolder, fno.fname);
+				f_unlink(filePath);
+				continue;
+			}
+
+			cacheFiles[numCacheFiles++] = {
+			    .pathHash = pathHash, .keyHash = keyHash, .size = (uint32_t)fno.fsize, .restoreRequested = false};
+			cacheFolderBytes += fno.fsize;
+		}
+		f_closedir(&dir);
+	}
+
+	indexNeedsBuilding = false;
+	D_PRINTLN("%d sample caches on card, %d KB", numCacheFiles, cacheFolderBytes >> 10);
+}
+
+void SampleCacheStore::startWriting(SampleCache* cache) {
+	if (!StorageManager::checkSDInitialized()) {
+		return;
+	}
+
+	Sample* sample = cache->sample;
+	uint32_t pathHash = getPathHash(sample);
+	uint32_t keyHash = getKeyHash(cache);
+	if (findCacheFile(pathHash, keyHash) != -1) {
+		return;
+	}
+
+	uint32_t fileLength = getFileLength(cache);
+	if (fileLength > kMaxCacheFolderBytes) {
+		return;
+	}
+
+	// Make room, oldest first
+	while (numCacheFiles && (numCacheFiles == kMaxCacheFiles || cacheFolderBytes + fileLength > kMaxCacheFolderBytes)) {
+		forgetCacheFile(0, true);
+	}
+
+	FRESULT result = f_mkdir(kCacheFolder);
+	if (result != FR_OK && result != FR_EXIST) {
+		return;
+	}
+
+	getCacheFilePath(currentFilePath, pathHash, keyHash);
+
+	// If it's already on the card, it'll have been written in an earlier session
+	result = f_open(&file, currentFilePath, FA_WRITE | FA_CREATE_NEW);
+	if (result != FR_OK) {
+		return;
+	}
+
+	CacheFileHeader header = {
+	    .magic = kCacheFileMagic,
+	    .version = kCacheFileVersion,
+	    .clusterSize = (uint32_t)Cluster::size,
+	    .cacheByteDepth = kCacheByteDepth,
+	    .pathHash = pathHash,
+	    .sampleFirstSector = sample->clusters.getElement(0)->sdAddress,
+	    .sampleLengthInSamples = (uint32_t)sample->lengthInSamples,
+	    .numChannels = sample->numChannels,
+	    .phaseIncrement = cache->phaseIncrement,
+	    .timeStretchRatio = cache->timeStretchRatio,
+	    .skipSamplesAtStart = cache->skipSamplesAtStart,
+	    .reversed = cache->reversed,
+	    .timeStretchQuality = (uint32_t)getTimeStretchQuality(cache->timeStretchRatio),
+	    .waveformLengthBytes = cache->waveformLengthBytes,
+	};
+
+	job = Job::WRITING;
+	currentCache = cache;
+	nextCluster = 0;
+
+	UINT bytesWritten;
+	result = f_write(&file, &header, sizeof(header), &bytesWritten);
+	if (result != FR_OK || bytesWritten != sizeof(header)) {
+		finishJob(false);
+		return;
+	}
+
+	D_PRINTLN("writing sample cache %s", currentFilePath);
+}
+
+void SampleCacheStore::writeNextCluster() {
+	SampleCache* cache = currentCache;
+
+	if (currentCacheInvalidated) {
+		finishJob(false);
+		return;
+	}
+
+	int32_t startBytePos = nextCluster << Cluster::size_magnitude;
+	int32_t numBytes = getClusterEndBytePos(cache, nextCluster) - startBytePos;
+
+	// Don't go through getCluster() - that'd reprioritize it as if it was being played
+	Cluster* cluster = cache->getClusterWithoutPrioritizing(nextCluster);
+
+	UINT bytesWritten;
+	FRESULT result = f_write(&file, cluster->data, numBytes, &bytesWritten);
+	if (currentCacheInvalidated || result != FR_OK || (int32_t)bytesWritten != numBytes) {
+		finishJob(false);
+		return;
+	}
+
+	nextCluster++;
+	if (nextCluster == getNumClusters(cache)) {
+		uint32_t pathHash = getPathHash(cache->sample);
+		uint32_t keyHash = getKeyHash(cache);
+		uint32_t fileLength = getFileLength(cache);
+		finishJob(true);
+		if (numCacheFiles < kMaxCacheFiles) {
+			// It was only written because it rendered, so there's no point restoring it again this song
+			cacheFiles[numCacheFiles++] = {
+			    .pathHash = pathHash, .keyHash = keyHash, .size = fileLength, .restoreRequested = true};
+			cacheFolderBytes += fileLength;
+		}
+	}
+}
+
+void SampleCacheStore::startRestoring(RestoreRequest const& request) {
+	// The Sample might have been deleted since the request was made
+	Sample* sample = nullptr;
+	for (int32_t e = 0; e < audioFileManager.audioFiles.getNumElements(); e++) {
+		AudioFile* audioFile = (AudioFile*)audioFileManager.audioFiles.getElement(e);
+		if (audioFile == request.sample) {
+			sample = request.sample;
+			break;
+		}
+	}
+	if (!sample || !sampleIsPersistable(sample) || getPathHash(sample) != request.pathHash) {
+		return;
+	}
+
+	int32_t i = findCacheFile(request.pathHash, getKeyHash(request.keyWords));
+	if (i == -1) {
+		return;
+	}
+
+	getCacheFilePath(currentFilePath, request.pathHash, cacheFiles[i].keyHash);
+	if (f_open(&file, currentFilePath, FA_READ) != FR_OK) {
+		forgetCacheFile(i, false);
+		return;
+	}
+
+	CacheFileHeader header;
+	UINT bytesRead;
+	FRESULT result = f_read(&file, &header, sizeof(header), &bytesRead);
+	bool valid = (result == FR_OK && bytesRead == sizeof(header) && header.magic == kCacheFileMagic
+	              && header.version == kCacheFileVersion && header.clusterSize == Cluster::size && header.cacheByteDepth == kCacheByteDepth
+	              && header.pathHash == request.pathHash
+	              && header.timeStretchQuality == (uint32_t)request.keyWords[4]);
+
+	// If the Sample itself has changed, this file is useless now
+	if (valid
+	    && (header.sampleFirstSector != sample->clusters.getElement(0)->sdAddress
+	        || header.sampleLengthInSamples != (uint32_t)sample->lengthInSamples
+	        || header.numChannels != sample->numChannels)) {
+		D_PRINTLN("stale sample cache");
+		valid = false;
+	}
+
+	SampleCache* cache = nullptr;
+	bool created = false;
+	if (valid) {
+		cache = sample->getOrCreateCache(header.phaseIncrement, header.timeStretchRatio, header.skipSamplesAtStart,
+		                                 header.reversed, true, &created);
+		if (!cache || !created) {
+			f_close(&file);
+			return; // Already in RAM, or no memory to make it
+		}
+
+		// Nothing can have got hold of the cache yet, so if the file doesn't fit it, it's left empty for the next voice
+		// to render into as normal - and to be written out afresh
+		if (cache->waveformLengthBytes != header.waveformLengthBytes || cacheFiles[i].size != getFileLength(cache)) {
+			f_close(&file);
+			forgetCacheFile(i, true);
+			cacheCreated(cache);
+			return;
+		}
+	}
+
+	if (!valid) {
+		f_close(&file);
+		forgetCacheFile(i, true);
+		return;
+	}
+
+	// Voices skip it til finishJob(), so none can be reading or writing it while it's only partly there
+	cache->restoring = true;
+	job = Job::RESTORING;
+	currentCache = cache;
+	nextCluster = 0;
+}
+
+void SampleCacheStore::restoreNextCluster() {
+	SampleCache* cache = currentCache;
+
+	// Out of memory, or stolen from - keep what we got
+	if (currentCacheInvalidated || !cache->setupNewCluster(nextCluster)) {
+		finishJob(false);
+		return;
+	}
+
+	// The new Cluster isn't in a stealable queue until getCluster() puts it there, so it can't be stolen while we read
+	// into it. Earlier ones can, though, which would truncate the cache under us.
+	Cluster* cluster = cache->getClusterWithoutPrioritizing(nextCluster);
+	int32_t numBytes = getClusterEndBytePos(cache, nextCluster) - (nextCluster << Cluster::size_magnitude);
+	UINT bytesRead;
+	FRESULT result = f_read(&file, cluster->data, numBytes, &bytesRead);
+	if (currentCacheInvalidated || result != FR_OK || (int32_t)bytesRead != numBytes) {
+		if (currentCache) {
+			cache->discardNewCluster(nextCluster);
+		}
+		else {
+			cluster->destroy(); // The cache itself has gone, but this Cluster was never its to free
+		}
+		finishJob(false);
+		return;
+	}
+
+	cache->setWriteBytePos(getClusterEndBytePos(cache, nextCluster));
+	cache->getCluster(nextCluster); // Queue it for stealing alongside the rest of the cache
+
+	nextCluster++;
+	if (nextCluster == getNumClusters(cache)) {
+		D_PRINTLN("restored sample cache, %d clusters", nextCluster);
+		finishJob(true);
+	}
+}
+
+void SampleCacheStore::finishJob(bool success) {
+	f_close(&file);
+	if (!success && job == Job::WRITING) {
+		D_PRINTLN("sample cache write abandoned");
+		f_unlink(currentFilePath);
+	}
+	if (job == Job::RESTORING && currentCache) {
+		currentCache->restoring = false; // If it fell short, voices just render the rest, as for any truncated cache
+	}
+	job = Job::NONE;
+	currentCache = nullptr;
+	currentCacheInvalidated = false;
+}
@@ -0,0 +1,112 @@
+/*
+ * Copyright © 2025 Synthstrom Audible Limited
+ *
+ * This file is part of The Synthstrom Audible Deluge Firmware.
+ *
+ * The Synthstrom Audible Deluge Firmware is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program.
+ * If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "definitions_cxx.hpp"
+#include <array>
+#include <cstdint>
+
+extern "C" {
+#include "fatfs/ff.h"
+}
+
+class Sample;
+class SampleCache;
+
+/*
+ * ===================== Persistent SampleCaches ==================
+ *
+ * When the "persist sample caches" community feature is on, any SampleCache (repitched and / or time-stretched audio)
+ * which gets rendered all the way to its end is written out to the CACHE folder on the card, one Cluster per call to
+ * slowRoutine(), so the SD card is never tied up for long. Each file is keyed by the Sample's path, by the same
+ * four words Sample::caches is keyed on - phaseIncrement, timeStretchRatio, skipSamplesAtStart and reversed - and by
+ * the time stretch quality setting it was rendered at.
+ *
+ * Nothing is read back at song load. Instead, slowRoutine() lists the CACHE folder into a small index in RAM, and the
+ * first time a voice asks for a cache which is in that index, requestRestore() queues it and the voice renders
+ * without a cache for that one note. slowRoutine() then reads the file back in, one Cluster per call, so only caches
+ * a song actually plays ever get loaded. Til that's finished the cache is flagged as restoring, and voices go without
+ * it rather than reading a half-loaded cache or writing into it. Restored Clusters are as stealable as any others - if one gets stolen, the
+ * cache is truncated exactly as it always has been.
+ *
+ * The folder is capped at kMaxCacheFiles files and kMaxCacheFolderBytes. Writing a new file evicts the ones listed
+ * first, which on FAT are generally the oldest. Files whose Sample has since changed are deleted when found.
+ */
+
+class SampleCacheStore {
+public:
+	void cacheCreated(SampleCache* cache);
+	void cacheInvalidated(SampleCache* cache);
+	void cacheDestroyed(SampleCache* cache);
+	bool requestRestore(Sample* sample, int32_t phaseIncrement, int32_t timeStretchRatio, int32_t skipSamplesAtStart,
+	                    bool reversed);
+
+	void slowRoutine();
+	void songLoading();
+
+private:
+	static constexpr int32_t kMaxPendingCaches = 16;
+	static constexpr int32_t kMaxPendingRestores = 8;
+	static constexpr int32_t kMaxCacheFiles = 128;
+	static constexpr uint32_t kMaxCacheFolderBytes = 256 << 20;
+
+	struct CacheFile {
+		uint32_t pathHash;
+		uint32_t keyHash;
+		uint32_t size;
+		bool restoreRequested;
+	};
+
+	struct RestoreRequest {
+		Sample* sample;
+		uint32_t pathHash;
+		int32_t keyWords[5];
+	};
+
+	enum class Job : uint8_t { NONE, WRITING, RESTORING };
+
+	bool isEnabled();
+	int32_t findCacheFile(uint32_t pathHash, uint32_t keyHash);
+	void forgetCacheFile(int32_t i, bool deleteFile);
+	void buildIndex();
+	void startWriting(SampleCache* cache);
+	void writeNextCluster();
+	void startRestoring(RestoreRequest const& request);
+	void restoreNextCluster();
+	void finishJob(bool success);
+
+	std::array<SampleCache*, kMaxPendingCaches> pendingCaches{};
+	int32_t numPendingCaches = 0;
+
+	std::array<RestoreRequest, kMaxPendingRestores> pendingRestores{};
+	int32_t numPendingRestores = 0;
+
+	std::array<CacheFile, kMaxCacheFiles> cacheFiles{};
+	int32_t numCacheFiles = 0;
+	uint32_t cacheFolderBytes = 0;
+	bool indexNeedsBuilding = true;
+
+	Job job = Job::NONE;
+	SampleCache* currentCache = nullptr;
+	int32_t nextCluster = 0;
+	bool currentCacheInvalidated = false;
+	FIL file;
+	char currentFilePath[64];
+};
+
+extern SampleCacheStore sampleCacheStore;
@@ -190,6 +190,10 @@ enum Entries {
 190: GlobalMIDICommand::SHIFT channel + 1
 191: GlobalMIDICommand::SHIFT noteCode + 1
 192-195: GlobalMIDICommand::SHIFT product / vendor ids
+196: screensaverMode
+197: screensaverTimeoutMinutes
+198: midiEngine.inputLatencyMS
+199: AudioEngine::latencyTier
 */
 
 uint8_t defaultScale;
@@ -285,6 +289,8 @@ void resetSettings() {
 	PadLEDs::flashCursor = FLASH_CURSOR_SLOW;
 
 	midiEngine.midiThru = false;
+	midiEngine.inputLatencyMS = 0;
+	AudioEngine::setLatencyTier(AudioLatencyTier::AUTO);
 	midiEngine.midiTakeover = MIDITakeoverMode::JUMP;
 	midiEngine.midiSelectKitRow = false;
 
@@ -814,6 +820,13 @@ void readSettings() {
 		screensaverMode =
 		    (buffer[196] < kNumScreensaverModes) ? static_cast<ScreensaverMode>(buffer[196]) : kDefaultScreensaverMode;
 	}
+
+	// Zeroed on any unit that's never saved it, which is OFF - so there's nothing to special case
+	midiEngine.inputLatencyMS = (buffer[198] <= kMaxMIDIInputLatencyMS) ? buffer[198] : 0;
+
+	// Zeroed on any unit that's never saved it too, which is AUTO - how it always worked before
+	AudioEngine::setLatencyTier((buffer[199] < kNumAudioLatencyTiers) ? static_cast<AudioLatencyTier>(buffer[199])
+	                                                                  : AudioLatencyTier::AUTO);
 }
 
 static bool areAutomationSettingsValid(std::span<uint8_t> buffer) {
@@ -1051,6 +1064,10 @@ void writeSettings() {
 	buffer[196] = util::to_underlying(screensaverMode);
 	buffer[197] = screensaverTimeoutMinutes;
 
+	buffer[198] = midiEngine.inputLatencyMS;
+
+	buffer[199] = util::to_underlying(AudioEngine::latencyTier);
+
 	R_SFLASH_EraseSector(0x80000 - 0x1000, SPIBSC_CH, SPIBSC_CMNCR_BSZ_SINGLE, 1, SPIBSC_OUTPUT_ADDR_24);
 	R_SFLASH_ByteProgram(0x80000 - 0x1000, buffer.data(), 256, SPIBSC_CH, SPIBSC_CMNCR_BSZ_SINGLE, SPIBSC_1BIT,
 	                     SPIBSC_OUTPUT_ADDR_24);
@@ -0,0 +1,208 @@
+/*
+ * Copyright © 2025 Synthstrom Audible Limited
+ *
+ * This file is part of The Synthstrom Audible Deluge Firmware.
+ *
+ * The Synthstrom Audible Deluge Firmware is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program.
+ * If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "storage/set_list.h"
+#include "gui/l10n/l10n.h"
+#include "gui/ui_timer_manager.h"
+#include "hid/display/display.h"
+#include "io/debug/log.h"
+#include "memory/general_memory_allocator.h"
+#include "model/settings/runtime_feature_settings.h"
+#include "storage/audio/audio_file_manager.h"
+#include "storage/song_preloader.h"
+#include "storage/storage_manager.h"
+#include <cstring>
+
+#define SETTINGS_FOLDER "SETTINGS"
+#define SET_LIST_FILE SETTINGS_FOLDER "/SetList.XML"
+
+SetList setList{};
+
+namespace {
+
+// Leave this much of the stealable region free for everything else that lives there - sample caches, the
+// SampleBrowser's previews, recording
+constexpr uint32_t kHeadroomDivisor = 8;
+
+} // namespace
+
+bool SetList::isActive() {
+	if (!runtimeFeatureSettings.isOn(RuntimeFeatureSettingType::SetListMode)) {
+		return false;
+	}
+	return numSongs > 0;
+}
+
+void SetList::slowRoutine() {
+	if (needsReading && !sdRoutineLock && !currentlyAccessingCard) {
+		readFromFile();
+	}
+}
+
+void SetList::readFromFile() {
+	needsReading = false;
+	numSongs = 0;
+	position = -1;
+	preloadingIndex = -1;
+
+	if (!runtimeFeatureSettings.isOn(RuntimeFeatureSettingType::SetListMode)) {
+		return;
+	}
+
+	FilePointer fp;
+	if (!StorageManager::fileExists(SET_LIST_FILE, &fp)) {
+		return;
+	}
+
+	// Not smDeserializer - that may be part way through a song. Whatever was active gets put back after, as
+	// SongPreloader does.
+	void* readerMemory = GeneralMemoryAllocator::get().allocLowSpeed(sizeof(XMLDeserializer));
+	if (!readerMemory) {
+		return;
+	}
+	XMLDeserializer* xmlReader = new (readerMemory) XMLDeserializer();
+	FileDeserializer* otherDeserializer = activeDeserializer;
+	FirmwareVersion otherFirmwareVersion = song_firmware_version;
+
+	Error error = StorageManager::openXMLFile(&fp, *xmlReader, "setList");
+	if (error == Error::NONE) {
+		readSongs(*xmlReader);
+		xmlReader->closeWriter();
+	}
+
+	activeDeserializer = otherDeserializer;
+	song_firmware_version = otherFirmwareVersion;
+	xmlReader->~XMLDeserializer();
+	delugeDealloc(readerMemory);
+
+	D_PRINTLN("Set list has %d songs", numSongs);
+}
+
+void SetList::readSongs(Deserializer& reader) {
+	char const* tagName;
+	while (*(tagName = reader.readNextTagOrAttributeName())) {
+		if (!strcmp(tagName, "song") && numSongs < kMaxNumSongs) {
+			String path;
+			reader.readTagOrAttributeValueString(&path);
+			if (!path.isEmpty()) {
+				String& entry = songPaths[numSongs];
+				if (strchr(path.get(), '/')) {
+					entry.set(&path);
+				}
+				else {
+					entry.set("SONGS/");
+					entry.concatenate(&path);
+				}
+				fits[numSongs] = Fit::UNKNOWN;
+				numSongs++;
+			}
+		}
+		reader.exitTag(tagName);
+	}
+}
+
+int32_t SetList::findSong(String* dirPath, String* filename) {
+	int32_t dirLength = dirPath->getLength();
+	for (int32_t i = 0; i < numSongs; i++) {
+		char const* path = songPaths[i].get();
+		if (!strncasecmp(path, dirPath->get(), dirLength) && path[dirLength] == '/'
+		    && !strcasecmp(&path[dirLength + 1], filename->get())) {
+			return i;
+		}
+	}
+	return -1;
+}
+
+void SetList::songLoaded(String* dirPath, String* filename) {
+	if (!isActive()) {
+		return;
+	}
+	position = findSong(dirPath, filename);
+}
+
+char const* SetList::getSongPath(int32_t offset) {
+	int32_t index = (position >= 0) ? position + offset : offset - 1;
+	if (index < 0 || index >= numSongs) {
+		return nullptr;
+	}
+	return songPaths[index].get();
+}
+
+void SetList::preloadNextSong() {
+	int32_t index = position + 1;
+	char const* path = getSongPath(1);
+	if (!path) {
+		return;
+	}
+
+	FilePointer fp;
+	if (!StorageManager::fileExists(path, &fp)) {
+		D_PRINTLN("Set list song %s missing", path);
+		return;
+	}
+
+	char const* slashPos = strrchr(path, '/');
+	String dirPath;
+	dirPath.set(path, slashPos - path);
+	String filename;
+	filename.set(slashPos + 1);
+
+	// If we already know the pair won't fit, just get the next song ready to start, like a plain preload would
+	preloadingIndex = index;
+	songPreloader.preload(&dirPath, &filename, &fp, fits[index] != Fit::TOO_BIG, nextSongPreloaded);
+}
+
+bool SetList::fitsAlongsideCurrentSong(String* dirPath, String* filename) {
+	int32_t index = findSong(dirPath, filename);
+	return index >= 0 && index == preloadingIndex && fits[index] == Fit::FITS;
+}
+
+// Called from the preload task once the next song is READY. That's no place to be going through every AudioFile or
+// putting up a popup, so the UI timer does it.
+void SetList::nextSongPreloaded() {
+	uiTimerManager.setTimer(TimerName::SET_LIST_NEXT_SONG, 0);
+}
+
+// Every sample either song uses now has a reason to be loaded, so summing their sizes gives what the pair of them
+// needs - with shared samples counted once.
+void SetList::checkNextSongFits() {
+	int32_t index = preloadingIndex;
+	if (index < 0 || index >= numSongs) {
+		return;
+	}
+
+	// If it's been taken or cancelled since, the sum would be of something else
+	if (songPreloader.getState() != SongPreloader::State::READY) {
+		return;
+	}
+
+	if (fits[index] != Fit::TOO_BIG) {
+		MemoryRegion& stealableRegion = GeneralMemoryAllocator::get().regions[MEMORY_REGION_STEALABLE];
+		uint64_t budget = stealableRegion.end - stealableRegion.start;
+		budget -= budget / kHeadroomDivisor;
+		uint64_t bytesNeeded = audioFileManager.getSampleBytesInUse();
+
+		D_PRINTLN("Set list: %s needs %d KB of samples with the current song, budget %d KB", songPaths[index].get(),
+		          (int32_t)(bytesNeeded >> 10), (int32_t)(budget >> 10));
+
+		fits[index] = (bytesNeeded <= budget) ? Fit::FITS : Fit::TOO_BIG;
+	}
+
+	if (fits[index] == Fit::TOO_BIG) {
+		display->displayPopup(deluge::l10n::get(deluge::l10n::String::STRING_FOR_NEXT_SONG_WONT_FIT));
+	}
+}
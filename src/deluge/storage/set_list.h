@@ -0,0 +1,94 @@
+/*
+ * Copyright © 2025 Synthstrom Audible Limited
+ *
+ * This file is part of The Synthstrom Audible Deluge Firmware.
+ *
+ * The Synthstrom Audible Deluge Firmware is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program.
+ * If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "util/d_string.h"
+#include <array>
+#include <cstdint>
+
+class Deserializer;
+
+/*
+ * ===================== Set lists ==================
+ *
+ * With the "set list" community feature on, SETTINGS/SetList.XML lists the songs of a set in the order they get
+ * played:
+ *
+ *   <setList>
+ *     <song>SONGS/OPENER.XML</song>
+ *     <song>SONGS/LIVE/SECOND.XML</song>
+ *   </setList>
+ *
+ * (A path without a folder is taken to be in SONGS.) The "next song" command then steps through the set rather than
+ * through whatever folder the current song happens to be in, and the song after the current one gets preloaded.
+ *
+ * The file is read at boot, when the feature is turned on and when a card is inserted - never on the way into a song
+ * load, which may already have the song's file open. It's read through a deserializer of its own, so a read from the
+ * card-insert path can't disturb anything else being read at the time.
+ *
+ * Only two songs are ever in RAM at once - the one playing and the next one - so that's the pair the sample memory
+ * budget is worked out for. Once the next song has been preloaded, we add up the sample data the two of them lay claim
+ * to, counting samples they share just once, and compare that against the stealable memory region. If it fits, the
+ * next song gets all its samples loaded ahead of time and the two songs are held in RAM side by side through the
+ * swap, so shared samples never drop out. If not, we say so, and only the samples it needs to start playing get
+ * preloaded.
+ */
+
+class SetList {
+public:
+	static constexpr int32_t kMaxNumSongs = 64;
+
+	enum class Fit : uint8_t {
+		UNKNOWN,
+		FITS,
+		TOO_BIG,
+	};
+
+	bool isActive();
+	/// Reads SETTINGS/SetList.XML, if the feature is on.
+	void readFromFile();
+	/// The card's been swapped, so the file gets read again on the next slowRoutine().
+	void cardReinserted() { needsReading = true; }
+	void slowRoutine();
+	/// Call whenever a song has been loaded, so we know where in the set we are.
+	void songLoaded(String* dirPath, String* filename);
+	/// The full path of the song the given distance on from the current one, or nullptr if that's outside the set. If
+	/// the current song isn't in the set, the next one is the first.
+	char const* getSongPath(int32_t offset);
+	/// Starts preloading the song after the current one.
+	void preloadNextSong();
+	/// Whether the given song is known to fit in RAM alongside the current one.
+	bool fitsAlongsideCurrentSong(String* dirPath, String* filename);
+	/// Called from the UI timer once the next song is preloaded.
+	void checkNextSongFits();
+
+private:
+	static void nextSongPreloaded();
+
+	void readSongs(Deserializer& reader);
+	int32_t findSong(String* dirPath, String* filename);
+
+	bool needsReading = false;
+	int32_t numSongs = 0;
+	int32_t position = -1;
+	int32_t preloadingIndex = -1;
+	std::array<String, kMaxNumSongs> songPaths;
+	std::array<Fit, kMaxNumSongs> fits{};
+};
+
+extern SetList setList;
@@ -14,9 +14,11 @@
 #include "memory/general_memory_allocator.h"
 #include "processing/engines/audio_engine.h"
 #include "scheduler_api.h"
+#include "storage/sysex_write_stream.h"
 #include "util/containers.h"
 #include "util/pack.h"
 #include <cstring>
+#include <string_view>
 
 #define MAX_DIR_LINES 25
 
@@ -43,6 +45,7 @@ struct FILdata {
 	bool fileOpen = false;
 	int forWrite = false;
 	FIL file;
+	smSysex::WriteStream writeStream;
 };
 
 int32_t FIDcounter = 1;
@@ -51,16 +54,21 @@ uint32_t LRUcounter = 1;
 PLACE_SDRAM_BSS FILdata openFiles[MAX_OPEN_FILES];
 
 const int MaxSysExLength = 1024;
+// Enough for a streaming client's full window, plus some slack in case it resends while we're catching up
+const size_t maxQueuedStreamedWrites = 2 * smSysex::kTransferWindow;
 
 struct SysExDataEntry {
 	MIDICable& cable;
 	int32_t len;
+	bool streamedWrite;
 	uint8_t data[sysexBufferMax];
 
-	SysExDataEntry(MIDICable& forCable, int32_t newLen) : cable{forCable}, len{newLen} {}
+	SysExDataEntry(MIDICable& forCable, int32_t newLen, bool isStreamedWrite)
+	    : cable{forCable}, len{newLen}, streamedWrite{isStreamedWrite} {}
 };
 
 deluge::deque<SysExDataEntry> SysExQ;
+size_t numStreamedWritesQueued = 0;
 
 // The following constants assume that the messageID part ranges from 1 to SYSEX_MSGID_MAX
 // and that SYSEX_MSGID_MAX is 1 less than a power of 2.
@@ -153,6 +161,7 @@ FILdata* smSysex::openFIL(const char* fPath, int forWrite, uint32_t* fsize, FRES
 		fp->forWrite = forWrite;
 		fp->fSize = f_size(&fp->file);
 		fp->fPosition = 0;
+		fp->writeStream.reset(0);
 		return fp;
 	}
 	return nullptr;
@@ -509,6 +518,7 @@ void smSysex::readBlock(MIDICable& cable, JsonDeserializer& reader) {
 	uint32_t addr = 0;
 	uint32_t size = blockBufferMax;
 	int32_t fid = 0;
+	bool wantsCRC = false;
 
 	auto repSN = reader.getReplySeqNum();
 	reader.match('{');
@@ -521,8 +531,11 @@ void smSysex::readBlock(MIDICable& cable, JsonDeserializer& reader) {
 		}
 		else if (!strcmp(tagName, "size")) {
 			size = reader.readTagOrAttributeValueInt();
-			if (size > blockBufferMax)
-				size = blockBufferMax;
+			if (size > kReadBlockMax)
+				size = kReadBlockMax;
+		}
+		else if (!strcmp(tagName, "crc")) {
+			wantsCRC = reader.readTagOrAttributeValueInt();
 		}
 		else {
 			reader.exitTag();
@@ -540,7 +553,7 @@ void smSysex::readBlock(MIDICable& cable, JsonDeserializer& reader) {
 	uint8_t* srcAddr = (uint8_t*)addr;
 	if (errCode == FRESULT::FR_OK) {
 		if (!readBlockBuffer && fp) {
-			readBlockBuffer = (uint8_t*)GeneralMemoryAllocator::get().allocLowSpeed(blockBufferMax);
+			readBlockBuffer = (uint8_t*)GeneralMemoryAllocator::get().allocLowSpeed(kReadBlockMax);
 		}
 
 		if (readBlockBuffer && fp) {
@@ -569,6 +582,9 @@ void smSysex::readBlock(MIDICable& cable, JsonDeserializer& reader) {
 	jWriter.writeAttribute("addr", addr);
 	jWriter.writeAttribute("size", size);
 	jWriter.writeAttribute("err", errCode);
+	if (wantsCRC) {
+		jWriter.writeAttribute("crc", size ? blockCRC(srcAddr, size) : 0);
+	}
 	jWriter.closeTag(true);
 
 	jWriter.writeByte(0); // spacer between Json and encoded block.
@@ -598,11 +614,18 @@ void smSysex::readBlock(MIDICable& cable, JsonDeserializer& reader) {
 	sendMsg(cable, jWriter);
 }
 
+// A write can carry "crc", the CRC-32 of the unpacked block, and the block won't be written if it doesn't match. It can
+// also carry "ack", which makes it a streamed write (see WriteStream) - replied to only if ack is 1 or it was rejected,
+// with the reply's "pos" telling the client where to carry on from.
 void smSysex::writeBlock(MIDICable& cable, JsonDeserializer& reader) {
 	char const* tagName;
 	uint32_t fileId = 0;
 	uint32_t addr = 0;
 	uint32_t size = blockBufferMax;
+	bool hasCRC = false;
+	uint32_t crc = 0;
+	bool streamed = false;
+	bool wantsAck = true;
 	reader.match('{');
 	while (*(tagName = reader.readNextTagOrAttributeName())) {
 		if (!strcmp(tagName, "addr")) {
@@ -616,6 +639,14 @@ void smSysex::writeBlock(MIDICable& cable, JsonDeserializer& reader) {
 		else if (!strcmp(tagName, "fid")) {
 			fileId = reader.readTagOrAttributeValueInt();
 		}
+		else if (!strcmp(tagName, "crc")) {
+			crc = reader.readTagOrAttributeValueInt();
+			hasCRC = true;
+		}
+		else if (!strcmp(tagName, "ack")) {
+			wantsAck = reader.readTagOrAttributeValueInt();
+			streamed = true;
+		}
 		else {
 			reader.exitTag();
 		}
@@ -631,34 +662,79 @@ void smSysex::writeBlock(MIDICable& cable, JsonDeserializer& reader) {
 	if (reader.peekChar(&aChar) && aChar != 0) {
 		D_PRINTLN("Missing Separater error in writeBlock");
 	}
-	uint32_t decodedSize = decodeDataFromReader(reader, writeBlockBuffer, size);
+	uint32_t decodedSize = writeBlockBuffer ? decodeDataFromReader(reader, writeBlockBuffer, size) : 0;
 	D_PRINTLN("Decoded block len: %d", decodedSize);
 
+	bool crcMatches = !hasCRC || (writeBlockBuffer && blockCRC(writeBlockBuffer, decodedSize) == crc);
+
 	// Here is where we actually write the buffer out.
 	FRESULT errCode = FRESULT::FR_OK;
 	FILdata* fp = entryForFID(fileId);
+	bool shouldReply = true;
 
 	if (fp == nullptr) {
 		errCode = FRESULT::FR_NOT_ENABLED;
 	}
-	if (writeBlockBuffer && (fp != nullptr)) {
-		if (addr != fp->fPosition) {
-			errCode = f_lseek(&fp->file, addr);
+	else if (streamed) {
+		StreamedWrite action = fp->writeStream.receive(addr, crcMatches, wantsAck);
+		if (action == StreamedWrite::REJECT_SILENTLY) {
+			return;
 		}
-		if (errCode == FRESULT::FR_OK) {
-			noteFileIdUse(fp);
-			UINT actuallyWritten = 0;
-			errCode = f_write(&fp->file, writeBlockBuffer, decodedSize, &actuallyWritten);
-			size = actuallyWritten;
-			fp->fPosition = addr + actuallyWritten;
+		if (action == StreamedWrite::REJECT_AND_REPLY) {
+			errCode = FRESULT::FR_INVALID_PARAMETER;
 		}
+		shouldReply = (action != StreamedWrite::WRITE);
+	}
+	else if (!crcMatches) {
+		errCode = FRESULT::FR_INVALID_PARAMETER;
 	}
+
+	if (errCode == FRESULT::FR_OK) {
+		size = 0;
+		if (writeBlockBuffer) {
+			if (addr != fp->fPosition) {
+				errCode = f_lseek(&fp->file, addr);
+			}
+			if (errCode == FRESULT::FR_OK) {
+				noteFileIdUse(fp);
+				UINT actuallyWritten = 0;
+				errCode = f_write(&fp->file, writeBlockBuffer, decodedSize, &actuallyWritten);
+				size = actuallyWritten;
+				fp->fPosition = addr + actuallyWritten;
+			}
+		}
+		else {
+			errCode = FRESULT::FR_NOT_ENOUGH_CORE;
+		}
+
+		if (!streamed) {
+			fp->writeStream.reset(fp->fPosition);
+		}
+		else {
+			fp->writeStream.wrote(size);
+			if (errCode != FRESULT::FR_OK || size != decodedSize) {
+				fp->writeStream.failed();
+				shouldReply = true;
+			}
+		}
+	}
+	else {
+		size = 0;
+	}
+
+	if (!shouldReply) {
+		return;
+	}
+
 	startReply(jWriter, reader);
 	jWriter.writeOpeningTag("^write", false, true);
 	jWriter.writeAttribute("fid", fileId);
 	jWriter.writeAttribute("addr", addr);
 	jWriter.writeAttribute("size", size);
 	jWriter.writeAttribute("err", errCode);
+	if (streamed && fp != nullptr) {
+		jWriter.writeAttribute("pos", fp->writeStream.getExpectedPos());
+	}
 	jWriter.closeTag(true);
 
 	sendMsg(cable, jWriter);
@@ -744,6 +820,9 @@ void smSysex::assignSession(MIDICable& cable, JsonDeserializer& reader) {
 	jWriter.writeAttribute("midBase", sessionNum << SYSEX_SESSION_SHIFT);
 	jWriter.writeAttribute("midMin", (sessionNum << SYSEX_SESSION_SHIFT) + 1);
 	jWriter.writeAttribute("midMax", (sessionNum << SYSEX_SESSION_SHIFT) + SYSEX_MSGID_MAX);
+	jWriter.writeAttribute("readMax", kReadBlockMax);
+	jWriter.writeAttribute("writeMax", kWriteBlockMax);
+	jWriter.writeAttribute("window", kTransferWindow);
 	jWriter.closeTag(true);
 	sendMsg(cable, jWriter);
 }
@@ -769,8 +848,68 @@ void smSysex::sysexReceived(MIDICable& cable, uint8_t* data, int32_t len) {
 		return;
 	}
 
-	SysExDataEntry& de = SysExQ.emplace_back(cable, len);
+	// A client streaming a file shouldn't get this far ahead of us. If one does, turn the write away and tell it so -
+	// it'll go back and resend from there. Everything else gets queued regardless, as the client waits for its reply.
+	bool streamedWrite = isStreamedWrite(data, len);
+	if (streamedWrite && numStreamedWritesQueued >= maxQueuedStreamedWrites) {
+		D_PRINTLN("Too many streamed writes queued, turning one away");
+		rejectStreamedWrite(cable, data, len);
+		return;
+	}
+
+	SysExDataEntry& de = SysExQ.emplace_back(cable, len, streamedWrite);
 	memcpy(de.data, data, len);
+	if (streamedWrite) {
+		numStreamedWritesQueued++;
+	}
+}
+
+// Whether this is a write block with an "ack" attribute - which is what a client streaming a file sends. The Json part
+// ends at the 0 before the packed data, so there's no need to look any further than that.
+bool smSysex::isStreamedWrite(uint8_t const* data, int32_t len) {
+	if (len < 2) {
+		return false;
+	}
+	char const* json = (char const*)data + 2;
+	char const* jsonEnd = (char const*)memchr(json, 0, len - 2);
+	std::string_view header(json, jsonEnd ? jsonEnd - json : len - 2);
+	return header.starts_with("{\"write\":") && header.find("\"ack\"") != std::string_view::npos;
+}
+
+// Replies to a streamed write which we haven't got room to queue, as writeBlock() would reply to a failed one, telling
+// the client to resume from that block.
+void smSysex::rejectStreamedWrite(MIDICable& cable, uint8_t* data, int32_t len) {
+	uint32_t fileId = 0;
+	uint32_t addr = 0;
+	JsonDeserializer parser(data + 2, len - 2);
+	parser.setReplySeqNum(data[1]);
+	parser.match('{');
+	if (!strcmp(parser.readNextTagOrAttributeName(), "write")) {
+		char const* tagName;
+		parser.match('{');
+		while (*(tagName = parser.readNextTagOrAttributeName())) {
+			if (!strcmp(tagName, "addr")) {
+				addr = parser.readTagOrAttributeValueInt();
+			}
+			else if (!strcmp(tagName, "fid")) {
+				fileId = parser.readTagOrAttributeValueInt();
+			}
+			else {
+				parser.exitTag();
+			}
+		}
+	}
+
+	startReply(jWriter, parser);
+	jWriter.writeOpeningTag("^write", false, true);
+	jWriter.writeAttribute("fid", fileId);
+	jWriter.writeAttribute("addr", addr);
+	jWriter.writeAttribute("size", 0);
+	jWriter.writeAttribute("err", FRESULT::FR_TIMEOUT);
+	jWriter.writeAttribute("pos", addr);
+	jWriter.closeTag(true);
+
+	sendMsg(cable, jWriter);
 }
 
 void smSysex::handleNextSysEx() {
@@ -845,6 +984,9 @@ void smSysex::handleNextSysEx() {
 		parser.exitTag();
 	}
 done:
+	if (de.streamedWrite) {
+		numStreamedWritesQueued--;
+	}
 	SysExQ.pop_front();
 }
 
@@ -916,7 +1058,7 @@ retry_copy:
 			// Copy file contents
 			uint8_t* copyBuffer = nullptr;
 			if (!readBlockBuffer) {
-				readBlockBuffer = (uint8_t*)GeneralMemoryAllocator::get().allocLowSpeed(blockBufferMax);
+				readBlockBuffer = (uint8_t*)GeneralMemoryAllocator::get().allocLowSpeed(kReadBlockMax);
 			}
 			copyBuffer = readBlockBuffer;
 
@@ -34,6 +34,8 @@ void startReply(JsonSerializer& writer, JsonDeserializer& reader);
 void sendMsg(MIDICable& device, JsonSerializer& writer);
 
 void sysexReceived(MIDICable& cable, uint8_t* data, int32_t len);
+bool isStreamedWrite(uint8_t const* data, int32_t len);
+void rejectStreamedWrite(MIDICable& cable, uint8_t* data, int32_t len);
 void handleNextSysEx();
 void openFile(MIDICable& cable, JsonDeserializer& reader);
 void closeFile(MIDICable& cable, JsonDeserializer& reader);
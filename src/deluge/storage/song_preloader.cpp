@@ -0,0 +1,305 @@
+/*
+ * Copyright © 2025 Synthstrom Audible Limited
+ *
+ * This file is part of The Synthstrom Audible Deluge Firmware.
+ *
+ * The Synthstrom Audible Deluge Firmware is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program.
+ * If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "storage/song_preloader.h"
+#include "io/debug/log.h"
+#include "memory/general_memory_allocator.h"
+#include "model/global_effectable/global_effectable.h"
+#include "model/song/song.h"
+#include "processing/engines/audio_engine.h"
+#include "storage/audio/audio_file_manager.h"
+#include "storage/file_item.h"
+#include <algorithm>
+#include <cstring>
+
+extern "C" {
+#include <scheduler_api.h>
+}
+
+SongPreloader songPreloader{};
+
+namespace {
+
+// How long the parse may run before letting the rest of the firmware have a go. Well under the 3ms after which the
+// scheduler starts complaining about a task.
+constexpr double kParseSliceSeconds = 0.002;
+
+// Same priority as loading the startup song - below everything that runs regularly
+constexpr uint8_t kPreloadTaskPriority = 100;
+
+// How long to wait for the first Clusters of the song's samples before calling it ready anyway
+constexpr double kSampleLoadTimeoutSeconds = 5;
+
+} // namespace
+
+void SongPreloader::preload(String* newDirPath, FileItem* fileItem) {
+	preload(newDirPath, &fileItem->filename, &fileItem->filePointer);
+}
+
+void SongPreloader::preload(String* newDirPath, String* newFilename, FilePointer* newFilePointer, bool newAllSamples,
+                            void (*newWhenReady)()) {
+	if (isPreloading(newDirPath, newFilename, newFilePointer) && state != State::FAILED) {
+		return;
+	}
+
+	cancel();
+
+	dirPath.set(newDirPath);
+	filename.set(newFilename);
+	filePointer = *newFilePointer;
+	allSamples = newAllSamples;
+	whenReady = newWhenReady;
+	state = State::PARSING;
+
+	if (taskRunning) {
+		// The old preload is still unwinding underneath whoever called us - it'll start on this one once it's done
+		restartRequested = true;
+		return;
+	}
+
+	taskRunning = true;
+	addOnceTask(runTask, kPreloadTaskPriority, 0, "preload song", RESOURCE_SD | RESOURCE_SD_ROUTINE);
+}
+
+void SongPreloader::cancel() {
+	restartRequested = false;
+
+	if (taskRunning) {
+		// We can only have been called from on top of the task while it yields. It'll notice and clean up after
+		// itself once it resumes
+		cancelRequested = true;
+	}
+	else {
+		deleteSong();
+	}
+	state = State::IDLE;
+}
+
+Song* SongPreloader::take(String* wantedDirPath, FileItem* fileItem) {
+	if (state != State::READY || !isPreloading(wantedDirPath, fileItem)) {
+		cancel();
+		return nullptr;
+	}
+
+	Song* readySong = song;
+	song = nullptr;
+	state = State::IDLE;
+	return readySong;
+}
+
+bool SongPreloader::isPreloading(String* wantedDirPath, String* wantedFilename, FilePointer* wantedFilePointer) {
+	return state != State::IDLE && dirPath.equals(wantedDirPath) && filename.equals(wantedFilename)
+	       && filePointer.sclust == wantedFilePointer->sclust;
+}
+
+void SongPreloader::runTask() {
+	songPreloader.run();
+}
+
+void SongPreloader::readerRoutine() {
+	songPreloader.yieldIfSliceUsedUp();
+}
+
+void SongPreloader::run() {
+	do {
+		restartRequested = false;
+		cancelRequested = false;
+
+		Error error = readSong();
+
+		if (error == Error::NONE && !cancelRequested) {
+			state = State::LOADING_SAMPLES;
+			loadSamples();
+		}
+
+		if (cancelRequested) {
+			deleteSong();
+		}
+		else if (error != Error::NONE) {
+			D_PRINTLN("Preloading %s failed", filename.get());
+			deleteSong();
+			state = State::FAILED;
+		}
+		else {
+			AudioEngine::logAction("song preloaded");
+			state = State::READY;
+			if (whenReady) {
+				whenReady();
+			}
+		}
+	} while (restartRequested);
+
+	cancelRequested = false;
+	taskRunning = false;
+}
+
+Error SongPreloader::readSong() {
+	// Each of these owns a Cluster-sized read buffer, so we only keep one around while actually parsing
+	void* readerMemory = GeneralMemoryAllocator::get().allocLowSpeed(
+	    std::max({sizeof(XMLDeserializer), sizeof(JsonDeserializer), sizeof(BinaryDeserializer)}));
+	if (!readerMemory) {
+		return Error::INSUFFICIENT_RAM;
+	}
+
+	void* songMemory = GeneralMemoryAllocator::get().allocMaxSpeed(sizeof(Song));
+	if (!songMemory) {
+		delugeDealloc(readerMemory);
+		return Error::INSUFFICIENT_RAM;
+	}
+	song = new (songMemory) Song();
+
+	bool json = filename.contains(".Json");
+	bool binary = !json && filename.contains(".DBIN");
+	if (json) {
+		reader = new (readerMemory) JsonDeserializer();
+	}
+	else if (binary) {
+		reader = new (readerMemory) BinaryDeserializer();
+	}
+	else {
+		reader = new (readerMemory) XMLDeserializer();
+	}
+
+	// Opening the file already reads from it, and anything which runs in the meantime sees the active deserializer - so
+	// reader has to be set up before it's made the active one
+	enterParse();
+
+	Error error;
+	if (json) {
+		error = StorageManager::openJsonFile(&filePointer, *static_cast<JsonDeserializer*>(reader), "song");
+	}
+	else if (binary) {
+		error = StorageManager::openBinaryFile(&filePointer, *static_cast<BinaryDeserializer*>(reader), "song");
+	}
+	else {
+		error = StorageManager::openXMLFile(&filePointer, *static_cast<XMLDeserializer*>(reader), "song");
+	}
+	if (error != Error::NONE) {
+		goto stopParsing; // The open call has already closed the file
+	}
+
+	error = song->paramManager.setupUnpatched();
+	if (error != Error::NONE) {
+		goto closeFile;
+	}
+	GlobalEffectable::initParams(&song->paramManager);
+
+	reader->backgroundRoutine = readerRoutine;
+	sliceStartTime = getSystemTime();
+
+	error = song->readFromFile(*reader);
+
+closeFile:
+	if (reader->closeWriter() != FR_OK && error == Error::NONE) {
+		error = Error::SD_CARD;
+	}
+
+stopParsing:
+	leaveParse();
+	deleteReader();
+
+	if (error == Error::NONE) {
+		song->dirPath.set(&dirPath);
+	}
+	return error;
+}
+
+// Claim whatever of the song's samples are already in RAM, then load the ones its active clips need - or all of them,
+// if asked. Any others get loaded once the song is swapped in, as they always have been.
+void SongPreloader::loadSamples() {
+	// If something else is part way through loading underneath us, we'd trample on its alternate sample folder. Leave
+	// the samples to performLoad() in that case - the song itself is still good
+	if (audioFileManager.thingTypeBeingLoaded != ThingType::NONE) {
+		return;
+	}
+
+	String filenameWithoutExtension;
+	filenameWithoutExtension.set(&filename);
+	char const* dotAddress = strrchr(filenameWithoutExtension.get(), '.');
+	if (dotAddress && filenameWithoutExtension.shorten(dotAddress - filenameWithoutExtension.get()) != Error::NONE) {
+		return;
+	}
+
+	Error error = audioFileManager.setupAlternateAudioFileDir(audioFileManager.alternateAudioFileLoadPath,
+	                                                          dirPath.get(), filenameWithoutExtension.get());
+	if (error != Error::NONE) {
+		return;
+	}
+
+	audioFileManager.thingBeginningLoading(ThingType::SONG);
+	song->loadAllSamples(false);
+	if (allSamples) {
+		song->loadAllSamples(true);
+	}
+	else {
+		song->loadCrucialSamplesOnly();
+	}
+	audioFileManager.thingFinishedLoading();
+
+	yieldWithTimeout(
+	    []() {
+		    return songPreloader.cancelRequested || !audioFileManager.loadingQueueHasAnyLowestPriorityElements();
+	    },
+	    kSampleLoadTimeoutSeconds);
+}
+
+void SongPreloader::yieldIfSliceUsedUp() {
+	if (getSystemTime() - sliceStartTime < kParseSliceSeconds) {
+		return;
+	}
+
+	leaveParse();
+	yieldToIdle([]() { return false; });
+	enterParse();
+
+	if (cancelRequested) {
+		// Make the rest of the file look empty, so the parse unwinds straight away
+		reader->truncate();
+	}
+	sliceStartTime = getSystemTime();
+}
+
+void SongPreloader::enterParse() {
+	otherDeserializer = activeDeserializer;
+	otherFirmwareVersion = song_firmware_version;
+	activeDeserializer = reader;
+	song_firmware_version = firmwareVersion;
+}
+
+void SongPreloader::leaveParse() {
+	firmwareVersion = song_firmware_version;
+	activeDeserializer = otherDeserializer;
+	song_firmware_version = otherFirmwareVersion;
+}
+
+void SongPreloader::deleteSong() {
+	if (song) {
+		void* toDealloc = dynamic_cast<void*>(song);
+		song->~Song(); // Will also delete paramManager
+		delugeDealloc(toDealloc);
+		song = nullptr;
+	}
+}
+
+void SongPreloader::deleteReader() {
+	if (reader) {
+		void* toDealloc = dynamic_cast<void*>(reader);
+		reader->~FileDeserializer();
+		delugeDealloc(toDealloc);
+		reader = nullptr;
+	}
+}
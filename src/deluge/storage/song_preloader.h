@@ -0,0 +1,104 @@
+/*
+ * Copyright © 2025 Synthstrom Audible Limited
+ *
+ * This file is part of The Synthstrom Audible Deluge Firmware.
+ *
+ * The Synthstrom Audible Deluge Firmware is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program.
+ * If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "definitions_cxx.hpp"
+#include "storage/file_item.h"
+#include "storage/storage_manager.h"
+#include "util/d_string.h"
+#include "util/firmware_version.h"
+#include <cstdint>
+
+class Song;
+
+/*
+ * ===================== Background song preloading ==================
+ *
+ * The SongPreloader reads a song in from the card as a low priority scheduler task, while the current song keeps
+ * playing. Parsing happens a couple of milliseconds at a time: every so often the file reader hands control back to
+ * the scheduler, and picks up where it left off once everything else has had its turn. Once the whole file is read,
+ * any samples already in RAM are claimed, the samples for the song's active clips are loaded, and we wait for their
+ * first Clusters to arrive - after which the song is READY.
+ *
+ * LoadSongUI::performLoad() take()s a READY song instead of opening and parsing the file itself, so the swap to it
+ * costs no more than arming it. Asking for anything other than the song being preloaded cancels the preload.
+ *
+ * The preloaded song is kept entirely separate from preLoadedSong, which means "a song swap is in progress" to the
+ * rest of the firmware.
+ */
+
+class SongPreloader {
+public:
+	enum class State : uint8_t {
+		IDLE,
+		PARSING,
+		LOADING_SAMPLES,
+		READY,
+		FAILED,
+	};
+
+	void preload(String* dirPath, FileItem* fileItem);
+	/// With allSamples, every Sample the song uses gets loaded rather than just those its active clips need. whenReady,
+	/// if supplied, gets called once the song is READY.
+	void preload(String* dirPath, String* filename, FilePointer* filePointer, bool allSamples = false,
+	             void (*whenReady)() = nullptr);
+	void cancel();
+	/// Hands over the song, if it's the one asked for and it's READY. Otherwise cancels any preload and returns nullptr.
+	Song* take(String* dirPath, FileItem* fileItem);
+
+	State getState() { return state; }
+	bool isPreloading(String* dirPath, FileItem* fileItem) {
+		return isPreloading(dirPath, &fileItem->filename, &fileItem->filePointer);
+	}
+	bool isPreloading(String* dirPath, String* filename, FilePointer* filePointer);
+
+private:
+	static void runTask();
+	static void readerRoutine();
+
+	void run();
+	Error readSong();
+	void loadSamples();
+	void yieldIfSliceUsedUp();
+	void enterParse();
+	void leaveParse();
+	void deleteSong();
+	void deleteReader();
+
+	State state = State::IDLE;
+	bool taskRunning = false;
+	bool cancelRequested = false;
+	bool restartRequested = false;
+
+	String dirPath;
+	String filename;
+	FilePointer filePointer;
+	bool allSamples = false;
+	void (*whenReady)() = nullptr;
+
+	Song* song = nullptr;
+	FileDeserializer* reader = nullptr;
+	double sliceStartTime = 0;
+
+	// The foreground's parsing state, swapped out while our reader is active, and ours while it isn't
+	FileDeserializer* otherDeserializer = nullptr;
+	FirmwareVersion otherFirmwareVersion = FirmwareVersion::current();
+	FirmwareVersion firmwareVersion = FirmwareVersion::current();
+};
+
+extern SongPreloader songPreloader;
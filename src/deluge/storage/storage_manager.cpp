@@ -66,12 +66,21 @@ PLACE_SDRAM_BSS XMLSerializer smSerializer;
 PLACE_SDRAM_BSS XMLDeserializer smDeserializer;
 PLACE_SDRAM_BSS JsonSerializer smJsonSerializer;
 PLACE_SDRAM_BSS JsonDeserializer smJsonDeserializer;
+PLACE_SDRAM_BSS BinarySerializer smBinarySerializer;
+PLACE_SDRAM_BSS BinaryDeserializer smBinaryDeserializer;
 FileDeserializer* activeDeserializer = &smDeserializer;
 
 const bool writeJsonFlag = false;
 
+// Whether the file most recently created was a binary one, which is then what everything writing through
+// GetSerializer() goes to
+bool writingBinaryFile = false;
+
 Serializer& GetSerializer() {
-	if (writeJsonFlag) {
+	if (writingBinaryFile) {
+		return smBinarySerializer;
+	}
+	else if (writeJsonFlag) {
 		return smJsonSerializer;
 	}
 	else {
@@ -186,6 +195,7 @@ Error StorageManager::createXMLFile(char const* filePath, XMLSerializer& writer,
 		}
 		return created.error();
 	}
+	writingBinaryFile = false;
 	writer.writeFIL = created.value().inner();
 	writer.reset();
 	if (!writeJsonFlag) {
@@ -205,6 +215,24 @@ Error StorageManager::createJsonFile(char const* filePath, JsonSerializer& write
 		}
 		return created.error();
 	}
+	writingBinaryFile = false;
+	writer.writeFIL = created.value().inner();
+	writer.reset();
+	return Error::NONE;
+}
+
+Error StorageManager::createBinaryFile(char const* filePath, BinarySerializer& writer, bool mayOverwrite,
+                                       bool displayErrors) {
+	auto created = createFile(filePath, mayOverwrite);
+	writer.reset();
+	if (!created) {
+		if (displayErrors) {
+			display->removeWorkingAnimation();
+			display->displayError(created.error());
+		}
+		return created.error();
+	}
+	writingBinaryFile = true;
 	writer.writeFIL = created.value().inner();
 	writer.reset();
 	return Error::NONE;
@@ -747,6 +775,22 @@ Error StorageManager::openJsonFile(FilePointer* filePointer, JsonDeserializer& r
 	return Error::FILE_CORRUPTED;
 }
 
+Error StorageManager::openBinaryFile(FilePointer* filePointer, BinaryDeserializer& reader, char const* firstTagName,
+                                     char const* altTagName, bool ignoreIncorrectFirmware) {
+
+	AudioEngine::logAction("openBinaryFile");
+	reader.reset();
+	// Prep to read first Cluster shortly
+	openFilePointer(filePointer, reader);
+	Error err = reader.openBinaryFile(filePointer, firstTagName, altTagName, ignoreIncorrectFirmware);
+	activeDeserializer = &reader;
+	if (err == Error::NONE)
+		return Error::NONE;
+	reader.closeWriter();
+
+	return Error::FILE_CORRUPTED;
+}
+
 Error StorageManager::openDelugeFile(FileItem* currentFileItem, char const* firstTagName, char const* altTagName,
                                      bool ignoreIncorrectFirmware) {
 	Error error;
@@ -754,6 +798,10 @@ Error StorageManager::openDelugeFile(FileItem* currentFileItem, char const* firs
 		error = StorageManager::openJsonFile(&currentFileItem->filePointer, smJsonDeserializer, firstTagName,
 		                                     altTagName, ignoreIncorrectFirmware);
 	}
+	else if (currentFileItem->filename.contains(".DBIN")) {
+		error = StorageManager::openBinaryFile(&currentFileItem->filePointer, smBinaryDeserializer, firstTagName,
+		                                       altTagName, ignoreIncorrectFirmware);
+	}
 	else {
 		error = StorageManager::openXMLFile(&currentFileItem->filePointer, smDeserializer, firstTagName, altTagName,
 		                                    ignoreIncorrectFirmware);
@@ -912,6 +960,11 @@ void FileReader::readDone() {
 	}
 
 	if (!(readCount & 63)) { // 511 bad. 255 almost fine. 127 almost always fine
+		if (backgroundRoutine) {
+			backgroundRoutine();
+			return;
+		}
+
 		AudioEngine::routineWithClusterLoading();
 
 		uiTimerManager.routine();
@@ -923,6 +976,15 @@ void FileReader::readDone() {
 	}
 }
 
+void FileReader::truncate() {
+	if (!memoryBased) {
+		// f_read() returns nothing once fptr reaches the end, without walking the cluster chain like f_lseek() would
+		readFIL.fptr = readFIL.obj.objsize;
+	}
+	currentReadBufferEndPos = fileReadBufferCurrentPos;
+	reachedBufferEnd = true;
+}
+
 FRESULT FileReader::closeWriter() {
 	if (!memoryBased)
 		return f_close(&readFIL);
@@ -21,6 +21,7 @@
 #include "extern.h"
 #include "fatfs/fatfs.hpp"
 #include "model/sync.h"
+#include "util/d_stringbuf.h"
 #include "util/firmware_version.h"
 
 #include <cstdint>
@@ -30,6 +31,7 @@ extern "C" {
 #include "fatfs/ff.h"
 }
 
+extern void silenceOldSongBeforeLoadingNew();
 extern void deleteOldSongBeforeLoadingNew();
 
 extern FatFS::Filesystem fileSystem;
@@ -68,6 +70,14 @@ public:
 	uint32_t bytesRemainingInBuffer() { return currentReadBufferEndPos - fileReadBufferCurrentPos; }
 	char* GetCurrentAddressInBuffer() { return fileClusterBuffer + fileReadBufferCurrentPos; }
 
+	/// Makes every read from here on behave as if the end of the file had been reached, so a parse in progress
+	/// unwinds at its next read.
+	void truncate();
+
+	/// If set, this gets called in place of the usual routines, every 64 reads. Lets a background task parse a file a
+	/// bit at a time and give the scheduler back in between.
+	void (*backgroundRoutine)() = nullptr;
+
 protected:
 	bool callRoutines = true;
 	bool readFileCluster();
@@ -138,6 +148,13 @@ public:
 	virtual Error closeFileAfterWriting(char const* path = nullptr, char const* beginningString = nullptr,
 	                                    char const* endString = nullptr) = 0;
 
+	/// Appends number, as numChars hex digits, to a "0x..." value being written a piece at a time with write()
+	virtual void writeHexDigits(uint32_t number, int32_t numChars = 8) {
+		char buffer[9];
+		intToHex(number, buffer, numChars);
+		write(buffer);
+	}
+
 	virtual void reset() = 0;
 	void writeFirmwareVersion();
 
@@ -202,6 +219,14 @@ public:
 
 	virtual void reset() = 0;
 
+	/// Binary files store "0x..." hex values as raw bytes. If the value about to be read is one of those, this returns
+	/// true and its bytes may be read with readNextBytesOfHexValue(), skipping the hex decoding. Otherwise nothing is
+	/// consumed, and the value should be read one char at a time as usual.
+	virtual bool prepareToReadHexValueAsBytes() { return false; }
+	/// Like readNextCharsOfTagOrAttributeValue(), but numBytes bytes rather than 2 * numBytes hex chars. Returns NULL
+	/// when nothing more to return. numBytes must be <= kFilenameBufferSize
+	virtual uint8_t const* readNextBytesOfHexValue(int32_t numBytes) { return nullptr; }
+
 	Error readTagOrAttributeValueString(std::string& string) {
 		String tmp;
 		Error error = readTagOrAttributeValueString(&tmp);
@@ -358,10 +383,153 @@ private:
 	Error readStringUntilChar(String* string, char endChar);
 };
 
+/*
+ * ===================== Binary song format ==================
+ *
+ * A compact alternative to XML which carries exactly the same tree of tags and attributes, so everything which reads
+ * or writes through Serializer / Deserializer works with it unchanged, and it converts losslessly to and from XML
+ * (see contrib/binary_song). What it saves is the text parsing - names and values are length-prefixed, integers are
+ * fixed-width, and the big "0x..." note and automation blobs are raw bytes which NoteRow and AutoParam can read
+ * directly via Deserializer::readNextBytesOfHexValue().
+ *
+ * The file starts with "DBIN" and a version byte, then 3 reserved bytes. Then records, each a type byte followed by:
+ *
+ *   OPEN   name                              A tag, whose attributes and child tags follow until its CLOSE
+ *   CLOSE
+ *   INT    name, int32                       A decimal value
+ *   STRING name, uint16 length, chars        length includes a terminating 0
+ *   HEX    name, {uint16 length, bytes}...   A "0x..." value as raw bytes, in chunks, ending with a 0-length one
+ *   BYTES  name, {uint16 length, bytes}...   Same, but plain hex with no "0x", as writeAttributeHexBytes() makes
+ *
+ * A name is a uint8 length and then its chars, including a terminating 0. Values are attributes unless their type
+ * has kBinaryRecordContent set, in which case they were a tag's contents - <name>value</name>. All multi-byte fields
+ * are little-endian.
+ */
+
+constexpr char const* kBinaryFileMagic = "DBIN";
+constexpr uint8_t kBinaryFileVersion = 1;
+
+enum BinaryRecordType : uint8_t {
+	kBinaryRecordOpen = 1,
+	kBinaryRecordClose = 2,
+	kBinaryRecordInt = 3,
+	kBinaryRecordString = 4,
+	kBinaryRecordHex = 5,
+	kBinaryRecordBytes = 6,
+	kBinaryRecordContent = 0x10,
+};
+
+class BinarySerializer : public Serializer, public FileWriter {
+public:
+	BinarySerializer();
+	~BinarySerializer() override = default;
+
+	void writeAttribute(char const* name, int32_t number, bool onNewLine = true) override;
+	void writeAttribute(char const* name, char const* value, bool onNewLine = true) override;
+	void writeAttributeHex(char const* name, int32_t number, int32_t numChars, bool onNewLine = true) override;
+	void writeAttributeHexBytes(char const* name, uint8_t* data, int32_t numBytes, bool onNewLine = true) override;
+	void writeTagNameAndSeperator(char const* tag) override;
+	void writeTag(char const* tag, int32_t number, bool box = false) override;
+	void writeTag(char const* tag, char const* contents, bool box = false, bool quote = true) override;
+	void writeOpeningTag(char const* tag, bool startNewLineAfter = true, bool box = false) override;
+	void writeOpeningTagBeginning(char const* tag, bool box = false, bool newLineBefore = true) override;
+	void writeOpeningTagEnd(bool startNewLineAfter = true) override {}
+	void closeTag(bool box = false) override;
+	void writeClosingTag(char const* tag, bool shouldPrintIndents = true, bool box = false) override;
+	void writeArrayStart(char const* tag, bool startNewLineAfter = true, bool box = false) override;
+	void writeArrayEnding(char const* tag, bool shouldPrintIndents = true, bool box = false) override;
+	void printIndents() override {}
+	void insertCommaIfNeeded() override {}
+	void write(char const* output) override;
+	void writeHexDigits(uint32_t number, int32_t numChars = 8) override;
+	Error closeFileAfterWriting(char const* path = nullptr, char const* beginningString = nullptr,
+	                            char const* endString = nullptr) override;
+	void reset() override;
+
+private:
+	// Values written a piece at a time with write(), after writeTagNameAndSeperator(), in whatever XML syntax the
+	// caller uses - we pick the value out from between the quotes
+	enum class RawState : uint8_t { NONE, BEFORE_VALUE, VALUE_START, HEX_VALUE, STRING_VALUE };
+
+	void writeName(char const* name);
+	void writeUint16(uint16_t value);
+	void writeInt32(int32_t value);
+	void writeStringRecord(uint8_t type, char const* name, char const* value, int32_t length);
+	void writeValue(uint8_t type, char const* name, char const* value);
+	void flushHexChunk();
+	void endRawValue();
+
+	RawState rawState = RawState::NONE;
+	char rawName[kFilenameBufferSize];
+	int32_t rawLength;
+	int8_t rawHighNibble;
+	char rawBuffer[2048];
+};
+
+class BinaryDeserializer : public FileDeserializer {
+public:
+	BinaryDeserializer();
+	BinaryDeserializer(uint8_t* inbuf, size_t buflen);
+	~BinaryDeserializer() override = default;
+
+	bool prepareToReadTagOrAttributeValueOneCharAtATime() override;
+	char const* readNextTagOrAttributeName() override;
+	char readNextCharOfTagOrAttributeValue() override;
+	int32_t getNumCharsRemainingInValueBeforeEndOfCluster() override;
+
+	int32_t readTagOrAttributeValueInt() override;
+	int32_t readTagOrAttributeValueHex(int32_t errorValue) override;
+	int readTagOrAttributeValueHexBytes(uint8_t* bytes, int32_t maxLen) override;
+
+	char const* readNextCharsOfTagOrAttributeValue(int32_t numChars) override;
+	Error readTagOrAttributeValueString(String* string) override;
+	char const* readTagOrAttributeValue() override;
+	bool match(char const ch) override { return true; }
+	void exitTag(char const* exitTagName = NULL, bool closeObject = false) override;
+
+	bool prepareToReadHexValueAsBytes() override;
+	uint8_t const* readNextBytesOfHexValue(int32_t numBytes) override;
+
+	Error openBinaryFile(FilePointer* filePointer, char const* firstTagName, char const* altTagName = "",
+	                     bool ignoreIncorrectFirmware = false);
+	void reset() override;
+	Error tryReadingFirmwareTagFromFile(char const* tagName, bool ignoreIncorrectFirmware) override;
+
+private:
+	enum class ValueType : uint8_t { NONE, INT, INT_AS_TEXT, STRING, HEX, BYTES };
+
+	ValueType valueType = ValueType::NONE;
+	bool valueHeaderRead;   // Values are only read once asked for, so that a name can point into the cluster buffer
+	int32_t valueInt;       // For INT_AS_TEXT, how far through textBuffer we are
+	uint32_t valueBytesLeft; // In the string including its terminating 0, or in the current chunk of a HEX / BYTES
+	char pendingChars[2];   // Still to be returned when reading a HEX / BYTES value a char at a time
+	int8_t numPendingChars;
+
+	int32_t tagDepthCaller;
+	int32_t tagDepthFile;
+
+	char nameBuffer[kFilenameBufferSize];
+	char textBuffer[12];
+	char stringBuffer[kFilenameBufferSize];
+
+	bool readBytes(void* dest, int32_t numBytes);
+	char const* readName();
+	char const* readRecord();
+	void loadValueHeader();
+	void finishValue();
+	void skipValue();
+	bool nextChunk();
+	bool readValueByte(uint8_t* byte);
+	char popPendingChar();
+	char const* getValueAsText();
+};
+
 extern XMLSerializer smSerializer;
 extern XMLDeserializer smDeserializer;
 extern JsonSerializer smJsonSerializer;
 extern JsonDeserializer smJsonDeserializer;
+extern BinarySerializer smBinarySerializer;
+extern BinaryDeserializer smBinaryDeserializer;
 extern Serializer& GetSerializer();
 extern FileDeserializer* activeDeserializer;
 
@@ -375,6 +543,10 @@ Error openXMLFile(FilePointer* filePointer, XMLDeserializer& reader, char const*
                   char const* altTagName = "", bool ignoreIncorrectFirmware = false);
 Error openJsonFile(FilePointer* filePointer, JsonDeserializer& reader, char const* firstTagName,
                    char const* altTagName = "", bool ignoreIncorrectFirmware = false);
+Error createBinaryFile(char const* pathName, BinarySerializer& writer, bool mayOverwrite = false,
+                       bool displayErrors = true);
+Error openBinaryFile(FilePointer* filePointer, BinaryDeserializer& reader, char const* firstTagName,
+                     char const* altTagName = "", bool ignoreIncorrectFirmware = false);
 Error openDelugeFile(FileItem* currentFileItem, char const* firstTagName, char const* altTagName = "",
                      bool ignoreIncorrectFirmware = false);
 Error initSD();
@@ -0,0 +1,46 @@
+/*
+ * Copyright © 2025 Synthstrom Audible Limited
+ *
+ * This file is part of The Synthstrom Audible Deluge Firmware.
+ *
+ * The Synthstrom Audible Deluge Firmware is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program.
+ * If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "storage/sysex_write_stream.h"
+#include "util/pack.h"
+
+uint32_t smSysex::blockCRC(uint8_t const* data, uint32_t length) {
+	return get_crc(const_cast<uint8_t*>(data), length);
+}
+
+smSysex::StreamedWrite smSysex::WriteStream::receive(uint32_t addr, bool crcMatches, bool wantsAck) {
+	// Out of order - a block before this one must have gone missing, or the client's resending something we've already
+	// got. Only tell it once though - blocks it sent before hearing back will keep arriving for a while. Unless it asks
+	// for a reply, in case it never got ours.
+	if (addr != expectedPos) {
+		if (broken && !wantsAck) {
+			return StreamedWrite::REJECT_SILENTLY;
+		}
+		broken = true;
+		return StreamedWrite::REJECT_AND_REPLY;
+	}
+
+	// The block we were waiting for - so if we'd rejected some, the client has gone back for them
+	broken = false;
+
+	if (!crcMatches) {
+		broken = true;
+		return StreamedWrite::REJECT_AND_REPLY;
+	}
+
+	return wantsAck ? StreamedWrite::WRITE_AND_ACK : StreamedWrite::WRITE;
+}
@@ -0,0 +1,73 @@
+/*
+ * Copyright © 2025 Synthstrom Audible Limited
+ *
+ * This file is part of The Synthstrom Audible Deluge Firmware.
+ *
+ * The Synthstrom Audible Deluge Firmware is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program.
+ * If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cstdint>
+
+namespace smSysex {
+
+// Transfer limits, which the "session" reply tells the client about so it can use the biggest blocks we can take.
+// Incoming sysex has to fit in a MIDICable's incomingSysexBuffer, so a write block, once packed 8-to-7 and wrapped in
+// its Json request, must stay under 1024 bytes. Outgoing sysex is only limited by the USB send ring buffer.
+constexpr uint32_t kReadBlockMax = 2048;
+constexpr uint32_t kWriteBlockMax = 768;
+// How many requests a client may have in flight at once when streaming writes
+constexpr uint32_t kTransferWindow = 4;
+
+/// CRC-32 of an unpacked block, as the "crc" attribute of read and write messages carries it. Our Json integers are
+/// signed, so one with its top bit set gets sent as a negative number - we accept it either way.
+uint32_t blockCRC(uint8_t const* data, uint32_t length);
+
+/// What writeBlock() should do with a streamed write - see WriteStream::receive().
+enum class StreamedWrite {
+	WRITE,            // Write it, no reply
+	WRITE_AND_ACK,    // Write it, and reply - acknowledging it and every block before it
+	REJECT_AND_REPLY, // Don't write it, and reply with where the client must resume from
+	REJECT_SILENTLY,  // Don't write it - the client's already been told where to resume from
+};
+
+/// Tracks a pipelined ("streamed") write into one open file. A client streaming a file sends write blocks back to back,
+/// each carrying "ack" - asking for a reply only on some of them, so it can keep up to kTransferWindow requests in
+/// flight, with each reply acknowledging everything before it. Blocks must arrive in order: if one goes missing (say a
+/// sysex message got dropped) or fails its CRC check, everything after it gets rejected, and the client is told, once,
+/// to go back and resume from the first byte we haven't written - so a sliding window with go-back-N recovery.
+class WriteStream {
+public:
+	/// Start expecting the block at pos next - on opening the file, or after any unstreamed write.
+	void reset(uint32_t pos) {
+		expectedPos = pos;
+		broken = false;
+	}
+
+	StreamedWrite receive(uint32_t addr, bool crcMatches, bool wantsAck);
+
+	/// The block receive() said to write has been written, numBytes of it at least.
+	void wrote(uint32_t numBytes) { expectedPos += numBytes; }
+
+	/// Writing the block failed - the client needs telling, and to resume from getExpectedPos().
+	void failed() { broken = true; }
+
+	/// Where the client must resume from - every byte before this has been written.
+	uint32_t getExpectedPos() const { return expectedPos; }
+
+private:
+	uint32_t expectedPos = 0;
+	bool broken = false;
+};
+
+} // namespace smSysex
@@ -55,6 +55,9 @@ public:
 
 	[[gnu::always_inline]] inline int32_t getNumElements() { return numElements; }
 
+	/// Bytes of heap allocated to hold the elements, including any spare room
+	uint32_t getMemoryUsage() { return (memory && !staticMemoryAllocationSize) ? memorySize * elementSize : 0; }
+
 	uint32_t elementSize;
 	bool emptyingShouldFreeMemory;
 	uint32_t staticMemoryAllocationSize;
@@ -64,3 +64,17 @@ uint32_t hexToIntFixedLength(char const* __restrict__ hexChars, int32_t length)
 
 	return output;
 }
+
+// The raw-bytes equivalent of the above, for hex values which were stored as bytes: big-endian, so the same field
+// is at half the offset and half the length. length must be >0
+uint32_t bytesToIntFixedLength(uint8_t const* __restrict__ bytes, int32_t length) {
+	uint32_t output = 0;
+	uint8_t const* const endByte = bytes + length;
+	do {
+		output <<= 8;
+		output |= *bytes;
+		bytes++;
+	} while (bytes != endByte);
+
+	return output;
+}
@@ -10,6 +10,7 @@ char halfByteToHexChar(uint8_t thisHalfByte);
 void intToHex(uint32_t number, char* output, int32_t numChars = 8);
 uint32_t hexToInt(char const* string);
 uint32_t hexToIntFixedLength(char const* __restrict__ hexChars, int32_t length);
+uint32_t bytesToIntFixedLength(uint8_t const* __restrict__ bytes, int32_t length);
 
 /// A string buffer with utility functions to append and format contents.
 /// does not handle allocation
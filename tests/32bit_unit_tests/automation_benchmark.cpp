@@ -0,0 +1,217 @@
+// Automation playback benchmark
+//
+// Plays dense automation - L interpolated lanes in one ParamSet, N nodes each - through a loop of ticks, to see
+// whether compiling each lane into a flat segment array (start pos, value, increment to the next segment) would be
+// worth the RAM and the rebuilding on every edit, compared with what the firmware does now.
+//
+// As in ParamSet::processCurrentPos(), whenever any lane gets to a node, every lane is processed, and between nodes
+// every lane's value is moved along by its interpolation increment each tick. That's done two ways:
+//
+// - Nodes: as AutoParam::processCurrentPos() does it - finding the node with ParamNodeVector::searchNearIndex(), from
+//   where it found one last time, then working out the increment to the next node when one is reached.
+// - Segments: walking along a segment array built for each lane beforehand, with each increment already worked out.
+//
+// Both have to end up with the same values all the way through - the exit code says whether they did, so ctest can
+// run a small configuration as a regression check.
+//
+// Usage: AutomationBenchmark [numLanes] [numNodesPerLane] [numLoops]
+
+#include "modulation/params/param_node.h"
+#include "modulation/params/param_node_vector.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+namespace {
+
+constexpr int32_t kTicksPerNode = 12;
+
+// With the default tick magnitude of 2 there are 96 ticks per quarter note
+constexpr int32_t kTicksPerSecondAt120BPM = 192;
+
+struct Lane {
+	ParamNodeVector nodes;
+
+	int32_t currentValue = 0;
+	int32_t valueIncrementPerHalfTick = 0;
+	int32_t nodeIndexLastSearched = 0;
+
+	// The segment array, and where we are in it
+	std::vector<int32_t> segmentPos;
+	std::vector<int32_t> segmentValue;
+	std::vector<int32_t> segmentIncrement;
+	int32_t segmentIndex = 0;
+};
+
+struct PassResult {
+	uint64_t checksum = 0;
+	double nanosecondsPerTick = 0;
+};
+
+// Deterministic, so every run of a given configuration automates the same way
+uint32_t randomState;
+uint32_t nextRandom() {
+	randomState = randomState * 1664525 + 1013904223;
+	return randomState >> 8;
+}
+
+// As AutoParam::setupInterpolation() and calculateInterpolationIncrement() for a node we've just reached
+int32_t getIncrementToNextNode(int32_t value, ParamNode* nextNode, int32_t ticksTilNextNode) {
+	int32_t halfDistance = (nextNode->value >> 1) - (value >> 1);
+	return halfDistance / ticksTilNextNode;
+}
+
+int32_t getTicksTilNextNode(int32_t pos, int32_t nextPos, int32_t loopLength) {
+	int32_t ticks = nextPos - pos;
+	if (ticks <= 0) {
+		ticks += loopLength;
+	}
+	return ticks;
+}
+
+void buildLanes(std::vector<Lane>& lanes, int32_t numNodes) {
+	randomState = 12345;
+	for (Lane& lane : lanes) {
+		lane.nodes.empty();
+		lane.nodes.insertAtIndex(0, numNodes);
+		for (int32_t n = 0; n < numNodes; n++) {
+			ParamNode* node = lane.nodes.getElement(n);
+			node->pos = n * kTicksPerNode + (n ? nextRandom() % (kTicksPerNode / 2) : 0);
+			node->value = (int32_t)(nextRandom() << 8);
+			node->interpolated = true;
+		}
+	}
+}
+
+// What has to happen to every lane's segment array after any edit to its nodes
+void buildSegments(Lane& lane, int32_t loopLength) {
+	int32_t numNodes = lane.nodes.getNumElements();
+	lane.segmentPos.resize(numNodes);
+	lane.segmentValue.resize(numNodes);
+	lane.segmentIncrement.resize(numNodes);
+	for (int32_t n = 0; n < numNodes; n++) {
+		ParamNode* node = lane.nodes.getElement(n);
+		ParamNode* nextNode = lane.nodes.getElement((n + 1) % numNodes);
+		lane.segmentPos[n] = node->pos;
+		lane.segmentValue[n] = node->value;
+		lane.segmentIncrement[n] =
+		    getIncrementToNextNode(node->value, nextNode, getTicksTilNextNode(node->pos, nextNode->pos, loopLength));
+	}
+}
+
+// As AutoParam::processCurrentPos() playing forwards, returning the ticks until this lane next needs processing
+int32_t processLaneFromNodes(Lane& lane, int32_t pos, int32_t loopLength) {
+	int32_t numNodes = lane.nodes.getNumElements();
+	int32_t i = lane.nodes.searchNearIndex(pos, false, lane.nodeIndexLastSearched);
+	if (i >= numNodes) {
+		i = 0;
+	}
+	lane.nodeIndexLastSearched = i;
+
+	ParamNode* node = lane.nodes.getElement(i);
+	if (node->pos != pos) {
+		return getTicksTilNextNode(pos, node->pos, loopLength);
+	}
+
+	ParamNode* nextNode = lane.nodes.getElement((i + 1) % numNodes);
+	int32_t ticksTilNextNode = getTicksTilNextNode(pos, nextNode->pos, loopLength);
+	lane.currentValue = node->value;
+	lane.valueIncrementPerHalfTick = getIncrementToNextNode(lane.currentValue, nextNode, ticksTilNextNode);
+	return ticksTilNextNode;
+}
+
+int32_t processLaneFromSegments(Lane& lane, int32_t pos, int32_t loopLength) {
+	int32_t numSegments = lane.segmentPos.size();
+	if (lane.segmentPos[lane.segmentIndex] == pos) {
+		lane.currentValue = lane.segmentValue[lane.segmentIndex];
+		lane.valueIncrementPerHalfTick = lane.segmentIncrement[lane.segmentIndex];
+		if (++lane.segmentIndex == numSegments) {
+			lane.segmentIndex = 0;
+		}
+	}
+	return getTicksTilNextNode(pos, lane.segmentPos[lane.segmentIndex], loopLength);
+}
+
+template <typename ProcessLane>
+PassResult play(std::vector<Lane>& lanes, int32_t loopLength, int32_t numLoops, ProcessLane processLane) {
+	for (Lane& lane : lanes) {
+		lane.currentValue = 0;
+		lane.valueIncrementPerHalfTick = 0;
+		lane.nodeIndexLastSearched = 0;
+		lane.segmentIndex = 0;
+	}
+
+	PassResult result;
+	int32_t numTicks = loopLength * numLoops;
+	int32_t ticksTilNextEvent = 0;
+	int32_t pos = 0;
+
+	auto startTime = std::chrono::steady_clock::now();
+	for (int32_t t = 0; t < numTicks; t++) {
+		if (!ticksTilNextEvent) {
+			ticksTilNextEvent = loopLength;
+			for (Lane& lane : lanes) {
+				ticksTilNextEvent = std::min(ticksTilNextEvent, processLane(lane, pos, loopLength));
+				result.checksum = result.checksum * 31 + (uint32_t)lane.currentValue;
+			}
+		}
+
+		for (Lane& lane : lanes) {
+			lane.currentValue += lane.valueIncrementPerHalfTick * 2;
+		}
+		ticksTilNextEvent--;
+		if (++pos == loopLength) {
+			pos = 0;
+		}
+	}
+	auto elapsed = std::chrono::steady_clock::now() - startTime;
+
+	for (Lane& lane : lanes) {
+		result.checksum = result.checksum * 31 + (uint32_t)lane.currentValue;
+	}
+	result.nanosecondsPerTick = (double)std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count() / numTicks;
+	return result;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+	int32_t numLanes = (argc > 1) ? atoi(argv[1]) : 32;
+	int32_t numNodes = (argc > 2) ? atoi(argv[2]) : 256;
+	int32_t numLoops = (argc > 3) ? atoi(argv[3]) : 50;
+	if (numLanes < 1 || numNodes < 2 || numLoops < 1) {
+		printf("Usage: %s [numLanes] [numNodesPerLane] [numLoops]\n", argv[0]);
+		return 2;
+	}
+
+	int32_t loopLength = numNodes * kTicksPerNode;
+	std::vector<Lane> lanes(numLanes);
+	buildLanes(lanes, numNodes);
+
+	auto startTime = std::chrono::steady_clock::now();
+	for (Lane& lane : lanes) {
+		buildSegments(lane, loopLength);
+	}
+	auto elapsed = std::chrono::steady_clock::now() - startTime;
+	double rebuildMicroseconds =
+	    (double)std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count() / 1000 / numLanes;
+
+	PassResult nodes = play(lanes, loopLength, numLoops, processLaneFromNodes);
+	PassResult segments = play(lanes, loopLength, numLoops, processLaneFromSegments);
+
+	printf("%d lanes x %d nodes, %d loops of %d ticks\n", numLanes, numNodes, numLoops, loopLength);
+	printf("  nodes     %8.1f ns/tick  %8.1f us per second at 120 BPM\n", nodes.nanosecondsPerTick,
+	       nodes.nanosecondsPerTick * kTicksPerSecondAt120BPM / 1000);
+	printf("  segments  %8.1f ns/tick  %8.1f us per second at 120 BPM\n", segments.nanosecondsPerTick,
+	       segments.nanosecondsPerTick * kTicksPerSecondAt120BPM / 1000);
+	printf("            plus %d bytes of RAM and a %.1f us rebuild per lane, every time its nodes are edited\n",
+	       numNodes * 3 * (int32_t)sizeof(int32_t), rebuildMicroseconds);
+
+	if (nodes.checksum != segments.checksum) {
+		printf("FAIL: playing from segments gave different values\n");
+		return 1;
+	}
+	return 0;
+}
@@ -0,0 +1,82 @@
+#include "CppUTest/TestHarness.h"
+#include "model/consequence/compressed_snapshot.h"
+#include "model/note/note.h"
+#include "model/note/note_vector.h"
+#include "modulation/params/param_node.h"
+#include "modulation/params/param_node_vector.h"
+
+TEST_GROUP(CompressedSnapshotTest){};
+
+TEST(CompressedSnapshotTest, notesRoundTrip) {
+	NoteVector notes;
+	constexpr int32_t kNumNotes = 500;
+	CHECK(notes.insertAtIndex(0, kNumNotes) == Error::NONE);
+	for (int32_t i = 0; i < kNumNotes; i++) {
+		Note* note = notes.getElement(i);
+		note->pos = i * 24 + (i % 3);
+		note->length = 1 + (i * 7) % 40;
+		note->velocity = (i % 10) ? 100 : 64 + (i & 63);
+		note->probability = (i % 50) ? kNumProbabilityValues : 10;
+		note->iterance = (i % 25) ? Iterance{0, 0} : Iterance{4, 0b0101};
+		note->fill = (i % 100 == 0);
+		note->lift = 64;
+	}
+	uint32_t uncompressedSize = notes.getMemoryUsage();
+
+	CompressedSnapshot snapshot;
+	CHECK(snapshot.compressNotes(&notes));
+	CHECK(snapshot.holdsData());
+	CHECK_EQUAL(0, notes.getNumElements());
+	CHECK(snapshot.getMemoryUsage() * 3 < uncompressedSize);
+
+	CHECK(snapshot.decompressNotes(&notes) == Error::NONE);
+	CHECK(!snapshot.holdsData());
+	CHECK_EQUAL(kNumNotes, notes.getNumElements());
+	for (int32_t i = 0; i < kNumNotes; i++) {
+		Note* note = notes.getElement(i);
+		CHECK_EQUAL(i * 24 + (i % 3), note->pos);
+		CHECK_EQUAL(1 + (i * 7) % 40, note->length);
+		CHECK_EQUAL((i % 10) ? 100 : 64 + (i & 63), note->velocity);
+		CHECK_EQUAL((i % 50) ? kNumProbabilityValues : 10, note->probability);
+		Iterance expectedIterance = (i % 25) ? Iterance{0, 0} : Iterance{4, 0b0101};
+		CHECK(note->iterance == expectedIterance);
+		CHECK_EQUAL(i % 100 == 0, note->fill);
+		CHECK_EQUAL(64, note->lift);
+	}
+}
+
+TEST(CompressedSnapshotTest, emptyNotesRoundTrip) {
+	NoteVector notes;
+	CompressedSnapshot snapshot;
+	CHECK(snapshot.compressNotes(&notes));
+	CHECK(snapshot.holdsData());
+	CHECK_EQUAL(0, snapshot.getMemoryUsage());
+	CHECK(snapshot.decompressNotes(&notes) == Error::NONE);
+	CHECK_EQUAL(0, notes.getNumElements());
+}
+
+TEST(CompressedSnapshotTest, paramNodesRoundTrip) {
+	ParamNodeVector nodes;
+	constexpr int32_t kNumNodes = 300;
+	CHECK(nodes.insertAtIndex(0, kNumNodes) == Error::NONE);
+	for (int32_t i = 0; i < kNumNodes; i++) {
+		ParamNode* node = nodes.getElement(i);
+		node->pos = i * 3;
+		// Swing right across the full range, so the differences overflow
+		node->value = (i & 1) ? 2147483647 - i : -2147483647 - 1 + i;
+		node->interpolated = (i % 3 == 0);
+	}
+
+	CompressedSnapshot snapshot;
+	CHECK(snapshot.compressParamNodes(&nodes));
+	CHECK_EQUAL(0, nodes.getNumElements());
+
+	CHECK(snapshot.decompressParamNodes(&nodes) == Error::NONE);
+	CHECK_EQUAL(kNumNodes, nodes.getNumElements());
+	for (int32_t i = 0; i < kNumNodes; i++) {
+		ParamNode* node = nodes.getElement(i);
+		CHECK_EQUAL(i * 3, node->pos);
+		CHECK_EQUAL((i & 1) ? 2147483647 - i : -2147483647 - 1 + i, node->value);
+		CHECK_EQUAL(i % 3 == 0, node->interpolated);
+	}
+}
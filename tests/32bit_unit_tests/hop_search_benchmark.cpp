@@ -0,0 +1,100 @@
+// Time stretch hop search benchmark
+//
+// Times findBestOffset() - the AMDF search TimeStretcher uses to line up a crossfade - trying every lag, and with the
+// coarse pass which only tries every coarseStep lags before refining around the best of them. The coarse pass is only
+// worth having if it comes out faster.
+//
+// The audio is a few harmonics with some wobble, at a range of true offsets. The coarse search has to land on the
+// same lag as the exhaustive one, or one that matches just as well - the exit code says whether it did, so ctest can
+// run a small configuration as a regression check.
+//
+// Usage: HopSearchBenchmark [numSearches] [coarseStep]
+
+#include "dsp/timestretch/hop_search.h"
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+using namespace deluge::dsp::timestretch;
+
+namespace {
+
+constexpr int32_t kWindow = 128;
+constexpr int32_t kMaxOffset = 256;
+constexpr int32_t kReferenceStart = 4096;
+
+std::vector<int16_t> makeAudio(size_t length) {
+	std::vector<int16_t> audio(length);
+	for (size_t i = 0; i < length; i++) {
+		double t = double(i) / 44100.0;
+		double value = 0.5 * std::sin(2 * M_PI * 110 * t) + 0.3 * std::sin(2 * M_PI * 330 * t + 0.5)
+		               + 0.15 * std::sin(2 * M_PI * 37 * t);
+		audio[i] = static_cast<int16_t>(value * 30000);
+	}
+	return audio;
+}
+
+struct PassResult {
+	std::vector<int32_t> offsets;
+	double microsecondsPerSearch = 0;
+};
+
+PassResult search(const std::vector<int16_t>& audio, int32_t numSearches, int32_t coarseStep) {
+	PassResult result;
+	result.offsets.reserve(numSearches);
+	auto startTime = std::chrono::steady_clock::now();
+	for (int32_t i = 0; i < numSearches; i++) {
+		int32_t trueOffset = (i * 37) % (2 * kMaxOffset) - kMaxOffset;
+		const int16_t* candidates = &audio[kReferenceStart - trueOffset - kMaxOffset];
+		HopSearchResult found = findBestOffset({&audio[kReferenceStart], kWindow},
+		                                       {candidates, kWindow + 2 * kMaxOffset}, kMaxOffset, coarseStep);
+		result.offsets.push_back(found.offset);
+	}
+	auto elapsed = std::chrono::steady_clock::now() - startTime;
+	result.microsecondsPerSearch =
+	    (double)std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count() / 1000 / numSearches;
+	return result;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+	int32_t numSearches = (argc > 1) ? atoi(argv[1]) : 20000;
+	int32_t coarseStep = (argc > 2) ? atoi(argv[2]) : 2;
+	if (numSearches < 1 || coarseStep < 2) {
+		printf("Usage: %s [numSearches] [coarseStep >= 2]\n", argv[0]);
+		return 2;
+	}
+
+	std::vector<int16_t> audio = makeAudio(2 * kReferenceStart);
+	PassResult exhaustive = search(audio, numSearches, 1);
+	PassResult coarse = search(audio, numSearches, coarseStep);
+
+	printf("%d searches of %d lags over a %d sample window\n", numSearches, 2 * kMaxOffset + 1, kWindow);
+	printf("  every lag        %8.2f us/search\n", exhaustive.microsecondsPerSearch);
+	printf("  every %d lags     %8.2f us/search  (%.2fx)\n", coarseStep, coarse.microsecondsPerSearch,
+	       exhaustive.microsecondsPerSearch / coarse.microsecondsPerSearch);
+
+	int32_t numWorse = 0;
+	for (int32_t i = 0; i < numSearches; i++) {
+		if (coarse.offsets[i] == exhaustive.offsets[i]) {
+			continue;
+		}
+		// A different lag is fine as long as it matches as well as the best one
+		int32_t trueOffset = (i * 37) % (2 * kMaxOffset) - kMaxOffset;
+		const int16_t* candidates = &audio[kReferenceStart - trueOffset - kMaxOffset];
+		auto differenceAt = [&](int32_t offset) {
+			return sumAbsDifference(&audio[kReferenceStart], &candidates[kMaxOffset + offset], kWindow);
+		};
+		if (differenceAt(coarse.offsets[i]) > differenceAt(exhaustive.offsets[i])) {
+			numWorse++;
+		}
+	}
+	if (numWorse != 0) {
+		printf("FAIL: the coarse search found a worse match %d times\n", numWorse);
+		return 1;
+	}
+	return 0;
+}
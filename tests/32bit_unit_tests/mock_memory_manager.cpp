@@ -4,8 +4,15 @@
 // this file implements a stub for the actual memory manager instead.
 
 #include "CppUTest/TestHarness.h"
+#include "mock_memory_manager.h"
 #include "memory/general_memory_allocator.h"
 #include <cstdlib>
+#ifdef __APPLE__
+#include <malloc/malloc.h>
+#define malloc_usable_size malloc_size
+#else
+#include <malloc.h>
+#endif
 
 // Fake allocator object
 GeneralMemoryAllocator allocator;
@@ -13,19 +20,19 @@ GeneralMemoryAllocator allocator;
 class MockMemoryAllocator {
 public:
 	void* alloc(uint32_t requiredSize, bool mayUseOnChipRam, bool makeStealable, void* thingNotToStealFrom) {
+		numAllocations++;
 		return malloc(requiredSize);
 	}
 
 	void dealloc(void* address) { free(address); }
 
-	void* allocExternal(uint32_t requiredSize) { return malloc(requiredSize); }
+	void* allocExternal(uint32_t requiredSize) { return alloc(requiredSize, false, false, nullptr); }
 
 	void deallocExternal(void* address) { free(address); }
 
 	uint32_t shortenRight(void* address, uint32_t newSize) {
-		/* noop on mock allocator */
-		/// TODO: integrate some sort of sanity checking to make this actually check whether hte call is valid
-		return 0;
+		/* noop on mock allocator - the memory just stays the size it was */
+		return getAllocatedSize(address);
 	}
 
 	uint32_t shortenLeft(void* address, uint32_t amountToShorten, uint32_t numBytesToMoveRightIfSuccessful = 0) {
@@ -36,21 +43,17 @@ public:
 
 	void extend(void* address, uint32_t minAmountToExtend, uint32_t idealAmountToExtend,
 	            uint32_t* getAmountExtendedLeft, uint32_t* getAmountExtendedRight, void* thingNotToStealFrom = NULL) {
-		// TODO: implementing this requires actually tracking allocations so we know the starting size.
-		CHECK(false);
+		// Never possible here - callers fall back to allocating new memory
+		*getAmountExtendedLeft = 0;
+		*getAmountExtendedRight = 0;
 	}
 
-	uint32_t extendRightAsMuchAsEasilyPossible(void* address) {
-		// TODO: implementing this requires actually tracking allocations so we know the starting size.
-		CHECK(false);
-		return -1;
-	}
+	uint32_t extendRightAsMuchAsEasilyPossible(void* address) { return getAllocatedSize(address); }
 
-	uint32_t getAllocatedSize(void* address) {
-		// TODO: implementing this requires actually tracking allocations so we know the starting size.
-		CHECK(false);
-		return -1;
-	}
+	// The ResizeableArray family asks this before growing, so get the real size from malloc rather than fail
+	uint32_t getAllocatedSize(void* address) { return malloc_usable_size(address); }
+
+	uint32_t numAllocations = 0;
 
 	void checkStack(char const* caller) { /* noop in tests */ }
 
@@ -114,6 +117,10 @@ int32_t GeneralMemoryAllocator::getRegion(void* address) {
 	return mockAllocator.getRegion(address);
 }
 
+uint32_t mockMemoryAllocationCount() {
+	return mockAllocator.numAllocations;
+}
+
 extern "C" {
 
 void* delugeAlloc(unsigned int requiredSize, bool mayUseOnChipRam) {
@@ -0,0 +1,6 @@
+#pragma once
+
+#include <cstdint>
+
+/// Number of allocations the mock memory manager has handed out so far, for checking code doesn't allocate.
+uint32_t mockMemoryAllocationCount();
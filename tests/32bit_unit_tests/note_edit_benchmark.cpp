@@ -0,0 +1,231 @@
+// NoteRow bulk edit benchmark
+//
+// Times the two NoteRow edits which used to work a Note at a time, on a long NoteRow, against the single-pass code
+// the firmware now uses:
+//
+// - Pasting: NoteRow::paste() used to insert each pasted Note into the NoteVector individually, shuffling everything
+//   after it along each time. Now it merges the pasted Notes in with the existing ones through NoteVectorMerge.
+// - Quantizing: NoteRow::quantize() used to wrap Notes which had been rounded past the end of the Clip round to the
+//   start by rotating the whole NoteVector one Note at a time - plus one more time and back again, even with nothing
+//   to wrap. Now it calls NoteVector::wrapRound(), which swaps the blocks round by reversing them in place.
+//
+// Both versions of each have to leave exactly the same Notes behind - the exit code says whether they did, so ctest
+// can run a small configuration as a regression check. The overlap and wrapping cases are in note_vector_tests.cpp.
+//
+// Usage: NoteEditBenchmark [numNotes] [numNotesToWrap] [numRepeats]
+
+#include "mock_memory_manager.h"
+#include "model/note/note.h"
+#include "model/note/note_vector.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+
+namespace {
+
+constexpr int32_t kNoteSpacing = 12;
+
+struct EditResult {
+	uint32_t allocations = 0;
+	double microseconds = 0;
+};
+
+template <typename Edit>
+EditResult timeEdit(Edit edit) {
+	uint32_t allocationsBefore = mockMemoryAllocationCount();
+	auto startTime = std::chrono::steady_clock::now();
+	edit();
+	auto elapsed = std::chrono::steady_clock::now() - startTime;
+
+	EditResult result;
+	result.allocations = mockMemoryAllocationCount() - allocationsBefore;
+	result.microseconds = (double)std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count() / 1000;
+	return result;
+}
+
+void setNote(Note* note, int32_t pos, int32_t length) {
+	note->pos = pos;
+	note->length = length;
+	note->velocity = 64 + (pos & 63);
+	note->probability = kNumProbabilityValues;
+	note->iterance = kDefaultIteranceValue;
+	note->fill = FillMode::OFF;
+	note->lift = kDefaultLiftValue;
+}
+
+bool notesMatch(NoteVector& a, NoteVector& b) {
+	if (a.getNumElements() != b.getNumElements()) {
+		return false;
+	}
+	for (int32_t i = 0; i < a.getNumElements(); i++) {
+		Note* noteA = a.getElement(i);
+		Note* noteB = b.getElement(i);
+		if (noteA->pos != noteB->pos || noteA->length != noteB->length || noteA->velocity != noteB->velocity) {
+			return false;
+		}
+	}
+	return true;
+}
+
+// Every other slot holds an existing Note, and the paste fills in the ones in between
+void buildPaste(NoteVector& notes, NoteVector& toPaste, int32_t numNotes) {
+	notes.empty();
+	notes.insertAtIndex(0, numNotes);
+	toPaste.empty();
+	toPaste.insertAtIndex(0, numNotes);
+	for (int32_t n = 0; n < numNotes; n++) {
+		setNote(notes.getElement(n), n * 2 * kNoteSpacing, kNoteSpacing / 2);
+		setNote(toPaste.getElement(n), (n * 2 + 1) * kNoteSpacing, kNoteSpacing / 2);
+	}
+}
+
+// As NoteRow::attemptNoteAdd(), minus the checks which this song never trips
+void pasteNoteByNote(NoteVector& notes, NoteVector& toPaste, int32_t numNotes) {
+	for (int32_t n = 0; n < numNotes; n++) {
+		Note* noteSource = toPaste.getElement(n);
+		int32_t i = notes.search(noteSource->pos + 1, GREATER_OR_EQUAL);
+		if (notes.insertAtIndex(i) != Error::NONE) {
+			return;
+		}
+		*notes.getElement(i) = *noteSource;
+	}
+}
+
+// As NoteRow::paste() now does it
+void pasteMerging(NoteVector& notes, NoteVector& toPaste, int32_t numNotes, int32_t loopLength) {
+	NoteVectorMerge merge(notes, loopLength);
+	if (merge.prepare(numNotes) != Error::NONE) {
+		return;
+	}
+	for (int32_t n = 0; n < numNotes; n++) {
+		Note* noteSource = toPaste.getElement(n);
+		Note* newNote = merge.addNote(noteSource->pos, noteSource->length);
+		if (newNote) {
+			newNote->velocity = noteSource->velocity;
+		}
+	}
+	merge.finish();
+	notes.swapStateWith(&merge.newNotes);
+}
+
+// The last numToWrap Notes have been quantized past the end of the Clip. (The old rotation got it wrong when Notes
+// wrapped off both ends at once, so this doesn't compare that case.)
+void buildQuantized(NoteVector& notes, int32_t numNotes, int32_t numToWrap) {
+	notes.empty();
+	notes.insertAtIndex(0, numNotes);
+	for (int32_t n = 0; n < numNotes; n++) {
+		setNote(notes.getElement(n), n * kNoteSpacing, kNoteSpacing / 2);
+	}
+}
+
+// The rotation loops NoteRow::quantize() used to have
+void wrapRotatingNoteByNote(NoteVector& notes, int32_t effectiveLength) {
+	int32_t finalNumElements = notes.getNumElements();
+	{
+		int32_t rotateAmount = 0;
+		while (rotateAmount < finalNumElements && notes.getElement(rotateAmount)->pos < 0) {
+			rotateAmount++;
+		}
+		while (rotateAmount >= 0) {
+			int32_t lastNoteIdx = finalNumElements - 1;
+			for (auto i = 1; i < finalNumElements; ++i) {
+				notes.swapElements(i - 1, i);
+			}
+			notes.getElement(lastNoteIdx)->pos += effectiveLength;
+			rotateAmount--;
+		}
+	}
+	{
+		int32_t rotateAmount = 0;
+		while (rotateAmount < notes.getNumElements()
+		       && notes.getElement(finalNumElements - rotateAmount - 1)->pos >= effectiveLength) {
+			rotateAmount++;
+		}
+		while (rotateAmount > 0) {
+			for (auto i = finalNumElements - 1; i > 0; i--) {
+				notes.swapElements(i - 1, i);
+			}
+			notes.getElement(0)->pos -= effectiveLength;
+			rotateAmount--;
+		}
+	}
+}
+
+void printEdit(char const* name, EditResult const& result, int32_t numRepeats) {
+	printf("  %-22s %10.1f us/edit  %6.1f allocations/edit\n", name, result.microseconds / numRepeats,
+	       (double)result.allocations / numRepeats);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+	int32_t numNotes = (argc > 1) ? atoi(argv[1]) : 2000;
+	int32_t numToWrap = (argc > 2) ? atoi(argv[2]) : 4;
+	int32_t numRepeats = (argc > 3) ? atoi(argv[3]) : 20;
+	if (numNotes < 1 || numToWrap < 0 || numToWrap >= numNotes || numRepeats < 1) {
+		printf("Usage: %s [numNotes] [numNotesToWrap] [numRepeats]\n", argv[0]);
+		return 2;
+	}
+
+	printf("%d notes, %d wrapping past the end when quantizing, %d repeats\n", numNotes, numToWrap, numRepeats);
+	bool ok = true;
+
+	// Pasting
+	{
+		NoteVector toPaste;
+		NoteVector noteByNote;
+		NoteVector merging;
+		EditResult noteByNoteResult;
+		EditResult mergingResult;
+
+		for (int32_t r = 0; r < numRepeats; r++) {
+			buildPaste(noteByNote, toPaste, numNotes);
+			EditResult result = timeEdit([&]() { pasteNoteByNote(noteByNote, toPaste, numNotes); });
+			noteByNoteResult.microseconds += result.microseconds;
+			noteByNoteResult.allocations += result.allocations;
+
+			buildPaste(merging, toPaste, numNotes);
+			result = timeEdit([&]() { pasteMerging(merging, toPaste, numNotes, numNotes * 2 * kNoteSpacing); });
+			mergingResult.microseconds += result.microseconds;
+			mergingResult.allocations += result.allocations;
+		}
+
+		printEdit("paste, note by note", noteByNoteResult, numRepeats);
+		printEdit("paste, merging", mergingResult, numRepeats);
+		if (!notesMatch(noteByNote, merging)) {
+			printf("FAIL: merging the paste left different notes\n");
+			ok = false;
+		}
+	}
+
+	// Quantizing
+	{
+		int32_t effectiveLength = (numNotes - numToWrap) * kNoteSpacing;
+		NoteVector noteByNote;
+		NoteVector reversing;
+		EditResult noteByNoteResult;
+		EditResult reversingResult;
+
+		for (int32_t r = 0; r < numRepeats; r++) {
+			buildQuantized(noteByNote, numNotes, numToWrap);
+			EditResult result = timeEdit([&]() { wrapRotatingNoteByNote(noteByNote, effectiveLength); });
+			noteByNoteResult.microseconds += result.microseconds;
+			noteByNoteResult.allocations += result.allocations;
+
+			buildQuantized(reversing, numNotes, numToWrap);
+			result = timeEdit([&]() { reversing.wrapRound(effectiveLength); });
+			reversingResult.microseconds += result.microseconds;
+			reversingResult.allocations += result.allocations;
+		}
+
+		printEdit("quantize, note by note", noteByNoteResult, numRepeats);
+		printEdit("quantize, reversing", reversingResult, numRepeats);
+		if (!notesMatch(noteByNote, reversing)) {
+			printf("FAIL: wrapping quantized notes by reversing left different notes\n");
+			ok = false;
+		}
+	}
+
+	return ok ? 0 : 1;
+}
@@ -0,0 +1,169 @@
+#include "CppUTest/TestHarness.h"
+#include "model/note/note.h"
+#include "model/note/note_vector.h"
+
+namespace {
+
+constexpr int32_t kLoopLength = 192;
+
+struct PosAndLength {
+	int32_t pos;
+	int32_t length;
+};
+
+template <size_t n>
+void setNotes(NoteVector& notes, PosAndLength const (&positions)[n]) {
+	notes.empty();
+	CHECK(notes.insertAtIndex(0, n) == Error::NONE);
+	for (size_t i = 0; i < n; i++) {
+		Note* note = notes.getElement(i);
+		note->pos = positions[i].pos;
+		note->length = positions[i].length;
+		note->velocity = 64 + i;
+	}
+}
+
+template <size_t n>
+void checkNotes(NoteVector& notes, PosAndLength const (&expected)[n]) {
+	CHECK_EQUAL(n, notes.getNumElements());
+	for (size_t i = 0; i < n; i++) {
+		CHECK_EQUAL(expected[i].pos, notes.getElement(i)->pos);
+		CHECK_EQUAL(expected[i].length, notes.getElement(i)->length);
+	}
+}
+
+} // namespace
+
+TEST_GROUP(NoteVectorMergeTest){};
+
+TEST(NoteVectorMergeTest, mergesInOrderAndLimitsToNextNote) {
+	NoteVector notes;
+	setNotes(notes, {{0, 24}, {96, 24}});
+
+	NoteVectorMerge merge(notes, kLoopLength);
+	CHECK(merge.prepare(3) == Error::NONE);
+	CHECK(merge.addNote(48, 12));
+	CHECK(merge.addNote(72, 48)); // Runs into the Note at 96
+	CHECK(merge.addNote(144, 12));
+	merge.finish();
+
+	checkNotes(merge.newNotes, {{0, 24}, {48, 12}, {72, 24}, {96, 24}, {144, 12}});
+	CHECK_EQUAL(64, merge.newNotes.getElement(0)->velocity);
+	CHECK_EQUAL(65, merge.newNotes.getElement(3)->velocity);
+}
+
+TEST(NoteVectorMergeTest, skipsNotesOverlappingExistingOnes) {
+	NoteVector notes;
+	setNotes(notes, {{0, 24}, {96, 24}});
+
+	NoteVectorMerge merge(notes, kLoopLength);
+	CHECK(merge.prepare(3) == Error::NONE);
+	CHECK(!merge.addNote(12, 12));  // Starts inside the Note at 0
+	CHECK(!merge.addNote(96, 12));  // Same pos as the Note at 96
+	CHECK(!merge.addNote(119, 12)); // Starts in the last tick of the Note at 96
+	merge.finish();
+
+	checkNotes(merge.newNotes, {{0, 24}, {96, 24}});
+}
+
+TEST(NoteVectorMergeTest, skipsNotesOverlappingEachOther) {
+	NoteVector notes;
+
+	NoteVectorMerge merge(notes, kLoopLength);
+	CHECK(merge.prepare(2) == Error::NONE);
+	CHECK(merge.addNote(24, 48));
+	CHECK(!merge.addNote(48, 12));
+	merge.finish();
+
+	checkNotes(merge.newNotes, {{24, 48}});
+}
+
+TEST(NoteVectorMergeTest, lastNoteWrapsRoundToFirst) {
+	NoteVector notes;
+	setNotes(notes, {{24, 24}, {96, 24}});
+
+	NoteVectorMerge merge(notes, kLoopLength);
+	CHECK(merge.prepare(1) == Error::NONE);
+	CHECK(merge.addNote(180, 96)); // Can only reach round to the Note at 24
+	merge.finish();
+
+	checkNotes(merge.newNotes, {{24, 24}, {96, 24}, {180, 36}});
+}
+
+TEST(NoteVectorMergeTest, existingTailWrappingRoundBlocksStart) {
+	NoteVector notes;
+	setNotes(notes, {{96, 24}, {180, 24}}); // Plays on until 12 ticks into the next loop
+
+	NoteVectorMerge merge(notes, kLoopLength);
+	CHECK(merge.prepare(2) == Error::NONE);
+	CHECK(!merge.addNote(0, 12));
+	CHECK(merge.addNote(12, 12));
+	merge.finish();
+
+	checkNotes(merge.newNotes, {{12, 12}, {96, 24}, {180, 24}});
+}
+
+TEST(NoteVectorMergeTest, intoEmptyTakesWholeLoopAtMost) {
+	NoteVector notes;
+
+	NoteVectorMerge merge(notes, kLoopLength);
+	CHECK(merge.prepare(1) == Error::NONE);
+	CHECK(merge.addNote(0, kLoopLength * 2));
+	merge.finish();
+
+	checkNotes(merge.newNotes, {{0, kLoopLength}});
+}
+
+TEST(NoteVectorMergeTest, nothingAdded) {
+	NoteVector notes;
+	setNotes(notes, {{0, 24}});
+
+	NoteVectorMerge merge(notes, kLoopLength);
+	CHECK(merge.prepare(0) == Error::NONE);
+	merge.finish();
+
+	checkNotes(merge.newNotes, {{0, 24}});
+}
+
+TEST_GROUP(NoteVectorWrapTest){};
+
+TEST(NoteVectorWrapTest, nothingToWrap) {
+	NoteVector notes;
+	setNotes(notes, {{0, 12}, {96, 12}, {191, 1}});
+	notes.wrapRound(kLoopLength);
+	checkNotes(notes, {{0, 12}, {96, 12}, {191, 1}});
+}
+
+TEST(NoteVectorWrapTest, wrapsOffTheEnd) {
+	NoteVector notes;
+	setNotes(notes, {{24, 12}, {96, 12}, {192, 12}, {200, 12}});
+	notes.wrapRound(kLoopLength);
+	checkNotes(notes, {{0, 12}, {8, 12}, {24, 12}, {96, 12}});
+	CHECK_EQUAL(66, notes.getElement(0)->velocity);
+	CHECK_EQUAL(67, notes.getElement(1)->velocity);
+	CHECK_EQUAL(64, notes.getElement(2)->velocity);
+}
+
+TEST(NoteVectorWrapTest, wrapsOffTheStart) {
+	NoteVector notes;
+	setNotes(notes, {{-12, 12}, {-1, 1}, {96, 12}});
+	notes.wrapRound(kLoopLength);
+	checkNotes(notes, {{96, 12}, {180, 12}, {191, 1}});
+}
+
+TEST(NoteVectorWrapTest, wrapsOffBothEndsAndStaysInOrder) {
+	NoteVector notes;
+	setNotes(notes, {{-24, 12}, {-6, 6}, {48, 12}, {96, 12}, {192, 12}, {210, 12}});
+	notes.wrapRound(kLoopLength);
+	checkNotes(notes, {{0, 12}, {18, 12}, {48, 12}, {96, 12}, {168, 12}, {186, 6}});
+	for (int32_t i = 1; i < notes.getNumElements(); i++) {
+		CHECK(notes.getElement(i - 1)->pos <= notes.getElement(i)->pos);
+	}
+}
+
+TEST(NoteVectorWrapTest, everythingWraps) {
+	NoteVector notes;
+	setNotes(notes, {{200, 12}, {300, 12}});
+	notes.wrapRound(kLoopLength);
+	checkNotes(notes, {{8, 12}, {108, 12}});
+}
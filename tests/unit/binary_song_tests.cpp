@@ -0,0 +1,250 @@
+#include "CppUTest/TestHarness.h"
+#include "model/note/note.h"
+#include "model/note/note_vector.h"
+#include "modulation/params/param_node.h"
+#include "modulation/params/param_node_vector.h"
+#include "storage/storage_manager.h"
+#include <cstring>
+#include <vector>
+
+namespace {
+
+struct TestNote {
+	uint32_t pos;
+	uint32_t length;
+	uint8_t velocity;
+	uint16_t iterance;
+};
+
+constexpr TestNote kNotes[] = {{0, 24, 64, 0}, {96, 48, 127, 0x0102}, {0x7FFFFFFF, 1, 1, 0xFFFF}};
+
+// Writes a song the way Song and NoteRow do, including note data a field at a time as a "0x..." value
+std::vector<uint8_t> saveSong(BinarySerializer& writer, bool hexDigitsAsText) {
+	writer.reset();
+	writer.writeOpeningTagBeginning("song");
+	writer.writeAttribute("swingAmount", -3);
+	writer.writeAttribute("name", "Round trip");
+	writer.writeAttributeHex("colour", 0xC0DE, 8);
+	writer.writeOpeningTagEnd();
+
+	writer.writeOpeningTagBeginning("noteRow");
+	writer.writeAttribute("y", 5);
+	writer.insertCommaIfNeeded();
+	writer.write("\n");
+	writer.printIndents();
+	writer.writeTagNameAndSeperator("noteData");
+	writer.write("\"0x");
+	for (TestNote const& note : kNotes) {
+		if (hexDigitsAsText) {
+			// Everything the firmware did before writeHexDigits()
+			char buffer[9];
+			intToHex(note.pos, buffer);
+			writer.write(buffer);
+			intToHex(note.length, buffer);
+			writer.write(buffer);
+			intToHex(note.velocity, buffer, 2);
+			writer.write(buffer);
+			intToHex(note.iterance, buffer, 4);
+			writer.write(buffer);
+		}
+		else {
+			writer.writeHexDigits(note.pos);
+			writer.writeHexDigits(note.length);
+			writer.writeHexDigits(note.velocity, 2);
+			writer.writeHexDigits(note.iterance, 4);
+		}
+	}
+	writer.write("\"");
+	writer.closeTag();
+
+	writer.writeClosingTag("song");
+	CHECK(writer.closeFileAfterWriting() == Error::NONE);
+
+	uint8_t* start = (uint8_t*)writer.getBufferPtr();
+	return std::vector<uint8_t>(start, start + writer.bytesWritten());
+}
+
+struct TestNode {
+	int32_t pos;
+	int32_t value;
+	bool interpolated;
+};
+
+constexpr TestNode kNodes[] = {{0, 0x40000000, false}, {48, -0x12345678, true}, {192, 0x7FFFFFFF, true}};
+
+// Writes a song's notes and automation with the firmware's own NoteVector and ParamNodeVector code, framed the way
+// NoteRow::writeToFile() and ParamSet::writeParamAsAttribute() frame them
+std::vector<uint8_t> saveNotesAndAutomation(BinarySerializer& writer, NoteVector& notes, ParamNodeVector& nodes,
+                                            int32_t currentValue) {
+	writer.reset();
+	writer.writeOpeningTagBeginning("song");
+	writer.writeOpeningTagEnd();
+
+	writer.writeOpeningTagBeginning("noteRow");
+	writer.insertCommaIfNeeded();
+	writer.write("\n");
+	writer.printIndents();
+	writer.writeTagNameAndSeperator("noteDataWithSplitProb");
+	writer.write("\"0x");
+	notes.writeToFile(writer);
+	writer.write("\"");
+
+	writer.insertCommaIfNeeded();
+	writer.write("\n");
+	writer.printIndents();
+	writer.writeTagNameAndSeperator("volume");
+	writer.write("\"0x");
+	writer.writeHexDigits(currentValue);
+	nodes.writeToFile(writer);
+	writer.write("\"");
+	writer.closeTag();
+
+	writer.writeClosingTag("song");
+	CHECK(writer.closeFileAfterWriting() == Error::NONE);
+
+	uint8_t* start = (uint8_t*)writer.getBufferPtr();
+	return std::vector<uint8_t>(start, start + writer.bytesWritten());
+}
+
+} // namespace
+
+TEST_GROUP(BinarySongTests){};
+
+TEST(BinarySongTests, hexDigitsGoStraightInAsBytes) {
+	BinarySerializer writer;
+	std::vector<uint8_t> asText = saveSong(writer, true);
+	std::vector<uint8_t> asBytes = saveSong(writer, false);
+
+	CHECK_EQUAL(asText.size(), asBytes.size());
+	CHECK(asText == asBytes);
+}
+
+TEST(BinarySongTests, saveThenLoadGivesBackWhatWasSaved) {
+	BinarySerializer writer;
+	std::vector<uint8_t> file = saveSong(writer, false);
+
+	BinaryDeserializer reader(file.data(), file.size());
+	CHECK(reader.openBinaryFile(nullptr, "song") == Error::NONE);
+
+	int32_t swingAmount = 0;
+	char name[32] = "";
+	int32_t colour = 0;
+	int32_t y = -1;
+	std::vector<TestNote> notes;
+
+	char const* tagName;
+	while (*(tagName = reader.readNextTagOrAttributeName())) {
+		if (!strcmp(tagName, "swingAmount")) {
+			swingAmount = reader.readTagOrAttributeValueInt();
+		}
+		else if (!strcmp(tagName, "name")) {
+			strncpy(name, reader.readTagOrAttributeValue(), sizeof(name) - 1);
+		}
+		else if (!strcmp(tagName, "colour")) {
+			colour = reader.readTagOrAttributeValueHex(0);
+		}
+		else if (!strcmp(tagName, "noteRow")) {
+			while (*(tagName = reader.readNextTagOrAttributeName())) {
+				if (!strcmp(tagName, "y")) {
+					y = reader.readTagOrAttributeValueInt();
+				}
+				else if (!strcmp(tagName, "noteData")) {
+					CHECK(reader.prepareToReadHexValueAsBytes());
+					uint8_t const* bytes;
+					while ((bytes = reader.readNextBytesOfHexValue(11))) {
+						notes.push_back({
+						    .pos = bytesToIntFixedLength(bytes, 4),
+						    .length = bytesToIntFixedLength(&bytes[4], 4),
+						    .velocity = (uint8_t)bytes[8],
+						    .iterance = (uint16_t)bytesToIntFixedLength(&bytes[9], 2),
+						});
+					}
+				}
+				reader.exitTag(tagName);
+			}
+		}
+		reader.exitTag(tagName);
+	}
+
+	CHECK_EQUAL(-3, swingAmount);
+	STRCMP_EQUAL("Round trip", name);
+	CHECK_EQUAL(0xC0DE, colour);
+	CHECK_EQUAL(5, y);
+	CHECK_EQUAL(std::size(kNotes), notes.size());
+	for (size_t n = 0; n < notes.size(); n++) {
+		CHECK_EQUAL(kNotes[n].pos, notes[n].pos);
+		CHECK_EQUAL(kNotes[n].length, notes[n].length);
+		CHECK_EQUAL(kNotes[n].velocity, notes[n].velocity);
+		CHECK_EQUAL(kNotes[n].iterance, notes[n].iterance);
+	}
+}
+
+TEST(BinarySongTests, notesAndAutomationSurviveASaveAndLoad) {
+	NoteVector notes;
+	for (TestNote const& testNote : kNotes) {
+		Note* note = notes.getElement(notes.insertAtKey(testNote.pos));
+		note->setLength(testNote.length);
+		note->setVelocity(testNote.velocity);
+		note->setLift(kDefaultLiftValue + 1);
+		note->setProbability(kNumProbabilityValues - 1);
+		note->setIterance(Iterance::fromInt(testNote.iterance));
+		note->setFill(FillMode::FILL);
+	}
+	ParamNodeVector nodes;
+	for (TestNode const& testNode : kNodes) {
+		ParamNode* node = nodes.getElement(nodes.insertAtKey(testNode.pos));
+		node->value = testNode.value;
+		node->interpolated = testNode.interpolated;
+	}
+
+	BinarySerializer writer;
+	std::vector<uint8_t> file = saveNotesAndAutomation(writer, notes, nodes, -5);
+
+	BinaryDeserializer reader(file.data(), file.size());
+	CHECK(reader.openBinaryFile(nullptr, "song") == Error::NONE);
+
+	NoteVector loadedNotes;
+	ParamNodeVector loadedNodes;
+	int32_t currentValue = 0;
+
+	char const* tagName;
+	while (*(tagName = reader.readNextTagOrAttributeName())) {
+		if (!strcmp(tagName, "noteRow")) {
+			while (*(tagName = reader.readNextTagOrAttributeName())) {
+				if (!strcmp(tagName, "noteDataWithSplitProb")) {
+					CHECK(loadedNotes.readFromFile(reader, 28) == Error::NONE);
+				}
+				else if (!strcmp(tagName, "volume")) {
+					// As AutoParam::readFromFile() does
+					CHECK(reader.prepareToReadHexValueAsBytes());
+					currentValue = bytesToIntFixedLength(reader.readNextBytesOfHexValue(4), 4);
+					CHECK(loadedNodes.readFromFile(reader, true, kMaxSequenceLength) == Error::NONE);
+				}
+				reader.exitTag(tagName);
+			}
+		}
+		reader.exitTag(tagName);
+	}
+
+	// The last note's too long to fit the sequence, so gets dropped on load as it always has
+	CHECK_EQUAL(std::size(kNotes) - 1, loadedNotes.getNumElements());
+	for (int32_t n = 0; n < loadedNotes.getNumElements(); n++) {
+		Note* note = loadedNotes.getElement(n);
+		CHECK_EQUAL(kNotes[n].pos, note->pos);
+		CHECK_EQUAL(kNotes[n].length, note->getLength());
+		CHECK_EQUAL(kNotes[n].velocity, note->getVelocity());
+		CHECK_EQUAL(kDefaultLiftValue + 1, note->getLift());
+		CHECK_EQUAL(kNumProbabilityValues - 1, note->getProbability());
+		CHECK_EQUAL(kNotes[n].iterance, note->getIterance().toInt());
+		CHECK_EQUAL(FillMode::FILL, note->getFill());
+	}
+
+	CHECK_EQUAL(-5, currentValue);
+	CHECK_EQUAL(std::size(kNodes), loadedNodes.getNumElements());
+	for (int32_t i = 0; i < loadedNodes.getNumElements(); i++) {
+		ParamNode* node = loadedNodes.getElement(i);
+		CHECK_EQUAL(kNodes[i].pos, node->pos);
+		CHECK_EQUAL(kNodes[i].value, node->value);
+		CHECK_EQUAL(kNodes[i].interpolated, node->interpolated);
+	}
+}
@@ -0,0 +1,131 @@
+#include "CppUTest/TestHarness.h"
+#include "dsp/compressor/rms_feedback.h"
+#include "dsp/compressor/sidechain_key.h"
+#include "processing/engines/audio_engine.h"
+#include "storage/storage_manager.h"
+#include <array>
+#include <cstring>
+#include <vector>
+
+namespace {
+
+constexpr size_t kWindow = 128;
+
+void fillWithSine(std::span<StereoSample> buffer, q31_t amplitude, int32_t period) {
+	for (size_t i = 0; i < buffer.size(); i++) {
+		q31_t value = amplitude * std::sin(2 * M_PI * float(i % period) / float(period));
+		buffer[i] = {value, value};
+	}
+}
+
+// Save a compressor inside a sound tag, as ModControllableAudio does, and load it back into another
+void saveAndLoad(RMSFeedbackCompressor& saved, RMSFeedbackCompressor& loaded) {
+	BinarySerializer writer;
+	writer.reset();
+	writer.writeOpeningTagBeginning("sound");
+	writer.writeAttribute("polyphonic", "poly");
+	writer.writeOpeningTagEnd();
+	saved.writeToFile(writer, "audioCompressor");
+	writer.writeClosingTag("sound");
+	CHECK(writer.closeFileAfterWriting() == Error::NONE);
+	uint8_t* start = (uint8_t*)writer.getBufferPtr();
+	std::vector<uint8_t> file(start, start + writer.bytesWritten());
+
+	BinaryDeserializer reader(file.data(), file.size());
+	CHECK(reader.openBinaryFile(nullptr, "sound") == Error::NONE);
+	bool found = false;
+	char const* tagName;
+	while (*(tagName = reader.readNextTagOrAttributeName())) {
+		if (!strcmp(tagName, "audioCompressor")) {
+			reader.match('{');
+			loaded.readFromFile(reader);
+			reader.exitTag("audioCompressor", true);
+			found = true;
+		}
+		else {
+			reader.exitTag(tagName);
+		}
+	}
+	CHECK(found);
+}
+
+} // namespace
+
+TEST_GROUP(CompressorTest){void setup(){AudioEngine::sideChainKey = SideChainKey{};
+}
+}
+;
+
+TEST(CompressorTest, settingsSurviveSaveAndLoad) {
+	RMSFeedbackCompressor saved;
+	saved.setAttack(ONE_Q31 / 3);
+	saved.setRelease(ONE_Q31 / 5);
+	saved.setThreshold(ONE_Q31 / 2);
+	saved.setRatio(ONE_Q31 / 7);
+	saved.setSidechain(ONE_Q31 / 11);
+	saved.setBlend(ONE_Q31 / 2);
+	CHECK(saved.setLookahead(ONE_Q31 / 4));
+	saved.setMultiband(true);
+	saved.setKeyedFromSidechain(true);
+
+	RMSFeedbackCompressor loaded;
+	saveAndLoad(saved, loaded);
+
+	CHECK_EQUAL(saved.getAttack(), loaded.getAttack());
+	CHECK_EQUAL(saved.getRelease(), loaded.getRelease());
+	CHECK_EQUAL(saved.getThreshold(), loaded.getThreshold());
+	CHECK_EQUAL(saved.getRatio(), loaded.getRatio());
+	CHECK_EQUAL(saved.getSidechain(), loaded.getSidechain());
+	CHECK_EQUAL(saved.getBlend(), loaded.getBlend());
+	CHECK_EQUAL(saved.getLookahead(), loaded.getLookahead());
+	CHECK(loaded.isMultiband());
+	CHECK(loaded.isKeyedFromSidechain());
+}
+
+TEST(CompressorTest, unusedOptionsAreLeftOutAndLoadAsOff) {
+	RMSFeedbackCompressor saved;
+	RMSFeedbackCompressor loaded;
+	saveAndLoad(saved, loaded);
+
+	CHECK_EQUAL(0, loaded.getLookahead());
+	CHECK(!loaded.isMultiband());
+	CHECK(!loaded.isKeyedFromSidechain());
+}
+
+TEST(CompressorTest, keyedCompressorsShareOneEnvelope) {
+	// Same threshold and ratio, very different attack and release, and different audio of their own. Keyed from the
+	// sidechain they should reduce their gain by exactly the same amount every window
+	RMSFeedbackCompressor fast;
+	RMSFeedbackCompressor slow;
+	fast.setAttack(0);
+	fast.setRelease(0);
+	slow.setAttack(ONE_Q31);
+	slow.setRelease(ONE_Q31);
+	for (RMSFeedbackCompressor* compressor : {&fast, &slow}) {
+		compressor->setThreshold(ONE_Q31 / 2);
+		compressor->setRatio(ONE_Q31 / 2);
+		compressor->setKeyedFromSidechain(true);
+	}
+
+	std::array<StereoSample, kWindow> key;
+	std::array<StereoSample, kWindow> fastAudio;
+	std::array<StereoSample, kWindow> slowAudio;
+	int32_t numWindowsReducing = 0;
+
+	for (int32_t window = 0; window < 200; window++) {
+		fillWithSine(fastAudio, 1 << 22, 50);
+		fillWithSine(slowAudio, 1 << 18, 70);
+		fast.render(fastAudio, 1 << 27, 1 << 27, ONE_Q31);
+		slow.render(slowAudio, 1 << 27, 1 << 27, ONE_Q31);
+		CHECK_EQUAL(fast.gainReduction, slow.gainReduction);
+		numWindowsReducing += (fast.gainReduction != 0);
+
+		// a loud kick for the first half, then silence so the envelope releases
+		fillWithSine(key, window < 100 ? (1 << 30) : 0, 100);
+		AudioEngine::sideChainKey.feed(key);
+		AudioEngine::sideChainKey.finishWindow(kWindow);
+	}
+
+	CHECK(numWindowsReducing > 0);
+	CHECK_EQUAL(0, fast.gainReduction);
+}
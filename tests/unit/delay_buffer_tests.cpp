@@ -0,0 +1,148 @@
+#include "CppUTest/TestHarness.h"
+#include "dsp/delay/delay_buffer.h"
+#include "util/fixedpoint.h"
+#include <array>
+#include <vector>
+
+namespace {
+
+constexpr uint32_t kRate = kMaxSampleValue * 8; // A 2048 frame buffer, so a few blocks wrap it
+
+// Block sizes which aren't multiples of four, so the resampled read has leftovers too
+constexpr std::array<size_t, 6> kBlockSizes = {128, 37, 1, 64, 255, 3};
+
+void fillWithNoise(DelayBuffer& buffer) {
+	uint32_t seed = 12345;
+	for (StereoSample* sample = buffer.begin(); sample != buffer.end(); sample++) {
+		seed = seed * 1664525 + 1013904223;
+		sample->l = (int32_t)seed >> 2;
+		seed = seed * 1664525 + 1013904223;
+		sample->r = (int32_t)seed >> 2;
+	}
+}
+
+// Two identical buffers, one for the block helpers and one for the per-sample ones
+struct BufferPair {
+	BufferPair() {
+		CHECK(block.init(kRate) == Error::NONE);
+		CHECK(perSample.init(kRate) == Error::NONE);
+		fillWithNoise(block);
+		fillWithNoise(perSample);
+	}
+
+	void checkSame() {
+		CHECK_EQUAL(block.begin() - &block.current(), perSample.begin() - &perSample.current());
+		for (size_t i = 0; i < block.sizeIncludingExtra; i++) {
+			CHECK_EQUAL(block.begin()[i].l, perSample.begin()[i].l);
+			CHECK_EQUAL(block.begin()[i].r, perSample.begin()[i].r);
+		}
+	}
+
+	DelayBuffer block;
+	DelayBuffer perSample;
+};
+
+void checkSame(std::span<const StereoSample> a, std::span<const StereoSample> b) {
+	CHECK_EQUAL(a.size(), b.size());
+	for (size_t i = 0; i < a.size(); i++) {
+		CHECK_EQUAL(a[i].l, b[i].l);
+		CHECK_EQUAL(a[i].r, b[i].r);
+	}
+}
+
+} // namespace
+
+TEST_GROUP(DelayBufferTest){};
+
+TEST(DelayBufferTest, readNativeBlockMatchesPerSample) {
+	BufferPair buffers;
+	size_t numWraps = 0;
+
+	for (int32_t repeat = 0; repeat < 16; repeat++) {
+		for (size_t blockSize : kBlockSizes) {
+			std::vector<StereoSample> fromBlock(blockSize);
+			std::vector<StereoSample> fromPerSample(blockSize);
+
+			bool blockWrapped = buffers.block.readNativeBlock(fromBlock);
+
+			bool perSampleWrapped = false;
+			for (StereoSample& sample : fromPerSample) {
+				perSampleWrapped = buffers.perSample.clearAndMoveOn() || perSampleWrapped;
+				sample = buffers.perSample.current();
+			}
+
+			CHECK_EQUAL(perSampleWrapped, blockWrapped);
+			numWraps += blockWrapped;
+			checkSame(fromPerSample, fromBlock);
+		}
+	}
+	buffers.checkSame();
+	CHECK(numWraps > 1);
+}
+
+TEST(DelayBufferTest, readResampledBlockMatchesPerSample) {
+	for (uint32_t rate : {kRate + (kRate >> 4), kRate - (kRate >> 3), kRate * 3}) {
+		BufferPair buffers;
+		buffers.block.setupForRender(rate);
+		buffers.perSample.setupForRender(rate);
+		CHECK(buffers.block.resampling());
+
+		for (int32_t repeat = 0; repeat < 4; repeat++) {
+			for (size_t blockSize : kBlockSizes) {
+				std::vector<StereoSample> fromBlock(blockSize);
+				std::vector<StereoSample> fromPerSample(blockSize);
+
+				bool blockWrapped = buffers.block.readResampledBlock(fromBlock);
+
+				DelayBuffer& buffer = buffers.perSample;
+				bool perSampleWrapped = false;
+				for (StereoSample& sample : fromPerSample) {
+					int32_t strength2 = buffer.advance([&] {
+						perSampleWrapped = buffer.clearAndMoveOn() || perSampleWrapped; //<
+					});
+					int32_t strength1 = 65536 - strength2;
+
+					StereoSample from1 = buffer.current();
+					StereoSample from2 = (&buffer.current() + 1 == buffer.end()) ? *buffer.begin()
+					                                                              : *(&buffer.current() + 1);
+					sample.l = (multiply_32x32_rshift32(from1.l, strength1 << 14)
+					            + multiply_32x32_rshift32(from2.l, strength2 << 14))
+					           << 2;
+					sample.r = (multiply_32x32_rshift32(from1.r, strength1 << 14)
+					            + multiply_32x32_rshift32(from2.r, strength2 << 14))
+					           << 2;
+				}
+
+				CHECK_EQUAL(perSampleWrapped, blockWrapped);
+				checkSame(fromPerSample, fromBlock);
+			}
+		}
+		buffers.checkSame();
+	}
+}
+
+TEST(DelayBufferTest, clearAndWriteNativeBlockMatchesPerSample) {
+	BufferPair buffers;
+	int32_t value = 0;
+
+	for (int32_t repeat = 0; repeat < 8; repeat++) {
+		for (size_t blockSize : kBlockSizes) {
+			std::vector<StereoSample> input(blockSize);
+			for (StereoSample& sample : input) {
+				sample.l = ++value;
+				sample.r = -value;
+			}
+
+			bool blockWrapped = buffers.block.clearAndWriteNativeBlock(input);
+
+			bool perSampleWrapped = false;
+			for (StereoSample sample : input) {
+				perSampleWrapped = buffers.perSample.clearAndMoveOn() || perSampleWrapped;
+				buffers.perSample.writeNative(sample);
+			}
+
+			CHECK_EQUAL(perSampleWrapped, blockWrapped);
+		}
+	}
+	buffers.checkSame();
+}
@@ -0,0 +1,143 @@
+#include "CppUTest/TestHarness.h"
+#include "io/midi/din_output_queue.h"
+#include <vector>
+
+namespace {
+
+std::vector<uint8_t> popAll(DINOutputQueue& queue, int32_t maxBytes = DINOutputQueue::kMaxBytes) {
+	std::vector<uint8_t> bytes(DINOutputQueue::kMaxBytes);
+	bytes.resize(queue.pop(bytes.data(), maxBytes));
+	return bytes;
+}
+
+} // namespace
+
+TEST_GROUP(DINOutputQueueTest){};
+
+TEST(DINOutputQueueTest, nothingGoesOutUntilReleased) {
+	DINOutputQueue queue;
+	queue.push(MIDIMessage::noteOn(0, 60, 100));
+
+	CHECK(popAll(queue).empty());
+	CHECK(!queue.isEmpty());
+
+	queue.release();
+	CHECK(popAll(queue) == (std::vector<uint8_t>{0x90, 60, 100}));
+	CHECK(queue.isEmpty());
+}
+
+TEST(DINOutputQueueTest, runningStatusLeavesOutRepeatedStatusBytes) {
+	DINOutputQueue queue;
+	queue.push(MIDIMessage::noteOn(0, 60, 100));
+	queue.push(MIDIMessage::noteOn(0, 64, 100));
+	queue.push(MIDIMessage::realtimeClock());
+	queue.push(MIDIMessage::noteOn(0, 67, 100));
+	queue.push(MIDIMessage::noteOn(1, 60, 100));
+	queue.release();
+
+	// Real-time goes first, and doesn't cancel running status
+	CHECK(popAll(queue) == (std::vector<uint8_t>{0xF8, 0x90, 60, 100, 64, 100, 67, 100, 0x91, 60, 100}));
+	CHECK_EQUAL(2, queue.getStats().bytesSavedByRunningStatus);
+
+	// Carries on into the next pop, unless it's been forgotten
+	queue.push(MIDIMessage::noteOn(1, 62, 100));
+	queue.release();
+	CHECK(popAll(queue) == (std::vector<uint8_t>{62, 100}));
+	queue.forgetRunningStatus();
+	queue.push(MIDIMessage::noteOn(1, 64, 100));
+	queue.release();
+	CHECK(popAll(queue) == (std::vector<uint8_t>{0x91, 64, 100}));
+
+	// System common cancels it
+	queue.push(MIDIMessage::systemPositionPointer(0));
+	queue.push(MIDIMessage::noteOn(1, 67, 100));
+	queue.release();
+	CHECK(popAll(queue) == (std::vector<uint8_t>{0xF2, 0, 0, 0x91, 67, 100}));
+}
+
+TEST(DINOutputQueueTest, waitingControllerValuesGetReplaced) {
+	DINOutputQueue queue;
+	for (int32_t value = 0; value < 10; value++) {
+		queue.push(MIDIMessage::cc(0, 74, value));
+		queue.push(MIDIMessage::cc(0, 71, value));
+		queue.push(MIDIMessage::pitchBend(0, 8192 + value));
+	}
+	// The same controller on another channel is a different controller
+	queue.push(MIDIMessage::cc(1, 74, 5));
+	queue.release();
+
+	CHECK(popAll(queue)
+	      == (std::vector<uint8_t>{0xB0, 74, 9, 71, 9, 0xE0, (8192 + 9) & 0x7F, (8192 + 9) >> 7, 0xB1, 74, 5}));
+	CHECK_EQUAL(9 * 3 * 3, queue.getStats().bytesSavedByCoalescing);
+}
+
+TEST(DINOutputQueueTest, controllerValuesStayInOrderWithNotes) {
+	DINOutputQueue queue;
+	queue.push(MIDIMessage::pitchBend(0, 0));
+	queue.push(MIDIMessage::noteOn(0, 60, 100));
+	// Has to go after the note, so can't replace the bend before it
+	queue.push(MIDIMessage::pitchBend(0, 16383));
+	queue.release();
+
+	CHECK(popAll(queue) == (std::vector<uint8_t>{0xE0, 0, 0, 0x90, 60, 100, 0xE0, 127, 127}));
+}
+
+TEST(DINOutputQueueTest, sequencedCCsAreNeverReplaced) {
+	DINOutputQueue queue;
+	// RPN 0 (pitch bend range) to 2, then 12 semitones
+	queue.push(MIDIMessage::cc(0, 101, 0));
+	queue.push(MIDIMessage::cc(0, 100, 0));
+	queue.push(MIDIMessage::cc(0, 6, 2));
+	queue.push(MIDIMessage::cc(0, 101, 0));
+	queue.push(MIDIMessage::cc(0, 100, 0));
+	queue.push(MIDIMessage::cc(0, 6, 12));
+	queue.release();
+
+	CHECK(popAll(queue) == (std::vector<uint8_t>{0xB0, 101, 0, 100, 0, 6, 2, 101, 0, 100, 0, 6, 12}));
+	CHECK_EQUAL(0, queue.getStats().bytesSavedByCoalescing);
+}
+
+TEST(DINOutputQueueTest, notesJumpControllerValuesOnOtherChannels) {
+	DINOutputQueue queue;
+	queue.push(MIDIMessage::cc(1, 74, 10));
+	queue.push(MIDIMessage::cc(0, 74, 10));
+	queue.push(MIDIMessage::noteOn(1, 60, 100));
+	queue.release();
+
+	// Ahead of channel 0's CC, but not channel 1's
+	CHECK(popAll(queue) == (std::vector<uint8_t>{0xB1, 74, 10, 0x91, 60, 100, 0xB0, 74, 10}));
+}
+
+TEST(DINOutputQueueTest, notesDontJumpReleasedMessages) {
+	DINOutputQueue queue;
+	queue.push(MIDIMessage::cc(0, 74, 10));
+	queue.release();
+	queue.push(MIDIMessage::noteOn(1, 60, 100));
+
+	CHECK(popAll(queue) == (std::vector<uint8_t>{0xB0, 74, 10}));
+	queue.release();
+	CHECK(popAll(queue) == (std::vector<uint8_t>{0x91, 60, 100}));
+}
+
+TEST(DINOutputQueueTest, onlyWholeMessagesArePopped) {
+	DINOutputQueue queue;
+	queue.push(MIDIMessage::noteOn(0, 60, 100));
+	queue.push(MIDIMessage::noteOn(1, 62, 100));
+	queue.release();
+
+	CHECK(popAll(queue, 5) == (std::vector<uint8_t>{0x90, 60, 100}));
+	CHECK(popAll(queue, 2).empty());
+	CHECK(popAll(queue, 3) == (std::vector<uint8_t>{0x91, 62, 100}));
+}
+
+TEST(DINOutputQueueTest, fullQueueRejectsUntilPopped) {
+	DINOutputQueue queue;
+	for (int32_t i = 0; i < DINOutputQueue::kMaxMessages; i++) {
+		CHECK(queue.push(MIDIMessage::noteOn(0, i, 100)));
+	}
+	CHECK(!queue.push(MIDIMessage::noteOn(0, 100, 100)));
+
+	std::vector<uint8_t> bytes(3);
+	CHECK_EQUAL(3, queue.pop(bytes.data(), 3, true));
+	CHECK(queue.push(MIDIMessage::noteOn(0, 100, 100)));
+}
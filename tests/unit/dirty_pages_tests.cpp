@@ -0,0 +1,100 @@
+#include "CppUTest/TestHarness.h"
+#include "hid/display/oled_canvas/dirty_pages.h"
+#include <cstring>
+
+using deluge::hid::display::oled_canvas::Canvas;
+using deluge::hid::display::oled_canvas::DirtyPages;
+
+namespace {
+constexpr int32_t kNumPages = Canvas::kImageHeight;
+constexpr int32_t kWidth = Canvas::kImageWidth;
+
+Canvas::ImageStore previousImage;
+Canvas::ImageStore image;
+} // namespace
+
+TEST_GROUP(DirtyPagesTest) {
+	void setup() {
+		memset(previousImage, 0, sizeof(previousImage));
+		memset(image, 0, sizeof(image));
+	}
+};
+
+TEST(DirtyPagesTest, identicalFramesAreClean) {
+	image[2][40] = previousImage[2][40] = 0x55;
+	DirtyPages dirty;
+	dirty.markChanges(image, previousImage);
+	CHECK(dirty.isEmpty());
+	int32_t first;
+	int32_t last;
+	CHECK(!dirty.getByteRange(first, last));
+}
+
+TEST(DirtyPagesTest, findsChangedColumnsOfEachPage) {
+	image[1][5] = 0x01;
+	image[1][6] = 0x80;
+	image[1][66] = 0xFF;
+	image[3][127] = 0x10;
+	image[kNumPages - 1][0] = 0x02;
+
+	DirtyPages dirty;
+	dirty.markChanges(image, previousImage);
+
+	CHECK(!dirty.isEmpty());
+	CHECK(!dirty.isPageDirty(0));
+	CHECK(dirty.isPageDirty(1));
+	CHECK_EQUAL(5, dirty.getMinX(1));
+	CHECK_EQUAL(66, dirty.getMaxX(1));
+	CHECK(!dirty.isPageDirty(2));
+	CHECK_EQUAL(127, dirty.getMinX(3));
+	CHECK_EQUAL(127, dirty.getMaxX(3));
+	CHECK_EQUAL(0, dirty.getMinX(kNumPages - 1));
+	CHECK_EQUAL(0, dirty.getMaxX(kNumPages - 1));
+
+	int32_t first;
+	int32_t last;
+	CHECK(dirty.getByteRange(first, last));
+	CHECK_EQUAL(kWidth + 5, first);
+	CHECK_EQUAL((kNumPages - 1) * kWidth, last);
+}
+
+TEST(DirtyPagesTest, copyDirtyBringsPreviousUpToDate) {
+	for (int32_t i = 0; i < 200; i++) {
+		image[(i * 7) % kNumPages][(i * 37) % kWidth] = i;
+	}
+
+	DirtyPages dirty;
+	dirty.markChanges(image, previousImage);
+	dirty.copyDirty(image, previousImage);
+	CHECK_EQUAL(0, memcmp(image, previousImage, sizeof(image)));
+
+	DirtyPages again;
+	again.markChanges(image, previousImage);
+	CHECK(again.isEmpty());
+}
+
+TEST(DirtyPagesTest, addAccumulatesAcrossFrames) {
+	DirtyPages sinceLastSent;
+
+	DirtyPages frame;
+	frame.markColumns(2, 10, 20);
+	sinceLastSent.add(frame);
+
+	frame.clear();
+	frame.markColumns(2, 30, 31);
+	frame.markColumns(4, 0, 0);
+	sinceLastSent.add(frame);
+
+	CHECK_EQUAL(10, sinceLastSent.getMinX(2));
+	CHECK_EQUAL(31, sinceLastSent.getMaxX(2));
+	CHECK(sinceLastSent.isPageDirty(4));
+	CHECK(!sinceLastSent.isPageDirty(3));
+
+	sinceLastSent.clear();
+	CHECK(sinceLastSent.isEmpty());
+	sinceLastSent.markAll();
+	for (int32_t page = 0; page < kNumPages; page++) {
+		CHECK_EQUAL(0, sinceLastSent.getMinX(page));
+		CHECK_EQUAL(kWidth - 1, sinceLastSent.getMaxX(page));
+	}
+}
@@ -1,5 +1,6 @@
 #include "CppUTest/TestHarness.h"
 #include "util/const_functions.h"
+#include "util/d_stringbuf.h"
 
 TEST_GROUP(FunctionTests){};
 
@@ -12,3 +13,13 @@ TEST(FunctionTests, mod) {
 	CHECK_EQUAL(2, mod(2, 3));
 	CHECK_EQUAL(0, mod(3, 3));
 }
+
+TEST(FunctionTests, bytesToIntFixedLengthMatchesHex) {
+	char const* hexChars = "0000C0DE7FFFFFFF40";
+	uint8_t bytes[] = {0x00, 0x00, 0xC0, 0xDE, 0x7F, 0xFF, 0xFF, 0xFF, 0x40};
+
+	CHECK_EQUAL(hexToIntFixedLength(hexChars, 8), bytesToIntFixedLength(bytes, 4));
+	CHECK_EQUAL(hexToIntFixedLength(&hexChars[8], 8), bytesToIntFixedLength(&bytes[4], 4));
+	CHECK_EQUAL(hexToIntFixedLength(&hexChars[16], 2), bytesToIntFixedLength(&bytes[8], 1));
+	CHECK_EQUAL(0xC0DEu, bytesToIntFixedLength(&bytes[2], 2));
+}
@@ -0,0 +1,120 @@
+#include "CppUTest/TestHarness.h"
+#include "dsp/timestretch/hop_search.h"
+#include <cmath>
+#include <algorithm>
+#include <random>
+#include <vector>
+
+using namespace deluge::dsp::timestretch;
+
+namespace {
+constexpr int32_t kWindow = 128;
+constexpr int32_t kMaxOffset = 256;
+
+// A couple of harmonics with some wobble, so that it isn't exactly periodic within the search range
+std::vector<int16_t> makeReferenceAudio(size_t length, double delay = 0) {
+	std::vector<int16_t> audio(length);
+	for (size_t i = 0; i < length; i++) {
+		double t = (double(i) - delay) / 44100.0;
+		double value = 0.5 * std::sin(2 * M_PI * 110 * t) + 0.3 * std::sin(2 * M_PI * 330 * t + 0.5)
+		               + 0.15 * std::sin(2 * M_PI * 37 * t);
+		audio[i] = static_cast<int16_t>(value * 30000);
+	}
+	return audio;
+}
+
+// Candidates where the reference window sits at lag trueOffset
+std::vector<int16_t> makeCandidates(const std::vector<int16_t>& audio, int32_t referenceStart, int32_t trueOffset) {
+	int32_t start = referenceStart - trueOffset - kMaxOffset;
+	return {audio.begin() + start, audio.begin() + start + kWindow + 2 * kMaxOffset};
+}
+
+uint32_t naiveSumAbsDifference(const int16_t* a, const int16_t* b, size_t length) {
+	uint32_t total = 0;
+	for (size_t i = 0; i < length; i++) {
+		total += std::abs(a[i] - b[i]);
+	}
+	return total;
+}
+} // namespace
+
+TEST_GROUP(HopSearchTests){};
+
+TEST(HopSearchTests, sumAbsDifferenceMatchesNaive) {
+	std::mt19937 rng(1234);
+	std::uniform_int_distribution<int32_t> dist(-32768, 32767);
+	std::vector<int16_t> a(67), b(67);
+	for (size_t i = 0; i < a.size(); i++) {
+		a[i] = dist(rng);
+		b[i] = dist(rng);
+	}
+	for (size_t length : {0u, 1u, 7u, 8u, 9u, 64u, 67u}) {
+		CHECK_EQUAL(naiveSumAbsDifference(a.data(), b.data(), length), sumAbsDifference(a.data(), b.data(), length));
+	}
+}
+
+TEST(HopSearchTests, findsOffsetInNoise) {
+	std::mt19937 rng(42);
+	std::uniform_int_distribution<int32_t> dist(-20000, 20000);
+	std::vector<int16_t> audio(4096);
+	for (int16_t& sample : audio) {
+		sample = dist(rng);
+	}
+	for (int32_t trueOffset : {0, 1, -1, 37, -200, 255, -256}) {
+		auto candidates = makeCandidates(audio, 2048, trueOffset);
+		// White noise has nothing in common with itself one sample later, so only an exhaustive search can find it
+		HopSearchResult result = findBestOffset({&audio[2048], kWindow}, candidates, kMaxOffset, 1);
+		CHECK_EQUAL(trueOffset, result.offset);
+	}
+}
+
+TEST(HopSearchTests, findsOffsetInTonalAudio) {
+	auto audio = makeReferenceAudio(8192);
+	for (int32_t trueOffset : {0, 3, -11, 100, -180}) {
+		auto candidates = makeCandidates(audio, 4096, trueOffset);
+		HopSearchResult result = findBestOffset({&audio[4096], kWindow}, candidates, kMaxOffset);
+		CHECK_EQUAL(trueOffset, result.offset);
+	}
+}
+
+TEST(HopSearchTests, coarseSearchMatchesExhaustiveSearch) {
+	auto audio = makeReferenceAudio(8192);
+	for (int32_t trueOffset : {5, -77, 201}) {
+		auto candidates = makeCandidates(audio, 4096, trueOffset);
+		HopSearchResult exhaustive = findBestOffset({&audio[4096], kWindow}, candidates, kMaxOffset, 1);
+		HopSearchResult coarse = findBestOffset({&audio[4096], kWindow}, candidates, kMaxOffset, 4);
+		CHECK_EQUAL(exhaustive.offset, coarse.offset);
+	}
+}
+
+TEST(HopSearchTests, fractionTracksSubSampleDelay) {
+	auto audio = makeReferenceAudio(8192);
+	for (double delay : {0.25, -0.25, 0.4}) {
+		auto delayed = makeReferenceAudio(8192, delay);
+		std::vector<int16_t> candidates(delayed.begin() + 4096 - kMaxOffset,
+		                                delayed.begin() + 4096 + kWindow + kMaxOffset);
+		HopSearchResult result = findBestOffset({&audio[4096], kWindow}, candidates, kMaxOffset);
+		double found = result.offset + result.fraction / double(1 << 24);
+		DOUBLES_EQUAL(delay, found, 0.15);
+	}
+}
+
+// The coarse pass only tries some of the lags before refining, so it may settle somewhere else - but never anywhere that
+// lines up worse than where the exhaustive search would have. How much time it saves is for HopSearchBenchmark
+TEST(HopSearchTests, coarseSearchFindsAnEquivalentHop) {
+	auto audio = makeReferenceAudio(8192);
+	for (int32_t coarseStep : {2, 3}) {
+		for (int32_t trueOffset = -kMaxOffset; trueOffset <= kMaxOffset; trueOffset += 19) {
+			auto candidates = makeCandidates(audio, 4096, trueOffset);
+			std::span<const int16_t> reference{&audio[4096], kWindow};
+			HopSearchResult exhaustive = findBestOffset(reference, candidates, kMaxOffset, 1);
+			HopSearchResult coarse = findBestOffset(reference, candidates, kMaxOffset, coarseStep);
+			if (coarse.offset != exhaustive.offset) {
+				auto differenceAt = [&](int32_t offset) {
+					return sumAbsDifference(reference.data(), &candidates[kMaxOffset + offset], kWindow);
+				};
+				CHECK_EQUAL(differenceAt(exhaustive.offset), differenceAt(coarse.offset));
+			}
+		}
+	}
+}
@@ -0,0 +1,95 @@
+/*
+ * Copyright © 2025 Synthstrom Audible Limited
+ *
+ * This file is part of The Synthstrom Audible Deluge Firmware.
+ *
+ * The Synthstrom Audible Deluge Firmware is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program.
+ * If not, see <https://www.gnu.org/licenses/>.
+ */
+
+// The firmware's allocator, backed by the host's malloc. Each allocation is preceded by its size, so the
+// ResizeableArray family can find out how big its memory is. Nothing can ever be shortened or extended in place, so
+// they fall back to allocating new memory as they would when the real allocator can't.
+
+#include "CppUTest/TestHarness.h"
+#include "memory/general_memory_allocator.h"
+#include "memory/memory_allocator_interface.h"
+#include <cstdlib>
+
+namespace {
+constexpr uint32_t kHeaderSize = 8;
+}
+
+MemoryRegion::MemoryRegion() = default;
+GeneralMemoryAllocator::GeneralMemoryAllocator() = default;
+
+void* GeneralMemoryAllocator::alloc(uint32_t requiredSize, bool mayUseOnChipRam, bool makeStealable,
+                                    void* thingNotToStealFrom) {
+	char* memory = (char*)malloc(requiredSize + kHeaderSize);
+	if (!memory) {
+		return nullptr;
+	}
+	*(uint32_t*)memory = requiredSize;
+	return memory + kHeaderSize;
+}
+
+void GeneralMemoryAllocator::dealloc(void* address) {
+	if (address) {
+		free((char*)address - kHeaderSize);
+	}
+}
+
+uint32_t GeneralMemoryAllocator::getAllocatedSize(void* address) {
+	return *(uint32_t*)((char*)address - kHeaderSize);
+}
+
+uint32_t GeneralMemoryAllocator::shortenRight(void* address, uint32_t newSize) {
+	return getAllocatedSize(address);
+}
+
+uint32_t GeneralMemoryAllocator::shortenLeft(void* address, uint32_t amountToShorten,
+                                             uint32_t numBytesToMoveRightIfSuccessful) {
+	return 0;
+}
+
+void GeneralMemoryAllocator::extend(void* address, uint32_t minAmountToExtend, uint32_t idealAmountToExtend,
+                                    uint32_t* getAmountExtendedLeft, uint32_t* getAmountExtendedRight,
+                                    void* thingNotToStealFrom) {
+	*getAmountExtendedLeft = 0;
+	*getAmountExtendedRight = 0;
+}
+
+void* allocMaxSpeed(uint32_t requiredSize, void* thingNotToStealFrom) {
+	return GeneralMemoryAllocator::get().alloc(requiredSize, true, false, thingNotToStealFrom);
+}
+
+void* allocLowSpeed(uint32_t requiredSize, void* thingNotToStealFrom) {
+	return GeneralMemoryAllocator::get().alloc(requiredSize, false, false, thingNotToStealFrom);
+}
+
+void* allocStealable(uint32_t requiredSize, void* thingNotToStealFrom) {
+	return GeneralMemoryAllocator::get().alloc(requiredSize, false, true, thingNotToStealFrom);
+}
+
+extern "C" {
+void* delugeAlloc(unsigned int requiredSize, bool mayUseOnChipRam) {
+	return GeneralMemoryAllocator::get().alloc(requiredSize, mayUseOnChipRam, false, nullptr);
+}
+
+void delugeDealloc(void* address) {
+	GeneralMemoryAllocator::get().dealloc(address);
+}
+
+// Anything which would have frozen the Deluge fails the test instead
+void freezeWithError(char const* errmsg) {
+	FAIL(errmsg);
+}
+}
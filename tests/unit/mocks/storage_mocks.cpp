@@ -0,0 +1,168 @@
+/*
+ * Copyright © 2025 Synthstrom Audible Limited
+ *
+ * This file is part of The Synthstrom Audible Deluge Firmware.
+ *
+ * The Synthstrom Audible Deluge Firmware is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program.
+ * If not, see <https://www.gnu.org/licenses/>.
+ */
+
+// The memory-based halves of FileReader and FileWriter from storage_manager.cpp, so serializers can be tested without
+// a card. Writers always write to memory here.
+
+#include "storage/storage_manager.h"
+#include "util/d_string.h"
+#include <cstdlib>
+
+FirmwareVersion song_firmware_version = FirmwareVersion::current();
+
+namespace AudioEngine {
+void logAudioAction(char const* string, const char* file, int line) {
+}
+} // namespace AudioEngine
+
+// TODO: Instead of these, make the real ones accessible (functions.cpp and d_string.cpp pull in too much)
+int32_t stringToInt(char const* string) {
+	return strtol(string, nullptr, 10);
+}
+
+char miscStringBuffer[kFilenameBufferSize];
+
+void String::clear(bool destructing) {
+}
+
+Error String::set(char const* newChars, int32_t newLength) {
+	return Error::UNSPECIFIED;
+}
+
+Error String::concatenateAtPos(char const* newChars, int32_t pos, int32_t newCharsLength) {
+	return Error::UNSPECIFIED;
+}
+
+FileReader::FileReader() : FileReader(nullptr, 0) {
+}
+
+FileReader::FileReader(char* memBuffer, uint32_t bufLen) {
+	fileClusterBuffer = memBuffer;
+	currentReadBufferEndPos = bufLen;
+	memoryBased = true;
+	callRoutines = false;
+	fileReadBufferCurrentPos = 0;
+}
+
+FileReader::~FileReader() = default;
+
+void FileReader::resetReader() {
+	fileReadBufferCurrentPos = 0;
+	readCount = 0;
+	reachedBufferEnd = false;
+}
+
+bool FileReader::readFileClusterIfNecessary() {
+	if (fileReadBufferCurrentPos >= currentReadBufferEndPos) {
+		reachedBufferEnd = true;
+	}
+	return !reachedBufferEnd;
+}
+
+bool FileReader::readFileCluster() {
+	return true;
+}
+
+bool FileReader::peekChar(char* thisChar) {
+	readFileClusterIfNecessary();
+	if (reachedBufferEnd) {
+		return false;
+	}
+	*thisChar = fileClusterBuffer[fileReadBufferCurrentPos];
+	return true;
+}
+
+bool FileReader::readChar(char* thisChar) {
+	readFileClusterIfNecessary();
+	if (reachedBufferEnd) {
+		return false;
+	}
+	*thisChar = fileClusterBuffer[fileReadBufferCurrentPos];
+	fileReadBufferCurrentPos++;
+	return true;
+}
+
+void FileReader::readDone() {
+	readCount++;
+}
+
+void FileReader::truncate() {
+	currentReadBufferEndPos = fileReadBufferCurrentPos;
+	reachedBufferEnd = true;
+}
+
+FRESULT FileReader::closeWriter() {
+	return FR_OK;
+}
+
+FileWriter::FileWriter() {
+	bufferSize = 32768;
+	writeClusterBuffer = new char[bufferSize];
+	memoryBased = true;
+	callRoutines = false;
+}
+
+FileWriter::FileWriter(bool inMem) : FileWriter() {
+}
+
+FileWriter::~FileWriter() {
+	delete[] writeClusterBuffer;
+}
+
+int32_t FileWriter::bytesWritten() {
+	return fileTotalBytesWritten + fileWriteBufferCurrentPos;
+}
+
+void FileWriter::resetWriter() {
+	fileWriteBufferCurrentPos = 0;
+	fileTotalBytesWritten = 0;
+	fileAccessFailedDuringWrite = false;
+}
+
+FRESULT FileWriter::closeWriter() {
+	return FR_OK;
+}
+
+void FileWriter::writeBlock(uint8_t* block, uint32_t size) {
+	for (uint32_t ix = 0; ix < size; ++ix) {
+		writeByte(block[ix]);
+	}
+}
+
+void FileWriter::writeByte(int8_t b) {
+	if (fileWriteBufferCurrentPos == bufferSize) {
+		fileAccessFailedDuringWrite = true;
+		return;
+	}
+	writeClusterBuffer[fileWriteBufferCurrentPos] = b;
+	fileWriteBufferCurrentPos++;
+}
+
+void FileWriter::writeChars(char const* output) {
+	while (*output) {
+		writeByte(*output);
+		output++;
+	}
+}
+
+Error FileWriter::writeBufferToFile() {
+	return Error::NONE;
+}
+
+Error FileWriter::closeAfterWriting(char const* path, char const* beginningString, char const* endString) {
+	return fileAccessFailedDuringWrite ? Error::WRITE_FAIL : Error::NONE;
+}
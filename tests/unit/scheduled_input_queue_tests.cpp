@@ -0,0 +1,93 @@
+#include "CppUTest/TestHarness.h"
+#include "io/midi/scheduled_input_queue.h"
+
+namespace {
+
+ScheduledInputQueue::Entry noteOn(uint32_t time, uint8_t note) {
+	return {.cable = nullptr, .time = time, .statusType = 0x09, .channel = 0, .data1 = note, .data2 = 100};
+}
+
+ScheduledInputQueue::Entry noteOff(uint32_t time, uint8_t note) {
+	return {.cable = nullptr, .time = time, .statusType = 0x08, .channel = 0, .data1 = note, .data2 = 64};
+}
+
+} // namespace
+
+TEST_GROUP(ScheduledInputQueueTest){};
+
+TEST(ScheduledInputQueueTest, heldBackUntilDue) {
+	ScheduledInputQueue queue;
+	CHECK(queue.push(noteOn(100, 60), 0));
+
+	CHECK(!queue.popDue(99));
+	CHECK_EQUAL(1, *queue.timeTilNext(99));
+	auto input = queue.popDue(100);
+	CHECK(input);
+	CHECK_EQUAL(60, input->data1);
+	CHECK(queue.isEmpty());
+	CHECK(!queue.timeTilNext(100));
+}
+
+TEST(ScheduledInputQueueTest, alreadyDueWithNothingAheadIsTurnedAway) {
+	ScheduledInputQueue queue;
+	CHECK(!queue.push(noteOn(50, 60), 50));
+	CHECK(!queue.push(noteOn(40, 60), 50));
+	CHECK(queue.isEmpty());
+}
+
+TEST(ScheduledInputQueueTest, noteOffNeverOvertakesItsNoteOn) {
+	ScheduledInputQueue queue;
+	CHECK(queue.push(noteOn(100, 60), 0));
+
+	// Read late enough that its own time has already passed - it still has to wait for the note-on
+	CHECK(queue.push(noteOff(40, 60), 60));
+	CHECK(!queue.popDue(60));
+
+	auto first = queue.popDue(100);
+	auto second = queue.popDue(100);
+	CHECK(first);
+	CHECK(second);
+	CHECK_EQUAL(0x09, first->statusType);
+	CHECK_EQUAL(0x08, second->statusType);
+	CHECK_EQUAL(100, second->time);
+}
+
+TEST(ScheduledInputQueueTest, laterTimesAreKept) {
+	ScheduledInputQueue queue;
+	CHECK(queue.push(noteOn(100, 60), 0));
+	CHECK(queue.push(noteOff(150, 60), 0));
+
+	CHECK(queue.popDue(100));
+	CHECK(!queue.popDue(149));
+	CHECK_EQUAL(150, queue.popDue(150)->time);
+}
+
+TEST(ScheduledInputQueueTest, wrapsRoundTheSampleTimer) {
+	ScheduledInputQueue queue;
+	CHECK(queue.push(noteOn(0xFFFFFFF0, 60), 0xFFFFFF00));
+	CHECK(queue.push(noteOff(0x10, 60), 0xFFFFFF00));
+
+	CHECK(queue.popDue(0xFFFFFFF0));
+	CHECK(!queue.popDue(0x0F));
+	CHECK(queue.popDue(0x10));
+}
+
+TEST(ScheduledInputQueueTest, fullMakesRoomFromTheOldest) {
+	ScheduledInputQueue queue;
+	for (uint32_t i = 0; i < ScheduledInputQueue::kSize; i++) {
+		CHECK(!queue.isFull());
+		CHECK(queue.push(noteOn(100 + i, i), 0));
+	}
+	CHECK(queue.isFull());
+
+	CHECK_EQUAL(0, queue.popOldest().data1);
+	CHECK(queue.push(noteOff(100, 0), 0));
+
+	for (uint32_t i = 1; i < ScheduledInputQueue::kSize; i++) {
+		CHECK_EQUAL(i, queue.popDue(1000)->data1);
+	}
+	auto last = queue.popDue(1000);
+	CHECK_EQUAL(0x08, last->statusType);
+	CHECK_EQUAL(100 + ScheduledInputQueue::kSize - 1, last->time);
+	CHECK(queue.isEmpty());
+}
@@ -0,0 +1,349 @@
+// Task scheduler simulator
+//
+// Registers the firmware's task set - FirmwareTasks::kTasks, as registerTasks() in deluge.cpp does, with the audio
+// routine's timing for the chosen latency tier as AudioEngine::setLatencyTier() sets it - with the real TaskManager,
+// and runs it for a given number of virtual seconds on the mock timer. Each task just passes mock time, drawn from a
+// run time profile: the p50/p99/max duration a task reports in its stats. The defaults below are rough guesses; for
+// real numbers, capture them from a unit playing a heavy song and pass the file in (see loadProfiles()). The audio
+// routine's time instead depends on how many samples have built up since it last rendered, and the cluster loader now
+// and then yields while it waits for the card, as it does on the hardware.
+//
+// Only the tasks that declare a max latency - the ones something audible depends on - have deadlines. One misses its
+// deadline when it starts later than its target time between calls plus its max latency after it last started, as in
+// Task::getDeadline(), and the TaskManager's reportDeadlineMiss() blames the miss, as the firmware's does. The audio
+// routine underruns when it starts more than its max time between calls after it last started - by then the output
+// buffer has run dry. The report gives each task's calls, CPU use, time between starts, and misses suffered and caused.
+//
+// The exit code says whether every task got to run and audio never underran, so ctest can run a short simulation as a
+// regression check on scheduling changes.
+//
+// Usage: SchedulerSimulator [virtualSeconds] [priority|edf] [audioLoadPercent] [seed] [auto|low|balanced|efficient]
+//                           [profileFile]
+
+#include "OSLikeStuff/scheduler_api.h"
+#include "OSLikeStuff/task_scheduler/task_scheduler.h"
+#include "firmware_tasks.h"
+#include "mocks/timer_mocks.h"
+#include <array>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <utility>
+
+uint8_t currentlyAccessingCard = false;
+uint32_t usbLock = false;
+bool sdRoutineLock = false;
+
+extern TaskManager taskManager;
+
+namespace {
+
+using namespace FirmwareTasks;
+
+constexpr int32_t kOutputBufferSamples = SSI_TX_BUFFER_NUM_SAMPLES;
+
+// Run times in microseconds
+struct Profile {
+	double p50;
+	double p99;
+	double max;
+};
+
+enum class Model {
+	FIXED_PROFILE,
+	AUDIO_ROUTINE,
+	CLUSTER_LOADER,
+};
+
+struct SimulatedTask {
+	FirmwareTask spec;
+	Profile profile;
+	Model model{Model::FIXED_PROFILE};
+
+	TaskID id{-1};
+	uint64_t timesCalled{0};
+	double busyTime{0};
+	double lastStart{-1};
+	Histogram timeBetweenStarts;
+	uint32_t deadlinesMissed{0};
+	uint32_t deadlineMissesCaused{0};
+};
+
+// Indexed as FirmwareTasks::kTasks
+constexpr std::array<Profile, kNumTasks> kDefaultProfiles{{
+    {},
+    {5, 20, 60},
+    {2, 10, 50},
+    {5, 30, 200},
+    {5, 40, 300},
+    {3, 20, 50},
+    {5, 50, 500},
+    {10, 60, 400},
+    {20, 800, 2000},
+    {2, 10, 1000},
+    {10, 100, 1000},
+    {5, 20, 100},
+    {5, 50, 500},
+    {5, 30, 100},
+    {50, 400, 1200},
+    {5, 50, 1500},
+}};
+
+std::array<SimulatedTask, kNumTasks> tasks;
+
+double audioLoad = 0.5;
+double lastAudioRender = 0;
+uint32_t audioUnderruns = 0;
+
+// Deterministic, so every run of a given configuration schedules the same way
+uint32_t randomState;
+double nextRandom() {
+	randomState = randomState * 1664525 + 1013904223;
+	return (randomState >> 8) / double(1 << 24);
+}
+
+// Half the runs come in at up to the p50, most of the rest up to the p99, and one in a hundred up to the max
+double drawRunTime(Profile const& profile) {
+	double u = nextRandom();
+	double from;
+	double to;
+	if (u < 0.5) {
+		from = profile.p50 * 0.5;
+		to = profile.p50;
+		u = u / 0.5;
+	}
+	else if (u < 0.99) {
+		from = profile.p50;
+		to = profile.p99;
+		u = (u - 0.5) / 0.49;
+	}
+	else {
+		from = profile.p99;
+		to = profile.max;
+		u = (u - 0.99) / 0.01;
+	}
+	return (from + (to - from) * u) / 1000000.;
+}
+
+double cardReadDoneAt;
+
+// Returns how long the task itself ran for, not counting anything that ran while it yielded
+double runModel(SimulatedTask& task) {
+	switch (task.model) {
+	case Model::AUDIO_ROUTINE: {
+		double samples = (getSystemTime() - lastAudioRender) * kSampleRate;
+		lastAudioRender = getSystemTime();
+		double runTime = std::min<double>(samples, kOutputBufferSamples) * audioLoad / kSampleRate;
+		passMockTime(runTime);
+		return runTime;
+	}
+
+	case Model::CLUSTER_LOADER: {
+		double runTime = drawRunTime(task.profile);
+		passMockTime(runTime);
+		// One time in 20 there's a cluster to read, and the loader yields to everything that doesn't need the card
+		// until it's arrived
+		if (nextRandom() < 0.05) {
+			currentlyAccessingCard = true;
+			cardReadDoneAt = getSystemTime() + 0.0005 + nextRandom() * 0.0015;
+			yield([]() { return getSystemTime() >= cardReadDoneAt; });
+			currentlyAccessingCard = false;
+		}
+		return runTime;
+	}
+
+	default:
+		double runTime = drawRunTime(task.profile);
+		passMockTime(runTime);
+		return runTime;
+	}
+}
+
+// The TaskManager's own counts get reset whenever it prints its stats, so see which one reportDeadlineMiss() added to
+// and keep count here
+void reportMiss(SimulatedTask& task) {
+	std::array<uint32_t, kNumTasks> causedBefore;
+	TaskStatsSummary stats;
+	for (size_t i = 0; i < kNumTasks; i++) {
+		getNextTaskStats(tasks[i].id - 1, &stats);
+		causedBefore[i] = stats.deadlineMissesCaused;
+	}
+	reportDeadlineMiss(task.id, task.lastStart);
+	for (size_t i = 0; i < kNumTasks; i++) {
+		getNextTaskStats(tasks[i].id - 1, &stats);
+		tasks[i].deadlineMissesCaused += stats.deadlineMissesCaused - causedBefore[i];
+	}
+}
+
+void runTask(SimulatedTask& task) {
+	// routine_() does nothing until there are at least 10 samples to render - and doesn't count that as a call
+	if (task.model == Model::AUDIO_ROUTINE && (getSystemTime() - lastAudioRender) * kSampleRate <= 10) {
+		ignoreForStats();
+		passMockTime(0.000002);
+		return;
+	}
+
+	double start = getSystemTime();
+	if (task.lastStart >= 0) {
+		double sinceLastStart = start - task.lastStart;
+		task.timeBetweenStarts.add(Time(sinceLastStart));
+		if (task.spec.maxLatency && sinceLastStart > task.spec.targetTimeBetweenCalls + task.spec.maxLatency) {
+			task.deadlinesMissed++;
+			reportMiss(task);
+		}
+		if (task.model == Model::AUDIO_ROUTINE && sinceLastStart > task.spec.maxTimeBetweenCalls) {
+			audioUnderruns++;
+		}
+	}
+	task.lastStart = start;
+
+	double runTime = runModel(task);
+	task.timesCalled++;
+	task.busyTime += runTime;
+}
+
+template <size_t... I>
+constexpr std::array<TaskHandle, sizeof...(I)> makeHandles(std::index_sequence<I...>) {
+	return {[]() { runTask(tasks[I]); }...};
+}
+constexpr auto handles = makeHandles(std::make_index_sequence<kNumTasks>());
+
+// Trim trailing whitespace, including a carriage return from a capture made on Windows
+void trimEnd(char* string) {
+	size_t length = strlen(string);
+	while (length && (string[length - 1] == ' ' || string[length - 1] == '\r' || string[length - 1] == '\n')) {
+		string[--length] = 0;
+	}
+}
+
+// Reads run time profiles, in microseconds, one task per line - either as printStats() prints them ("... Dur:
+// p50/p99/max us ... Task: name", with SCHEDULER_DETAILED_STATS on), or as "p50 p99 max name", for the durationP50,
+// durationP99 and durationMax the debug sysex task stats reply (subcommand 3) gives. Lines for tasks that aren't in
+// the firmware's set, and any other lines, are skipped.
+bool loadProfiles(const char* path) {
+	FILE* file = fopen(path, "r");
+	if (!file) {
+		return false;
+	}
+	char line[512];
+	int32_t numLoaded = 0;
+	while (fgets(line, sizeof(line), file)) {
+		trimEnd(line);
+		Profile profile;
+		const char* name = nullptr;
+		int nameStart = 0;
+		char const* duration = strstr(line, "Dur:");
+		char const* taskName = strstr(line, "Task: ");
+		if (duration && taskName
+		    && sscanf(duration, "Dur: %lf/%lf/%lf", &profile.p50, &profile.p99, &profile.max) == 3) {
+			name = taskName + strlen("Task: ");
+		}
+		else if (sscanf(line, "%lf %lf %lf %n", &profile.p50, &profile.p99, &profile.max, &nameStart) == 3
+		         && nameStart) {
+			name = line + nameStart;
+		}
+		if (!name) {
+			continue;
+		}
+		for (SimulatedTask& task : tasks) {
+			if (!strcmp(task.spec.name, name)) {
+				task.profile = profile;
+				numLoaded++;
+			}
+		}
+	}
+	fclose(file);
+	printf("Loaded %d run time profiles from %s\n", numLoaded, path);
+	return true;
+}
+
+bool parseLatencyTier(const char* name, AudioLatencyTier* tier) {
+	constexpr std::array<const char*, kNumAudioLatencyTiers> kNames{"auto", "low", "balanced", "efficient"};
+	for (size_t i = 0; i < kNames.size(); i++) {
+		if (!strcmp(name, kNames[i])) {
+			*tier = static_cast<AudioLatencyTier>(i);
+			return true;
+		}
+	}
+	return false;
+}
+
+void printReport(double seconds) {
+	printf("%-30s %9s %6s %10s %10s %8s %8s\n", "task", "calls", "CPU%", "p99 gap", "max gap", "missed", "caused");
+	double totalBusy = 0;
+	for (SimulatedTask const& task : tasks) {
+		totalBusy += task.busyTime;
+		printf("%-30s %9llu %6.2f %8.3fms %8.3fms ", task.spec.name, (unsigned long long)task.timesCalled,
+		       100. * task.busyTime / seconds, 1000. * double(Time(task.timeBetweenStarts.getPercentile(99))),
+		       1000. * double(Time(task.timeBetweenStarts.max)));
+		if (task.spec.maxLatency) {
+			printf("%8u", task.deadlinesMissed);
+		}
+		else {
+			printf("%8s", "-");
+		}
+		printf(" %8u\n", task.deadlineMissesCaused);
+	}
+	printf("Tasks busy %.2f%% of the time, audio underran %u times\n", 100. * totalBusy / seconds, audioUnderruns);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+	double seconds = (argc > 1) ? atof(argv[1]) : 60;
+	bool earliestDeadlineFirst = (argc > 2) && !strcmp(argv[2], "edf");
+	audioLoad = ((argc > 3) ? atof(argv[3]) : 50) / 100.;
+	randomState = (argc > 4) ? atoi(argv[4]) : 1;
+	AudioLatencyTier latencyTier = AudioLatencyTier::AUTO;
+	bool policyKnown = (argc <= 2) || earliestDeadlineFirst || !strcmp(argv[2], "priority");
+	bool tierKnown = (argc <= 5) || parseLatencyTier(argv[5], &latencyTier);
+	if (seconds <= 0 || audioLoad < 0 || audioLoad > 1 || !policyKnown || !tierKnown) {
+		printf("Usage: %s [virtualSeconds] [priority|edf] [audioLoadPercent] [seed] [auto|low|balanced|efficient] "
+		       "[profileFile]\n",
+		       argv[0]);
+		return 2;
+	}
+
+	for (size_t i = 0; i < kNumTasks; i++) {
+		tasks[i].spec = kTasks[i];
+		tasks[i].profile = kDefaultProfiles[i];
+	}
+	tasks[AUDIO_ROUTINE].model = Model::AUDIO_ROUTINE;
+	tasks[LOAD_CLUSTERS].model = Model::CLUSTER_LOADER;
+	tasks[AUDIO_ROUTINE].spec = audioRoutine(latencyTier);
+
+	if (argc > 6 && !loadProfiles(argv[6])) {
+		printf("Couldn't read %s\n", argv[6]);
+		return 2;
+	}
+
+	printf("%.0f virtual seconds, %s scheduling, audio using %.0f%% of the CPU, rendering %.3fms at a time at most\n",
+	       seconds, earliestDeadlineFirst ? "earliest deadline first" : "priority", audioLoad * 100.,
+	       1000. * tasks[AUDIO_ROUTINE].spec.maxTimeBetweenCalls);
+
+	setEarliestDeadlineFirstScheduling(earliestDeadlineFirst);
+	for (size_t i = 0; i < kNumTasks; i++) {
+		tasks[i].id = add(static_cast<Index>(i), handles[i]);
+	}
+	// as AudioEngine::setLatencyTier()
+	FirmwareTask const& audio = tasks[AUDIO_ROUTINE].spec;
+	setTimeBetweenCallsForTask(tasks[AUDIO_ROUTINE].id, audio.backOffTime, audio.targetTimeBetweenCalls,
+	                           audio.maxTimeBetweenCalls);
+	setMaxLatencyForTask(tasks[AUDIO_ROUTINE].id, audio.maxLatency);
+	taskManager.start(seconds);
+
+	printReport(seconds);
+
+	bool ok = true;
+	for (SimulatedTask const& task : tasks) {
+		if (!task.timesCalled) {
+			printf("FAIL: %s never ran\n", task.spec.name);
+			ok = false;
+		}
+	}
+	if (audioUnderruns) {
+		printf("FAIL: audio underran\n");
+		ok = false;
+	}
+	return ok ? 0 : 1;
+}
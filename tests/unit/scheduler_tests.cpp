@@ -1,5 +1,6 @@
 #include "CppUTest/TestHarness.h"
 #include "CppUTestExt/MockSupport.h"
+#include "OSLikeStuff/task_scheduler/budgeted_section.cpp"
 #include "OSLikeStuff/task_scheduler/task_scheduler.cpp"
 #include "OSLikeStuff/task_scheduler/task_scheduler_c_api.cpp"
 #include "cstdint"
@@ -277,6 +278,161 @@ TEST(Scheduler, overSchedule) {
 	taskManager.start(0.01);
 	mock().checkExpectations();
 };
+// A task that's been kept waiting too long makes whoever held it up pay
+TaskID victimID = -1;
+Time victimLastCall;
+void victim() {
+	mock().actualCall("victim");
+	Time now = getSystemTime();
+	if (now - victimLastCall > Time(0.0015)) {
+		reportDeadlineMiss(victimID, victimLastCall);
+	}
+	victimLastCall = now;
+	passMockTime(0.00005);
+}
+
+TEST(Scheduler, deadlineMissIsBlamedOnLongestTask) {
+	mock().clear();
+	mock().expectNCalls(1, "sleep_2ms");
+	victimLastCall = 0;
+	victimID = addRepeatingTask(victim, 0, 0.0005, 0.001, 0.001, "victim", RESOURCE_NONE);
+	addRepeatingTask(sleep_50ns, 5, 0.001, 0.001, 0.002, "blameless", RESOURCE_NONE);
+	TaskID culprit = addOnceTask(sleep_2ms, 10, 0.003, "culprit", RESOURCE_NONE);
+	taskManager.start(0.01);
+
+	// the culprit's once task is gone, so it can't be counted against its slot - but nothing else gets the blame
+	TaskStatsSummary stats;
+	for (TaskID id = getNextTaskStats(-1, &stats); id >= 0; id = getNextTaskStats(id, &stats)) {
+		CHECK(id != culprit);
+		CHECK_EQUAL(0, stats.deadlineMissesCaused);
+	}
+
+	// a repeating task keeps its count
+	mock().clear();
+	culprit = addRepeatingTask(sleep_2ms, 10, 0.003, 0.003, 0.01, "repeating culprit", RESOURCE_NONE);
+	taskManager.start(0.01);
+	getNextTaskStats(culprit - 1, &stats);
+	STRCMP_EQUAL("repeating culprit", stats.name);
+	CHECK(stats.deadlineMissesCaused > 0);
+}
+
+// A long task that runs the victim itself, late, is still mid-run when the victim reports - it's the one to blame,
+// not the victim's own run that it's nested in
+TaskID longCallerID = -1;
+void longCaller() {
+	passMockTime(0.002);
+	taskManager.runTask(victimID);
+}
+
+TEST(Scheduler, deadlineMissIsBlamedOnNestingCaller) {
+	mock().clear();
+	victimLastCall = getSystemTime();
+	victimID = addRepeatingTask(victim, 0, 0.0005, 0.001, 0.001, "victim", RESOURCE_NONE);
+	addRepeatingTask(sleep_50ns, 5, 0.001, 0.001, 0.002, "blameless", RESOURCE_NONE);
+	longCallerID = addRepeatingTask(longCaller, 10, 0.003, 0.003, 0.01, "long caller", RESOURCE_NONE);
+	taskManager.start(0.01);
+
+	TaskStatsSummary stats;
+	for (TaskID id = getNextTaskStats(-1, &stats); id >= 0; id = getNextTaskStats(id, &stats)) {
+		if (id == longCallerID) {
+			CHECK(stats.deadlineMissesCaused > 0);
+		}
+		else {
+			CHECK_EQUAL(0, stats.deadlineMissesCaused);
+		}
+	}
+}
+
+TEST(Scheduler, histogramPercentiles) {
+	Histogram histogram;
+	for (int i = 0; i < 98; i++) {
+		histogram.add(Time(0.00001));
+	}
+	histogram.add(Time(0.0001));
+	histogram.add(Time(0.001));
+
+	// to within the bucket size
+	CHECK(histogram.getPercentile(50) >= Time(0.00001));
+	CHECK(histogram.getPercentile(50) < Time(0.000015));
+	CHECK(histogram.getPercentile(99) >= Time(0.0001));
+	CHECK(histogram.getPercentile(99) < Time(0.00015));
+	CHECK(histogram.getPercentile(100) == Time(0.001));
+	CHECK(histogram.max == Time(0.001));
+
+	histogram.reset();
+	CHECK(histogram.getPercentile(50) == Time(0));
+}
+
+// A low priority task with a tight deadline doesn't have to wait behind a high priority one that's always due
+TEST(Scheduler, earliestDeadlineFirst) {
+	mock().clear();
+	addRepeatingTask(sleep_2ms, 0, 0, 0.001, 0.005, "always due", RESOURCE_NONE);
+	TaskID tight = addRepeatingTask(sleep_50ns, 10, 0.0001, 0.001, 0.01, "tight deadline", RESOURCE_NONE);
+	setMaxLatencyForTask(tight, 0.0005);
+	taskManager.start(0.02);
+	TaskStatsSummary stats;
+	getNextTaskStats(tight - 1, &stats);
+	uint32_t callsByPriority = stats.timesCalled;
+
+	taskManager = TaskManager();
+	mock().clear();
+	setEarliestDeadlineFirstScheduling(true);
+	addRepeatingTask(sleep_2ms, 0, 0, 0.001, 0.005, "always due", RESOURCE_NONE);
+	tight = addRepeatingTask(sleep_50ns, 10, 0.0001, 0.001, 0.01, "tight deadline", RESOURCE_NONE);
+	setMaxLatencyForTask(tight, 0.0005);
+	taskManager.start(0.02);
+	getNextTaskStats(tight - 1, &stats);
+
+	// once after every run of the other task, rather than only when it hits its max time between calls
+	CHECK(stats.timesCalled >= 8);
+	CHECK(stats.timesCalled > callsByPriority * 2);
+	CHECK(stats.latencyMax <= 2100);
+}
+
+TEST(Scheduler, setTimeBetweenCalls) {
+	mock().clear();
+	mock().expectNCalls(0.01 / 0.001 + 0.01 / 0.002, "sleep_50ns");
+	TaskID id = addRepeatingTask(sleep_50ns, 0, 0.001, 0.001, 0.001, "sleep_50ns", RESOURCE_NONE);
+	taskManager.start(0.0095);
+	// half as often from the next call on
+	setTimeBetweenCallsForTask(id, 0.002, 0.002, 0.002);
+	taskManager.start(0.0095);
+	mock().checkExpectations();
+}
+
+TEST(Scheduler, budgetedSectionYieldsOnceOverBudget) {
+	static int32_t timesYielded;
+	timesYielded = 0;
+	BudgetedSection section("test", 1, 0.001, []() { timesYielded++; });
+	for (int32_t i = 0; i < 20; i++) {
+		passMockTime(0.0003);
+		section.check();
+	}
+	// every fourth time round, 1.2ms in
+	CHECK_EQUAL(5, timesYielded);
+	CHECK(section.getLongestStretch() < Time(0.0013));
+}
+
+TEST(Scheduler, budgetedSectionCountsTasksRunInsideIt) {
+	static int32_t timesYielded;
+	timesYielded = 0;
+	mock().clear();
+	mock().expectNCalls(6, "sleep_20ns");
+	TaskID other = addRepeatingTask(sleep_20ns, 0, 0.001, 0.001, 0.001, "sleep_20ns", RESOURCE_NONE);
+	BudgetedSection section("test", 1, 0.001, []() { timesYielded++; });
+	for (int32_t i = 0; i < 20; i++) {
+		passMockTime(0.0003);
+		// as if this loop called AudioEngine::routineWithClusterLoading() itself every third time round
+		if (i % 3 == 2) {
+			runTask(other);
+		}
+		section.check();
+	}
+	mock().checkExpectations();
+	CHECK_EQUAL(0, timesYielded);
+	CHECK(section.getLongestStretch() < Time(0.001));
+}
+
 TEST(Scheduler, yield_with_lock) {
 	mock().clear();
 	// will be locked out by the usb lock
@@ -0,0 +1,251 @@
+#include "CppUTest/TestHarness.h"
+#include "storage/sysex_write_stream.h"
+#include "util/pack.h"
+#include <algorithm>
+#include <cstring>
+#include <deque>
+#include <set>
+#include <vector>
+
+using namespace smSysex;
+
+namespace {
+
+// A streamed write block, as the client packs it into a "write" message
+struct WriteMessage {
+	uint32_t addr;
+	uint32_t crc;
+	bool ack;
+	std::vector<uint8_t> packed;
+};
+
+// The "pos" and "err" of a "^write" reply
+struct WriteReply {
+	uint32_t pos;
+	bool rejected;
+};
+
+// Stands in for the MIDI cable, both ways. Messages arrive in the order they were sent, but the cable can be told to
+// drop or corrupt particular ones on the way to the device.
+struct LoopbackCable {
+	std::deque<WriteMessage> toDevice;
+	std::deque<WriteReply> toHost;
+	std::set<int32_t> messagesToDrop;
+	std::set<int32_t> messagesToCorrupt;
+	int32_t numMessagesSent = 0;
+
+	void send(WriteMessage message) {
+		int32_t n = numMessagesSent++;
+		if (messagesToDrop.contains(n)) {
+			return;
+		}
+		if (messagesToCorrupt.contains(n)) {
+			message.packed[message.packed.size() / 2] ^= 0x01;
+		}
+		toDevice.push_back(std::move(message));
+	}
+};
+
+// The device end - what smSysex::writeBlock() does with a streamed write, writing into memory rather than a file
+struct Device {
+	WriteStream stream;
+	std::vector<uint8_t> file;
+	int32_t numBlocksWritten = 0;
+
+	void receive(WriteMessage const& message, LoopbackCable& cable) {
+		uint8_t block[kWriteBlockMax];
+		uint32_t size = unpack_7bit_to_8bit(block, kWriteBlockMax, const_cast<uint8_t*>(message.packed.data()),
+		                                    message.packed.size());
+		bool crcMatches = (blockCRC(block, size) == message.crc);
+
+		switch (stream.receive(message.addr, crcMatches, message.ack)) {
+		case StreamedWrite::WRITE:
+		case StreamedWrite::WRITE_AND_ACK:
+			file.resize(std::max<size_t>(file.size(), message.addr + size));
+			memcpy(&file[message.addr], block, size);
+			stream.wrote(size);
+			numBlocksWritten++;
+			if (message.ack) {
+				cable.toHost.push_back({stream.getExpectedPos(), false});
+			}
+			break;
+		case StreamedWrite::REJECT_AND_REPLY:
+			cable.toHost.push_back({stream.getExpectedPos(), true});
+			break;
+		case StreamedWrite::REJECT_SILENTLY:
+			break;
+		}
+	}
+};
+
+// The client end - keeps up to kTransferWindow blocks in flight, asking for an ack every half window and on the last
+// block, going back to wherever a rejection says, and starting again from the last ack if it hears nothing at all
+struct Host {
+	std::vector<uint8_t> const& data;
+	uint32_t blockSize;
+	uint32_t nextAddr = 0;
+	uint32_t ackedPos = 0;
+	int32_t numTimeouts = 0;
+
+	bool done() const { return ackedPos >= data.size(); }
+
+	bool windowFull() const { return nextAddr - ackedPos >= kTransferWindow * blockSize; }
+
+	void sendWhatWindowAllows(LoopbackCable& cable) {
+		while (nextAddr < data.size() && !windowFull()) {
+			uint32_t size = std::min<uint32_t>(blockSize, data.size() - nextAddr);
+			uint32_t blockNum = nextAddr / blockSize;
+			bool isLast = (nextAddr + size == data.size());
+
+			WriteMessage message;
+			message.addr = nextAddr;
+			message.crc = blockCRC(&data[nextAddr], size);
+			message.ack = isLast || (blockNum % (kTransferWindow / 2)) == (kTransferWindow / 2) - 1;
+			message.packed.resize(size + (size + 6) / 7);
+			int32_t packedSize = pack_8bit_to_7bit(message.packed.data(), message.packed.size(),
+			                                       const_cast<uint8_t*>(&data[nextAddr]), size);
+			message.packed.resize(packedSize);
+			cable.send(std::move(message));
+
+			nextAddr += size;
+		}
+	}
+
+	void receive(WriteReply const& reply) {
+		ackedPos = reply.pos;
+		if (reply.rejected || nextAddr < ackedPos) {
+			nextAddr = reply.pos;
+		}
+	}
+
+	// Nothing in flight either way, and we're not finished - so something we're waiting on went missing
+	void timeOut() {
+		nextAddr = ackedPos;
+		numTimeouts++;
+	}
+};
+
+std::vector<uint8_t> makeFile(size_t size) {
+	std::vector<uint8_t> data(size);
+	uint32_t state = 12345;
+	for (uint8_t& byte : data) {
+		state = state * 1664525 + 1013904223;
+		byte = state >> 24;
+	}
+	return data;
+}
+
+// Runs the transfer to completion, or gives up after plenty of steps. Returns the number of replies the host got.
+int32_t transfer(Host& host, Device& device, LoopbackCable& cable) {
+	int32_t numReplies = 0;
+	for (int32_t step = 0; step < 100000 && !host.done(); step++) {
+		host.sendWhatWindowAllows(cable);
+
+		if (!cable.toDevice.empty()) {
+			device.receive(cable.toDevice.front(), cable);
+			cable.toDevice.pop_front();
+		}
+
+		while (!cable.toHost.empty()) {
+			host.receive(cable.toHost.front());
+			cable.toHost.pop_front();
+			numReplies++;
+		}
+
+		if (cable.toDevice.empty() && !host.done() && (host.windowFull() || host.nextAddr >= host.data.size())) {
+			host.timeOut();
+		}
+	}
+	return numReplies;
+}
+
+} // namespace
+
+TEST_GROUP(SysexWriteStreamTest) {
+	void setup() { init_crc_table(); }
+};
+
+TEST(SysexWriteStreamTest, outOfOrderBlockRejectedOnceThenSilently) {
+	WriteStream stream;
+	stream.reset(0);
+
+	CHECK(stream.receive(0, true, false) == StreamedWrite::WRITE);
+	stream.wrote(100);
+
+	// Block at 100 went missing
+	CHECK(stream.receive(200, true, false) == StreamedWrite::REJECT_AND_REPLY);
+	CHECK_EQUAL(100, stream.getExpectedPos());
+	CHECK(stream.receive(300, true, false) == StreamedWrite::REJECT_SILENTLY);
+	// But if the client asks, it gets told again
+	CHECK(stream.receive(300, true, true) == StreamedWrite::REJECT_AND_REPLY);
+
+	// And once it's gone back, we're streaming again
+	CHECK(stream.receive(100, true, true) == StreamedWrite::WRITE_AND_ACK);
+	stream.wrote(100);
+	CHECK_EQUAL(200, stream.getExpectedPos());
+}
+
+TEST(SysexWriteStreamTest, badCRCRejected) {
+	WriteStream stream;
+	stream.reset(500);
+
+	CHECK(stream.receive(500, false, false) == StreamedWrite::REJECT_AND_REPLY);
+	CHECK_EQUAL(500, stream.getExpectedPos());
+	CHECK(stream.receive(600, true, false) == StreamedWrite::REJECT_SILENTLY);
+	CHECK(stream.receive(500, true, false) == StreamedWrite::WRITE);
+}
+
+TEST(SysexWriteStreamTest, cleanTransferOnlyAcksEveryHalfWindow) {
+	std::vector<uint8_t> data = makeFile(kWriteBlockMax * 40 + 123);
+	LoopbackCable cable;
+	Device device;
+	Host host{data, kWriteBlockMax};
+
+	int32_t numReplies = transfer(host, device, cable);
+
+	CHECK(host.done());
+	CHECK(device.file == data);
+	CHECK_EQUAL(41, device.numBlocksWritten);
+	CHECK_EQUAL(0, host.numTimeouts);
+	CHECK(numReplies <= 41 / (kTransferWindow / 2) + 1);
+}
+
+TEST(SysexWriteStreamTest, recoversFromDroppedMessages) {
+	std::vector<uint8_t> data = makeFile(kWriteBlockMax * 30);
+	LoopbackCable cable;
+	cable.messagesToDrop = {3, 4, 17, 29};
+	Device device;
+	Host host{data, kWriteBlockMax};
+
+	transfer(host, device, cable);
+
+	CHECK(host.done());
+	CHECK(device.file == data);
+}
+
+TEST(SysexWriteStreamTest, recoversFromCorruptedMessages) {
+	std::vector<uint8_t> data = makeFile(kWriteBlockMax * 30 + 7);
+	LoopbackCable cable;
+	cable.messagesToCorrupt = {0, 10, 11, 25};
+	Device device;
+	Host host{data, kWriteBlockMax};
+
+	transfer(host, device, cable);
+
+	CHECK(host.done());
+	CHECK(device.file == data);
+}
+
+TEST(SysexWriteStreamTest, recoversFromDroppedLastBlock) {
+	std::vector<uint8_t> data = makeFile(kWriteBlockMax * 8);
+	LoopbackCable cable;
+	cable.messagesToDrop = {7};
+	Device device;
+	Host host{data, kWriteBlockMax};
+
+	transfer(host, device, cable);
+
+	CHECK(host.done());
+	CHECK(device.file == data);
+	CHECK(host.numTimeouts > 0);
+}
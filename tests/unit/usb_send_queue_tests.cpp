@@ -0,0 +1,246 @@
+#include "CppUTest/TestHarness.h"
+#include "io/midi/usb_send_queue.h"
+#include <vector>
+
+namespace {
+
+constexpr uint32_t kClock = 0xF8'0F;
+
+uint32_t noteOn(int32_t cable, uint8_t note) {
+	return (100u << 24) | ((uint32_t)note << 16) | (0x90u << 8) | (cable << 4) | 0x9;
+}
+
+uint32_t cc(int32_t cable, uint8_t value) {
+	return ((uint32_t)value << 24) | (74u << 16) | (0xB0u << 8) | (cable << 4) | 0xB;
+}
+
+// A sysex continuation packet, numbered so the order can be checked
+uint32_t sysex(int32_t cable, int32_t n) {
+	return ((uint32_t)(n & 127) << 24) | ((uint32_t)((n >> 7) & 127) << 16) | (0x01u << 8) | (cable << 4) | 0x4;
+}
+
+// Stands in for the USB host controller and the devices on the hub: takes one transfer at a time, of up to
+// kPacketsPerTransfer packets, to whichever device the scheduler picks - the way usbSendCompleteAsHost() does
+struct FakeHub {
+	static constexpr int32_t kNumDevices = 5;
+	static constexpr int32_t kPacketsPerTransfer = 2;
+
+	USBMIDISendQueue devices[kNumDevices];
+	std::vector<uint32_t> received[kNumDevices];
+	int32_t lastDevice = 0;
+
+	FakeHub() {
+		for (auto& device : devices) {
+			device.clear();
+		}
+	}
+
+	// @returns the device that got the transfer, or -1 if there was nothing to send
+	int32_t transfer() {
+		USBMIDISendQueue const* queues[kNumDevices];
+		for (int32_t d = 0; d < kNumDevices; d++) {
+			queues[d] = &devices[d];
+		}
+		int32_t d = pickNextUSBMIDIDeviceToSendTo(queues, kNumDevices, lastDevice);
+		if (d < 0) {
+			return -1;
+		}
+		uint32_t packets[kPacketsPerTransfer];
+		int32_t num = devices[d].pop(packets, kPacketsPerTransfer);
+		received[d].insert(received[d].end(), packets, packets + num);
+		lastDevice = d;
+		return d;
+	}
+};
+
+} // namespace
+
+TEST_GROUP(USBSendQueueTest){};
+
+TEST(USBSendQueueTest, realtimeGoesFirst) {
+	USBMIDISendQueue queue;
+	queue.clear();
+	queue.push(cc(0, 1));
+	queue.push(cc(0, 2));
+	queue.push(kClock);
+
+	uint32_t packets[4];
+	CHECK_EQUAL(3, queue.pop(packets, 4));
+	CHECK_EQUAL(kClock, packets[0]);
+	CHECK_EQUAL(cc(0, 1), packets[1]);
+	CHECK_EQUAL(cc(0, 2), packets[2]);
+	CHECK(queue.isEmpty());
+}
+
+TEST(USBSendQueueTest, cablesTakeTurns) {
+	USBMIDISendQueue queue;
+	queue.clear();
+	for (int32_t i = 0; i < 100; i++) {
+		queue.push(cc(0, i));
+	}
+	queue.push(noteOn(1, 60));
+	queue.push(noteOn(1, 64));
+
+	uint32_t packets[4];
+	CHECK_EQUAL(4, queue.pop(packets, 4));
+	CHECK_EQUAL(cc(0, 0), packets[0]);
+	CHECK_EQUAL(noteOn(1, 60), packets[1]);
+	CHECK_EQUAL(cc(0, 1), packets[2]);
+	CHECK_EQUAL(noteOn(1, 64), packets[3]);
+
+	// And each cable's packets stay in order
+	CHECK_EQUAL(2, queue.pop(packets, 2));
+	CHECK_EQUAL(cc(0, 2), packets[0]);
+	CHECK_EQUAL(cc(0, 3), packets[1]);
+}
+
+TEST(USBSendQueueTest, fullCableReportsBackPressure) {
+	USBMIDISendQueue queue;
+	queue.clear();
+	CHECK_EQUAL(USB_MIDI_CABLE_QUEUE_LEN, queue.getSpace(0));
+	for (int32_t i = 0; i < USB_MIDI_CABLE_QUEUE_LEN; i++) {
+		CHECK(queue.push(cc(0, i & 127)));
+	}
+	CHECK_EQUAL(0, queue.getSpace(0));
+	CHECK(!queue.push(cc(0, 0)));
+
+	// Other cables, and real-time, still have room
+	CHECK_EQUAL(USB_MIDI_CABLE_QUEUE_LEN, queue.getSpace(1));
+	CHECK(queue.push(noteOn(1, 60)));
+	CHECK(queue.push(kClock));
+	CHECK_EQUAL(USB_MIDI_CABLE_QUEUE_LEN + 2, queue.getNumQueued());
+}
+
+TEST(USBSendQueueTest, chattyDeviceDoesntHoldUpClockToOthers) {
+	FakeHub hub;
+
+	// Device 0 has a big backlog of CCs
+	for (int32_t i = 0; i < 200; i++) {
+		hub.devices[0].push(cc(0, i & 127));
+	}
+	hub.transfer();
+	hub.transfer();
+
+	// Then the clock goes out to everything
+	for (auto& device : hub.devices) {
+		device.push(kClock);
+	}
+
+	// Every device gets its clock in the next round of transfers, each as the first packet of its transfer
+	for (int32_t i = 0; i < FakeHub::kNumDevices; i++) {
+		hub.transfer();
+	}
+	for (int32_t d = 0; d < FakeHub::kNumDevices; d++) {
+		CHECK(!hub.received[d].empty());
+		CHECK_EQUAL(kClock, hub.received[d][d == 0 ? 4 : 0]);
+	}
+
+	// And device 0 still gets all its CCs, in order
+	while (hub.transfer() >= 0) {}
+	CHECK_EQUAL(201, (int32_t)hub.received[0].size());
+	for (int32_t i = 0, n = 0; i < (int32_t)hub.received[0].size(); i++) {
+		if (hub.received[0][i] != kClock) {
+			CHECK_EQUAL(cc(0, n & 127), hub.received[0][i]);
+			n++;
+		}
+	}
+}
+
+TEST(USBSendQueueTest, devicesTakeTurns) {
+	FakeHub hub;
+	for (int32_t i = 0; i < 20; i++) {
+		hub.devices[0].push(cc(0, i));
+		hub.devices[3].push(noteOn(0, i));
+	}
+
+	std::vector<int32_t> order;
+	for (int32_t i = 0; i < 4; i++) {
+		order.push_back(hub.transfer());
+	}
+	CHECK(order == (std::vector<int32_t>{3, 0, 3, 0}));
+}
+
+TEST(USBSendQueueTest, cablesWeDontSendToAreRefused) {
+	USBMIDISendQueue queue;
+	queue.clear();
+	CHECK(!queue.push(noteOn(USB_MIDI_NUM_CABLES, 60)));
+	CHECK(queue.isEmpty());
+}
+
+TEST_GROUP(USBSysexOverflowTest) {
+	USBMIDISendQueue queue;
+	USBMIDISysexOverflow overflow;
+	void setup() { queue.clear(); }
+};
+
+TEST(USBSysexOverflowTest, longSysexWaitsForRoomAndStaysInOrder) {
+	constexpr int32_t kNumPackets = USB_MIDI_CABLE_QUEUE_LEN + 100;
+	CHECK(overflow.getSpace(queue, 1) >= kNumPackets);
+	for (int32_t i = 0; i < kNumPackets; i++) {
+		overflow.push(queue, sysex(1, i));
+	}
+	CHECK_EQUAL(0, queue.getSpace(1));
+	CHECK(!overflow.isEmpty());
+
+	std::vector<uint32_t> sent;
+	uint32_t packets[32];
+	while (true) {
+		int32_t num = queue.pop(packets, 32);
+		if (!num) {
+			break;
+		}
+		sent.insert(sent.end(), packets, packets + num);
+		overflow.refill();
+	}
+	CHECK(overflow.isEmpty());
+	CHECK_EQUAL(kNumPackets, (int32_t)sent.size());
+	for (int32_t i = 0; i < kNumPackets; i++) {
+		CHECK_EQUAL(sysex(1, i), sent[i]);
+	}
+}
+
+TEST(USBSysexOverflowTest, nextSysexQueuesBehindOneStillWaiting) {
+	for (int32_t i = 0; i < USB_MIDI_CABLE_QUEUE_LEN + 10; i++) {
+		overflow.push(queue, sysex(1, i));
+	}
+	// Room comes up in the queue, but the next sysex mustn't jump in ahead of the rest of the first
+	uint32_t packets[20];
+	CHECK_EQUAL(20, queue.pop(packets, 20));
+	CHECK_EQUAL(USBMIDISysexOverflow::kMaxPackets - 10, overflow.getSpace(queue, 1));
+	overflow.push(queue, sysex(1, 1000));
+	CHECK_EQUAL(20, queue.getSpace(1));
+
+	overflow.refill();
+	CHECK(overflow.isEmpty());
+	std::vector<uint32_t> sent(packets, packets + 20);
+	int32_t num;
+	while ((num = queue.pop(packets, 20))) {
+		sent.insert(sent.end(), packets, packets + num);
+	}
+	CHECK_EQUAL(sysex(1, USB_MIDI_CABLE_QUEUE_LEN + 9), sent[sent.size() - 2]);
+	CHECK_EQUAL(sysex(1, 1000), sent.back());
+}
+
+TEST(USBSysexOverflowTest, otherCablesOnlyGetTheirQueueWhileInUse) {
+	for (int32_t i = 0; i < USB_MIDI_CABLE_QUEUE_LEN + 10; i++) {
+		overflow.push(queue, sysex(1, i));
+	}
+	CHECK_EQUAL(USB_MIDI_CABLE_QUEUE_LEN, overflow.getSpace(queue, 2));
+
+	USBMIDISendQueue otherDevice;
+	otherDevice.clear();
+	CHECK_EQUAL(USB_MIDI_CABLE_QUEUE_LEN, overflow.getSpace(otherDevice, 1));
+
+	// Which they can use straight away
+	overflow.push(queue, sysex(2, 0));
+	CHECK_EQUAL(USB_MIDI_CABLE_QUEUE_LEN - 1, queue.getSpace(2));
+}
+
+TEST(USBSysexOverflowTest, forgottenWhenItsDeviceGoes) {
+	for (int32_t i = 0; i < USB_MIDI_CABLE_QUEUE_LEN + 10; i++) {
+		overflow.push(queue, sysex(0, i));
+	}
+	overflow.forget(queue);
+	CHECK(overflow.isEmpty());
+	CHECK_EQUAL(USB_MIDI_CABLE_QUEUE_LEN + USBMIDISysexOverflow::kMaxPackets, overflow.getSpace(queue, 1));
+}